@@ -18,6 +18,7 @@
 #include <string>
 #include <cstdio>
 #include <boost/smart_ptr.hpp>
+#include "compress.h"
 
 namespace kpfutils {
 
@@ -34,6 +35,71 @@ namespace kpfutils {
  */
 boost::shared_ptr<FILE> fileCheckOpen(const std::string& fileName, const char* mode);
 
+/** Wrapper that throws @ref kpfutils::except::FileIo "FileIo" if it cannot 
+ *	open a file, optionally compressing everything written to it
+ */
+boost::shared_ptr<FILE> fileCheckOpen(const std::string& fileName, const char* mode, 
+	Codec codec);
+
+/** Closes a file opened by fileCheckOpen(), throwing 
+ *	@ref kpfutils::except::FileIo "FileIo" if any of the data written to 
+ *	it were lost
+ */
+void fileCheckClose(boost::shared_ptr<FILE>& hFile);
+
+namespace detail {
+
+/** Deleter for uncompressed file handles created by fileCheckOpen()
+ *
+ * A deleter cannot report errors, so fileCheckClose() closes the file 
+ * through close() instead, and the deleter then does nothing.
+ */
+class FileCloser {
+public:
+	/** Creates a deleter for a file.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory to 
+	 *	store the file name.
+	 */
+	explicit FileCloser(const std::string& fileName) : fileName(fileName), closed(false) {
+	}
+
+	/** Closes the file, if close() has not already done so.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	void operator()(FILE* hFile) {
+		if (!closed) {
+			fclose(hFile);
+		}
+	}
+
+	/** Closes the file.
+	 *
+	 * @return The return value of @c fclose().
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	int close(FILE* hFile) {
+		closed = true;
+		return fclose(hFile);
+	}
+
+	/** Returns the name of the file.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	const std::string& name() const {
+		return fileName;
+	}
+
+private:
+	std::string fileName;
+	bool closed;
+};
+
+}	// end detail
+
 /** Wrapper that throws @c std::bad_alloc if an object was not allocated and 
  *	has no effect otherwise.
  *
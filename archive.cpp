@@ -0,0 +1,523 @@
+/** Single-file archives of many named tables
+ * @file common/archive.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/smart_ptr.hpp>
+#include "alloc.tmp.h"
+#include "archive.h"
+#include "cerror.h"
+#include "fileio.h"
+
+namespace {
+
+using std::string;
+
+/** First line of every archive
+ */
+const string ARCHIVE_MAGIC = "#kpfutils archive 1\n";
+/** Start of the fixed-length last line of every archive. The line gives
+ *	the offset of the index.
+ */
+const string TRAILER_TAG   = "#index ";
+/** Width of the index offset in the trailer
+ */
+const size_t TRAILER_DIGITS = 20;
+/** Total length of the trailer, including its newline
+ */
+const size_t TRAILER_SIZE  = TRAILER_TAG.size() + TRAILER_DIGITS + 1;
+
+/** Reads a block of a file, without disturbing the file position
+ *
+ * @param[in] hInput The file to read.
+ * @param[in] offset The position of the first byte to read.
+ * @param[in] length The number of bytes to read.
+ * @param[out] buffer The location to store the data.
+ *
+ * @exception kpfutils::except::FileIo Thrown if the data could not be read.
+ *
+ * @exceptsafe @p buffer is in an unspecified state in the event of an exception.
+ */
+void readBlock(FILE* hInput, off_t offset, size_t length, char* buffer) {
+	const int fd = fileno(hInput);
+	while (length > 0) {
+		ssize_t nRead = pread(fd, buffer, length, offset);
+		if (nRead < 0 && errno == EINTR) {
+			continue;
+		} else if (nRead < 0) {
+			int err = errno;
+			errno = 0;
+			throw kpfutils::except::FileIo(string("Could not read archive: ")
+				+ strerror(err));
+		} else if (nRead == 0) {
+			throw kpfutils::except::FileIo("Could not read archive: unexpected end of file");
+		}
+		buffer += nRead;
+		offset += nRead;
+		length -= static_cast<size_t>(nRead);
+	}
+}
+
+/** Reports a failed C library call on an archive
+ *
+ * @param[in] msg A string prepended to the error message.
+ *
+ * @post @c errno = 0
+ *
+ * @exception kpfutils::except::FileIo Always thrown.
+ */
+void throwIoError(const string& msg) {
+	int err = errno;
+	errno = 0;
+	throw kpfutils::except::FileIo(msg + strerror(err));
+}
+
+/** Deleter for file handles that read from a memory buffer
+ *
+ * The deleter owns the buffer, so that it lives exactly as long as the
+ * file handle.
+ */
+class MemoryCloser {
+public:
+	explicit MemoryCloser(const boost::shared_array<char>& buffer) : buffer(buffer) {
+	}
+
+	void operator()(FILE* hInput) {
+		fclose(hInput);
+	}
+
+private:
+	boost::shared_array<char> buffer;
+};
+
+}	// end anonymous namespace
+
+namespace kpfutils {
+
+using boost::lexical_cast;
+using boost::shared_ptr;
+
+/** Creates a new, empty archive.
+ *
+ * @param[in] fileName The file in which to store the archive. If the file
+ *	already exists, it is replaced.
+ *
+ * @exception kpfutils::except::FileIo Thrown if the file could not be
+ *	created.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+ArchiveWriter::ArchiveWriter(const string& fileName) : fileName(fileName),
+		hArchive(fileCheckOpen(fileName, "wb")), names(), nameSet(), extents(),
+		curName(), curStart(0), inEntry(false) {
+	if (fputs(ARCHIVE_MAGIC.c_str(), hArchive.get()) < 0) {
+		fileError(hArchive.get(), "Could not start archive " + fileName + ": ");
+	}
+}
+
+/** Closes the archive, if it has not been closed already.
+ *
+ * If an entry is still being written, it is discarded.
+ *
+ * @exceptsafe Does not throw exceptions. Any errors in writing the index
+ *	are ignored; call close() explicitly to detect them.
+ */
+ArchiveWriter::~ArchiveWriter() {
+	try {
+		close();
+	} catch (...) {
+	}
+}
+
+/** Starts a new entry in the archive.
+ *
+ * @param[in] entryName The name under which the entry will be stored.
+ *
+ * @return A handle to which the contents of the entry should be written.
+ *	The handle remains owned by the archive, and must not be closed or
+ *	repositioned. It may only be used until the next call to endEntry(),
+ *	discardEntry(), or close().
+ *
+ * @pre No entry is in progress
+ * @pre @p entryName is not empty, does not contain a newline, and has
+ *	not already been used in this archive
+ *
+ * @exception std::logic_error Thrown if an entry is already in progress
+ *	or the archive has been closed.
+ * @exception std::invalid_argument Thrown if @p entryName is not a valid
+ *	name.
+ * @exception kpfutils::except::FileIo Thrown if the archive could not be
+ *	accessed.
+ *
+ * @exceptsafe The object is unchanged in the event of an exception.
+ */
+FILE* ArchiveWriter::beginEntry(const string& entryName) {
+	if (hArchive.get() == NULL) {
+		throw std::logic_error("Archive " + fileName + " has already been closed");
+	}
+	if (inEntry) {
+		throw std::logic_error("Cannot start entry " + entryName + " in " + fileName
+			+ " before finishing entry " + curName);
+	}
+	if (entryName.empty() || entryName.find('\n') != string::npos) {
+		throw std::invalid_argument("Invalid archive entry name '" + entryName + "'");
+	}
+	if (nameSet.count(entryName) > 0) {
+		throw std::invalid_argument("Archive " + fileName
+			+ " already contains an entry named " + entryName);
+	}
+
+	off_t start = ftello(hArchive.get());
+	if (start < 0) {
+		throwIoError("Could not find position in " + fileName + ": ");
+	}
+
+	// IMPORTANT: no exceptions beyond this point
+
+	curName  = entryName;
+	curStart = start;
+	inEntry  = true;
+	return hArchive.get();
+}
+
+/** Finishes the current entry and adds it to the index.
+ *
+ * @pre An entry is in progress
+ *
+ * @post No entry is in progress
+ *
+ * @exception std::logic_error Thrown if no entry is in progress.
+ * @exception kpfutils::except::FileIo Thrown if the archive could not be
+ *	accessed.
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	extend the index.
+ *
+ * @exceptsafe The object is unchanged in the event of an exception.
+ */
+void ArchiveWriter::endEntry() {
+	if (!inEntry) {
+		throw std::logic_error("No entry in progress in " + fileName);
+	}
+
+	off_t end = ftello(hArchive.get());
+	if (end < 0) {
+		throwIoError("Could not find position in " + fileName + ": ");
+	}
+
+	names.push_back(curName);
+	try {
+		extents.push_back(std::make_pair(curStart, end - curStart));
+		try {
+			nameSet.insert(curName);
+		} catch (...) {
+			extents.pop_back();
+			throw;
+		}
+	} catch (...) {
+		names.pop_back();
+		throw;
+	}
+
+	// IMPORTANT: no exceptions beyond this point
+
+	curName.clear();
+	inEntry = false;
+}
+
+/** Abandons the current entry, removing it from the archive.
+ *
+ * Anything written since the last call to beginEntry() will be
+ * overwritten by the next entry or by the index.
+ *
+ * @post No entry is in progress
+ *
+ * @exception kpfutils::except::FileIo Thrown if the archive could not be
+ *	accessed.
+ *
+ * @exceptsafe The object is unchanged in the event of an exception.
+ */
+void ArchiveWriter::discardEntry() {
+	if (inEntry) {
+		if (0 != fseeko(hArchive.get(), curStart, SEEK_SET)) {
+			throwIoError("Could not rewind " + fileName + ": ");
+		}
+		curName.clear();
+		inEntry = false;
+	}
+}
+
+/** Writes the archive index and closes the file.
+ *
+ * If an entry is still being written, it is discarded. Calling close()
+ * on a closed archive has no effect.
+ *
+ * @exception kpfutils::except::FileIo Thrown if the index could not be
+ *	written.
+ *
+ * @exceptsafe The archive is closed, but may be unreadable, in the event
+ *	of an exception.
+ */
+void ArchiveWriter::close() {
+	if (hArchive.get() == NULL) {
+		return;
+	}
+	// Release the file no matter what
+	boost::shared_ptr<FILE> hOutput;
+	hOutput.swap(hArchive);
+
+	if (inEntry) {
+		if (0 != fseeko(hOutput.get(), curStart, SEEK_SET)) {
+			throwIoError("Could not rewind " + fileName + ": ");
+		}
+		inEntry = false;
+	}
+
+	off_t indexStart = ftello(hOutput.get());
+	if (indexStart < 0) {
+		throwIoError("Could not find position in " + fileName + ": ");
+	}
+
+	for(size_t i = 0; i < names.size(); i++) {
+		const string line = lexical_cast<string>(extents[i].first) + " "
+			+ lexical_cast<string>(extents[i].second) + " " + names[i] + "\n";
+		if (fputs(line.c_str(), hOutput.get()) < 0) {
+			fileError(hOutput.get(), "Could not write index of " + fileName + ": ");
+		}
+	}
+
+	string offset = lexical_cast<string>(indexStart);
+	offset.insert(0, TRAILER_DIGITS - offset.size(), ' ');
+	if (fputs((TRAILER_TAG + offset + "\n").c_str(), hOutput.get()) < 0) {
+		fileError(hOutput.get(), "Could not write index of " + fileName + ": ");
+	}
+
+	// A discarded entry may have left data past the end of the index
+	off_t archiveEnd = ftello(hOutput.get());
+	if (archiveEnd < 0) {
+		throwIoError("Could not find position in " + fileName + ": ");
+	}
+	if (0 != fflush(hOutput.get())) {
+		fileError(hOutput.get(), "Could not write index of " + fileName + ": ");
+	}
+	if (0 != ftruncate(fileno(hOutput.get()), archiveEnd)) {
+		throwIoError("Could not truncate " + fileName + ": ");
+	}
+}
+
+/** Opens an existing archive and loads its index.
+ *
+ * @param[in] fileName The archive to read.
+ *
+ * @exception kpfutils::except::FileIo Thrown if the file could not be
+ *	read or is not a valid archive.
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	store the index.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+ArchiveReader::ArchiveReader(const string& fileName) : fileName(fileName),
+		hArchive(fileCheckOpen(fileName, "rb")), index() {
+	const string invalid = fileName + " is not a valid archive";
+
+	if (0 != fseeko(hArchive.get(), 0, SEEK_END)) {
+		throwIoError("Could not read " + fileName + ": ");
+	}
+	off_t fileSize = ftello(hArchive.get());
+	if (fileSize < 0) {
+		throwIoError("Could not read " + fileName + ": ");
+	}
+	if (fileSize < static_cast<off_t>(ARCHIVE_MAGIC.size() + TRAILER_SIZE)) {
+		throw except::FileIo(invalid);
+	}
+
+	std::vector<char> buffer(std::max(ARCHIVE_MAGIC.size(), TRAILER_SIZE));
+	readBlock(hArchive.get(), 0, ARCHIVE_MAGIC.size(), &buffer[0]);
+	if (string(&buffer[0], ARCHIVE_MAGIC.size()) != ARCHIVE_MAGIC) {
+		throw except::FileIo(invalid);
+	}
+
+	const off_t trailerStart = fileSize - static_cast<off_t>(TRAILER_SIZE);
+	readBlock(hArchive.get(), trailerStart, TRAILER_SIZE, &buffer[0]);
+	const string trailer(&buffer[0], TRAILER_SIZE);
+	if (trailer.compare(0, TRAILER_TAG.size(), TRAILER_TAG) != 0) {
+		throw except::FileIo(invalid);
+	}
+	off_t indexStart;
+	try {
+		indexStart = lexical_cast<off_t>(boost::algorithm::trim_copy(
+			trailer.substr(TRAILER_TAG.size(), TRAILER_DIGITS)));
+	} catch (const boost::bad_lexical_cast& e) {
+		throw except::FileIo(invalid);
+	}
+	if (indexStart < static_cast<off_t>(ARCHIVE_MAGIC.size())
+			|| indexStart > trailerStart) {
+		throw except::FileIo(invalid);
+	}
+
+	std::vector<char> indexText(static_cast<size_t>(trailerStart - indexStart) + 1);
+	readBlock(hArchive.get(), indexStart, indexText.size() - 1, &indexText[0]);
+
+	// Parse "offset length name" lines
+	const char* line = &indexText[0];
+	const char* const indexEnd = line + indexText.size() - 1;
+	while (line < indexEnd) {
+		const char* lineEnd = std::find(line, indexEnd, '\n');
+		const char* space1  = std::find(line, lineEnd, ' ');
+		const char* space2  = std::find(space1 == lineEnd ? lineEnd : space1+1, lineEnd, ' ');
+		if (space2 == lineEnd) {
+			throw except::FileIo(invalid);
+		}
+
+		off_t offset, length;
+		try {
+			offset = lexical_cast<off_t>(string(line, space1));
+			length = lexical_cast<off_t>(string(space1+1, space2));
+		} catch (const boost::bad_lexical_cast& e) {
+			throw except::FileIo(invalid);
+		}
+		if (offset < 0 || length < 0 || offset + length > indexStart) {
+			throw except::FileIo(invalid);
+		}
+		index[string(space2+1, lineEnd)] = std::make_pair(offset, length);
+
+		line = lineEnd + 1;
+	}
+}
+
+/** Tests whether the archive has an entry with a particular name.
+ *
+ * @param[in] entryName The name to search for.
+ *
+ * @return True if and only if the archive contains an entry named
+ *	@p entryName.
+ *
+ * @perform O(log N), where N is the number of entries in the archive.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+bool ArchiveReader::contains(const string& entryName) const {
+	return index.count(entryName) > 0;
+}
+
+/** Returns the names of all entries in the archive.
+ *
+ * @return The entry names, in lexicographic order.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	store the names.
+ *
+ * @exceptsafe The object is unchanged in the event of an exception.
+ */
+std::vector<string> ArchiveReader::entryNames() const {
+	std::vector<string> names;
+	names.reserve(index.size());
+	for(Index::const_iterator it = index.begin(); it != index.end(); it++) {
+		names.push_back(it->first);
+	}
+	return names;
+}
+
+/** Looks up an entry, throwing if it does not exist
+ *
+ * @param[in] entryName The entry to search for.
+ *
+ * @return The index record for @p entryName.
+ *
+ * @exception std::invalid_argument Thrown if there is no entry named
+ *	@p entryName.
+ *
+ * @exceptsafe The object is unchanged in the event of an exception.
+ */
+const ArchiveReader::Index::value_type& ArchiveReader::find(const string& entryName) const {
+	Index::const_iterator it = index.find(entryName);
+	if (it == index.end()) {
+		throw std::invalid_argument("Archive " + fileName + " has no entry named "
+			+ entryName);
+	}
+	return *it;
+}
+
+/** Returns the contents of an entry.
+ *
+ * @param[in] entryName The entry to read.
+ *
+ * @return The complete contents of the entry, exactly as they were
+ *	written.
+ *
+ * @perform O(log N + L), where N is the number of entries in the
+ *	archive and L is the length of the entry.
+ *
+ * @exception std::invalid_argument Thrown if there is no entry named
+ *	@p entryName.
+ * @exception kpfutils::except::FileIo Thrown if the entry could not be read.
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	store the entry.
+ *
+ * @exceptsafe The object is unchanged in the event of an exception.
+ */
+string ArchiveReader::read(const string& entryName) const {
+	const Index::value_type& entry = find(entryName);
+	const size_t length = static_cast<size_t>(entry.second.second);
+
+	if (length == 0) {
+		return string();
+	}
+	std::vector<char> buffer(length);
+	readBlock(hArchive.get(), entry.second.first, length, &buffer[0]);
+	return string(buffer.begin(), buffer.end());
+}
+
+/** Returns a read-only file handle to the contents of an entry.
+ *
+ * This function allows entries to be parsed by any function that reads
+ * an open file, such as
+ * @ref kpfutils::readTable(FILE*, const string&, vector<double>&, vector<double>&) "readTable()".
+ *
+ * @param[in] entryName The entry to read.
+ *
+ * @return A handle that reads the entry from memory. The handle is
+ *	independent of the archive, and may outlive this object.
+ *
+ * @exception std::invalid_argument Thrown if there is no entry named
+ *	@p entryName.
+ * @exception kpfutils::except::FileIo Thrown if the entry could not be read.
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	store the entry.
+ *
+ * @exceptsafe The object is unchanged in the event of an exception.
+ */
+shared_ptr<FILE> ArchiveReader::open(const string& entryName) const {
+	const Index::value_type& entry = find(entryName);
+	const size_t length = static_cast<size_t>(entry.second.second);
+
+	// fmemopen() cannot represent an empty buffer
+	boost::shared_array<char> buffer(new char[std::max<size_t>(length, 1)]);
+	readBlock(hArchive.get(), entry.second.first, length, buffer.get());
+
+	FILE* hEntry = (length > 0 ? fmemopen(buffer.get(), length, "r") : tmpfile());
+	if (hEntry == NULL) {
+		throwIoError("Could not open entry " + entryName + " in " + fileName + ": ");
+	}
+	return shared_ptr<FILE>(hEntry, MemoryCloser(buffer));
+}
+
+}	// end kpfutils
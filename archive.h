@@ -0,0 +1,149 @@
+/** Single-file archives of many named tables
+ * @file common/archive.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#ifndef KPFUTILSARCHIVEH
+#define KPFUTILSARCHIVEH
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cstdio>
+#include <sys/types.h>
+#include <boost/smart_ptr.hpp>
+
+namespace kpfutils {
+
+using std::string;
+
+/** @defgroup archive Table Archives
+ *
+ * These classes store many small text tables in a single large file.
+ *
+ * An archive consists of the concatenated contents of each table (called
+ * an entry), followed by an index giving the name, offset, and length
+ * of each entry. Any single entry can be retrieved without reading the
+ * rest of the archive. Writing one archive in place of thousands of
+ * small files greatly reduces the load on shared file system metadata
+ * servers.
+ *
+ * Include archive.h to use these classes.
+ *
+ * @{
+ */
+
+/** Writes tables to a new archive file.
+ *
+ * Each entry is written by calling beginEntry(), writing to the returned
+ * handle with any table-printing function (e.g.,
+ * @ref kpfutils::printTable() "printTable()"), and then calling
+ * endEntry(). The index is written by close().
+ */
+class ArchiveWriter {
+public:
+	/** Creates a new, empty archive.
+	 */
+	explicit ArchiveWriter(const string& fileName);
+
+	/** Closes the archive, if it has not been closed already.
+	 */
+	~ArchiveWriter();
+
+	/** Starts a new entry in the archive.
+	 */
+	FILE* beginEntry(const string& entryName);
+
+	/** Finishes the current entry and adds it to the index.
+	 */
+	void endEntry();
+
+	/** Abandons the current entry, removing it from the archive.
+	 */
+	void discardEntry();
+
+	/** Writes the archive index and closes the file.
+	 */
+	void close();
+
+private:
+	// Not copyable
+	ArchiveWriter(const ArchiveWriter&);
+	ArchiveWriter& operator=(const ArchiveWriter&);
+
+	string fileName;
+	boost::shared_ptr<FILE> hArchive;
+
+	/** Names of all entries written so far, in the order they were written
+	 */
+	std::vector<string> names;
+	/** Names of all entries written so far, for fast duplicate checks
+	 */
+	std::set<string> nameSet;
+	/** Offset and length of each entry in @p names
+	 */
+	std::vector<std::pair<off_t, off_t> > extents;
+
+	/** Name of the entry being written, or empty if none
+	 */
+	string curName;
+	/** Offset of the entry being written
+	 */
+	off_t curStart;
+	bool inEntry;
+};
+
+/** Provides random access to the entries in an archive.
+ *
+ * ArchiveReader is safe to use from multiple threads at once.
+ */
+class ArchiveReader {
+public:
+	/** Opens an existing archive and loads its index.
+	 */
+	explicit ArchiveReader(const string& fileName);
+
+	/** Tests whether the archive has an entry with a particular name.
+	 */
+	bool contains(const string& entryName) const;
+
+	/** Returns the names of all entries in the archive.
+	 */
+	std::vector<string> entryNames() const;
+
+	/** Returns the contents of an entry.
+	 */
+	string read(const string& entryName) const;
+
+	/** Returns a read-only file handle to the contents of an entry.
+	 */
+	boost::shared_ptr<FILE> open(const string& entryName) const;
+
+private:
+	typedef std::map<string, std::pair<off_t, off_t> > Index;
+
+	/** Looks up an entry, throwing if it does not exist
+	 */
+	const Index::value_type& find(const string& entryName) const;
+
+	string fileName;
+	boost::shared_ptr<FILE> hArchive;
+	Index index;
+};
+
+/** @} */	// end archive
+
+}	// end kpfutils
+
+#endif		// KPFUTILSARCHIVEH
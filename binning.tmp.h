@@ -0,0 +1,380 @@
+/** Statistics of data grouped into bins
+ * @file common/binning.tmp.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#ifndef KPFUTILSBINNINGH
+#define KPFUTILSBINNINGH
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+#include <boost/concept/requires.hpp>
+#include <boost/iterator/iterator_concepts.hpp>
+#include "stats.tmp.h"
+
+namespace kpfutils {
+
+/** @addtogroup stats
+ *
+ * Include binning.tmp.h to compute statistics of data grouped by another
+ * quantity, such as the night or the phase of each measurement.
+ *
+ * @{
+ */
+
+/** A set of adjacent bins on the real line.
+ *
+ * Bin i covers the interval [@p edges()[i], @p edges()[i+1]), except that
+ * the last bin also includes its upper edge. Bins may be uniform, in
+ * which case a value's bin is found by arithmetic, or have arbitrary
+ * edges, in which case it is found by binary search.
+ */
+class BinEdges {
+public:
+	/** Creates a set of equal-width bins.
+	 *
+	 * @param[in] low The lower edge of the first bin.
+	 * @param[in] high The upper edge of the last bin.
+	 * @param[in] nBins The number of bins.
+	 *
+	 * @exception std::invalid_argument Thrown if @p nBins is zero or
+	 *	@p low &ge; @p high.
+	 * @exception std::bad_alloc Thrown if there is not enough memory to
+	 *	store the edges.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	BinEdges(double low, double high, size_t nBins) : edgeList(), uniform(true),
+			low(low), high(high), scale(0.0) {
+		if (nBins == 0) {
+			throw std::invalid_argument("BinEdges must have at least one bin");
+		}
+		if (!(low < high)) {
+			throw std::invalid_argument("BinEdges must have a positive width");
+		}
+
+		const double width = (high - low) / static_cast<double>(nBins);
+		edgeList.reserve(nBins + 1);
+		for(size_t i = 0; i < nBins; i++) {
+			edgeList.push_back(low + static_cast<double>(i) * width);
+		}
+		edgeList.push_back(high);
+		scale = static_cast<double>(nBins) / (high - low);
+	}
+
+	/** Creates a set of bins with arbitrary edges.
+	 *
+	 * @param[in] edges The edges of the bins, in ascending order.
+	 *
+	 * @exception std::invalid_argument Thrown if @p edges has fewer than
+	 *	two elements or is not strictly increasing.
+	 * @exception std::bad_alloc Thrown if there is not enough memory to
+	 *	store the edges.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	explicit BinEdges(const std::vector<double>& edges) : edgeList(edges),
+			uniform(false), low(0.0), high(0.0), scale(0.0) {
+		if (edges.size() < 2) {
+			throw std::invalid_argument("BinEdges must have at least one bin");
+		}
+		for(size_t i = 1; i < edges.size(); i++) {
+			if (!(edges[i-1] < edges[i])) {
+				throw std::invalid_argument("BinEdges must be strictly increasing");
+			}
+		}
+		low  = edges.front();
+		high = edges.back();
+	}
+
+	/** Returns the number of bins.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	size_t size() const {
+		return edgeList.size() - 1;
+	}
+
+	/** Returns the edges of the bins, in the form expected by printHist().
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	const std::vector<double>& edges() const {
+		return edgeList;
+	}
+
+	/** Tests whether the bins have equal widths.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	bool isUniform() const {
+		return uniform;
+	}
+
+	/** Finds the bin containing a value.
+	 *
+	 * @param[in] key The value to look up.
+	 * @param[out] bin If the function returns true, the index of the
+	 *	bin containing @p key. Otherwise unchanged.
+	 *
+	 * @return True if @p key lies in one of the bins, false if it is
+	 *	outside all of them or is NaN.
+	 *
+	 * @perform O(1) for uniform bins, O(log B) otherwise, where
+	 *	B = size().
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	bool find(double key, size_t& bin) const {
+		// Also rejects NaN
+		if (!(key >= low && key <= high)) {
+			return false;
+		}
+
+		const size_t nBins = edgeList.size() - 1;
+		size_t i = 0;
+		if (uniform) {
+			i = std::min(static_cast<size_t>((key - low) * scale), nBins - 1);
+			// Correct for rounding, so that bins agree exactly with edges()
+			if (key < edgeList[i]) {
+				i--;
+			} else if (i + 1 < nBins && key >= edgeList[i+1]) {
+				i++;
+			}
+		} else {
+			i = std::upper_bound(edgeList.begin(), edgeList.end(), key)
+				- edgeList.begin() - 1;
+			i = std::min(i, nBins - 1);
+		}
+
+		bin = i;
+		return true;
+	}
+
+private:
+	std::vector<double> edgeList;
+	bool uniform;
+	double low;
+	double high;
+	/** Number of bins per unit key, for uniform bins
+	 */
+	double scale;
+};
+
+/** Flags selecting the statistics computed by binnedStats()
+ */
+enum BinStatistic {
+	/** Number of values in each bin
+	 */
+	BIN_COUNT    = 1,
+	/** Mean of each bin
+	 */
+	BIN_MEAN     = 2,
+	/** Sample variance of each bin
+	 */
+	BIN_VARIANCE = 4,
+	/** Median of each bin, as found by quantile()
+	 */
+	BIN_MEDIAN   = 8,
+	/** All of the above
+	 */
+	BIN_ALL      = 15
+};
+
+/** Statistics of data grouped into bins, as returned by binnedStats()
+ *
+ * Each vector of statistics has one element per bin, or is empty if
+ * the statistic was not requested. Any of them may be passed to
+ * printHist() together with @p binEdges.
+ */
+struct BinnedStats {
+	/** Creates an empty set of statistics.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	BinnedStats() : binEdges(), count(), mean(), variance(), median() {
+	}
+
+	/** Exchanges the contents of two sets of statistics.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	void swap(BinnedStats& other) {
+		binEdges.swap(other.binEdges);
+		count   .swap(other.count);
+		mean    .swap(other.mean);
+		variance.swap(other.variance);
+		median  .swap(other.median);
+	}
+
+	/** The edges of the bins
+	 */
+	std::vector<double> binEdges;
+	/** The number of values in each bin
+	 */
+	std::vector<double> count;
+	/** The mean of each bin, or NaN if the bin is empty
+	 */
+	std::vector<double> mean;
+	/** The sample variance of each bin, or NaN if the bin has fewer
+	 *	than two values
+	 */
+	std::vector<double> variance;
+	/** The median of each bin, or NaN if the bin is empty
+	 */
+	std::vector<double> median;
+};
+
+/** Computes statistics of data grouped into bins by a key, such as the
+ *	time or phase of each measurement. The keys are accessed using
+ *	first and last iterators, and the data are read from a parallel
+ *	range.
+ *
+ * Each key is assigned to a bin as it is read, and the corresponding
+ * datum is added to that bin's running count, mean, and sum of squared
+ * deviations, so the data are traversed only once. If the median is
+ * requested, the data are also copied into a single buffer, grouped by
+ * bin, and each group is partially sorted in place. Data whose keys lie
+ * outside all bins are ignored.
+ *
+ * @tparam ConstInputIterator1 The iterator type for the keys. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
+ * @tparam ConstInputIterator2 The iterator type for the data. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
+ * @param[in] bins The bins into which to group the data.
+ * @param[in] keyFirst Input iterator marking the key of the first datum.
+ * @param[in] keyLast Input iterator marking the position after the key
+ *	of the last datum.
+ * @param[in] dataFirst Input iterator marking the first datum.
+ * @param[in] which A bitwise OR of BinStatistic values naming the
+ *	statistics to compute.
+ * @param[out] result The edges of @p bins and the requested statistics
+ *	of each bin. Statistics not requested are left empty.
+ *
+ * @pre The range starting at @p dataFirst has at least as many elements
+ *	as [@p keyFirst, @p keyLast)
+ * @pre No datum whose key lies in @p bins is NaN
+ *
+ * @perform O(D + B) for uniform bins and O(D log B + B) otherwise, where
+ *	D = std::distance(@p keyFirst, @p keyLast) and B = @p bins.size().
+ *	Finding medians adds O(D) on average.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	store the statistics.
+ *
+ * @exceptsafe The arguments are unchanged in the event of an exception.
+ *
+ * @test Uniform bins, keys 0 to 99, data random. Expected
+ *	behavior: each bin's count, mean, variance, and median agree with
+ *	mean(), variance(), and quantile() applied to its slice.
+ * @test Arbitrary bins, random keys and data. Expected behavior: same
+ *	counts as equivalent uniform bins.
+ * @test Keys on every bin edge, below the first edge, above the last
+ *	edge, and NaN. Expected behavior: edge keys go in the bin they
+ *	start, except the last edge, which goes in the last bin; the others
+ *	are ignored.
+ * @test Bins with no data. Expected behavior: count 0, and mean,
+ *	variance, and median NaN.
+ */
+template <typename ConstInputIterator1, typename ConstInputIterator2>
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstInputIterator1>))
+	((ForwardTraversalConcept<ConstInputIterator1>))
+	((ReadableIteratorConcept<ConstInputIterator2>))
+	((ForwardTraversalConcept<ConstInputIterator2>)),	// Iterator semantics
+	(void)) // Return type
+binnedStats(const BinEdges& bins, ConstInputIterator1 keyFirst, ConstInputIterator1 keyLast,
+		ConstInputIterator2 dataFirst, unsigned int which, BinnedStats& result) {
+	const size_t nBins = bins.size();
+	const bool wantMedian = (which & BIN_MEDIAN) != 0;
+
+	std::vector<double> count(nBins, 0.0), mean(nBins, 0.0), m2(nBins, 0.0);
+	std::vector<size_t> binOf;
+	std::vector<double> values;
+	for(; keyFirst != keyLast; keyFirst++, dataFirst++) {
+		size_t bin = 0;
+		if (bins.find(static_cast<double>(*keyFirst), bin)) {
+			const double x = static_cast<double>(*dataFirst);
+
+			// Welford (1962) update of the bin's running moments
+			count[bin] += 1.0;
+			const double delta = x - mean[bin];
+			mean[bin] += delta / count[bin];
+			m2  [bin] += delta * (x - mean[bin]);
+
+			if (wantMedian) {
+				binOf .push_back(bin);
+				values.push_back(x);
+			}
+		}
+	}
+
+	const double NaN = std::numeric_limits<double>::quiet_NaN();
+
+	// copy-and-swap
+	BinnedStats temp;
+	temp.binEdges = bins.edges();
+	if ((which & BIN_COUNT) != 0) {
+		temp.count = count;
+	}
+	if ((which & BIN_MEAN) != 0) {
+		temp.mean.assign(nBins, NaN);
+		for(size_t i = 0; i < nBins; i++) {
+			if (count[i] >= 1.0) {
+				temp.mean[i] = mean[i];
+			}
+		}
+	}
+	if ((which & BIN_VARIANCE) != 0) {
+		temp.variance.assign(nBins, NaN);
+		for(size_t i = 0; i < nBins; i++) {
+			if (count[i] >= 2.0) {
+				temp.variance[i] = m2[i] / (count[i] - 1.0);
+			}
+		}
+	}
+	if (wantMedian) {
+		// Counting sort groups the values by bin in one extra pass
+		std::vector<size_t> start(nBins + 1, 0);
+		for(size_t i = 0; i < nBins; i++) {
+			start[i+1] = start[i] + static_cast<size_t>(count[i]);
+		}
+		std::vector<double> grouped(values.size());
+		std::vector<size_t> next(start.begin(), start.end() - 1);
+		for(size_t i = 0; i < values.size(); i++) {
+			grouped[next[binOf[i]]++] = values[i];
+		}
+
+		temp.median.assign(nBins, NaN);
+		for(size_t i = 0; i < nBins; i++) {
+			const size_t n = start[i+1] - start[i];
+			if (n > 0) {
+				std::vector<double>::iterator mid = grouped.begin() + start[i]
+					+ detail::quantileIndex(0.5, n);
+				std::nth_element(grouped.begin() + start[i], mid,
+					grouped.begin() + start[i+1]);
+				temp.median[i] = *mid;
+			}
+		}
+	}
+
+	// IMPORTANT: no exceptions beyond this point
+
+	result.swap(temp);
+}
+
+/** @} */	// end stats
+
+}	// end kpfutils
+
+#endif		// KPFUTILSBINNINGH
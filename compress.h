@@ -0,0 +1,56 @@
+/** Compression options for output files
+ * @file common/compress.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#ifndef KPFUTILSCOMPRESSH
+#define KPFUTILSCOMPRESSH
+
+#include <string>
+
+namespace kpfutils {
+
+/** @addtogroup cstyle
+ *
+ * Include compress.h to select a compression format for output files.
+ *
+ * @{
+ */
+
+/** Compression formats supported by
+ *	@ref kpfutils::fileCheckOpen(const std::string&, const char*, Codec) "fileCheckOpen()".
+ */
+enum Codec {
+	/** Write plain, uncompressed text
+	 */
+	CODEC_NONE,
+	/** Choose the codec from the file extension, as in codecFromName()
+	 */
+	CODEC_AUTO,
+	/** Write a gzip stream, readable by @c gunzip or @c zcat
+	 */
+	CODEC_GZIP,
+	/** Write a Zstandard stream, readable by @c unzstd or @c zstdcat.
+	 *	Available only if the library was compiled with @c KPFUTILS_HAVE_ZSTD.
+	 */
+	CODEC_ZSTD
+};
+
+/** Identifies the compression format implied by a file name
+ */
+Codec codecFromName(const std::string& fileName);
+
+/** @} */ 	// End cstyle
+
+}	// end kpfutils
+
+#endif	// KPFUTILSCOMPRESSH
@@ -2,7 +2,7 @@
  * @file common/csv.h
  * @author Krzysztof Findeisen
  * @date Created July 24, 2011
- * @date Last modified January 14, 2014
+ * @date Last modified October 18, 2026
  */
 
 /* Copyright 2014, California Institute of Technology.
@@ -18,6 +18,7 @@
 #include <string>
 #include <vector>
 #include <cstdio>
+#include "compress.h"
 
 namespace kpfutils {
 
@@ -55,10 +56,35 @@ void readTable(const string& fileName, const string& format,
 void readTable(FILE* hInput, const string& format, 
 		vector<double>& col1, vector<double>& col2, vector<double>& col3);
 
+/** Reads a file containing two columns of data, storing the second in 
+ *	single precision
+ */
+void readTable(const string& fileName, const string& format, 
+		vector<double>& col1, vector<float>& col2);
+
+/** Reads a file containing two columns of data, storing the second in 
+ *	single precision
+ */
+void readTable(FILE* hInput, const string& format, 
+		vector<double>& col1, vector<float>& col2);
+
+/** Reads a file containing three columns of data, storing the second and 
+ *	third in single precision
+ */
+void readTable(const string& fileName, const string& format, 
+		vector<double>& col1, vector<float>& col2, vector<float>& col3);
+
+/** Reads a file containing three columns of data, storing the second and 
+ *	third in single precision
+ */
+void readTable(FILE* hInput, const string& format, 
+		vector<double>& col1, vector<float>& col2, vector<float>& col3);
+
 /** Prints a file containing a two-column table
  */	
 void printTable(const string& fileName, const string& header, 
-		const vector<double>& col1, const vector<double>& col2);
+		const vector<double>& col1, const vector<double>& col2, 
+		Codec codec = CODEC_AUTO);
 
 /** Prints a file containing a two-column table
  */	
@@ -67,7 +93,8 @@ void printTable(FILE* hOutput, const string& header,
 
 /** Prints a file containing a histogram
  */	
-void printHist(const string& fileName, const vector<double>& binEdges, const vector<double>& values);
+void printHist(const string& fileName, const vector<double>& binEdges, const vector<double>& values, 
+		Codec codec = CODEC_AUTO);
 
 /** Prints a file containing a histogram
  */	
@@ -39,6 +39,8 @@ using boost::shared_ptr;
  * @exceptsafe The function arguments are unchanged in the event of an exception.
  */
 shared_ptr<FILE> fileCheckOpen(const std::string& fileName, const char* mode) {
+	// Allocate the deleter first, so that the file cannot leak
+	detail::FileCloser closer(fileName);
 	FILE* handle = fopen(fileName.c_str(), mode);
 	
 	if (handle == NULL) {
@@ -53,7 +55,7 @@ shared_ptr<FILE> fileCheckOpen(const std::string& fileName, const char* mode) {
 		}
 	}
 	
-	return shared_ptr<FILE>(handle, &fclose);
+	return shared_ptr<FILE>(handle, closer);
 }
 
 }	// end kpfutils
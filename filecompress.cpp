@@ -0,0 +1,591 @@
+/** Functions for writing compressed output files
+ * @file common/filecompress.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <unistd.h>
+#include <zlib.h>
+#ifdef KPFUTILS_HAVE_ZSTD
+#include <zstd.h>
+#endif
+#include <boost/smart_ptr.hpp>
+#include <boost/thread.hpp>
+#include <boost/utility.hpp>
+#include "alloc.tmp.h"
+#include "compress.h"
+#include "fileio.h"
+
+namespace kpfutils {
+
+using boost::shared_ptr;
+using std::string;
+
+/** Identifies the compression format implied by a file name
+ *
+ * @param[in] fileName The name of a file to be written.
+ *
+ * @return CODEC_GZIP if @p fileName ends in ".gz", CODEC_ZSTD if it ends
+ *	in ".zst", and CODEC_NONE otherwise.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+Codec codecFromName(const std::string& fileName) {
+	const size_t len = fileName.size();
+	if (len >= 3 && 0 == fileName.compare(len-3, 3, ".gz")) {
+		return CODEC_GZIP;
+	} else if (len >= 4 && 0 == fileName.compare(len-4, 4, ".zst")) {
+		return CODEC_ZSTD;
+	} else {
+		return CODEC_NONE;
+	}
+}
+
+}	// end kpfutils
+
+namespace {
+
+using boost::shared_ptr;
+using std::string;
+using kpfutils::except::FileIo;
+
+/** Size of the blocks handed from the formatting thread to the compression
+ *	thread, and of the blocks written to disk
+ */
+const size_t CHUNK_SIZE = 1 << 16;
+
+/** Common interface for the supported compression libraries
+ */
+class Compressor : boost::noncopyable {
+public:
+	virtual ~Compressor() {}
+
+	/** Compresses a block of data, writing any completed output to @p hOutput
+	 *
+	 * @exception kpfutils::except::FileIo Thrown if the data could not
+	 *	be compressed or written.
+	 */
+	virtual void compress(const char* data, size_t length, FILE* hOutput) = 0;
+
+	/** Flushes all pending output to @p hOutput and ends the compressed stream
+	 *
+	 * @exception kpfutils::except::FileIo Thrown if the data could not
+	 *	be compressed or written.
+	 */
+	virtual void finish(FILE* hOutput) = 0;
+
+protected:
+	/** Writes a block of compressed data
+	 *
+	 * @exception kpfutils::except::FileIo Thrown if the data could not
+	 *	be written.
+	 */
+	static void put(const char* data, size_t length, FILE* hOutput) {
+		if (length > 0 && fwrite(data, 1, length, hOutput) != length) {
+			throw FileIo(string("Could not write compressed data: ")
+				+ strerror(errno));
+		}
+	}
+};
+
+/** Compressor producing gzip-format output using zlib
+ */
+class GzipCompressor : public Compressor {
+public:
+	GzipCompressor() : stream(), outBuffer(CHUNK_SIZE) {
+		stream.zalloc = Z_NULL;
+		stream.zfree  = Z_NULL;
+		stream.opaque = Z_NULL;
+		// 16 added to the window size requests a gzip header
+		if (Z_OK != deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+				15 + 16, 8, Z_DEFAULT_STRATEGY)) {
+			throw FileIo("Could not initialize gzip compression");
+		}
+	}
+
+	virtual ~GzipCompressor() {
+		deflateEnd(&stream);
+	}
+
+	virtual void compress(const char* data, size_t length, FILE* hOutput) {
+		// zlib does not modify its input, but predates const correctness
+		stream.next_in  = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+		stream.avail_in = static_cast<uInt>(length);
+		deflateAll(Z_NO_FLUSH, hOutput);
+	}
+
+	virtual void finish(FILE* hOutput) {
+		stream.next_in  = Z_NULL;
+		stream.avail_in = 0;
+		deflateAll(Z_FINISH, hOutput);
+	}
+
+private:
+	void deflateAll(int flush, FILE* hOutput) {
+		int status;
+		do {
+			stream.next_out  = reinterpret_cast<Bytef*>(&outBuffer[0]);
+			stream.avail_out = static_cast<uInt>(outBuffer.size());
+			status = deflate(&stream, flush);
+			if (status == Z_STREAM_ERROR) {
+				throw FileIo("Could not compress data with gzip");
+			}
+			put(&outBuffer[0], outBuffer.size() - stream.avail_out, hOutput);
+		} while (stream.avail_out == 0 || (flush == Z_FINISH && status != Z_STREAM_END));
+	}
+
+	z_stream stream;
+	std::vector<char> outBuffer;
+};
+
+#ifdef KPFUTILS_HAVE_ZSTD
+/** Compressor producing Zstandard-format output using libzstd
+ */
+class ZstdCompressor : public Compressor {
+public:
+	ZstdCompressor() : context(ZSTD_createCCtx()), outBuffer(ZSTD_CStreamOutSize()) {
+		if (context == NULL) {
+			throw std::bad_alloc();
+		}
+	}
+
+	virtual ~ZstdCompressor() {
+		ZSTD_freeCCtx(context);
+	}
+
+	virtual void compress(const char* data, size_t length, FILE* hOutput) {
+		ZSTD_inBuffer input = {data, length, 0};
+		while (input.pos < input.size) {
+			streamOnce(input, ZSTD_e_continue, hOutput);
+		}
+	}
+
+	virtual void finish(FILE* hOutput) {
+		ZSTD_inBuffer input = {NULL, 0, 0};
+		while (streamOnce(input, ZSTD_e_end, hOutput) != 0) {
+		}
+	}
+
+private:
+	size_t streamOnce(ZSTD_inBuffer& input, ZSTD_EndDirective mode, FILE* hOutput) {
+		ZSTD_outBuffer output = {&outBuffer[0], outBuffer.size(), 0};
+		size_t remaining = ZSTD_compressStream2(context, &output, &input, mode);
+		if (ZSTD_isError(remaining)) {
+			throw FileIo(string("Could not compress data with zstd: ")
+				+ ZSTD_getErrorName(remaining));
+		}
+		put(&outBuffer[0], output.pos, hOutput);
+		return remaining;
+	}
+
+	// Not copyable
+	ZstdCompressor(const ZstdCompressor&);
+	ZstdCompressor& operator=(const ZstdCompressor&);
+
+	ZSTD_CCtx* context;
+	std::vector<char> outBuffer;
+};
+#endif
+
+/** Creates a compressor for a particular format
+ *
+ * @exception kpfutils::except::FileIo Thrown if @p codec is not supported.
+ */
+Compressor* makeCompressor(kpfutils::Codec codec) {
+	switch (codec) {
+	case kpfutils::CODEC_GZIP:
+		return new GzipCompressor();
+#ifdef KPFUTILS_HAVE_ZSTD
+	case kpfutils::CODEC_ZSTD:
+		return new ZstdCompressor();
+#else
+	case kpfutils::CODEC_ZSTD:
+		throw FileIo("zstd compression is not supported by this build of kpfutils");
+#endif
+	default:
+		throw std::invalid_argument("Not a compression codec");
+	}
+}
+
+/** Flushes and closes a file opened by fileCheckOpen()
+ *
+ * @param[in] closer The deleter of the file.
+ * @param[in] hFile The file to close.
+ *
+ * @return A description of the first error encountered while writing or 
+ *	closing the file, or an empty string if there was none.
+ *
+ * @post @p hFile is closed, even if an exception is thrown.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	describe the error.
+ */
+string closeFile(kpfutils::detail::FileCloser& closer, FILE* hFile) {
+	// Collect all error codes before closing the file, as errno changes
+	int flushErr = 0;
+	const bool flushFailed = (0 != fflush(hFile));
+	if (flushFailed) {
+		flushErr = errno;
+	}
+	// An earlier write may have failed without a later call noticing
+	const bool writeFailed = (0 != ferror(hFile));
+	int closeErr = 0;
+	errno = 0;
+	const bool closeFailed = (0 != closer.close(hFile));
+	if (closeFailed) {
+		closeErr = errno;
+	}
+	errno = 0;
+
+	if (flushFailed) {
+		return "Could not write " + closer.name() + ": " + strerror(flushErr);
+	} else if (writeFailed) {
+		return "Could not write " + closer.name();
+	} else if (closeFailed) {
+		return "Could not close " + closer.name() + ": " + strerror(closeErr);
+	} else {
+		return "";
+	}
+}
+
+/** State shared between a compressed file handle and its compression thread
+ */
+struct CompressedStream : boost::noncopyable {
+	CompressedStream(const string& fileName, int source, const shared_ptr<FILE>& target)
+			: fileName(fileName), source(source), target(target), compressor(), 
+			buffer(CHUNK_SIZE), worker(), error(), closed(false) {
+	}
+
+	/** Closes the pipe, waits for the compression thread, and closes the
+	 *	compressed file
+	 *
+	 * @param[in] hInput The write end of the pipe.
+	 *
+	 * @return A description of the first error encountered while
+	 *	writing the file, or an empty string if there was none.
+	 *
+	 * @post closed is set
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	string close(FILE* hInput) {
+		const bool pipeFailed = (0 != fclose(hInput));
+		const int pipeErr = errno;
+		errno = 0;
+		worker.join();
+		closed = true;
+
+		try {
+			string targetError;
+			kpfutils::detail::FileCloser* closer = 
+				boost::get_deleter<kpfutils::detail::FileCloser>(target);
+			if (closer != NULL) {
+				targetError = closeFile(*closer, target.get());
+			}
+			target.reset();
+
+			if (!error.empty()) {
+				return "Could not write " + fileName + ": " + error;
+			} else if (!targetError.empty()) {
+				return targetError;
+			} else if (pipeFailed) {
+				return "Could not write to compression pipe for " + fileName + ": "
+					+ strerror(pipeErr);
+			} else {
+				return "";
+			}
+		} catch (const std::bad_alloc&) {
+			target.reset();
+			// Too little memory for the message, but still report the failure
+			return string(1, '?');
+		}
+	}
+
+	/** The name of the compressed file
+	 */
+	string fileName;
+
+	/** Read end of the pipe connecting the formatting and compression threads
+	 */
+	int source;
+	/** The compressed file on disk
+	 */
+	shared_ptr<FILE> target;
+	boost::scoped_ptr<Compressor> compressor;
+	/** Allocated up front so that the compression thread cannot fail
+	 */
+	std::vector<char> buffer;
+	boost::thread worker;
+	/** The first error encountered by the compression thread. Written
+	 *	only by that thread, and read only after it has been joined.
+	 */
+	string error;
+	/** Set once the handle has been closed
+	 */
+	bool closed;
+};
+
+/** Records an error in the compression thread, unless one has already
+ *	been recorded
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void recordError(CompressedStream& stream, const char* message) {
+	if (stream.error.empty()) {
+		try {
+			stream.error = message;
+		} catch (const std::bad_alloc&) {
+			// Too little memory for the message, but still report the failure
+			stream.error.assign(1, '?');
+		}
+	}
+}
+
+/** Compresses everything written to a pipe until the pipe is closed
+ *
+ * @param[in] stream The pipe to read and the file to write.
+ *
+ * @post @p stream->source is closed
+ * @post @p stream->error describes the first failure to compress or write
+ *	the data, if any, apart from errors deferred until the file is closed.
+ *
+ * @exceptsafe Does not throw exceptions. The pipe is always read to the
+ *	end, so that the formatting thread never blocks on a stalled reader.
+ */
+void drainPipe(shared_ptr<CompressedStream> stream) {
+	std::vector<char>& buffer = stream->buffer;
+	bool ok = true;
+
+	for(;;) {
+		ssize_t nRead = read(stream->source, &buffer[0], buffer.size());
+		if (nRead < 0 && errno == EINTR) {
+			continue;
+		} else if (nRead <= 0) {
+			break;
+		}
+
+		if (ok) {
+			try {
+				stream->compressor->compress(&buffer[0],
+					static_cast<size_t>(nRead), stream->target.get());
+			} catch (const std::exception& e) {
+				recordError(*stream, e.what());
+				ok = false;
+			}
+		}
+	}
+
+	if (ok) {
+		try {
+			stream->compressor->finish(stream->target.get());
+		} catch (const std::exception& e) {
+			recordError(*stream, e.what());
+			ok = false;
+		}
+	}
+	// Errors deferred by stdio buffering are caught when the file is closed
+	close(stream->source);
+}
+
+/** Deleter for a compressed file handle
+ *
+ * Closing the handle signals end-of-data to the compression thread; the
+ * deleter waits for the compressed stream to be completed and closed.
+ * A deleter cannot report errors, so fileCheckClose() closes the handle
+ * through close() instead.
+ */
+class CompressedCloser {
+public:
+	explicit CompressedCloser(const shared_ptr<CompressedStream>& stream)
+			: stream(stream) {
+	}
+
+	/** Closes the handle, if fileCheckClose() has not already done so.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	void operator()(FILE* hInput) {
+		if (!stream->closed) {
+			stream->close(hInput);
+		}
+	}
+
+	/** Closes the handle and reports any error.
+	 *
+	 * @exception kpfutils::except::FileIo Thrown if the file could not
+	 *	be compressed or written.
+	 */
+	void close(FILE* hInput) {
+		const string error = stream->close(hInput);
+		if (!error.empty()) {
+			throw FileIo(error);
+		}
+	}
+
+private:
+	shared_ptr<CompressedStream> stream;
+};
+
+}	// end anonymous namespace
+
+namespace kpfutils {
+
+/** Wrapper that throws @ref kpfutils::except::FileIo "FileIo" if it cannot
+ *	open a file, optionally compressing everything written to it
+ *
+ * If a codec is used, the returned handle writes uncompressed text into a
+ * pipe, and a dedicated thread compresses the pipe contents into
+ * @p fileName. Formatting and compression therefore proceed in parallel.
+ *
+ * @param[in] fileName The file to open.
+ * @param[in] mode The mode to open the file, following the same
+ *	conventions as for @c fopen()
+ * @param[in] codec The compression format for @p fileName. If CODEC_AUTO,
+ *	the format is chosen by codecFromName().
+ *
+ * @return A handle to the newly opened file. The file will be closed once its
+ *	last reference disappears. If compression is in use, closing the file
+ *	waits for all pending data to be compressed. Pass the handle to
+ *	fileCheckClose() to learn whether the data were written successfully.
+ *
+ * @pre If @p codec resolves to anything other than CODEC_NONE, @p mode
+ *	is "w" or "a"
+ *
+ * @exception std::invalid_argument Thrown if @p mode is not compatible
+ *	with compression.
+ * @exception kpfutils::except::FileIo Thrown if the file could not be
+ *	opened, or if @p codec is not supported.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+shared_ptr<FILE> fileCheckOpen(const std::string& fileName, const char* mode,
+		Codec codec) {
+	if (codec == CODEC_AUTO) {
+		codec = codecFromName(fileName);
+	}
+	if (codec == CODEC_NONE) {
+		return fileCheckOpen(fileName, mode);
+	}
+
+	if (0 != strcmp(mode, "w") && 0 != strcmp(mode, "a")) {
+		throw std::invalid_argument("Compressed files may only be opened with mode \"w\" or \"a\", not \""
+			+ string(mode) + "\"");
+	}
+
+	// Don't create the file if the codec is unavailable
+	boost::scoped_ptr<Compressor> compressor(makeCompressor(codec));
+
+	// Concatenated gzip or zstd streams are themselves valid streams, so
+	//	appending needs no special treatment
+	shared_ptr<FILE> target = fileCheckOpen(fileName, (string(mode) + "b").c_str());
+
+	int fds[2];
+	if (0 != pipe(fds)) {
+		int err = errno;
+		errno = 0;
+		throw except::FileIo("Could not create compression pipe for "
+			+ fileName + ": " + strerror(err));
+	}
+
+	FILE* hOutput = fdopen(fds[1], "w");
+	if (hOutput == NULL) {
+		int err = errno;
+		errno = 0;
+		close(fds[0]);
+		close(fds[1]);
+		throw except::FileIo("Could not open compression pipe for "
+			+ fileName + ": " + strerror(err));
+	}
+	// Match the pipe's own capacity, to minimize context switches
+	setvbuf(hOutput, NULL, _IOFBF, CHUNK_SIZE);
+
+	shared_ptr<CompressedStream> stream;
+	try {
+		stream.reset(new CompressedStream(fileName, fds[0], target));
+		stream->compressor.swap(compressor);
+
+		boost::thread worker(&drainPipe, stream);
+		stream->worker.swap(worker);
+	} catch (...) {
+		fclose(hOutput);
+		close(fds[0]);
+		throw;
+	}
+
+	// IMPORTANT: no exceptions beyond this point
+
+	return shared_ptr<FILE>(hOutput, CompressedCloser(stream));
+}
+
+/** Closes a file opened by fileCheckOpen(), throwing
+ *	@ref kpfutils::except::FileIo "FileIo" if any of the data written to
+ *	it were lost
+ *
+ * Compressed files are written by a separate thread, and write errors may
+ * also be deferred by buffering, so errors are not necessarily reported
+ * by the calls that write to the handle. This function waits for all
+ * pending data to be written and reports any error.
+ *
+ * @param[in,out] hFile The file to close. On return, @p hFile is empty.
+ *
+ * @pre @p hFile is the only reference to the file
+ * @pre @p hFile was created by fileCheckOpen(). Other handles are 
+ *	released without checking for errors.
+ *
+ * @post @p hFile is empty, even if an exception is thrown.
+ *
+ * @exception kpfutils::except::FileIo Thrown if the data could not be
+ *	compressed or written.
+ *
+ * @exceptsafe The file is closed in the event of an exception.
+ */
+void fileCheckClose(shared_ptr<FILE>& hFile) {
+	if (!hFile) {
+		return;
+	}
+
+	CompressedCloser* closer = boost::get_deleter<CompressedCloser>(hFile);
+	if (closer != NULL) {
+		try {
+			closer->close(hFile.get());
+		} catch (...) {
+			hFile.reset();
+			throw;
+		}
+		hFile.reset();
+		return;
+	}
+
+	detail::FileCloser* plain = boost::get_deleter<detail::FileCloser>(hFile);
+	if (plain != NULL) {
+		string error;
+		try {
+			error = closeFile(*plain, hFile.get());
+		} catch (...) {
+			hFile.reset();
+			throw;
+		}
+		hFile.reset();
+		if (!error.empty()) {
+			throw except::FileIo(error);
+		}
+	} else {
+		hFile.reset();
+	}
+}
+
+}	// end kpfutils
@@ -0,0 +1,500 @@
+/** Histograms of large data sets
+ * @file common/histogram.tmp.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#ifndef KPFUTILSHISTOGRAMH
+#define KPFUTILSHISTOGRAMH
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <boost/bind/bind.hpp>
+#include <boost/concept/requires.hpp>
+#include <boost/iterator/iterator_concepts.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread.hpp>
+#include "binning.tmp.h"
+#include "sorted.tmp.h"
+#include "stats_parallel.tmp.h"
+
+namespace kpfutils {
+
+/** @addtogroup stats
+ *
+ * Include histogram.tmp.h to count data in bins. The results can be
+ * written with printHist(). parallelHistogram() requires Boost.Thread.
+ *
+ * @{
+ */
+
+namespace detail {
+
+/** Stands in for a range of weights that are all one.
+ *
+ * Lets the weighted and unweighted histograms share their kernels; the
+ * compiler reduces each weight to a constant.
+ */
+class UnitWeights {
+public:
+	/** Returns the weight of the current datum.
+	 */
+	double operator*() const {
+		return 1.0;
+	}
+
+	/** Moves to the next datum.
+	 */
+	UnitWeights& operator++() {
+		return *this;
+	}
+
+	/** Moves to the next datum.
+	 */
+	UnitWeights operator++(int) {
+		return *this;
+	}
+
+	/** Moves forward by several data.
+	 */
+	UnitWeights operator+(std::ptrdiff_t) const {
+		return *this;
+	}
+};
+
+/** Adds each datum's weight to the bin containing it
+ *
+ * @param[in] bins The bins to fill.
+ * @param[in] first, last The data to count.
+ * @param[in] weightFirst The weight of the first datum.
+ * @param[in,out] values The running total of each bin.
+ *
+ * @exceptsafe Does not throw exceptions unless the iterators throw.
+ */
+template <typename ConstInputIterator, typename WeightIterator>
+void fillBins(const BinEdges& bins, ConstInputIterator first, ConstInputIterator last,
+		WeightIterator weightFirst, std::vector<double>& values) {
+	for(; first != last; first++, weightFirst++) {
+		size_t bin = 0;
+		if (bins.find(static_cast<double>(*first), bin)) {
+			values[bin] += static_cast<double>(*weightFirst);
+		}
+	}
+}
+
+/** Adds each datum's weight to the bin containing it, for data in
+ *	ascending order
+ *
+ * The data and the bin edges are walked together, as in a merge, so no
+ * search is needed.
+ *
+ * @param[in] bins The bins to fill.
+ * @param[in] first, last The data to count, in ascending order.
+ * @param[in] weightFirst The weight of the first datum.
+ * @param[in,out] values The running total of each bin.
+ *
+ * @exceptsafe Does not throw exceptions unless the iterators throw.
+ */
+template <typename ConstRandomAccessIterator, typename WeightIterator>
+void mergeBins(const BinEdges& bins, ConstRandomAccessIterator first,
+		ConstRandomAccessIterator last, WeightIterator weightFirst,
+		std::vector<double>& values) {
+	const std::vector<double>& edges = bins.edges();
+	const size_t nBins = bins.size();
+
+	// Skip data below the first bin
+	ConstRandomAccessIterator it = std::lower_bound(first, last, edges.front());
+	weightFirst = weightFirst + (it - first);
+
+	size_t bin = 0;
+	for(; it != last; it++, weightFirst++) {
+		const double x = static_cast<double>(*it);
+		if (x > edges.back()) {
+			break;
+		}
+		while (bin + 1 < nBins && x >= edges[bin+1]) {
+			bin++;
+		}
+		values[bin] += static_cast<double>(*weightFirst);
+	}
+}
+
+/** Fills one thread's private copy of the bins
+ *
+ * @exceptsafe Does not throw exceptions unless the iterators throw.
+ */
+template <typename ConstRandomAccessIterator, typename WeightIterator>
+void shareBins(const BinEdges& bins, ConstRandomAccessIterator first,
+		ConstRandomAccessIterator last, WeightIterator weightFirst,
+		std::vector<double>& values) {
+	fillBins(bins, first, last, weightFirst, values);
+}
+
+/** Fills bins from equal, contiguous shares of a range, one per thread
+ *
+ * Each thread counts into its own array, so no locking is needed; the
+ * arrays are added in order once all threads finish.
+ *
+ * @param[in] bins The bins to fill.
+ * @param[in] first, last The data to count.
+ * @param[in] weightFirst The weight of the first datum.
+ * @param[in] nThreads The requested number of threads, or 0 to use one
+ *	per processor.
+ * @param[out] values The total of each bin.
+ *
+ * @exception boost::thread_resource_error Thrown if a thread could not
+ *	be started.
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	start the threads.
+ *
+ * @exceptsafe All threads are finished in the event of an exception.
+ *	The contents of @p values are unspecified.
+ */
+template <typename ConstRandomAccessIterator, typename WeightIterator>
+void parallelBins(const BinEdges& bins, ConstRandomAccessIterator first,
+		ConstRandomAccessIterator last, WeightIterator weightFirst,
+		unsigned int nThreads, std::vector<double>& values) {
+	const size_t n = static_cast<size_t>(std::distance(first, last));
+	if (nThreads == 0) {
+		nThreads = std::max(1u, boost::thread::hardware_concurrency());
+	}
+	const size_t nShares = std::max<size_t>(1,
+		std::min<size_t>(nThreads, n / MIN_THREAD_CHUNK));
+
+	std::vector<std::vector<double> > shares(nShares,
+		std::vector<double>(bins.size(), 0.0));
+	boost::thread_group workers;
+	try {
+		for(size_t i = 1; i < nShares; i++) {
+			workers.create_thread(boost::bind(
+				&shareBins<ConstRandomAccessIterator, WeightIterator>,
+				boost::cref(bins), first + i*n/nShares, first + (i+1)*n/nShares,
+				weightFirst + i*n/nShares, boost::ref(shares[i])));
+		}
+		fillBins(bins, first, first + n/nShares, weightFirst, shares[0]);
+	} catch (...) {
+		workers.join_all();
+		throw;
+	}
+	workers.join_all();
+
+	values.swap(shares[0]);
+	for(size_t i = 1; i < nShares; i++) {
+		for(size_t bin = 0; bin < values.size(); bin++) {
+			values[bin] += shares[i][bin];
+		}
+	}
+}
+
+}	// end detail
+
+/** Counts the values in a generic container object that fall in each
+ *	of a set of bins. The container class is accessed using first and
+ *	last iterators, and the histogram is computed over the interval
+ *	[first, last).
+ *
+ * For uniform bins, each value's bin is found by arithmetic; otherwise
+ * it is found by binary search. Values outside all bins are ignored.
+ *
+ * @tparam ConstInputIterator The iterator type for the container. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
+ * @param[in] bins The bins into which to count the data.
+ * @param[in] first Input iterator marking the first element in the container.
+ * @param[in] last Input iterator marking the position after the last
+ *	element in the container.
+ * @param[out] binEdges The edges of @p bins.
+ * @param[out] values The number of values in each bin.
+ *
+ * @pre [@p first, @p last) is a valid range
+ *
+ * @post @p binEdges and @p values may be passed directly to printHist().
+ *
+ * @perform O(D + B) for uniform bins and O(D log B + B) otherwise, where
+ *	D = std::distance(@p first, @p last) and B = @p bins.size().
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	store the histogram.
+ *
+ * @exceptsafe The arguments are unchanged in the event of an exception.
+ *
+ * @test Vector of doubles, length 100, randomly generated, uniform or
+ *	equivalent arbitrary bins. Expected behavior: each bin's count
+ *	equals the number of values between its edges.
+ * @test Values on every bin edge and outside the bins. Expected
+ *	behavior: same assignment as BinEdges::find().
+ */
+template <typename ConstInputIterator>
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstInputIterator>))
+	((ForwardTraversalConcept<ConstInputIterator>)),	// Iterator semantics
+	(void)) // Return type
+histogram(const BinEdges& bins, ConstInputIterator first, ConstInputIterator last,
+		std::vector<double>& binEdges, std::vector<double>& values) {
+	// copy-and-swap
+	std::vector<double> tempEdges(bins.edges()), tempValues(bins.size(), 0.0);
+	detail::fillBins(bins, first, last, detail::UnitWeights(), tempValues);
+
+	// IMPORTANT: no exceptions beyond this point
+
+	binEdges.swap(tempEdges);
+	values  .swap(tempValues);
+}
+
+/** Adds the weights of the values in a generic container object that
+ *	fall in each of a set of bins.
+ *
+ * This function behaves exactly like the unweighted version, except that
+ * each value contributes its weight, read from a parallel range, rather
+ * than one. Weights are summed in @c double.
+ *
+ * @tparam ConstInputIterator The iterator type for the data. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
+ * @tparam ConstWeightIterator The iterator type for the weights. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
+ * @param[in] bins The bins into which to count the data.
+ * @param[in] first Input iterator marking the first datum.
+ * @param[in] last Input iterator marking the position after the last datum.
+ * @param[in] weightFirst Input iterator marking the weight of the first
+ *	datum.
+ * @param[out] binEdges The edges of @p bins.
+ * @param[out] values The total weight in each bin.
+ *
+ * @pre The range starting at @p weightFirst has at least as many elements
+ *	as [@p first, @p last)
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	store the histogram.
+ *
+ * @exceptsafe The arguments are unchanged in the event of an exception.
+ *
+ * @test Vector of doubles, length 100, randomly generated, all weights
+ *	2. Expected behavior: twice the unweighted histogram.
+ */
+template <typename ConstInputIterator, typename ConstWeightIterator>
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstInputIterator>))
+	((ForwardTraversalConcept<ConstInputIterator>))
+	((ReadableIteratorConcept<ConstWeightIterator>))
+	((ForwardTraversalConcept<ConstWeightIterator>)),	// Iterator semantics
+	(void)) // Return type
+histogram(const BinEdges& bins, ConstInputIterator first, ConstInputIterator last,
+		ConstWeightIterator weightFirst,
+		std::vector<double>& binEdges, std::vector<double>& values) {
+	// copy-and-swap
+	std::vector<double> tempEdges(bins.edges()), tempValues(bins.size(), 0.0);
+	detail::fillBins(bins, first, last, weightFirst, tempValues);
+
+	// IMPORTANT: no exceptions beyond this point
+
+	binEdges.swap(tempEdges);
+	values  .swap(tempValues);
+}
+
+/** Counts the values in a sorted container that fall in each of a set
+ *	of bins.
+ *
+ * Since both the data and the bin edges are in ascending order, they are
+ * walked together as in a merge, and no value's bin needs to be searched
+ * for. Values outside all bins are skipped with a single binary search.
+ *
+ * @tparam Container The type of container holding the data. Must have
+ *	random-access iterators.
+ * @param[in] bins The bins into which to count the data.
+ * @param[in] data The data to count.
+ * @param[out] binEdges The edges of @p bins.
+ * @param[out] values The number of values in each bin.
+ *
+ * @perform O(D + B), where D = @p data.size() and B = @p bins.size().
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	store the histogram.
+ *
+ * @exceptsafe The arguments are unchanged in the event of an exception.
+ *
+ * @test Sorted vector of doubles, length 100, arbitrary bins. Expected
+ *	behavior: same result as the unsorted version.
+ * @test Sorted vector of doubles with values on every bin edge and
+ *	outside the bins. Expected behavior: same result as the unsorted
+ *	version.
+ */
+template <class Container>
+void histogram(const BinEdges& bins, const Sorted<Container>& data,
+		std::vector<double>& binEdges, std::vector<double>& values) {
+	// copy-and-swap
+	std::vector<double> tempEdges(bins.edges()), tempValues(bins.size(), 0.0);
+	detail::mergeBins(bins, data.begin(), data.end(), detail::UnitWeights(), tempValues);
+
+	// IMPORTANT: no exceptions beyond this point
+
+	binEdges.swap(tempEdges);
+	values  .swap(tempValues);
+}
+
+/** Adds the weights of the values in a sorted container that fall in
+ *	each of a set of bins.
+ *
+ * This function behaves exactly like the unweighted version, except that
+ * each value contributes its weight, read from a parallel range, rather
+ * than one.
+ *
+ * @tparam Container The type of container holding the data. Must have
+ *	random-access iterators.
+ * @tparam ConstWeightIterator The iterator type for the weights. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/RandomAccessTraversal.html">random access</a>.
+ * @param[in] bins The bins into which to count the data.
+ * @param[in] data The data to count.
+ * @param[in] weightFirst Input iterator marking the weight of the first
+ *	datum.
+ * @param[out] binEdges The edges of @p bins.
+ * @param[out] values The total weight in each bin.
+ *
+ * @pre The range starting at @p weightFirst has at least as many elements
+ *	as @p data
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	store the histogram.
+ *
+ * @exceptsafe The arguments are unchanged in the event of an exception.
+ *
+ * @test Sorted vector of doubles, length 100, random weights. Expected
+ *	behavior: agrees with the unsorted version to within 1e-10.
+ */
+template <class Container, typename ConstWeightIterator>
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstWeightIterator>))
+	((RandomAccessTraversalConcept<ConstWeightIterator>)),	// Iterator semantics
+	(void)) // Return type
+histogram(const BinEdges& bins, const Sorted<Container>& data,
+		ConstWeightIterator weightFirst,
+		std::vector<double>& binEdges, std::vector<double>& values) {
+	// copy-and-swap
+	std::vector<double> tempEdges(bins.edges()), tempValues(bins.size(), 0.0);
+	detail::mergeBins(bins, data.begin(), data.end(), weightFirst, tempValues);
+
+	// IMPORTANT: no exceptions beyond this point
+
+	binEdges.swap(tempEdges);
+	values  .swap(tempValues);
+}
+
+/** Counts the values in a random-access container that fall in each of a
+ *	set of bins, using several threads. The histogram is computed over
+ *	the interval [first, last).
+ *
+ * The range is split into equal, contiguous shares. Each thread counts
+ * its share into a private array, and the arrays are added once all
+ * threads finish, so the threads never contend for a bin. Ranges too
+ * short to benefit from threading are processed on the calling thread
+ * alone.
+ *
+ * @tparam ConstRandomAccessIterator The iterator type for the container. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/RandomAccessTraversal.html">random access</a>.
+ * @param[in] bins The bins into which to count the data.
+ * @param[in] first Input iterator marking the first element in the container.
+ * @param[in] last Input iterator marking the position after the last
+ *	element in the container.
+ * @param[out] binEdges The edges of @p bins.
+ * @param[out] values The number of values in each bin.
+ * @param[in] nThreads The maximum number of threads to use, including
+ *	the calling thread. If 0, uses one thread per processor.
+ *
+ * @pre [@p first, @p last) is a valid range
+ * @pre [@p first, @p last) is not modified by another thread during the call
+ *
+ * @perform O(D/T + BT), where D = std::distance(@p first, @p last),
+ *	B = @p bins.size(), and T = @p nThreads.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	store the histogram.
+ * @exception boost::thread_resource_error Thrown if a thread could not
+ *	be started.
+ *
+ * @exceptsafe The arguments are unchanged in the event of an exception.
+ *
+ * @test Vector of doubles, length 10^6, 1, 3, or 8 threads. Expected
+ *	behavior: identical to histogram().
+ */
+template <typename ConstRandomAccessIterator>
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstRandomAccessIterator>))
+	((RandomAccessTraversalConcept<ConstRandomAccessIterator>)),	// Iterator semantics
+	(void)) // Return type
+parallelHistogram(const BinEdges& bins, ConstRandomAccessIterator first,
+		ConstRandomAccessIterator last,
+		std::vector<double>& binEdges, std::vector<double>& values,
+		unsigned int nThreads = 0) {
+	// copy-and-swap
+	std::vector<double> tempEdges(bins.edges()), tempValues;
+	detail::parallelBins(bins, first, last, detail::UnitWeights(), nThreads, tempValues);
+
+	// IMPORTANT: no exceptions beyond this point
+
+	binEdges.swap(tempEdges);
+	values  .swap(tempValues);
+}
+
+/** Adds the weights of the values in a random-access container that fall
+ *	in each of a set of bins, using several threads.
+ *
+ * This function behaves exactly like the unweighted version, except that
+ * each value contributes its weight, read from a parallel range, rather
+ * than one. Since each thread's totals are added in order, the result is
+ * the same from run to run for a given number of threads, but may
+ * differ in the last few bits from histogram().
+ *
+ * @tparam ConstRandomAccessIterator The iterator type for the data. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/RandomAccessTraversal.html">random access</a>.
+ * @tparam ConstWeightIterator The iterator type for the weights. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/RandomAccessTraversal.html">random access</a>.
+ * @param[in] bins The bins into which to count the data.
+ * @param[in] first Input iterator marking the first datum.
+ * @param[in] last Input iterator marking the position after the last datum.
+ * @param[in] weightFirst Input iterator marking the weight of the first
+ *	datum.
+ * @param[out] binEdges The edges of @p bins.
+ * @param[out] values The total weight in each bin.
+ * @param[in] nThreads The maximum number of threads to use, including
+ *	the calling thread. If 0, uses one thread per processor.
+ *
+ * @pre The range starting at @p weightFirst has at least as many elements
+ *	as [@p first, @p last)
+ * @pre Neither range is modified by another thread during the call
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	store the histogram.
+ * @exception boost::thread_resource_error Thrown if a thread could not
+ *	be started.
+ *
+ * @exceptsafe The arguments are unchanged in the event of an exception.
+ *
+ * @test Vector of doubles, length 10^6, random weights, 4 threads.
+ *	Expected behavior: agrees with histogram() to within 1e-8.
+ */
+template <typename ConstRandomAccessIterator, typename ConstWeightIterator>
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstRandomAccessIterator>))
+	((RandomAccessTraversalConcept<ConstRandomAccessIterator>))
+	((ReadableIteratorConcept<ConstWeightIterator>))
+	((RandomAccessTraversalConcept<ConstWeightIterator>)),	// Iterator semantics
+	(void)) // Return type
+parallelHistogram(const BinEdges& bins, ConstRandomAccessIterator first,
+		ConstRandomAccessIterator last, ConstWeightIterator weightFirst,
+		std::vector<double>& binEdges, std::vector<double>& values,
+		unsigned int nThreads = 0) {
+	// copy-and-swap
+	std::vector<double> tempEdges(bins.edges()), tempValues;
+	detail::parallelBins(bins, first, last, weightFirst, nThreads, tempValues);
+
+	// IMPORTANT: no exceptions beyond this point
+
+	binEdges.swap(tempEdges);
+	values  .swap(tempValues);
+}
+
+/** @} */	// end stats
+
+}	// end kpfutils
+
+#endif		// KPFUTILSHISTOGRAMH
@@ -2,7 +2,7 @@
  * @file common/kpfutils.h
  * @author Krzysztof Findeisen
  * @date Created June 18, 2013
- * @date Last modified February 28, 2014
+ * @date Last modified October 18, 2026
  */
 
 /* Copyright 2014, California Institute of Technology.
@@ -20,14 +20,14 @@
  * @internal "+build" tag can be used to distinguish which development 
  *	version was used to create which output
  */
-#define KPFUTILS_VERSION_STRING "1.0.0"
+#define KPFUTILS_VERSION_STRING "1.1.0"
 
 /** Machine-readable version information
  */
 #define KPFUTILS_MAJOR_VERSION 1
 /** Machine-readable version information
  */
-#define KPFUTILS_MINOR_VERSION 0
+#define KPFUTILS_MINOR_VERSION 1
 
 /** @mainpage
  *
@@ -88,11 +88,20 @@
  * The library may switch to CMake in the future for improved portability.
  *
  * @c kpfutils depends on the following external libraries:
- * - <a href="http://www.boost.org/">Boost</a> 1.33 or later
+ * - <a href="http://www.boost.org/">Boost</a> 1.33 or later, including 
+ *	the compiled Boost.Thread and Boost.System libraries
+ * - <a href="http://www.zlib.net/">zlib</a> 1.2 or later
+ * - <a href="http://www.zstd.net/">Zstandard</a> 1.4 or later (optional)
  * 
- * Boost is not provided with the installation package, as it is included 
- * with many C++ compilers and operating systems. Please contact your 
- * system administrator if Boost is not installed.
+ * Boost and zlib are not provided with the installation package, as they 
+ * are included with many C++ compilers and operating systems. Please contact 
+ * your system administrator if they are not installed. Zstandard support 
+ * is enabled by adding <tt>-D KPFUTILS_HAVE_ZSTD</tt> to @c FEATURES in 
+ * @c makefile.inc.
+ *
+ * Programs using @c kpfutils must link with 
+ * <tt>-lkpfutils -lboost_thread -lboost_system -lz</tt>, plus @c -lzstd 
+ * if Zstandard support is enabled.
  * 
  * In addition, (re-)generating this documentation requires 
  * <a href="http://www.doxygen.org/">Doxygen</a> 1.8.0 or later.
@@ -131,6 +140,90 @@
  * All version numbers are to be interpreted as described therein. This 
  * documentation constitutes the public API for the library.
  *
+ * @section v1_1_0 Version 1.1.0
+ *
+ * - Table and light curve writers can compress their output with gzip or 
+ *	zstd, chosen from the file extension or an explicit 
+ *	@ref kpfutils::Codec "Codec" argument.
+ * - Added @ref archive "table archives" for storing many light curve 
+ *	products in one file, with random-access retrieval.
+ * - Added a @ref kpfutils::FileNameList "FileNameList" overload of 
+ *	@ref kpfutils::readFileNames() "readFileNames()" that stores all 
+ *	names in a single buffer.
+ * - @ref kpfutils::readFileNames() "readFileNames()" no longer splits 
+ *	names longer than 249 characters.
+ * - Added @ref kpfutils::Prefetcher "Prefetcher" for reading lists of 
+ *	files ahead of time.
+ * - Added @ref kpfutils::meanVariance() "meanVariance()", which finds the 
+ *	mean and variance in one numerically stable pass, with a 
+ *	vectorizable kernel for contiguous @c float and @c double data.
+ * - @ref kpfutils::quantile() "quantile()" now runs in linear time, and 
+ *	has variants that reuse a scratch buffer, reorder the input in 
+ *	place, or read sorted data in constant time.
+ * - Added @ref kpfutils::quantiles() "quantiles()", which finds many 
+ *	quantiles of the same data in one selection pass.
+ * - Added @ref kpfutils::QuantileSketch "QuantileSketch", a mergeable 
+ *	streaming estimator of quantiles with bounded memory.
+ * - Added @ref kpfutils::Moments "Moments", a mergeable accumulator for 
+ *	the first four moments, and multithreaded 
+ *	@ref kpfutils::parallelMean() "parallelMean()", 
+ *	@ref kpfutils::parallelVariance() "parallelVariance()", and 
+ *	@ref kpfutils::parallelMoments() "parallelMoments()".
+ * - Added @ref kpfutils::weightedMean() "weightedMean()", 
+ *	@ref kpfutils::weightedVariance() "weightedVariance()", and 
+ *	@ref kpfutils::reducedChiSq() "reducedChiSq()", which use 
+ *	per-point errors in a single pass.
+ * - Added @ref kpfutils::nanMean() "nanMean()", 
+ *	@ref kpfutils::nanVariance() "nanVariance()", and 
+ *	@ref kpfutils::nanQuantile() "nanQuantile()", which skip NaN (and 
+ *	optionally infinite) values without copying the data.
+ * - @ref kpfutils::isNan() "isNan()", @ref kpfutils::isNanOrInf() 
+ *	"isNanOrInf()", and @ref kpfutils::NotNan "NotNan" are now inline, 
+ *	and NotNan can be called through a const reference.
+ * - Added bulk tests for non-finite values, including 
+ *	@ref kpfutils::compactFinite() "compactFinite()" for cleaning 
+ *	several columns of a light curve at once.
+ * - Added robust.tmp.h with medianAbsDev() and sigmaClip(), an iterative
+ *	sigma clipper that reuses its mask and buffer between passes
+ * - Added rolling.h with rollingMeanRms(), rollingQuantile(), and
+ *	rollingMedian() for statistics in sliding time windows
+ * - mean(), variance(), quantile(), and isSorted() now use array kernels,
+ *	chosen at compile time, for pointers and std::vector iterators
+ * - Added a timing benchmark for the statistics functions (make bench)
+ * - isSorted() compares contiguous arrays in vectorized blocks
+ * - Added sorted.tmp.h with Sorted, a container whose order is known, and
+ *	Sorted overloads of the light curve readers and rolling statistics
+ * - sortByTime() returns immediately if its input is already sorted
+ * - Added single-precision overloads of readTable(), readWgLightCurve(),
+ *	readWg2LightCurve(), readMcLightCurve(), and readCsvLightCurve(), which
+ *	store measurements and errors as FloatVec while keeping times in @c double
+ * - mean() and variance() accumulate @c float values in @c double for all
+ *	iterator types, not only contiguous arrays
+ * - Added variability.tmp.h, which computes skewness, kurtosis, the von
+ *	Neumann ratio, the Stetson J and K indices, and the weighted standard
+ *	deviation of one or many light curves in two passes
+ * - Added binning.tmp.h, which finds the count, mean, variance, and median
+ *	of data in uniform or arbitrary bins of a key column in one pass
+ * - Added histogram.tmp.h, which counts data into uniform or arbitrary bins,
+ *	with optional weights, a merge pass for Sorted data, and a threaded
+ *	version, and returns the vectors expected by printHist()
+ * - Added lombScargle(), a generalized Lomb-Scargle periodogram computed by
+ *	extirpolation and FFT, with an exact mode for validation
+ * - Added parallelLombScargle(), a threaded direct-sum periodogram that
+ *	steps through regular grids by phasor rotation instead of calling
+ *	sin() and cos() for every term
+ * - Added FrequencyGrid, which holds a frequency grid and its FFT tables
+ *	for reuse, and batchLombScargle(), which computes the periodograms
+ *	of many light curves on a worker pool and delivers them in order to
+ *	a callback such as PeriodogramPrinter
+ * - Added LS_DIRECT, the phasor-rotation kernel, as a lombScargle() method
+ * - Added bootstrapFap() and bootstrapPeaks(), which estimate periodogram
+ *	false alarm probabilities by resampling in parallel
+ * - Added PeriodogramWorkspace, which lets FrequencyGrid::periodogram()
+ *	reuse its memory between light curves
+ * - Added findPeaks() and refinePeaks(), which extract the strongest
+ *	periodogram peaks and locate them on a fine local grid
+ *
  * @section v1_0_0 Version 1.0.0
  *
  * Initial release.
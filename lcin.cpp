@@ -2,7 +2,7 @@
  * @file common/lcin.cpp
  * @author Krzysztof Findeisen
  * @date Created February 6, 2011
- * @date Last modified July 25, 2013
+ * @date Last modified October 18, 2026
  */
 
 /* Copyright 2014, California Institute of Technology.
@@ -20,6 +20,7 @@
 #include "alloc.tmp.h"
 #include "csv.h"
 #include "lcio.h"
+#include "sorted.tmp.h"
 
 using namespace std;
 
@@ -31,6 +32,12 @@ using namespace std;
  *	or magnitude) observed at each time
  * @param[in,out] errs a vector containing the error on each measurement
  *
+ * @tparam Value the type in which measurements and errors are stored
+ *
+ * The errors are compared to @p errMax rounded to @p Value, so that an 
+ * error equal to @p errMax in the input file is kept whatever the 
+ * precision in which it is stored.
+ *
  * @invariant @p times.size() = @p data.size() = @p errs.size()
  * @invariant for all i, @p data[i] &plusmn; @p errs[i] is the 
  *	measurement taken at @p times[i]
@@ -45,10 +52,13 @@ using namespace std;
  *
  * @todo Reimplement using a filter iterator
  */
+template <typename Value>
 void errorFilter(double errMax, 
-		vector<double>& times, vector<double>& data, vector<double>& errs) {
+		vector<double>& times, vector<Value>& data, vector<Value>& errs) {
 	// copy-and-swap
-	vector<double> tempTimes(times), tempData(data), tempErrs(errs);
+	vector<double> tempTimes(times);
+	vector<Value> tempData(data), tempErrs(errs);
+	const Value threshold = static_cast<Value>(errMax);
 	
 	for(size_t i = 0; i < tempErrs.size(); ) {
 		// loop invariant: tempTimes.size() = tempData.size() = tempErrs.size()
@@ -56,7 +66,7 @@ void errorFilter(double errMax,
 		//		the measurement taken at tempTimes[k]
 		// loop invariant: all errs[0...i) are <= errMax
 		// loop variant: tempErrs.size() - i
-		if (tempErrs[i] <= errMax) {
+		if (tempErrs[i] <= threshold) {
 			i++;
 		} else {
 			tempTimes.erase(tempTimes.begin()+i);
@@ -72,17 +82,32 @@ void errorFilter(double errMax,
 	swap(errs , tempErrs);
 }
 
+/** Removes all (time, data, error) triplets exceeding an error threshold
+ *
+ * Equivalent to errorFilter<double>(@p errMax, @p times, @p data, @p errs).
+ */
+void errorFilter(double errMax, 
+		vector<double>& times, vector<double>& data, vector<double>& errs) {
+	errorFilter<double>(errMax, times, data, errs);
+}
+
 /** Sorts the (time, data) pairs in time order
  * 
  * @param[in,out] times a vector containing the times of each observation
  * @param[in,out] data a vector containing the measurement (typically flux 
  *	or magnitude) observed at each time
  *
+ * @tparam Value the type in which measurements are stored
+ *
  * @pre @p times.size() = @p data.size()
  * @post @p times is sorted in ascending order
+ * @post measurements taken at equal times are sorted in ascending order
  * @invariant for all i, @p data[i] is the measurement taken 
  *	at @p times[i]
  *
+ * @perform O(N) if @p times is already strictly increasing, O(N log N) 
+ *	otherwise, where N = @p times.size().
+ *
  * @exception std::bad_alloc Thrown if there is not enough memory to sort 
  *	the data.
  *
@@ -90,8 +115,17 @@ void errorFilter(double errMax,
  *
  * @todo Reimplement using a permutation iterator
  */
-void sortByTime(vector<double>& times, vector<double>& data) {
-	vector<pair<double, double> > sortableVec;
+template <typename Value>
+void sortByTime(vector<double>& times, vector<Value>& data) {
+	// Most light curves are stored in time order
+	// Ties must still be sorted by measurement, so that the output does 
+	//	not depend on the input order
+	if (kpfutils::isSorted(times.begin(), times.end()) 
+			&& adjacent_find(times.begin(), times.end()) == times.end()) {
+		return;
+	}
+	
+	vector<pair<double, Value> > sortableVec;
 	
 	// Pack into a single vector for sorting together
 	for(size_t i = 0; i < times.size(); i++) {
@@ -104,10 +138,11 @@ void sortByTime(vector<double>& times, vector<double>& data) {
 	// copy-and-swap
 	// note: exactly the same number of copies as if we'd copied directly 
 	//	from sortableVec to (times, data)
-	vector<double> tempTimes, tempData;
+	vector<double> tempTimes;
+	vector<Value> tempData;
 	tempTimes.reserve(times.size());
 	tempData .reserve(data .size());
-	for(vector<pair<double, double> >::const_iterator it = sortableVec.begin(); 
+	for(typename vector<pair<double, Value> >::const_iterator it = sortableVec.begin(); 
 			it != sortableVec.end(); it++) {
 		tempTimes.push_back(it->first);
 		tempData .push_back(it->second);
@@ -119,16 +154,26 @@ void sortByTime(vector<double>& times, vector<double>& data) {
 	swap(data , tempData);
 }
 
+/** Sorts the (time, data) pairs in time order
+ *
+ * Equivalent to sortByTime<double>(@p times, @p data).
+ */
+void sortByTime(vector<double>& times, vector<double>& data) {
+	sortByTime<double>(times, data);
+}
+
 /** Allows (time, data, error) triplets to be compared in time order
  */
+template <typename Value>
 struct Triple {
 	double time;
-	double data;
-	double error;
+	Value data;
+	Value error;
 };
 /** Time order comparison of (time, data, error) triplets
  */
-bool operator<(const Triple& first, const Triple& second) {
+template <typename Value>
+bool operator<(const Triple<Value>& first, const Triple<Value>& second) {
 	return (first.time < second.time);
 }
 
@@ -139,11 +184,16 @@ bool operator<(const Triple& first, const Triple& second) {
  *	or magnitude) observed at each time
  * @param[in,out] errs a vector containing the error on each measurement
  *
+ * @tparam Value the type in which measurements and errors are stored
+ *
  * @post @p times is sorted in ascending order
  * @invariant @p times.size() = @p data.size() = @p errs.size()
  * @invariant for all i, @p data[i] &plusmn; @p errs[i] is the 
  *	measurement taken at @p times[i]
  *
+ * @perform O(N) if @p times is already sorted, O(N log N) otherwise, 
+ *	where N = @p times.size().
+ *
  * @exception std::bad_alloc Thrown if there is not enough memory to sort 
  *	the data.
  *
@@ -151,13 +201,19 @@ bool operator<(const Triple& first, const Triple& second) {
  *
  * @todo Reimplement using a permutation iterator
  */
-void sortByTime(vector<double>& times, vector<double>& data, vector<double>& errs) {
-	vector<Triple> sortableVec;
+template <typename Value>
+void sortByTime(vector<double>& times, vector<Value>& data, vector<Value>& errs) {
+	// Most light curves are stored in time order
+	if (kpfutils::isSorted(times.begin(), times.end())) {
+		return;
+	}
+	
+	vector<Triple<Value> > sortableVec;
 	
 	// Pack into a single vector for sorting together
 	for(size_t i = 0; i < times.size(); i++) {
 		// C++98 can't parse push_back({...}), so break up the expression
-		Triple newVal = {times[i], data[i], errs[i]};
+		Triple<Value> newVal = {times[i], data[i], errs[i]};
 		sortableVec.push_back(newVal);
 	}
 	
@@ -166,11 +222,12 @@ void sortByTime(vector<double>& times, vector<double>& data, vector<double>& err
 	// copy-and-swap
 	// note: exactly the same number of copies as if we'd copied directly 
 	//	from sortableVec to (times, data, errs)
-	vector<double> tempTimes, tempData, tempErrs;
+	vector<double> tempTimes;
+	vector<Value> tempData, tempErrs;
 	tempTimes.reserve(times.size());
 	tempData .reserve(data .size());
 	tempErrs .reserve(errs .size());
-	for(vector<Triple>::const_iterator it = sortableVec.begin(); 
+	for(typename vector<Triple<Value> >::const_iterator it = sortableVec.begin(); 
 			it != sortableVec.end(); it++) {
 		tempTimes.push_back(it->time);
 		tempData .push_back(it->data);
@@ -184,8 +241,82 @@ void sortByTime(vector<double>& times, vector<double>& data, vector<double>& err
 	swap(errs , tempErrs);
 }
 
+/** Sorts the (time, data, error) triplets in time order
+ *
+ * Equivalent to sortByTime<double>(@p times, @p data, @p errs).
+ */
+void sortByTime(vector<double>& times, vector<double>& data, vector<double>& errs) {
+	sortByTime<double>(times, data, errs);
+}
+
 namespace kpfutils {
 
+namespace {
+
+/** Reads a table of times, measurements, and errors, removing noisy points 
+ *	and sorting the rest in time order
+ *
+ * @param[in] fileName the name of a file to be read.
+ * @param[in] format a scanf-style formatting string that reads exactly 
+ *	three @c double values (time, measurement, error) from each row.
+ * @param[in] errMax the maximum error to tolerate in a data point.
+ * @param[out] timeVec, dataVec, errVec the three columns of the table.
+ *
+ * @tparam Value the type in which measurements and errors are stored
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+template <typename Value>
+void readErrorCurve(const string& fileName, const string& format, double errMax, 
+		DoubleVec &timeVec, vector<Value> &dataVec, vector<Value> &errVec) {
+	// copy-and-swap
+	vector<double> tempTimes;
+	vector<Value> tempData, tempErrs;
+	
+	boost::shared_ptr<FILE> hInput = fileCheckOpen(fileName, "r");
+
+	readTable(hInput.get(), format, tempTimes, tempData, tempErrs);
+	errorFilter(errMax, tempTimes, tempData, tempErrs);
+	sortByTime(tempTimes, tempData, tempErrs);
+
+	// IMPORTANT: no exceptions beyond this point
+	
+	swap(timeVec, tempTimes);
+	swap(dataVec, tempData );
+	swap( errVec, tempErrs );
+}
+
+/** Reads a table of times and measurements, sorting them in time order
+ *
+ * @param[in] fileName the name of a file to be read.
+ * @param[in] format a scanf-style formatting string that reads exactly 
+ *	two @c double values (time, measurement) from each row.
+ * @param[out] timeVec, dataVec the two columns of the table.
+ *
+ * @tparam Value the type in which measurements are stored
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+template <typename Value>
+void readCurve(const string& fileName, const string& format, 
+		DoubleVec &timeVec, vector<Value> &dataVec) {
+	// copy-and-swap
+	vector<double> tempTimes;
+	vector<Value> tempData;
+	
+	boost::shared_ptr<FILE> hInput = fileCheckOpen(fileName, "r");
+
+	readTable(hInput.get(), format, tempTimes, tempData);
+	sortByTime(tempTimes, tempData);
+
+	// IMPORTANT: no exceptions beyond this point
+	
+	swap(timeVec, tempTimes);
+	swap(dataVec, tempData );
+}
+
+}	// end unnamed
+
 /** Reads a file containing a list of Julian days, measurements, and errors
  * 
  * @param[in] fileName the name of a file to be read. The file 
@@ -216,20 +347,7 @@ namespace kpfutils {
  */
 void readWgLightCurve(const string& fileName, double errMax, DoubleVec &timeVec, 
 		DoubleVec &dataVec, DoubleVec &errVec) {
-	// copy-and-swap
-	vector<double> tempTimes, tempData, tempErrs;
-	
-	boost::shared_ptr<FILE> hInput = fileCheckOpen(fileName, "r");
-
-	readTable(hInput.get(), " %lf %lf %lf", tempTimes, tempData, tempErrs);
-	errorFilter(errMax, tempTimes, tempData, tempErrs);
-	sortByTime(tempTimes, tempData, tempErrs);
-
-	// IMPORTANT: no exceptions beyond this point
-	
-	swap(timeVec, tempTimes);
-	swap(dataVec, tempData );
-	swap( errVec, tempErrs );
+	readErrorCurve(fileName, " %lf %lf %lf", errMax, timeVec, dataVec, errVec);
 }
 
 /** Reads a file containing a list of obsids, Julian days, measurements, errors, and limits
@@ -265,20 +383,7 @@ void readWgLightCurve(const string& fileName, double errMax, DoubleVec &timeVec,
  */
 void readWg2LightCurve(const string& fileName, double errMax, DoubleVec &timeVec, 
 		DoubleVec &dataVec, DoubleVec &errVec) {
-	// copy-and-swap
-	vector<double> tempTimes, tempData, tempErrs;
-	
-	boost::shared_ptr<FILE> hInput = fileCheckOpen(fileName, "r");
-
-	readTable(hInput.get(), " %*i %lf %lf %lf %*lf", tempTimes, tempData, tempErrs);
-	errorFilter(errMax, tempTimes, tempData, tempErrs);
-	sortByTime(tempTimes, tempData, tempErrs);
-
-	// IMPORTANT: no exceptions beyond this point
-	
-	swap(timeVec, tempTimes);
-	swap(dataVec, tempData );
-	swap( errVec, tempErrs );
+	readErrorCurve(fileName, " %*i %lf %lf %lf %*lf", errMax, timeVec, dataVec, errVec);
 }
 
 /** Reads a file containing a list of Julian days and measurements
@@ -304,18 +409,7 @@ void readWg2LightCurve(const string& fileName, double errMax, DoubleVec &timeVec
  * @exceptsafe The function arguments are unchanged in the event of an exception.
  */
 void readMcLightCurve(const string& fileName, DoubleVec &timeVec, DoubleVec &dataVec) {
-	// copy-and-swap
-	vector<double> tempTimes, tempData;
-	
-	boost::shared_ptr<FILE> hInput = fileCheckOpen(fileName, "r");
-
-	readTable(hInput.get(), " %lf %lf", tempTimes, tempData);
-	sortByTime(tempTimes, tempData);
-
-	// IMPORTANT: no exceptions beyond this point
-	
-	swap(timeVec, tempTimes);
-	swap(dataVec, tempData );
+	readCurve(fileName, " %lf %lf", timeVec, dataVec);
 }
 
 /** Reads a file containing a list of Julian days and measurements
@@ -341,18 +435,276 @@ void readMcLightCurve(const string& fileName, DoubleVec &timeVec, DoubleVec &dat
  * @exceptsafe The function arguments are unchanged in the event of an exception.
  */
 void readCsvLightCurve(const string& fileName, DoubleVec &timeVec, DoubleVec &dataVec) {
-	// copy-and-swap
-	vector<double> tempTimes, tempData;
+	readCurve(fileName, " %lf , %lf", timeVec, dataVec);
+}
+
+/** Reads a file containing a list of Julian days, measurements, and errors, 
+ *	marking the times as sorted
+ *
+ * This function behaves exactly like the version taking a plain vector of 
+ * times, but returns the times in a Sorted container so that later 
+ * functions need not check their order again.
+ * 
+ * @param[in] fileName the name of a file to be read, in the format 
+ *	expected by readWgLightCurve(const string&, double, DoubleVec&, DoubleVec&, DoubleVec&).
+ * @param[in] errMax the maximum error to tolerate in a data 
+ *	point. Any points with an error exceeding @p errMax are ignored.
+ * @param[out] timeVec a container of the times of each observation
+ * @param[out] dataVec a vector containing the measurement (typically flux 
+ *	or magnitude) observed at each time
+ * @param[out] errVec a vector containing the error on each measurement
+ *
+ * @post @p timeVec.size() = @p dataVec.size() = @p errVec.size()
+ * @post for all i, @p dataVec[i] &plusmn; @p errVec[i] is the 
+ *	measurement taken at the ith element of @p timeVec
+ * @post for all i, @p errVec[i] &le; @p errMax
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to store 
+ *	the data.
+ * @exception kpfutils::except::FileIo Thrown if any file operation fails.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void readWgLightCurve(const string& fileName, double errMax, Sorted<DoubleVec> &timeVec, 
+		DoubleVec &dataVec, DoubleVec &errVec) {
+	DoubleVec tempTimes;
+	readWgLightCurve(fileName, errMax, tempTimes, dataVec, errVec);
+
+	// IMPORTANT: no exceptions beyond this point
 	
-	boost::shared_ptr<FILE> hInput = fileCheckOpen(fileName, "r");
+	timeVec.adopt(tempTimes, knownSorted);
+}
 
-	readTable(hInput.get(), " %lf , %lf", tempTimes, tempData);
-	sortByTime(tempTimes, tempData);
+/** Reads a file containing a list of obsids, Julian days, measurements, errors, 
+ *	and limits, marking the times as sorted
+ *
+ * This function behaves exactly like the version taking a plain vector of 
+ * times, but returns the times in a Sorted container so that later 
+ * functions need not check their order again.
+ * 
+ * @param[in] fileName the name of a file to be read, in the format 
+ *	expected by readWg2LightCurve(const string&, double, DoubleVec&, DoubleVec&, DoubleVec&).
+ * @param[in] errMax the maximum error to tolerate in a data point. Any 
+ *	points with an error exceeding @p errMax are ignored.
+ * @param[out] timeVec a container of the times of each observation
+ * @param[out] dataVec a vector containing the measurement (typically flux 
+ *	or magnitude) observed at each time
+ * @param[out] errVec a vector containing the error on each measurement
+ *
+ * @post @p timeVec.size() = @p dataVec.size() = @p errVec.size()
+ * @post for all i, @p dataVec[i] &plusmn; @p errVec[i] is the 
+ *	measurement taken at the ith element of @p timeVec
+ * @post for all i, @p errVec[i] &le; @p errMax
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to store 
+ *	the data.
+ * @exception kpfutils::except::FileIo Thrown if any file operation fails.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void readWg2LightCurve(const string& fileName, double errMax, Sorted<DoubleVec> &timeVec, 
+		DoubleVec &dataVec, DoubleVec &errVec) {
+	DoubleVec tempTimes;
+	readWg2LightCurve(fileName, errMax, tempTimes, dataVec, errVec);
 
 	// IMPORTANT: no exceptions beyond this point
 	
-	swap(timeVec, tempTimes);
-	swap(dataVec, tempData );
+	timeVec.adopt(tempTimes, knownSorted);
+}
+
+/** Reads a file containing a list of Julian days and measurements, marking 
+ *	the times as sorted
+ *
+ * This function behaves exactly like the version taking a plain vector of 
+ * times, but returns the times in a Sorted container so that later 
+ * functions need not check their order again.
+ * 
+ * @param[in] fileName the name of a file to be read, in the format 
+ *	expected by readMcLightCurve(const string&, DoubleVec&, DoubleVec&).
+ * @param[out] timeVec a container of the times of each observation
+ * @param[out] dataVec a vector containing the measurement (typically flux 
+ *	or magnitude) observed at each time
+ *
+ * @post @p timeVec.size() = @p dataVec.size()
+ * @post for all i, @p dataVec[i] is the measurement taken at the ith 
+ *	element of @p timeVec
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to store 
+ *	the data.
+ * @exception kpfutils::except::FileIo Thrown if any file operation fails.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void readMcLightCurve(const string& fileName, Sorted<DoubleVec> &timeVec, DoubleVec &dataVec) {
+	DoubleVec tempTimes;
+	readMcLightCurve(fileName, tempTimes, dataVec);
+
+	// IMPORTANT: no exceptions beyond this point
+	
+	timeVec.adopt(tempTimes, knownSorted);
+}
+
+/** Reads a file containing a list of Julian days and measurements, marking 
+ *	the times as sorted
+ *
+ * This function behaves exactly like the version taking a plain vector of 
+ * times, but returns the times in a Sorted container so that later 
+ * functions need not check their order again.
+ * 
+ * @param[in] fileName the name of a file to be read, in the format 
+ *	expected by readCsvLightCurve(const string&, DoubleVec&, DoubleVec&).
+ * @param[out] timeVec a container of the times of each observation
+ * @param[out] dataVec a vector containing the measurement (typically flux 
+ *	or magnitude) observed at each time
+ *
+ * @post @p timeVec.size() = @p dataVec.size()
+ * @post for all i, @p dataVec[i] is the measurement taken at the ith 
+ *	element of @p timeVec
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to store 
+ *	the data.
+ * @exception kpfutils::except::FileIo Thrown if any file operation fails.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void readCsvLightCurve(const string& fileName, Sorted<DoubleVec> &timeVec, DoubleVec &dataVec) {
+	DoubleVec tempTimes;
+	readCsvLightCurve(fileName, tempTimes, dataVec);
+
+	// IMPORTANT: no exceptions beyond this point
+	
+	timeVec.adopt(tempTimes, knownSorted);
+}
+
+/** Reads a file containing a list of Julian days, measurements, and errors, storing the 
+ *	measurements and errors in single precision
+ *
+ * This function behaves exactly like the version taking vectors of 
+ * @c double, but halves the memory needed for the measurements and 
+ * errors. The times are always read in double precision, since 
+ * single precision cannot resolve intervals shorter than a few minutes 
+ * at modern Julian dates.
+ * 
+ * @param[in] fileName the name of a file to be read, in the format 
+ *	expected by readWgLightCurve(const string&, double, DoubleVec&, DoubleVec&, DoubleVec&).
+ * @param[in] errMax the maximum error to tolerate in a data 
+ *	point. Any points with an error exceeding @p errMax are ignored.
+ * @param[out] timeVec a vector containing the times of each 
+ *	observation
+ * @param[out] dataVec a vector containing the measurement (typically flux 
+ *	or magnitude) observed at each time
+ * @param[out] errVec a vector containing the error on each measurement
+ *
+ * @post @p timeVec is sorted in ascending order
+ * @post @p timeVec.size() = @p dataVec.size() = @p errVec.size()
+ * @post for all i, @p dataVec[i] &plusmn; @p errVec[i] is the 
+ *	measurement taken at @p timeVec[i], rounded to single precision
+ * @post for all i, @p errVec[i] &le; @p errMax rounded to single precision
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to store 
+ *	the data.
+ * @exception kpfutils::except::FileIo Thrown if any file operation fails.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void readWgLightCurve(const string& fileName, double errMax, DoubleVec &timeVec, 
+		FloatVec &dataVec, FloatVec &errVec) {
+	readErrorCurve(fileName, " %lf %lf %lf", errMax, timeVec, dataVec, errVec);
+}
+
+/** Reads a file containing a list of obsids, Julian days, measurements, 
+ *	errors, and limits, storing the 
+ *	measurements and errors in single precision
+ *
+ * This function behaves exactly like the version taking vectors of 
+ * @c double, but halves the memory needed for the measurements and 
+ * errors. The times are always read in double precision, since 
+ * single precision cannot resolve intervals shorter than a few minutes 
+ * at modern Julian dates.
+ * 
+ * @param[in] fileName the name of a file to be read, in the format 
+ *	expected by readWg2LightCurve(const string&, double, DoubleVec&, DoubleVec&, DoubleVec&).
+ * @param[in] errMax the maximum error to tolerate in a data 
+ *	point. Any points with an error exceeding @p errMax are ignored.
+ * @param[out] timeVec a vector containing the times of each 
+ *	observation
+ * @param[out] dataVec a vector containing the measurement (typically flux 
+ *	or magnitude) observed at each time
+ * @param[out] errVec a vector containing the error on each measurement
+ *
+ * @post @p timeVec is sorted in ascending order
+ * @post @p timeVec.size() = @p dataVec.size() = @p errVec.size()
+ * @post for all i, @p dataVec[i] &plusmn; @p errVec[i] is the 
+ *	measurement taken at @p timeVec[i], rounded to single precision
+ * @post for all i, @p errVec[i] &le; @p errMax rounded to single precision
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to store 
+ *	the data.
+ * @exception kpfutils::except::FileIo Thrown if any file operation fails.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void readWg2LightCurve(const string& fileName, double errMax, DoubleVec &timeVec, 
+		FloatVec &dataVec, FloatVec &errVec) {
+	readErrorCurve(fileName, " %*i %lf %lf %lf %*lf", errMax, timeVec, dataVec, errVec);
+}
+
+/** Reads a file containing a list of Julian days and measurements, storing the 
+ *	measurements in single precision
+ *
+ * This function behaves exactly like the version taking vectors of 
+ * @c double, but halves the memory needed for the measurements. The 
+ * times are always read in double precision.
+ * 
+ * @param[in] fileName the name of a file to be read, in the format 
+ *	expected by readMcLightCurve(const string&, DoubleVec&, DoubleVec&).
+ * @param[out] timeVec a vector containing the times of each 
+ *	observation
+ * @param[out] dataVec a vector containing the measurement (typically flux 
+ *	or magnitude) observed at each time
+ *
+ * @post @p timeVec is sorted in ascending order
+ * @post @p timeVec.size() = @p dataVec.size()
+ * @post for all i, @p dataVec[i] is the measurement taken at @p timeVec[i], 
+ *	rounded to single precision
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to store 
+ *	the data.
+ * @exception kpfutils::except::FileIo Thrown if any file operation fails.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void readMcLightCurve(const string& fileName, DoubleVec &timeVec, FloatVec &dataVec) {
+	readCurve(fileName, " %lf %lf", timeVec, dataVec);
+}
+
+/** Reads a file containing a list of Julian days and measurements, storing the 
+ *	measurements in single precision
+ *
+ * This function behaves exactly like the version taking vectors of 
+ * @c double, but halves the memory needed for the measurements. The 
+ * times are always read in double precision.
+ * 
+ * @param[in] fileName the name of a file to be read, in the format 
+ *	expected by readCsvLightCurve(const string&, DoubleVec&, DoubleVec&).
+ * @param[out] timeVec a vector containing the times of each 
+ *	observation
+ * @param[out] dataVec a vector containing the measurement (typically flux 
+ *	or magnitude) observed at each time
+ *
+ * @post @p timeVec is sorted in ascending order
+ * @post @p timeVec.size() = @p dataVec.size()
+ * @post for all i, @p dataVec[i] is the measurement taken at @p timeVec[i], 
+ *	rounded to single precision
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to store 
+ *	the data.
+ * @exception kpfutils::except::FileIo Thrown if any file operation fails.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void readCsvLightCurve(const string& fileName, DoubleVec &timeVec, FloatVec &dataVec) {
+	readCurve(fileName, " %lf , %lf", timeVec, dataVec);
 }
 
 }	// end kpfutils
@@ -2,7 +2,7 @@
  * @file common/lcio.h
  * @author Krzysztof Findeisen
  * @date Created February 4, 2011
- * @date Last modified July 25, 2012
+ * @date Last modified October 18, 2026
  */
 
 /* Copyright 2014, California Institute of Technology.
@@ -17,11 +17,16 @@
 
 #include <string>
 #include <vector>
+#include <cstdio>
+#include "compress.h"
 
 namespace kpfutils {
 
 using std::string;
 
+class ArchiveWriter;
+template <class Container> class Sorted;
+
 /** @defgroup lcio Lightcurve I/O
  *
  * These functions read and write light curves to disk.
@@ -35,10 +40,107 @@ using std::string;
  */
 typedef std::vector<double> DoubleVec;
 
+/** Shorthand for a vector of single-precision floats
+ *
+ * Suitable for measurements and errors whose precision does not justify 
+ * a @c double. Times should always be stored in a DoubleVec.
+ */
+typedef std::vector<float> FloatVec;
+
+/** Compact, read-only list of file names
+ *
+ * All names are stored back to back, each followed by a null character, 
+ * in a single buffer. Each name can therefore be passed directly to C 
+ * functions such as @c fopen(), without creating a @c std::string. 
+ * Storing a million names requires only two allocations.
+ */
+class FileNameList {
+public:
+	/** Creates an empty list.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	FileNameList() : arena(), starts() {
+	}
+
+	/** Returns the number of names in the list.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	size_t size() const {
+		return starts.size();
+	}
+
+	/** Tests whether the list is empty.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	bool empty() const {
+		return starts.empty();
+	}
+
+	/** Returns a null-terminated name.
+	 *
+	 * @param[in] i The index of the name to return.
+	 *
+	 * @return A pointer to the @p i<sup>th</sup> name, valid until the 
+	 *	list is modified or destroyed.
+	 *
+	 * @pre @p i < size()
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	const char* operator[](size_t i) const {
+		return &arena[starts[i]];
+	}
+
+	/** Returns the number of characters in a name.
+	 *
+	 * @param[in] i The index of the name to measure.
+	 *
+	 * @return The length of the @p i<sup>th</sup> name, not counting the 
+	 *	terminating null.
+	 *
+	 * @pre @p i < size()
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	size_t length(size_t i) const {
+		return (i+1 < starts.size() ? starts[i+1] : arena.size()) - starts[i] - 1;
+	}
+
+	/** Preallocates memory for a list of names.
+	 */
+	void reserve(size_t nChars, size_t nNames);
+
+	/** Adds a name to the end of the list.
+	 */
+	void push_back(const char* first, const char* last);
+
+	/** Exchanges the contents of two lists.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	void swap(FileNameList& other) {
+		arena .swap(other.arena);
+		starts.swap(other.starts);
+	}
+
+private:
+	std::vector<char> arena;
+	/** Offset in @p arena of the first character of each name
+	 */
+	std::vector<size_t> starts;
+};
+
 /** Reads a file containing a list of file names
  */
 void readFileNames(const string& fileName, std::vector<string> &fileList);
 
+/** Reads a file containing a list of file names
+ */
+void readFileNames(const string& fileName, FileNameList &fileList);
+
 /** Filters a set of vectors to include only dates between @p date1 and @p date2
  */	
 void filterLightCurve(double date1, double date2, DoubleVec &times, 
@@ -49,37 +151,113 @@ void filterLightCurve(double date1, double date2, DoubleVec &times,
 void readWgLightCurve(const string& fileName, double errMax, DoubleVec &timeVec, 
 	DoubleVec &dataVec, DoubleVec &errVec);
 
+/** Reads a file containing a list of Julian days, measurements, and errors, 
+ *	marking the times as sorted
+ */	
+void readWgLightCurve(const string& fileName, double errMax, Sorted<DoubleVec> &timeVec, 
+	DoubleVec &dataVec, DoubleVec &errVec);
+
 /** Reads a file containing a list of obsids, Julian days, measurements, errors, and limits
  */	
 void readWg2LightCurve(const string& fileName, double errMax, DoubleVec &timeVec, 
 	DoubleVec &dataVec, DoubleVec &errVec);
 
+/** Reads a file containing a list of obsids, Julian days, measurements, errors, 
+ *	and limits, marking the times as sorted
+ */	
+void readWg2LightCurve(const string& fileName, double errMax, Sorted<DoubleVec> &timeVec, 
+	DoubleVec &dataVec, DoubleVec &errVec);
+
 /** Reads a file containing a list of Julian days and measurements
  */	
 void readMcLightCurve(const string& fileName, DoubleVec &timeVec, 
 	DoubleVec &dataVec);
 
+/** Reads a file containing a list of Julian days and measurements, marking 
+ *	the times as sorted
+ */	
+void readMcLightCurve(const string& fileName, Sorted<DoubleVec> &timeVec, 
+	DoubleVec &dataVec);
+
 /** Reads a file containing a list of Julian days and measurements
  */	
 void readCsvLightCurve(const string& fileName, DoubleVec &timeVec, 
 	DoubleVec &dataVec);
 
+/** Reads a file containing a list of Julian days and measurements, marking 
+ *	the times as sorted
+ */	
+void readCsvLightCurve(const string& fileName, Sorted<DoubleVec> &timeVec, 
+	DoubleVec &dataVec);
+
+/** Reads a file containing a list of Julian days, measurements, and errors, 
+ *	storing the measurements and errors in single precision
+ */	
+void readWgLightCurve(const string& fileName, double errMax, DoubleVec &timeVec, 
+	FloatVec &dataVec, FloatVec &errVec);
+
+/** Reads a file containing a list of obsids, Julian days, measurements, errors, 
+ *	and limits, storing the measurements and errors in single precision
+ */	
+void readWg2LightCurve(const string& fileName, double errMax, DoubleVec &timeVec, 
+	FloatVec &dataVec, FloatVec &errVec);
+
+/** Reads a file containing a list of Julian days and measurements, storing 
+ *	the measurements in single precision
+ */	
+void readMcLightCurve(const string& fileName, DoubleVec &timeVec, 
+	FloatVec &dataVec);
+
+/** Reads a file containing a list of Julian days and measurements, storing 
+ *	the measurements in single precision
+ */	
+void readCsvLightCurve(const string& fileName, DoubleVec &timeVec, 
+	FloatVec &dataVec);
+
 /** Prints a file containing a periodogram
  */	
 void printPeriodogram(const string& fileName, const DoubleVec &freq, const DoubleVec &power, 
+	double threshold, double fap, Codec codec = CODEC_AUTO);
+
+/** Prints a file containing a periodogram
+ */	
+void printPeriodogram(FILE* hOutput, const DoubleVec &freq, const DoubleVec &power, 
 	double threshold, double fap);
 
+/** Adds a periodogram to an archive
+ */	
+void printPeriodogram(ArchiveWriter& archive, const string& entryName, 
+	const DoubleVec &freq, const DoubleVec &power, double threshold, double fap);
+
 /** Prints a file containing an autocorrelation function
  */	
-void printAcf(const string& fileName, const DoubleVec &times, const DoubleVec &acf);
+void printAcf(const string& fileName, const DoubleVec &times, const DoubleVec &acf, 
+	Codec codec = CODEC_AUTO);
+
+/** Adds an autocorrelation function to an archive
+ */	
+void printAcf(ArchiveWriter& archive, const string& entryName, 
+	const DoubleVec &times, const DoubleVec &acf);
 
 /** Prints a file containing a Delta-m Delta-t scatter plot
  */	
-void printDmDt(const string& fileName, const DoubleVec &times, const DoubleVec &deltam);
+void printDmDt(const string& fileName, const DoubleVec &times, const DoubleVec &deltam, 
+	Codec codec = CODEC_AUTO);
+
+/** Adds a Delta-m Delta-t scatter plot to an archive
+ */	
+void printDmDt(ArchiveWriter& archive, const string& entryName, 
+	const DoubleVec &times, const DoubleVec &deltam);
 
 /** Prints a file containing a rms vs t scatter plot
  */	
-void printRmsT(const string& fileName, const DoubleVec &times, const DoubleVec &rmsVals);
+void printRmsT(const string& fileName, const DoubleVec &times, const DoubleVec &rmsVals, 
+	Codec codec = CODEC_AUTO);
+
+/** Adds a rms vs t scatter plot to an archive
+ */	
+void printRmsT(ArchiveWriter& archive, const string& entryName, 
+	const DoubleVec &times, const DoubleVec &rmsVals);
 
 /** @} */	// end lcio
 
@@ -2,7 +2,7 @@
  * @file common/lcout.cpp
  * @author Krzysztof Findeisen
  * @date Created July 24, 2011
- * @date Last modified July 25, 2013
+ * @date Last modified October 18, 2026
  */
 
 /* Copyright 2014, California Institute of Technology.
@@ -15,6 +15,7 @@
 #include <vector>
 #include <cstdio>
 #include "alloc.tmp.h"
+#include "archive.h"
 #include "csv.h"
 #include "cerror.h"
 #include "lcio.h"
@@ -31,6 +32,8 @@ using namespace std;
  * @param[in] power a vector of powers in the periodogram
  * @param[in] threshold the significance threshold
  * @param[in] fap the false alarm probability associated with threshold
+ * @param[in] codec the compression format for @p fileName. By default, 
+ *	chosen from the extension of @p fileName.
  *
  * @pre @p freq.size() = @p power.size()
  * 
@@ -44,22 +47,48 @@ using namespace std;
  * @exceptsafe The function arguments are unchanged in the event of an exception.
  */
 void printPeriodogram(const string& fileName, const DoubleVec &freq, const DoubleVec &power, 
-		double threshold, double fap) {
-	boost::shared_ptr<FILE> hOutput = fileCheckOpen(fileName, "w");
+		double threshold, double fap, Codec codec) {
+	boost::shared_ptr<FILE> hOutput = fileCheckOpen(fileName, "w", codec);
+
+	printPeriodogram(hOutput.get(), freq, power, threshold, fap);
+	fileCheckClose(hOutput);
+}
 
+/** Prints a file containing a periodogram
+ * 
+ * @param[in] hOutput an open file handle to be written to
+ * @param[in] freq a vector of frequencies at which the periodogram has been
+ *	measured
+ * @param[in] power a vector of powers in the periodogram
+ * @param[in] threshold the significance threshold
+ * @param[in] fap the false alarm probability associated with threshold
+ *
+ * @pre @p freq.size() = @p power.size()
+ * 
+ * @post Writes two header lines in the format "THRESHOLD: #" 
+ *	and "FAP: #", followed by two space-delimited columns 
+ *	containing the frequencies and corresponding power.
+ *
+ * @exception std::invalid_argument Thrown if @p freq.size() &ne; @p power.size()
+ * @exception kpfutils::except::FileIo Thrown if any file operation fails.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void printPeriodogram(FILE* hOutput, const DoubleVec &freq, const DoubleVec &power, 
+		double threshold, double fap) {
 	// Print the FAP value
 	if (fap < 0.05) {
-		if (fprintf(hOutput.get(), "FAP %.1g%% above %7.1f\n", fap*100.0, threshold) < 0) {
-			fileError(hOutput.get(), "Could not print header in printPeriodogram(): ");
+		if (fprintf(hOutput, "FAP %.1g%% above %7.1f\n", fap*100.0, threshold) < 0) {
+			fileError(hOutput, "Could not print header in printPeriodogram(): ");
 		}
 	} else {
-		if (fprintf(hOutput.get(), "FAP %.0f%% above %7.1f\n", fap*100.0, threshold) < 0) {
-			fileError(hOutput.get(), "Could not print header in printPeriodogram(): ");
+		if (fprintf(hOutput, "FAP %.0f%% above %7.1f\n", fap*100.0, threshold) < 0) {
+			fileError(hOutput, "Could not print header in printPeriodogram(): ");
 		}
 	}
 	
 	// Print the table
-	printTable(hOutput.get(), "Freq\tPower", freq, power);
+	printTable(hOutput, "Freq\tPower", freq, power);
 //	int status = fprintf(hOutput, "Freq\tPower\n");
 //	if (status < 0) {
 //		throw std::runtime_error("Could not print periodogram column header.");
@@ -77,6 +106,8 @@ void printPeriodogram(const string& fileName, const DoubleVec &freq, const Doubl
  * @param[in] fileName the name of a file to be written to
  * @param[in] times a vector of time offsets at which the ACF has been measured
  * @param[in] acf a vector of correlations
+ * @param[in] codec the compression format for @p fileName. By default, 
+ *	chosen from the extension of @p fileName.
  *
  * @pre @p times.size() = @p acf.size()
  * 
@@ -88,10 +119,12 @@ void printPeriodogram(const string& fileName, const DoubleVec &freq, const Doubl
  *
  * @exceptsafe The function arguments are unchanged in the event of an exception.
  */	
-void printAcf(const string& fileName, const DoubleVec &times, const DoubleVec &acf) {
-	boost::shared_ptr<FILE> hOutput = fileCheckOpen(fileName, "w");
+void printAcf(const string& fileName, const DoubleVec &times, const DoubleVec &acf, 
+		Codec codec) {
+	boost::shared_ptr<FILE> hOutput = fileCheckOpen(fileName, "w", codec);
 
 	printTable(hOutput.get(), "Offset\tACF", times, acf);
+	fileCheckClose(hOutput);
 	// Print the table
 //	int status = fprintf(hOutput, "Offset\tACF\n");
 //	if (status < 0) {
@@ -110,6 +143,8 @@ void printAcf(const string& fileName, const DoubleVec &times, const DoubleVec &a
  * @param[in] fileName the name of a file to be written to
  * @param[in] deltaT a vector of time differences
  * @param[in] deltaM a vector of magnitude differences
+ * @param[in] codec the compression format for @p fileName. By default, 
+ *	chosen from the extension of @p fileName.
  *
  * @pre @p deltaT.size() = @p deltaM.size()
  * 
@@ -121,10 +156,12 @@ void printAcf(const string& fileName, const DoubleVec &times, const DoubleVec &a
  *
  * @exceptsafe The function arguments are unchanged in the event of an exception.
  */
-void printDmDt(const string& fileName, const DoubleVec &deltaT, const DoubleVec &deltaM) {
-	boost::shared_ptr<FILE> hOutput = fileCheckOpen(fileName, "w");
+void printDmDt(const string& fileName, const DoubleVec &deltaT, const DoubleVec &deltaM, 
+		Codec codec) {
+	boost::shared_ptr<FILE> hOutput = fileCheckOpen(fileName, "w", codec);
 
 	printTable(hOutput.get(), "Offset\tMag Diff.", deltaT, deltaM);
+	fileCheckClose(hOutput);
 	// Print the table
 //	int status = fprintf(hOutput, "Offset\tMag Diff.\n");
 //	if (status < 0) {
@@ -143,6 +180,8 @@ void printDmDt(const string& fileName, const DoubleVec &deltaT, const DoubleVec
  * @param[in] fileName the name of a file to be written to
  * @param[in] times a vector of time differences
  * @param[in] rmsVals a vector of RMS scores
+ * @param[in] codec the compression format for @p fileName. By default, 
+ *	chosen from the extension of @p fileName.
  *
  * @pre @p times.size() &ne; @p rmsVals.size()
  * 
@@ -154,10 +193,12 @@ void printDmDt(const string& fileName, const DoubleVec &deltaT, const DoubleVec
  *
  * @exceptsafe The function arguments are unchanged in the event of an exception.
  */	
-void printRmsT(const string& fileName, const DoubleVec &times, const DoubleVec &rmsVals) {
-	boost::shared_ptr<FILE> hOutput = fileCheckOpen(fileName, "w");
+void printRmsT(const string& fileName, const DoubleVec &times, const DoubleVec &rmsVals, 
+		Codec codec) {
+	boost::shared_ptr<FILE> hOutput = fileCheckOpen(fileName, "w", codec);
 
 	printTable(hOutput.get(), "Interval\tRMS", times, rmsVals);
+	fileCheckClose(hOutput);
 	// Print the table
 //	int status = fprintf(hOutput, "Interval\tRMS\n");
 //	if (status < 0) {
@@ -171,4 +212,131 @@ void printRmsT(const string& fileName, const DoubleVec &times, const DoubleVec &
 //	}
 }
 
+/** Adds a periodogram to an archive
+ * 
+ * @param[in] archive the archive to be written to
+ * @param[in] entryName the name under which to store the periodogram
+ * @param[in] freq a vector of frequencies at which the periodogram has been
+ *	measured
+ * @param[in] power a vector of powers in the periodogram
+ * @param[in] threshold the significance threshold
+ * @param[in] fap the false alarm probability associated with threshold
+ *
+ * @pre @p freq.size() = @p power.size()
+ * @pre @p entryName is not already in @p archive
+ * 
+ * @post @p archive contains an entry named @p entryName, formatted as 
+ *	for printPeriodogram(const string&, const DoubleVec&, const DoubleVec&, double, double, Codec)
+ *
+ * @exception std::invalid_argument Thrown if @p freq.size() &ne; @p power.size() 
+ *	or @p entryName is not a valid name.
+ * @exception kpfutils::except::FileIo Thrown if any file operation fails.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void printPeriodogram(ArchiveWriter& archive, const string& entryName, 
+		const DoubleVec &freq, const DoubleVec &power, double threshold, double fap) {
+	FILE* hOutput = archive.beginEntry(entryName);
+	try {
+		printPeriodogram(hOutput, freq, power, threshold, fap);
+	} catch (...) {
+		archive.discardEntry();
+		throw;
+	}
+	archive.endEntry();
+}
+
+/** Adds an autocorrelation function to an archive
+ * 
+ * @param[in] archive the archive to be written to
+ * @param[in] entryName the name under which to store the table
+ * @param[in] times a vector of time offsets at which the ACF has been measured
+ * @param[in] acf a vector of correlations
+ *
+ * @pre @p times.size() = @p acf.size()
+ * @pre @p entryName is not already in @p archive
+ * 
+ * @post @p archive contains an entry named @p entryName, formatted as 
+ *	for printAcf(const string&, const DoubleVec&, const DoubleVec&, Codec)
+ *
+ * @exception std::invalid_argument Thrown if @p times.size() &ne; @p acf.size() 
+ *	or @p entryName is not a valid name.
+ * @exception kpfutils::except::FileIo Thrown if any file operation fails.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void printAcf(ArchiveWriter& archive, const string& entryName, 
+		const DoubleVec &times, const DoubleVec &acf) {
+	FILE* hOutput = archive.beginEntry(entryName);
+	try {
+		printTable(hOutput, "Offset\tACF", times, acf);
+	} catch (...) {
+		archive.discardEntry();
+		throw;
+	}
+	archive.endEntry();
+}
+
+/** Adds a Delta-m Delta-t scatter plot to an archive
+ * 
+ * @param[in] archive the archive to be written to
+ * @param[in] entryName the name under which to store the table
+ * @param[in] deltaT a vector of time differences
+ * @param[in] deltaM a vector of magnitude differences
+ *
+ * @pre @p deltaT.size() = @p deltaM.size()
+ * @pre @p entryName is not already in @p archive
+ * 
+ * @post @p archive contains an entry named @p entryName, formatted as 
+ *	for printDmDt(const string&, const DoubleVec&, const DoubleVec&, Codec)
+ *
+ * @exception std::invalid_argument Thrown if @p deltaT.size() &ne; @p deltaM.size() 
+ *	or @p entryName is not a valid name.
+ * @exception kpfutils::except::FileIo Thrown if any file operation fails.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void printDmDt(ArchiveWriter& archive, const string& entryName, 
+		const DoubleVec &deltaT, const DoubleVec &deltaM) {
+	FILE* hOutput = archive.beginEntry(entryName);
+	try {
+		printTable(hOutput, "Offset\tMag Diff.", deltaT, deltaM);
+	} catch (...) {
+		archive.discardEntry();
+		throw;
+	}
+	archive.endEntry();
+}
+
+/** Adds a rms vs t scatter plot to an archive
+ * 
+ * @param[in] archive the archive to be written to
+ * @param[in] entryName the name under which to store the table
+ * @param[in] times a vector of time differences
+ * @param[in] rmsVals a vector of RMS scores
+ *
+ * @pre @p times.size() = @p rmsVals.size()
+ * @pre @p entryName is not already in @p archive
+ * 
+ * @post @p archive contains an entry named @p entryName, formatted as 
+ *	for printRmsT(const string&, const DoubleVec&, const DoubleVec&, Codec)
+ *
+ * @exception std::invalid_argument Thrown if @p times.size() &ne; @p rmsVals.size() 
+ *	or @p entryName is not a valid name.
+ * @exception kpfutils::except::FileIo Thrown if any file operation fails.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */
+void printRmsT(ArchiveWriter& archive, const string& entryName, 
+		const DoubleVec &times, const DoubleVec &rmsVals) {
+	FILE* hOutput = archive.beginEntry(entryName);
+	try {
+		printTable(hOutput, "Interval\tRMS", times, rmsVals);
+	} catch (...) {
+		archive.discardEntry();
+		throw;
+	}
+	archive.endEntry();
+}
+
 }	// end kpfutils
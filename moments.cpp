@@ -0,0 +1,139 @@
+/** Mergeable accumulators for sample moments
+ * @file common/moments.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#include <cmath>
+#include "moments.h"
+#include "stats_except.h"
+
+namespace kpfutils {
+
+/** Creates an accumulator with no data.
+ *
+ * @post count() = 0
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+Moments::Moments() : n(0.0), mu(0.0), m2(0.0), m3(0.0), m4(0.0) {
+}
+
+/** Adds all the data summarized by another accumulator to this one.
+ *
+ * The result is the same, up to roundoff error, as if every value added
+ * to @p other had been added to this accumulator.
+ *
+ * @param[in] other The accumulator to merge. May be this accumulator.
+ *
+ * @post count() is increased by @p other.count().
+ *
+ * @perform O(1)
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void Moments::merge(const Moments& other) {
+	if (other.n <= 0.0) {
+		return;
+	} else if (n <= 0.0) {
+		*this = other;
+		return;
+	}
+
+	const double nA = n, nB = other.n;
+	const double nTotal = nA + nB;
+	const double delta  = other.mu - mu;
+	const double delta2 = delta  * delta;
+	const double delta3 = delta2 * delta;
+	const double delta4 = delta2 * delta2;
+
+	const double newMu = mu + delta * nB / nTotal;
+	const double newM2 = m2 + other.m2 + delta2 * nA * nB / nTotal;
+	const double newM3 = m3 + other.m3
+		+ delta3 * nA * nB * (nA - nB) / (nTotal*nTotal)
+		+ 3.0 * delta * (nA * other.m2 - nB * m2) / nTotal;
+	const double newM4 = m4 + other.m4
+		+ delta4 * nA * nB * (nA*nA - nA*nB + nB*nB) / (nTotal*nTotal*nTotal)
+		+ 6.0 * delta2 * (nA*nA * other.m2 + nB*nB * m2) / (nTotal*nTotal)
+		+ 4.0 * delta * (nA * other.m3 - nB * m3) / nTotal;
+
+	n  = nTotal;
+	mu = newMu;
+	m2 = newM2;
+	m3 = newM3;
+	m4 = newM4;
+}
+
+/** Returns the mean of the data set.
+ *
+ * @return The arithmetic mean of all values added.
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if count() < 1.
+ *
+ * @exceptsafe The accumulator is unchanged in the event of an exception.
+ */
+double Moments::mean() const {
+	if (n < 1.0) {
+		throw except::NotEnoughData("Not enough data to compute mean");
+	}
+	return mu;
+}
+
+/** Returns the unbiased sample variance of the data set.
+ *
+ * @return The variance of all values added, normalized by count() - 1.
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if count() < 2.
+ *
+ * @exceptsafe The accumulator is unchanged in the event of an exception.
+ */
+double Moments::variance() const {
+	if (n < 2.0) {
+		throw except::NotEnoughData("Not enough data to compute variance");
+	}
+	return m2 / (n - 1.0);
+}
+
+/** Returns the skewness of the data set.
+ *
+ * @return The sample skewness g<sub>1</sub> = m<sub>3</sub>/m<sub>2</sub><sup>3/2</sup>,
+ *	where m<sub>k</sub> is the kth central moment normalized by count().
+ *	If all values are equal, returns NaN.
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if count() < 3.
+ *
+ * @exceptsafe The accumulator is unchanged in the event of an exception.
+ */
+double Moments::skewness() const {
+	if (n < 3.0) {
+		throw except::NotEnoughData("Not enough data to compute skewness");
+	}
+	return std::sqrt(n) * m3 / std::pow(m2, 1.5);
+}
+
+/** Returns the excess kurtosis of the data set.
+ *
+ * @return The sample excess kurtosis g<sub>2</sub> = m<sub>4</sub>/m<sub>2</sub><sup>2</sup> - 3,
+ *	where m<sub>k</sub> is the kth central moment normalized by count().
+ *	If all values are equal, returns NaN.
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if count() < 4.
+ *
+ * @exceptsafe The accumulator is unchanged in the event of an exception.
+ */
+double Moments::kurtosis() const {
+	if (n < 4.0) {
+		throw except::NotEnoughData("Not enough data to compute kurtosis");
+	}
+	return n * m4 / (m2*m2) - 3.0;
+}
+
+}	// end kpfutils
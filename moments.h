@@ -0,0 +1,132 @@
+/** Mergeable accumulators for sample moments
+ * @file common/moments.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#ifndef KPFUTILSMOMENTSH
+#define KPFUTILSMOMENTSH
+
+namespace kpfutils {
+
+/** @addtogroup stats
+ *
+ * Include moments.h to accumulate moments of data one value at a time.
+ *
+ * @{
+ */
+
+/** Accumulates the first four central moments of a data set.
+ *
+ * Values may be added one at a time with add(), and accumulators for
+ * disjoint parts of a data set may be combined with merge(). Both
+ * operations use numerically stable updates (Welford 1962, Chan et al.
+ * 1979, Pébay 2008), so the results are accurate even when the mean is
+ * much larger than the spread of the data.
+ */
+class Moments {
+public:
+	/** Creates an accumulator with no data.
+	 */
+	Moments();
+
+	/** Adds a value to the data set.
+	 *
+	 * @param[in] x The value to add.
+	 *
+	 * @pre @p x is not NaN
+	 *
+	 * @perform O(1)
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	void add(double x) {
+		const double n1      = n;
+		n += 1.0;
+		const double delta   = x - mu;
+		const double deltaN  = delta / n;
+		const double deltaN2 = deltaN * deltaN;
+		const double term1   = delta * deltaN * n1;
+
+		mu += deltaN;
+		m4 += term1 * deltaN2 * (n*n - 3.0*n + 3.0) + 6.0 * deltaN2 * m2 - 4.0 * deltaN * m3;
+		m3 += term1 * deltaN * (n - 2.0) - 3.0 * deltaN * m2;
+		m2 += term1;
+	}
+
+	/** Adds all the data summarized by another accumulator to this one.
+	 */
+	void merge(const Moments& other);
+
+	/** Returns the number of values in the data set.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	double count() const {
+		return n;
+	}
+
+	/** Returns the mean of the data set.
+	 */
+	double mean() const;
+
+	/** Returns the unbiased sample variance of the data set.
+	 */
+	double variance() const;
+
+	/** Returns the skewness of the data set.
+	 */
+	double skewness() const;
+
+	/** Returns the excess kurtosis of the data set.
+	 */
+	double kurtosis() const;
+
+	/** Returns the sum of squared deviations from the mean.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	double sumSq() const {
+		return m2;
+	}
+
+	/** Returns the sum of cubed deviations from the mean.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	double sumCube() const {
+		return m3;
+	}
+
+	/** Returns the sum of fourth powers of deviations from the mean.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	double sumQuart() const {
+		return m4;
+	}
+
+private:
+	/** Number of values. Stored as a double to avoid conversions in the
+	 *	update formulas.
+	 */
+	double n;
+	double mu;
+	double m2;
+	double m3;
+	double m4;
+};
+
+/** @} */	// end stats
+
+}	// end kpfutils
+
+#endif		// KPFUTILSMOMENTSH
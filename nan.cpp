@@ -2,7 +2,7 @@
  * @file common/nan.cpp
  * @author Krzysztof Findeisen
  * @date Created April 11, 2013
- * @date Last modified October 30, 2013
+ * @date Last modified October 18, 2026
  */
 
 /* Copyright 2014, California Institute of Technology.
@@ -12,49 +12,235 @@
  * distribution and at http://opensource.org/licenses/BSD-3-Clause. 
  */
 
-#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
 #include "nan.h"
 
 namespace kpfutils {
 
-using std::numeric_limits;
+/*----------------------------------------------------------
+ * Bulk tests
+ * The loops below test many values with branch-free comparisons, so that 
+ *	the compiler can vectorize them. Branches are taken only once per 
+ *	block. The loops are written so that they vectorize even with the 
+ *	baseline x86-64 instruction set.
+ */
+
+namespace {
+
+/** Number of values scanned between checks for an early exit
+ */
+const size_t SCAN_BLOCK = 256;
+
+}	// end anonymous namespace
 
-/** isNan() tests whether a floating-point number is undefined
+/** Counts the non-finite values in an array
+ *
+ * @param[in] data, n The array to test.
  *
- * @param[in] x The number to test
- * 
- * @return true if and only if @p x equals signaling or quiet not-a-number
+ * @return The number of elements of @p data that are NaN or infinite.
+ *
+ * @perform O(@p n), vectorizable.
  *
  * @exceptsafe Does not throw exceptions.
  */
-bool isNan(const double x) {
-	return (x != x);
+size_t countNonFinite(const double* data, size_t n) {
+	// Counting in floating point lets the compare results stay in vector 
+	//	registers; the count is exact for any realistic n
+	double count = 0.0;
+	for(size_t i = 0; i < n; i++) {
+		count += (isNanOrInf(data[i]) ? 1.0 : 0.0);
+	}
+	return static_cast<size_t>(count);
 }
 
-/** isNanOrInf() tests whether a floating-point number is non-finite
+/** Finds the first non-finite value in an array
+ *
+ * @param[in] data, n The array to test.
+ *
+ * @return The index of the first element of @p data that is NaN or 
+ *	infinite, or @p n if all elements are finite.
  *
- * @param[in] x The number to test
- * 
- * @return true if and only if @p x equals signaling or quiet not-a-number, 
- *	or @p x is infinite
+ * @perform O(@p n) in the worst case. Each block of values is tested 
+ *	without branches before it is searched.
  *
  * @exceptsafe Does not throw exceptions.
  */
-bool isNanOrInf(const double x) {
-	return ( isNan(x) || (x ==  numeric_limits<double>::infinity()) 
-			  || (x == -numeric_limits<double>::infinity()) );
+size_t findFirstNonFinite(const double* data, size_t n) {
+	for(size_t start = 0; start < n; start += SCAN_BLOCK) {
+		const double* const block = data + start;
+		const size_t len = std::min(SCAN_BLOCK, n - start);
+
+		// x - x is 0 for finite x and NaN otherwise, and NaNs propagate 
+		//	through the sum
+		double probe = 0.0;
+		for(size_t i = 0; i < len; i++) {
+			probe += block[i] - block[i];
+		}
+		if (isNan(probe)) {
+			for(size_t i = 0; i < len; i++) {
+				if (isNanOrInf(block[i])) {
+					return start + i;
+				}
+			}
+		}
+	}
+	return n;
 }
 
-/** Returns true iff the argument is not NaN.
+/** Marks the finite values in an array
+ *
+ * @param[in] data, n The array to test.
+ * @param[out] mask An array whose ith element is 1 if @p data[i] is 
+ *	finite, and 0 otherwise. Its previous contents are discarded, but its 
+ *	capacity is reused.
+ *
+ * @return The number of finite values in @p data.
+ *
+ * @post @p mask.size() = @p n
+ *
+ * @perform O(@p n), vectorizable.
+ *
+ * @exception std::bad_alloc Thrown if @p mask could not be enlarged.
+ *
+ * @exceptsafe The contents of @p mask are unspecified in the event of an 
+ *	exception.
+ */
+size_t buildFiniteMask(const double* data, size_t n, std::vector<unsigned char>& mask) {
+	mask.resize(n);
+	if (n == 0) {
+		return 0;
+	}
+
+	unsigned char* const out = &mask[0];
+	for(size_t i = 0; i < n; i++) {
+		out[i] = (isNanOrInf(data[i]) ? 0 : 1);
+	}
+
+	size_t count = 0;
+	for(size_t i = 0; i < n; i++) {
+		count += out[i];
+	}
+	return count;
+}
+
+/** Removes all rows containing non-finite values from a set of parallel 
+ *	columns
+ *
+ * The columns are tested a block at a time, and the results combined into 
+ * a mask of rows in which every column is finite. Rows are then moved into 
+ * place without branches.
+ *
+ * @param[in,out] columns An array of @p nColumns pointers, each to an 
+ *	array of @p n values. On return, the first N elements of each array 
+ *	are the rows whose values are all finite, in their original order. 
+ *	The remaining elements are unspecified.
+ * @param[in] nColumns The number of columns.
+ * @param[in] n The number of rows.
  *
- * @param[in] x
+ * @return The number N of rows kept.
  *
- * @return @p x &ne; NaN
+ * @pre The column arrays do not overlap.
+ *
+ * @perform O(@p n @p nColumns)
  *
  * @exceptsafe Does not throw exceptions.
  */
-bool NotNan::operator() (double x) {
-	return !isNan(x);
+size_t compactFinite(double* const columns[], size_t nColumns, size_t n) {
+	if (nColumns == 0) {
+		return n;
+	}
+
+	// Mask of usable rows, stored as doubles so that it can be built with 
+	//	vector instructions
+	double ok[SCAN_BLOCK];
+	size_t kept = 0;
+	for(size_t start = 0; start < n; start += SCAN_BLOCK) {
+		const size_t len = std::min(SCAN_BLOCK, n - start);
+
+		std::fill(ok, ok+len, 1.0);
+		for(size_t c = 0; c < nColumns; c++) {
+			const double* const block = columns[c] + start;
+			for(size_t i = 0; i < len; i++) {
+				ok[i] *= (isNanOrInf(block[i]) ? 0.0 : 1.0);
+			}
+		}
+
+		// Since kept <= start + i, each row is read before it is overwritten
+		for(size_t i = 0; i < len; i++) {
+			for(size_t c = 0; c < nColumns; c++) {
+				columns[c][kept] = columns[c][start + i];
+			}
+			kept += static_cast<size_t>(ok[i]);
+		}
+	}
+	return kept;
+}
+
+/** Removes all rows containing non-finite values from two parallel columns
+ *
+ * @param[in,out] column1, column2 The columns to filter. On return, they 
+ *	contain only the rows in which both values are finite, in their 
+ *	original order.
+ *
+ * @return The number of rows kept.
+ *
+ * @perform O(N), where N is the length of the columns.
+ *
+ * @exception std::invalid_argument Thrown if the columns have different 
+ *	lengths.
+ *
+ * @exceptsafe The columns are unchanged in the event of an exception.
+ */
+size_t compactFinite(std::vector<double>& column1, std::vector<double>& column2) {
+	if (column1.size() != column2.size()) {
+		throw std::invalid_argument("Columns passed to compactFinite() have different lengths.");
+	}
+	if (column1.empty()) {
+		return 0;
+	}
+
+	double* const columns[] = {&column1[0], &column2[0]};
+	const size_t kept = compactFinite(columns, 2, column1.size());
+	column1.resize(kept);
+	column2.resize(kept);
+	return kept;
+}
+
+/** Removes all rows containing non-finite values from three parallel columns
+ *
+ * This function is typically used to clean the times, data, and errors of 
+ * a light curve in one pass.
+ *
+ * @param[in,out] column1, column2, column3 The columns to filter. On 
+ *	return, they contain only the rows in which all three values are 
+ *	finite, in their original order.
+ *
+ * @return The number of rows kept.
+ *
+ * @perform O(N), where N is the length of the columns.
+ *
+ * @exception std::invalid_argument Thrown if the columns have different 
+ *	lengths.
+ *
+ * @exceptsafe The columns are unchanged in the event of an exception.
+ */
+size_t compactFinite(std::vector<double>& column1, std::vector<double>& column2, 
+		std::vector<double>& column3) {
+	if (column1.size() != column2.size() || column1.size() != column3.size()) {
+		throw std::invalid_argument("Columns passed to compactFinite() have different lengths.");
+	}
+	if (column1.empty()) {
+		return 0;
+	}
+
+	double* const columns[] = {&column1[0], &column2[0], &column3[0]};
+	const size_t kept = compactFinite(columns, 3, column1.size());
+	column1.resize(kept);
+	column2.resize(kept);
+	column3.resize(kept);
+	return kept;
 }
 
 }	// end kpfutils
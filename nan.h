@@ -2,7 +2,7 @@
  * @file common/nan.h
  * @author Krzysztof Findeisen
  * @date Created April 11, 2013
- * @date Last modified October 30, 2013
+ * @date Last modified October 18, 2026
  */
 
 /* Copyright 2014, California Institute of Technology.
@@ -15,25 +15,80 @@
 #ifndef KPFNANH
 #define KPFNANH
 
+#include <vector>
+#include <cstddef>
+
 namespace kpfutils {
 
 /** isNan() tests whether a floating-point number is undefined
+ *
+ * @param[in] x The number to test
+ * 
+ * @return true if and only if @p x equals signaling or quiet not-a-number
+ *
+ * @exceptsafe Does not throw exceptions.
  */
-bool isNan(double x);
+inline bool isNan(const double x) {
+	return (x != x);
+}
 
 /** isNanOrInf() tests whether a floating-point number is non-finite
+ *
+ * @param[in] x The number to test
+ * 
+ * @return true if and only if @p x equals signaling or quiet not-a-number, 
+ *	or @p x is infinite
+ *
+ * @exceptsafe Does not throw exceptions.
  */
-bool isNanOrInf(double x);
+inline bool isNanOrInf(const double x) {
+	// x - x is NaN if x is infinite or NaN, and 0 otherwise
+	return !(x - x == 0.0);
+}
 
 /** Default-constructible predicate for testing whether something is not NaN
  */
 class NotNan {
 public: 
 	/** Returns true iff the argument is not NaN.
+	 *
+	 * @param[in] x
+	 *
+	 * @return @p x &ne; NaN
+	 *
+	 * @exceptsafe Does not throw exceptions.
 	 */
-	bool operator() (double x);
+	bool operator() (double x) const {
+		return !isNan(x);
+	}
 };
 
+/** Counts the non-finite values in an array
+ */
+size_t countNonFinite(const double* data, size_t n);
+
+/** Finds the first non-finite value in an array
+ */
+size_t findFirstNonFinite(const double* data, size_t n);
+
+/** Marks the finite values in an array
+ */
+size_t buildFiniteMask(const double* data, size_t n, std::vector<unsigned char>& mask);
+
+/** Removes all rows containing non-finite values from a set of parallel 
+ *	columns
+ */
+size_t compactFinite(double* const columns[], size_t nColumns, size_t n);
+
+/** Removes all rows containing non-finite values from two parallel columns
+ */
+size_t compactFinite(std::vector<double>& column1, std::vector<double>& column2);
+
+/** Removes all rows containing non-finite values from three parallel columns
+ */
+size_t compactFinite(std::vector<double>& column1, std::vector<double>& column2, 
+		std::vector<double>& column3);
+
 }	// end kpfutils
 
 #endif	// ifndef KPFNANH
@@ -0,0 +1,1179 @@
+/** Lomb-Scargle periodograms of unevenly sampled time series
+ * @file common/periodogram.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#include <algorithm>
+#include <complex>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <boost/bind/bind.hpp>
+#include <boost/function.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread.hpp>
+#include "periodogram.h"
+#include "stats_except.h"
+#include "stats_parallel.tmp.h"
+
+namespace kpfutils {
+
+namespace {
+
+typedef std::complex<double> Complex;
+
+const double TWO_PI = 6.283185307179586476925286766559;
+
+/** Ratio of the FFT length to the number of frequencies requested
+ */
+const size_t OVERSAMPLING = 5;
+
+/** Number of grid points each measurement is spread over
+ */
+const long EXTIRP_ORDER = 6;
+
+/** Number of frequency steps between exact evaluations of the phasors in
+ *	the rotation kernel
+ */
+const size_t ANCHOR_INTERVAL = 32;
+
+/** Number of independent partial sums in the rotation kernel
+ *
+ * Separate accumulators let the compiler vectorize the loop over
+ * measurements without reordering any floating-point sum.
+ */
+const size_t LANES = 4;
+
+/** A time series prepared for the trigonometric sums
+ *
+ * The times are measured from the earliest time, which does not change the
+ * periodogram but keeps the phases small. The weights are normalized to
+ * sum to one, and the data are stored as weights times residuals from the
+ * weighted mean.
+ */
+struct Series {
+	/** Creates an empty series.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	Series() : times(), weights(), weightedData(), variance(0.0) {
+	}
+
+	/** Times relative to the earliest time */
+	std::vector<double> times;
+	/** Normalized inverse-variance weights */
+	std::vector<double> weights;
+	/** Weighted residuals from the weighted mean */
+	std::vector<double> weightedData;
+	/** Weighted variance of the data about the weighted mean */
+	double variance;
+};
+
+/** Checks a time series and converts it to the form used by the
+ *	trigonometric sums
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are fewer
+ *	than 3 measurements.
+ * @exception std::invalid_argument Thrown if @p times, @p data, and
+ *	@p errors have different lengths, or if any error is not positive
+ *	and finite.
+ * @exception std::bad_alloc Thrown if there is not enough memory for
+ *	the copy.
+ *
+ * @exceptsafe @p series is unchanged if the input is invalid, and in a
+ *	valid but unspecified state if memory runs out. It does not
+ *	allocate memory if it already has room for the time series.
+ */
+void prepare(const std::vector<double>& times, const std::vector<double>& data,
+		const std::vector<double>& errors, Series& series) {
+	const size_t n = times.size();
+	if (data.size() != n || errors.size() != n) {
+		throw std::invalid_argument("Times, data, and errors have different lengths in lombScargle()");
+	}
+	if (n < 3) {
+		throw except::NotEnoughData("Not enough data to compute periodogram");
+	}
+	for (size_t i = 0; i < n; i++) {
+		if (!(errors[i] > 0.0 && errors[i] < std::numeric_limits<double>::infinity())) {
+			throw std::invalid_argument("Errors must be positive and finite in lombScargle()");
+		}
+	}
+
+	series.times.resize(n);
+	series.weights.resize(n);
+	series.weightedData.resize(n);
+
+	double sumWeights = 0.0;
+	for (size_t i = 0; i < n; i++) {
+		series.weights[i] = 1.0 / (errors[i] * errors[i]);
+		sumWeights += series.weights[i];
+	}
+
+	double mean = 0.0;
+	for (size_t i = 0; i < n; i++) {
+		series.weights[i] /= sumWeights;
+		mean += series.weights[i] * data[i];
+	}
+
+	const double tMin = *std::min_element(times.begin(), times.end());
+	series.variance = 0.0;
+	for (size_t i = 0; i < n; i++) {
+		const double residual = data[i] - mean;
+		series.times[i] = times[i] - tMin;
+		series.weightedData[i] = series.weights[i] * residual;
+		series.variance += series.weightedData[i] * residual;
+	}
+	// Roundoff in the mean would otherwise give constant data a
+	//	tiny, meaningless variance
+	if (std::adjacent_find(data.begin(), data.end(), std::not_equal_to<double>()) == data.end()) {
+		series.variance = 0.0;
+	}
+}
+
+/** Evaluates the sums of @p h[i] sin(2&pi; f t[i]) and
+ *	@p h[i] cos(2&pi; f t[i]) directly at each frequency f in @p freq
+ *
+ * @exceptsafe @p sinSums and @p cosSums are in a valid but unspecified
+ *	state in the event of an exception.
+ */
+void directSums(const std::vector<double>& times, const std::vector<double>& h,
+		const std::vector<double>& freq, std::vector<double>& sinSums,
+		std::vector<double>& cosSums) {
+	sinSums.resize(freq.size());
+	cosSums.resize(freq.size());
+
+	for (size_t k = 0; k < freq.size(); k++) {
+		double s = 0.0, c = 0.0;
+		for (size_t i = 0; i < times.size(); i++) {
+			// Reduce the phase first, so that long baselines do not lose precision
+			double phase = freq[k] * times[i];
+			phase -= std::floor(phase);
+			s += h[i] * std::sin(TWO_PI * phase);
+			c += h[i] * std::cos(TWO_PI * phase);
+		}
+		sinSums[k] = s;
+		cosSums[k] = c;
+	}
+}
+
+/** Returns the length of the FFT needed for a grid of @p nFreq frequencies
+ *
+ * The FFT requires a power of two.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t fftLength(size_t nFreq) {
+	size_t nGrid = 1;
+	while (nGrid < nFreq * OVERSAMPLING || nGrid < static_cast<size_t>(EXTIRP_ORDER)) {
+		nGrid <<= 1;
+	}
+	return nGrid;
+}
+
+/** Computes the twiddle factors exp(2&pi;ik/n), k = 0, ..., n/2 - 1, for
+ *	an FFT of length @p n
+ *
+ * The factors are computed directly rather than by repeated
+ * multiplication, so that their error does not grow with @p n.
+ *
+ * @exceptsafe @p twiddle is unchanged in the event of an exception.
+ */
+void fftTwiddles(size_t n, std::vector<Complex>& twiddle) {
+	std::vector<Complex> temp(n / 2);
+	for (size_t k = 0; k < n / 2; k++) {
+		const double angle = TWO_PI * static_cast<double>(k) / static_cast<double>(n);
+		temp[k] = Complex(std::cos(angle), std::sin(angle));
+	}
+
+	// IMPORTANT: no exceptions beyond this point
+
+	twiddle.swap(temp);
+}
+
+/** Computes x[k] = sum_j x[j] exp(+2&pi;ijk/n) in place, without
+ *	normalization
+ *
+ * @param[in,out] x The data to transform.
+ * @param[in] twiddle The twiddle factors computed by fftTwiddles() for
+ *	n = @p x.size().
+ *
+ * @pre @p x.size() is a power of two
+ *
+ * @perform O(n log n), where n = @p x.size().
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void fft(std::vector<Complex>& x, const std::vector<Complex>& twiddle) {
+	const size_t n = x.size();
+
+	for (size_t i = 1, j = 0; i < n; i++) {
+		size_t bit = n >> 1;
+		for (; j & bit; bit >>= 1) {
+			j ^= bit;
+		}
+		j ^= bit;
+		if (i < j) {
+			std::swap(x[i], x[j]);
+		}
+	}
+
+	for (size_t len = 2; len <= n; len <<= 1) {
+		const size_t half = len / 2;
+		const size_t stride = n / len;
+		for (size_t start = 0; start < n; start += len) {
+			for (size_t k = 0; k < half; k++) {
+				const Complex u = x[start + k];
+				const Complex v = x[start + k + half] * twiddle[k * stride];
+				x[start + k]        = u + v;
+				x[start + k + half] = u - v;
+			}
+		}
+	}
+}
+
+/** Spreads a value at an arbitrary position onto a periodic regular grid
+ *
+ * The value is divided among the EXTIRP_ORDER grid points nearest @p x
+ * using Lagrange interpolation weights, so that any polynomial of lower
+ * order sampled at those points has the same sum against the grid as
+ * against the original value (Press & Rybicki 1989).
+ *
+ * @pre 0 &le; @p x &lt; @p grid.size()
+ * @pre @p grid.size() &ge; EXTIRP_ORDER
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void extirpolate(double x, const Complex& y, std::vector<Complex>& grid) {
+	const long n = static_cast<long>(grid.size());
+	const double xFloor = std::floor(x);
+	if (x == xFloor) {
+		grid[static_cast<size_t>(xFloor)] += y;
+		return;
+	}
+
+	const long first = static_cast<long>(xFloor) - (EXTIRP_ORDER / 2 - 1);
+	double numerator = 1.0;
+	for (long m = 0; m < EXTIRP_ORDER; m++) {
+		numerator *= x - static_cast<double>(first + m);
+	}
+
+	// denominator = prod_{j != m} (m - j), starting from m = 0
+	double denominator = 1.0;
+	for (long j = 1; j < EXTIRP_ORDER; j++) {
+		denominator *= -static_cast<double>(j);
+	}
+	for (long m = 0; m < EXTIRP_ORDER; m++) {
+		if (m > 0) {
+			denominator *= static_cast<double>(m) / static_cast<double>(m - EXTIRP_ORDER);
+		}
+		const long node = first + m;
+		const size_t index = static_cast<size_t>((node % n + n) % n);
+		grid[index] += y * (numerator / (denominator * (x - static_cast<double>(node))));
+	}
+}
+
+/** Approximates the sums of @p h[i] sin(2&pi; f t[i]) and
+ *	@p h[i] cos(2&pi; f t[i]) at f = @p f0 + k @p df, k = 0, ...,
+ *	@p nFreq - 1, by extirpolation and FFT
+ *
+ * @pre @p twiddle was computed by fftTwiddles() for
+ *	n = fftLength(@p nFreq)
+ *
+ * @param[in,out] grid Scratch space for the FFT.
+ *
+ * @perform O(N + M log M), where N = @p times.size() and
+ *	M = @p nFreq.
+ *
+ * @exceptsafe @p grid, @p sinSums, and @p cosSums are in a valid but
+ *	unspecified state in the event of an exception.
+ */
+void fastSums(const std::vector<double>& times, const std::vector<double>& h,
+		double f0, double df, size_t nFreq, const std::vector<Complex>& twiddle,
+		std::vector<Complex>& grid, std::vector<double>& sinSums,
+		std::vector<double>& cosSums) {
+	const size_t nGrid = 2 * twiddle.size();
+	grid.assign(nGrid, Complex(0.0, 0.0));
+
+	for (size_t i = 0; i < times.size(); i++) {
+		// Shifting the frequencies by f0 multiplies each term by a
+		//	constant phase factor
+		double offset = f0 * times[i];
+		offset -= std::floor(offset);
+		const Complex y = h[i] * Complex(std::cos(TWO_PI * offset),
+			std::sin(TWO_PI * offset));
+
+		double phase = df * times[i];
+		phase -= std::floor(phase);
+		extirpolate(phase * static_cast<double>(nGrid), y, grid);
+	}
+
+	fft(grid, twiddle);
+
+	sinSums.resize(nFreq);
+	cosSums.resize(nFreq);
+	for (size_t k = 0; k < nFreq; k++) {
+		sinSums[k] = grid[k].imag();
+		cosSums[k] = grid[k].real();
+	}
+}
+
+/** Trigonometric sums needed for the periodogram at each frequency
+ */
+struct TrigSums {
+	/** Creates an empty set of sums.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	TrigSums() : sinData(), cosData(), sinWeight(), cosWeight(),
+			sin2Weight(), cos2Weight() {
+	}
+
+	/** Creates a set of sums for @p nFreq frequencies, all zero.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	explicit TrigSums(size_t nFreq) : sinData(nFreq), cosData(nFreq),
+			sinWeight(nFreq), cosWeight(nFreq),
+			sin2Weight(nFreq), cos2Weight(nFreq) {
+	}
+
+	/** Makes room for @p nFreq frequencies.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory.
+	 *
+	 * @exceptsafe The sums are in a valid but unspecified state in the
+	 *	event of an exception.
+	 */
+	void resize(size_t nFreq) {
+		sinData   .resize(nFreq);
+		cosData   .resize(nFreq);
+		sinWeight .resize(nFreq);
+		cosWeight .resize(nFreq);
+		sin2Weight.resize(nFreq);
+		cos2Weight.resize(nFreq);
+	}
+
+	/** Sums of weighted data times sin(&omega;t) */
+	std::vector<double> sinData;
+	/** Sums of weighted data times cos(&omega;t) */
+	std::vector<double> cosData;
+	/** Sums of weights times sin(&omega;t) */
+	std::vector<double> sinWeight;
+	/** Sums of weights times cos(&omega;t) */
+	std::vector<double> cosWeight;
+	/** Sums of weights times sin(2&omega;t) */
+	std::vector<double> sin2Weight;
+	/** Sums of weights times cos(2&omega;t) */
+	std::vector<double> cos2Weight;
+};
+
+/** Combines the trigonometric sums into the generalized Lomb-Scargle power
+ *
+ * The terms follow Zechmeister & K&uuml;rster (2009), with the phase
+ * offset &tau; chosen so that the sine and cosine terms are orthogonal.
+ *
+ * @exceptsafe @p power is in a valid but unspecified state in the event
+ *	of an exception.
+ */
+void combine(const TrigSums& sums, double variance, std::vector<double>& power) {
+	const size_t nFreq = sums.sinData.size();
+	power.assign(nFreq, 0.0);
+
+	// A constant light curve has no power anywhere
+	if (variance > 0.0) {
+		for (size_t k = 0; k < nFreq; k++) {
+			const double s  = sums.sinWeight [k], c  = sums.cosWeight [k];
+			const double s2 = sums.sin2Weight[k], c2 = sums.cos2Weight[k];
+			const double sh = sums.sinData   [k], ch = sums.cosData   [k];
+
+			// tan(2 omega tau) = num/den
+			const double num = s2 - 2.0*s*c;
+			const double den = c2 - (c*c - s*s);
+			const double r = std::sqrt(num*num + den*den);
+			const double cos2Tau = (r > 0.0 ? den/r : 1.0);
+			const double sin2Tau = (r > 0.0 ? num/r : 0.0);
+			const double cosTau = std::sqrt(0.5 * (1.0 + cos2Tau));
+			const double sinTau = (sin2Tau < 0.0 ? -1.0 : 1.0)
+				* std::sqrt(0.5 * (1.0 - cos2Tau));
+
+			const double yc = ch*cosTau + sh*sinTau;
+			const double ys = sh*cosTau - ch*sinTau;
+			const double cTau = c*cosTau + s*sinTau;
+			const double sTau = s*cosTau - c*sinTau;
+			const double cc = 0.5 * (1.0 + c2*cos2Tau + s2*sin2Tau) - cTau*cTau;
+			const double ss = 0.5 * (1.0 - c2*cos2Tau - s2*sin2Tau) - sTau*sTau;
+
+			double p = 0.0;
+			if (cc > 0.0) {
+				p += yc*yc / cc;
+			}
+			if (ss > 0.0) {
+				p += ys*ys / ss;
+			}
+			power[k] = p / variance;
+		}
+	}
+}
+
+/** Evaluates all the trigonometric sums for frequencies
+ *	[@p kFirst, @p kLast) of a list, calling sin() and cos() once per
+ *	term
+ *
+ * The sums at twice each frequency are found from the double-angle
+ * formulas.
+ *
+ * @pre @p sums holds at least @p kLast frequencies
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void directShare(const Series& series, const std::vector<double>& freq,
+		size_t kFirst, size_t kLast, TrigSums& sums) {
+	const size_t n = series.times.size();
+	for (size_t k = kFirst; k < kLast; k++) {
+		double sd = 0.0, cd = 0.0, sw = 0.0, cw = 0.0, sw2 = 0.0, cw2 = 0.0;
+		for (size_t j = 0; j < n; j++) {
+			double phase = freq[k] * series.times[j];
+			phase -= std::floor(phase);
+			const double s = std::sin(TWO_PI * phase);
+			const double c = std::cos(TWO_PI * phase);
+			const double w = series.weights[j];
+			sd  += series.weightedData[j] * s;
+			cd  += series.weightedData[j] * c;
+			sw  += w * s;
+			cw  += w * c;
+			sw2 += w * (2.0*s*c);
+			cw2 += w * (c*c - s*s);
+		}
+		sums.sinData   [k] = sd;
+		sums.cosData   [k] = cd;
+		sums.sinWeight [k] = sw;
+		sums.cosWeight [k] = cw;
+		sums.sin2Weight[k] = sw2;
+		sums.cos2Weight[k] = cw2;
+	}
+}
+
+/** Unit complex numbers, one per measurement, stored as separate real
+ *	and imaginary arrays so that loops over them can be vectorized
+ */
+struct Phasors {
+	/** Creates an empty set of phasors.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	Phasors() : re(), im() {
+	}
+
+	/** Creates @p n phasors, all zero.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	explicit Phasors(size_t n) : re(n), im(n) {
+	}
+
+	/** Makes room for @p n phasors.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory.
+	 *
+	 * @exceptsafe The phasors are in a valid but unspecified state in
+	 *	the event of an exception.
+	 */
+	void resize(size_t n) {
+		re.resize(n);
+		im.resize(n);
+	}
+
+	/** Sets each phasor to exp(2&pi;i f t[j]).
+	 *
+	 * @pre @p times.size() equals the number of phasors
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	void anchor(const std::vector<double>& times, double f) {
+		for (size_t j = 0; j < times.size(); j++) {
+			double phase = f * times[j];
+			phase -= std::floor(phase);
+			re[j] = std::cos(TWO_PI * phase);
+			im[j] = std::sin(TWO_PI * phase);
+		}
+	}
+
+	/** Multiplies each phasor by the corresponding phasor in @p step.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	void rotate(const Phasors& step) {
+		for (size_t j = 0; j < re.size(); j++) {
+			const double c = re[j];
+			re[j] = c * step.re[j] - im[j] * step.im[j];
+			im[j] = im[j] * step.re[j] + c * step.im[j];
+		}
+	}
+
+	/** Real parts */
+	std::vector<double> re;
+	/** Imaginary parts */
+	std::vector<double> im;
+};
+
+/** Evaluates all the trigonometric sums for frequencies
+ *	@p fMin + k @p fStep, k in [@p kFirst, @p kLast), by rotating a
+ *	phasor for each measurement
+ *
+ * Moving from one frequency to the next multiplies the phasor
+ * exp(2&pi;i f t[j]) by exp(2&pi;i @p fStep t[j]), so the only trigonometric
+ * calls are made once per measurement every ANCHOR_INTERVAL frequencies,
+ * when the phasors are recomputed exactly to stop roundoff from
+ * accumulating. Between anchors, the error in the phase grows by the
+ * roundoff in @p fStep t[j] at each step; see parallelLombScargle() for
+ * the resulting bound. The sums at twice each frequency are found from the
+ * double-angle formulas.
+ *
+ * The phasors are anchored at multiples of ANCHOR_INTERVAL, so the result
+ * for each frequency does not depend on how the grid was divided.
+ *
+ * @param[in] series The time series to analyze.
+ * @param[in] fMin, fStep The frequency grid.
+ * @param[in] step The phasors exp(2&pi;i @p fStep t[j]).
+ * @param[in,out] work Scratch space for each share.
+ * @param[in] share The index of the scratch space to use.
+ * @param[in] kFirst, kLast The range of frequency indices to evaluate.
+ * @param[out] sums The trigonometric sums for [@p kFirst, @p kLast).
+ *
+ * @pre @p kFirst is a multiple of ANCHOR_INTERVAL
+ * @pre @p sums holds at least @p kLast frequencies
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void rotationShare(const Series& series, double fMin, double fStep, const Phasors& step,
+		std::vector<Phasors>& work, size_t share, size_t kFirst, size_t kLast,
+		TrigSums& sums) {
+	const size_t n = series.times.size();
+	const std::vector<double>& wy = series.weightedData;
+	const std::vector<double>& w  = series.weights;
+	Phasors& phasors = work[share];
+	const std::vector<double>& re = phasors.re;
+	const std::vector<double>& im = phasors.im;
+
+	for (size_t k = kFirst; k < kLast; k++) {
+		if (k % ANCHOR_INTERVAL == 0) {
+			phasors.anchor(series.times, fMin + static_cast<double>(k) * fStep);
+		}
+
+		double sd[LANES], cd[LANES], sw[LANES], cw[LANES], sw2[LANES], cw2[LANES];
+		for (size_t l = 0; l < LANES; l++) {
+			sd[l] = cd[l] = sw[l] = cw[l] = sw2[l] = cw2[l] = 0.0;
+		}
+		size_t j = 0;
+		for (; j + LANES <= n; j += LANES) {
+			for (size_t l = 0; l < LANES; l++) {
+				const double c = re[j+l], s = im[j+l];
+				sd [l] += wy[j+l] * s;
+				cd [l] += wy[j+l] * c;
+				sw [l] += w [j+l] * s;
+				cw [l] += w [j+l] * c;
+				sw2[l] += w [j+l] * (2.0*s*c);
+				cw2[l] += w [j+l] * (c*c - s*s);
+			}
+		}
+		for (size_t l = 0; j < n; j++, l++) {
+			const double c = re[j], s = im[j];
+			sd [l] += wy[j] * s;
+			cd [l] += wy[j] * c;
+			sw [l] += w [j] * s;
+			cw [l] += w [j] * c;
+			sw2[l] += w [j] * (2.0*s*c);
+			cw2[l] += w [j] * (c*c - s*s);
+		}
+
+		double sdTotal = 0.0, cdTotal = 0.0, swTotal = 0.0,
+			cwTotal = 0.0, sw2Total = 0.0, cw2Total = 0.0;
+		for (size_t l = 0; l < LANES; l++) {
+			sdTotal  += sd [l];
+			cdTotal  += cd [l];
+			swTotal  += sw [l];
+			cwTotal  += cw [l];
+			sw2Total += sw2[l];
+			cw2Total += cw2[l];
+		}
+		sums.sinData   [k] = sdTotal;
+		sums.cosData   [k] = cdTotal;
+		sums.sinWeight [k] = swTotal;
+		sums.cosWeight [k] = cwTotal;
+		sums.sin2Weight[k] = sw2Total;
+		sums.cos2Weight[k] = cw2Total;
+
+		phasors.rotate(step);
+	}
+}
+
+/** Decides how many threads to use for a frequency grid
+ *
+ * @param[in] nFreq The number of frequencies.
+ * @param[in] nObs The number of measurements.
+ * @param[in] align The granularity of the shares.
+ * @param[in] nThreads The requested number of threads, or 0 to use one
+ *	per processor.
+ *
+ * @return The number of shares, at least one, such that each share has
+ *	at least one block of @p align frequencies and enough work to be
+ *	worth a thread.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t countShares(size_t nFreq, size_t nObs, size_t align, unsigned int nThreads) {
+	if (nThreads == 0) {
+		nThreads = std::max(1u, boost::thread::hardware_concurrency());
+	}
+	const size_t nBlocks = (nFreq + align - 1) / align;
+	return std::max<size_t>(1, std::min(std::min<size_t>(nThreads, nBlocks),
+		nFreq * nObs / detail::MIN_THREAD_CHUNK));
+}
+
+/** Runs a task over contiguous shares of a frequency grid, one per thread
+ *
+ * Share boundaries fall on multiples of @p align. The first share is
+ * processed by the calling thread.
+ *
+ * @param[in] nFreq The number of frequencies.
+ * @param[in] align The granularity of the shares.
+ * @param[in] nShares The number of shares, as given by countShares().
+ * @param[in] task A function taking the index of a share and its first
+ *	and one-past-last frequency indices. Must not throw.
+ *
+ * @exception boost::thread_resource_error Thrown if a thread could not
+ *	be started.
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	start the threads.
+ *
+ * @exceptsafe All threads are finished in the event of an exception.
+ */
+void splitFrequencies(size_t nFreq, size_t align, size_t nShares,
+		const boost::function<void (size_t, size_t, size_t)>& task) {
+	const size_t nBlocks = (nFreq + align - 1) / align;
+
+	boost::thread_group workers;
+	try {
+		for(size_t i = 1; i < nShares; i++) {
+			const size_t kFirst = std::min(nFreq, i     * nBlocks / nShares * align);
+			const size_t kLast  = std::min(nFreq, (i+1) * nBlocks / nShares * align);
+			workers.create_thread(boost::bind(task, i, kFirst, kLast));
+		}
+		task(0, 0, std::min(nFreq, nBlocks / nShares * align));
+	} catch (...) {
+		workers.join_all();
+		throw;
+	}
+	workers.join_all();
+}
+
+
+}	// end unnamed
+
+/** Scratch memory for FrequencyGrid::periodogram()
+ */
+struct PeriodogramWorkspace::Impl {
+	/** Creates empty scratch memory.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	Impl() : series(), sums(), grid(), step(), work(1), doubleFreq() {
+	}
+
+	Series series;
+	TrigSums sums;
+	/** FFT grid for LS_FAST */
+	std::vector<Complex> grid;
+	/** Rotation phasors for LS_DIRECT */
+	Phasors step;
+	/** Running phasors for LS_DIRECT */
+	std::vector<Phasors> work;
+	/** Doubled frequencies for LS_EXACT */
+	std::vector<double> doubleFreq;
+};
+
+/** Creates an empty workspace.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+PeriodogramWorkspace::PeriodogramWorkspace() : impl(new Impl()) {
+}
+
+/** Releases the scratch memory.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+PeriodogramWorkspace::~PeriodogramWorkspace() {
+}
+
+/** Creates a regular frequency grid.
+ *
+ * @param[in] fMin The lowest frequency, in units of inverse time.
+ * @param[in] fStep The spacing between frequencies.
+ * @param[in] nFreq The number of frequencies.
+ * @param[in] method The algorithm that periodogram() will use.
+ *
+ * @post frequencies()[k] = @p fMin + k@p fStep
+ *
+ * @perform O(M log M) for LS_FAST, or O(M) otherwise, where
+ *	M = @p nFreq.
+ *
+ * @exception std::invalid_argument Thrown if @p fMin or @p fStep is not
+ *	positive, or if @p nFreq is zero.
+ * @exception std::bad_alloc Thrown if there is not enough memory for
+ *	the grid.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+FrequencyGrid::FrequencyGrid(double fMin, double fStep, size_t nFreq, LsMethod method)
+		: lowFreq(fMin), step(fStep), algorithm(method), freq(), twiddles() {
+	if (!(fMin > 0.0) || !(fStep > 0.0) || nFreq == 0) {
+		throw std::invalid_argument("Frequency grid must be positive and nonempty");
+	}
+
+	freq.resize(nFreq);
+	for (size_t k = 0; k < nFreq; k++) {
+		freq[k] = fMin + static_cast<double>(k) * fStep;
+	}
+	if (method == LS_FAST) {
+		fftTwiddles(fftLength(nFreq), twiddles);
+	}
+}
+
+/** Computes the Lomb-Scargle periodogram of a time series on this grid.
+ *
+ * This function gives the same result as
+ * lombScargle(@p times, @p data, @p errors, fMin, fStep, nFreq, freq,
+ * @p power, method()), but does not set up the grid again.
+ *
+ * @param[in] times The times at which @p data were measured.
+ * @param[in] data The measurements to analyze.
+ * @param[in] errors The uncertainties of @p data.
+ * @param[out] power On output, @p power[k] is the periodogram at
+ *	frequencies()[k], between 0 and 1.
+ *
+ * @pre No value in @p times or @p data is NaN
+ *
+ * @post @p power.size() = frequencies().size()
+ *
+ * @perform O(N + M log M) for LS_FAST, or O(NM) otherwise, where
+ *	N = @p times.size() and M = frequencies().size().
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are fewer
+ *	than 3 measurements.
+ * @exception std::invalid_argument Thrown if @p times, @p data, and
+ *	@p errors have different lengths, or if any error is not positive
+ *	and finite.
+ * @exception std::bad_alloc Thrown if there is not enough memory for
+ *	the computation.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an
+ *	exception. This function may be called from several threads at
+ *	once.
+ */
+void FrequencyGrid::periodogram(const std::vector<double>& times,
+		const std::vector<double>& data, const std::vector<double>& errors,
+		std::vector<double>& power) const {
+	PeriodogramWorkspace workspace;
+	std::vector<double> tempPower;
+	periodogram(times, data, errors, tempPower, workspace);
+
+	// IMPORTANT: no exceptions beyond this point
+
+	power.swap(tempPower);
+}
+
+/** Computes the Lomb-Scargle periodogram of a time series on this grid,
+ *	using memory left over from previous calls.
+ *
+ * This function gives the same result as the version without a
+ * workspace. Once @p workspace and @p power have been used for a light
+ * curve of a given length, later calls with light curves no longer than
+ * that do not allocate memory.
+ *
+ * @param[in] times The times at which @p data were measured.
+ * @param[in] data The measurements to analyze.
+ * @param[in] errors The uncertainties of @p data.
+ * @param[out] power On output, @p power[k] is the periodogram at
+ *	frequencies()[k], between 0 and 1.
+ * @param[in,out] workspace Scratch memory for the computation. Its
+ *	contents on input are ignored.
+ *
+ * @pre No value in @p times or @p data is NaN
+ *
+ * @post @p power.size() = frequencies().size()
+ *
+ * @perform O(N + M log M) for LS_FAST, or O(NM) otherwise, where
+ *	N = @p times.size() and M = frequencies().size().
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are fewer
+ *	than 3 measurements.
+ * @exception std::invalid_argument Thrown if @p times, @p data, and
+ *	@p errors have different lengths, or if any error is not positive
+ *	and finite.
+ * @exception std::bad_alloc Thrown if there is not enough memory for
+ *	the computation.
+ *
+ * @exceptsafe @p power and @p workspace are unchanged if the time series
+ *	is invalid, and @p power is in a valid but unspecified state if
+ *	memory runs out. This function may be called from several
+ *	threads at once, if each uses its own @p workspace and @p power.
+ *
+ * @test Light curves of length 60, 30, and 60, one workspace. Expected
+ *	behavior: identical to the version without a workspace.
+ */
+void FrequencyGrid::periodogram(const std::vector<double>& times,
+		const std::vector<double>& data, const std::vector<double>& errors,
+		std::vector<double>& power, PeriodogramWorkspace& workspace) const {
+	PeriodogramWorkspace::Impl& scratch = *workspace.impl;
+	Series& series = scratch.series;
+	prepare(times, data, errors, series);
+	const size_t n = series.times.size();
+	const size_t nFreq = freq.size();
+
+	TrigSums& sums = scratch.sums;
+	sums.resize(nFreq);
+	if (algorithm == LS_FAST) {
+		fastSums(series.times, series.weightedData, lowFreq, step, nFreq, twiddles,
+			scratch.grid, sums.sinData, sums.cosData);
+		fastSums(series.times, series.weights, lowFreq, step, nFreq, twiddles,
+			scratch.grid, sums.sinWeight, sums.cosWeight);
+		fastSums(series.times, series.weights, 2.0*lowFreq, 2.0*step, nFreq, twiddles,
+			scratch.grid, sums.sin2Weight, sums.cos2Weight);
+	} else if (algorithm == LS_DIRECT) {
+		scratch.step.resize(n);
+		scratch.step.anchor(series.times, step);
+		scratch.work[0].resize(n);
+		rotationShare(series, lowFreq, step, scratch.step, scratch.work, 0, 0, nFreq, sums);
+	} else {
+		scratch.doubleFreq.resize(nFreq);
+		for (size_t k = 0; k < nFreq; k++) {
+			scratch.doubleFreq[k] = 2.0 * freq[k];
+		}
+		directSums(series.times, series.weightedData, freq,
+			sums.sinData, sums.cosData);
+		directSums(series.times, series.weights, freq,
+			sums.sinWeight, sums.cosWeight);
+		directSums(series.times, series.weights, scratch.doubleFreq,
+			sums.sin2Weight, sums.cos2Weight);
+	}
+
+	combine(sums, series.variance, power);
+}
+
+/** Computes the Lomb-Scargle periodogram of a time series on a regular
+ *	frequency grid.
+ *
+ * The periodogram is the generalized, error-weighted form of
+ * Zechmeister & K&uuml;rster (2009), which allows for a mean that differs
+ * from the weighted mean of the data.
+ *
+ * @param[in] times The times at which @p data were measured.
+ * @param[in] data The measurements to analyze.
+ * @param[in] errors The uncertainties of @p data.
+ * @param[in] fMin The lowest frequency to test, in units of inverse @p times.
+ * @param[in] fStep The spacing between test frequencies.
+ * @param[in] nFreq The number of frequencies to test.
+ * @param[out] freq On output, @p freq[k] = @p fMin + k@p fStep.
+ * @param[out] power On output, @p power[k] is the periodogram at
+ *	@p freq[k], between 0 and 1.
+ * @param[in] method The algorithm used to compute the trigonometric sums.
+ *	LS_FAST is accurate to a few parts in 10<sup>4</sup> in the power,
+ *	which is adequate for peak finding; LS_DIRECT is accurate to
+ *	roundoff error, as described for parallelLombScargle(); LS_EXACT
+ *	is intended for validation.
+ *
+ * @pre No value in @p times or @p data is NaN
+ * @pre @p times need not be sorted
+ *
+ * @post @p freq.size() = @p power.size() = @p nFreq
+ * @post If all values in @p data are equal, @p power is zero everywhere.
+ *
+ * @perform O(N + M log M) for LS_FAST, or O(NM) for LS_DIRECT and
+ *	LS_EXACT, where N = @p times.size() and M = @p nFreq.
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are fewer
+ *	than 3 measurements.
+ * @exception std::invalid_argument Thrown if @p times, @p data, and
+ *	@p errors have different lengths, if any error is not positive and
+ *	finite, if @p fMin or @p fStep is not positive, or if @p nFreq is
+ *	zero.
+ * @exception std::bad_alloc Thrown if there is not enough memory for
+ *	the computation.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an
+ *	exception.
+ *
+ * @test Unevenly sampled sinusoid with noise and unequal errors,
+ *	LS_FAST and LS_EXACT. Expected behavior: the two agree to within
+ *	1e-3, and both peak at the input frequency.
+ * @test Constant data. Expected behavior: power is zero everywhere.
+ * @test Mismatched lengths, zero errors, nonpositive frequencies, or
+ *	fewer than 3 points. Expected behavior: throw invalid_argument or
+ *	NotEnoughData.
+ */
+void lombScargle(const std::vector<double>& times, const std::vector<double>& data,
+		const std::vector<double>& errors, double fMin, double fStep, size_t nFreq,
+		std::vector<double>& freq, std::vector<double>& power, LsMethod method) {
+	const FrequencyGrid grid(fMin, fStep, nFreq, method);
+	std::vector<double> tempFreq(grid.frequencies());
+	std::vector<double> tempPower;
+	grid.periodogram(times, data, errors, tempPower);
+
+	// IMPORTANT: no exceptions beyond this point
+
+	freq.swap(tempFreq);
+	power.swap(tempPower);
+}
+
+/** Computes the Lomb-Scargle periodogram of a time series at arbitrary
+ *	frequencies.
+ *
+ * The trigonometric sums are evaluated directly, so this version is
+ * suited to short or irregular frequency lists, such as refining a peak
+ * found on a regular grid.
+ *
+ * @param[in] times The times at which @p data were measured.
+ * @param[in] data The measurements to analyze.
+ * @param[in] errors The uncertainties of @p data.
+ * @param[in] freq The frequencies to test, in units of inverse @p times.
+ * @param[out] power On output, @p power[k] is the periodogram at
+ *	@p freq[k], between 0 and 1.
+ *
+ * @pre No value in @p times or @p data is NaN
+ *
+ * @post @p power.size() = @p freq.size()
+ *
+ * @perform O(NM), where N = @p times.size() and M = @p freq.size().
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are fewer
+ *	than 3 measurements.
+ * @exception std::invalid_argument Thrown if @p times, @p data, and
+ *	@p errors have different lengths, if any error is not positive and
+ *	finite, or if any frequency is not positive.
+ * @exception std::bad_alloc Thrown if there is not enough memory for
+ *	the computation.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an
+ *	exception.
+ *
+ * @test Unevenly sampled sinusoid, frequencies from the regular grid.
+ *	Expected behavior: agrees with the LS_EXACT grid to within 1e-10.
+ */
+void lombScargle(const std::vector<double>& times, const std::vector<double>& data,
+		const std::vector<double>& errors, const std::vector<double>& freq,
+		std::vector<double>& power) {
+	std::vector<double> doubleFreq(freq.size());
+	for (size_t k = 0; k < freq.size(); k++) {
+		if (!(freq[k] > 0.0)) {
+			throw std::invalid_argument("Frequencies must be positive in lombScargle()");
+		}
+		doubleFreq[k] = 2.0 * freq[k];
+	}
+	Series series;
+	prepare(times, data, errors, series);
+
+	TrigSums sums;
+	directSums(series.times, series.weightedData, freq, sums.sinData, sums.cosData);
+	directSums(series.times, series.weights, freq, sums.sinWeight, sums.cosWeight);
+	directSums(series.times, series.weights, doubleFreq, sums.sin2Weight, sums.cos2Weight);
+
+	std::vector<double> tempPower;
+	combine(sums, series.variance, tempPower);
+
+	// IMPORTANT: no exceptions beyond this point
+
+	power.swap(tempPower);
+}
+
+/** Computes the Lomb-Scargle periodogram of a time series on a regular
+ *	frequency grid, using several threads.
+ *
+ * The trigonometric sums are evaluated directly, without the
+ * approximations of LS_FAST, but each thread steps through its share of
+ * the grid by rotating a phasor for each measurement rather than calling
+ * sin() and cos() for every term. The phasors are recomputed exactly
+ * every 32 frequencies.
+ *
+ * The result differs from LS_EXACT in two ways. First, each rotation
+ * adds a relative error of at most about 3.3&epsilon;, where &epsilon;
+ * is the machine epsilon, which contributes at most
+ * 2.5 &times; 10<sup>-14</sup> to each term. Second, the phases are
+ * rounded differently: LS_EXACT rounds each frequency and the product
+ * f t, while the rotation adds up to 31 rounded steps @p fStep t to an
+ * anchor phase. The two phases can differ by up to about
+ * 2&pi;&epsilon;(f + 16 @p fStep)D radians, where D is the time spanned
+ * by @p times, and twice that for the sums at 2f. Every trigonometric
+ * sum therefore differs from the LS_EXACT sum by less than
+ * [2.5 &times; 10<sup>-14</sup> + 4&pi;&epsilon;(f + 16 @p fStep)D]
+ * times the sum of the absolute values of its coefficients. Since the
+ * weights sum to one, this bound is absolute for the weight sums, and
+ * for the data sums it is relative to the weighted standard deviation
+ * of @p data. The second term dominates for long baselines; neither
+ * version is more accurate than the other.
+ *
+ * @param[in] times The times at which @p data were measured.
+ * @param[in] data The measurements to analyze.
+ * @param[in] errors The uncertainties of @p data.
+ * @param[in] fMin The lowest frequency to test, in units of inverse @p times.
+ * @param[in] fStep The spacing between test frequencies.
+ * @param[in] nFreq The number of frequencies to test.
+ * @param[out] freq On output, @p freq[k] = @p fMin + k@p fStep.
+ * @param[out] power On output, @p power[k] is the periodogram at
+ *	@p freq[k], between 0 and 1.
+ * @param[in] nThreads The number of threads to use, or 0 to use one per
+ *	processor. Fewer threads are used if the grid is too small to
+ *	divide profitably.
+ *
+ * @pre No value in @p times or @p data is NaN
+ *
+ * @post @p freq.size() = @p power.size() = @p nFreq
+ * @post The result does not depend on @p nThreads.
+ *
+ * @perform O(NM/T), where N = @p times.size(), M = @p nFreq, and
+ *	T is the number of threads.
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are fewer
+ *	than 3 measurements.
+ * @exception std::invalid_argument Thrown if @p times, @p data, and
+ *	@p errors have different lengths, if any error is not positive and
+ *	finite, if @p fMin or @p fStep is not positive, or if @p nFreq is
+ *	zero.
+ * @exception std::bad_alloc Thrown if there is not enough memory for
+ *	the computation.
+ * @exception boost::thread_resource_error Thrown if a thread could not
+ *	be started.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an
+ *	exception.
+ *
+ * @test Unevenly sampled sinusoid with noise, 1000 frequencies, 1, 3, or
+ *	8 threads. Expected behavior: agrees with LS_EXACT to within 1e-10,
+ *	and identical for all thread counts.
+ * @test Sinusoid sampled over 30000 days, frequencies up to 2 per day.
+ *	Expected behavior: agrees with LS_EXACT to within the bound on
+ *	the phase error.
+ */
+void parallelLombScargle(const std::vector<double>& times, const std::vector<double>& data,
+		const std::vector<double>& errors, double fMin, double fStep, size_t nFreq,
+		std::vector<double>& freq, std::vector<double>& power, unsigned int nThreads) {
+	if (!(fMin > 0.0) || !(fStep > 0.0) || nFreq == 0) {
+		throw std::invalid_argument("Frequency grid must be positive and nonempty in parallelLombScargle()");
+	}
+	Series series;
+	prepare(times, data, errors, series);
+	const size_t n = series.times.size();
+
+	std::vector<double> tempFreq(nFreq);
+	for (size_t k = 0; k < nFreq; k++) {
+		tempFreq[k] = fMin + static_cast<double>(k) * fStep;
+	}
+
+	TrigSums sums(nFreq);
+	Phasors step(n);
+	step.anchor(series.times, fStep);
+	const size_t nShares = countShares(nFreq, n, ANCHOR_INTERVAL, nThreads);
+	std::vector<Phasors> work(nShares, Phasors(n));
+	splitFrequencies(nFreq, ANCHOR_INTERVAL, nShares, boost::bind(&rotationShare,
+		boost::cref(series), fMin, fStep, boost::cref(step), boost::ref(work),
+		boost::placeholders::_1, boost::placeholders::_2, boost::placeholders::_3, 
+		boost::ref(sums)));
+
+	std::vector<double> tempPower;
+	combine(sums, series.variance, tempPower);
+
+	// IMPORTANT: no exceptions beyond this point
+
+	freq.swap(tempFreq);
+	power.swap(tempPower);
+}
+
+/** Computes the Lomb-Scargle periodogram of a time series at arbitrary
+ *	frequencies, using several threads.
+ *
+ * The frequencies are divided among the threads, and the trigonometric
+ * sums are evaluated directly. The sums at twice each frequency come
+ * from the double-angle formulas, so this version makes half as many
+ * calls to sin() and cos() as lombScargle(), and agrees with it to
+ * within roundoff error.
+ *
+ * @param[in] times The times at which @p data were measured.
+ * @param[in] data The measurements to analyze.
+ * @param[in] errors The uncertainties of @p data.
+ * @param[in] freq The frequencies to test, in units of inverse @p times.
+ * @param[out] power On output, @p power[k] is the periodogram at
+ *	@p freq[k], between 0 and 1.
+ * @param[in] nThreads The number of threads to use, or 0 to use one per
+ *	processor. Fewer threads are used if there are too few
+ *	frequencies to divide profitably.
+ *
+ * @pre No value in @p times or @p data is NaN
+ *
+ * @post @p power.size() = @p freq.size()
+ * @post The result does not depend on @p nThreads.
+ *
+ * @perform O(NM/T), where N = @p times.size(), M = @p freq.size(), and
+ *	T is the number of threads.
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are fewer
+ *	than 3 measurements.
+ * @exception std::invalid_argument Thrown if @p times, @p data, and
+ *	@p errors have different lengths, if any error is not positive and
+ *	finite, or if any frequency is not positive.
+ * @exception std::bad_alloc Thrown if there is not enough memory for
+ *	the computation.
+ * @exception boost::thread_resource_error Thrown if a thread could not
+ *	be started.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an
+ *	exception.
+ *
+ * @test Unevenly sampled sinusoid, frequencies from the regular grid,
+ *	4 threads. Expected behavior: agrees with lombScargle() to within
+ *	1e-10.
+ */
+void parallelLombScargle(const std::vector<double>& times, const std::vector<double>& data,
+		const std::vector<double>& errors, const std::vector<double>& freq,
+		std::vector<double>& power, unsigned int nThreads) {
+	for (size_t k = 0; k < freq.size(); k++) {
+		if (!(freq[k] > 0.0)) {
+			throw std::invalid_argument("Frequencies must be positive in parallelLombScargle()");
+		}
+	}
+	Series series;
+	prepare(times, data, errors, series);
+
+	TrigSums sums(freq.size());
+	splitFrequencies(freq.size(), 1, countShares(freq.size(), series.times.size(), 1, nThreads),
+		boost::bind(&directShare, boost::cref(series), boost::cref(freq), 
+		boost::placeholders::_2, boost::placeholders::_3, boost::ref(sums)));
+
+	std::vector<double> tempPower;
+	combine(sums, series.variance, tempPower);
+
+	// IMPORTANT: no exceptions beyond this point
+
+	power.swap(tempPower);
+}
+
+}	// end kpfutils
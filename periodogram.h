@@ -0,0 +1,307 @@
+/** Lomb-Scargle periodograms of unevenly sampled time series
+ * @file common/periodogram.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#ifndef KPFUTILSPERIODOGRAMH
+#define KPFUTILSPERIODOGRAMH
+
+#include <complex>
+#include <string>
+#include <vector>
+#include <boost/function.hpp>
+#include <boost/scoped_ptr.hpp>
+
+namespace kpfutils {
+
+/** @addtogroup stats
+ *
+ * Include periodogram.h to search a light curve for periodic signals.
+ *
+ * The periodograms are the generalized, error-weighted Lomb-Scargle
+ * periodogram of Zechmeister & K&uuml;rster (2009), which fits a sinusoid
+ * plus a constant at each trial frequency. The power is the fraction of the
+ * weighted variance removed by the fit, so it lies between 0 and 1. The
+ * output can be passed directly to printPeriodogram().
+ *
+ * lombScargle() runs in a single thread. The parallelLombScargle()
+ * functions, which divide one periodogram among threads, and
+ * batchLombScargle(), which divides many light curves among threads,
+ * require Boost.Thread. So do bootstrapFap() and bootstrapPeaks(), which
+ * assess the significance of periodogram peaks by resampling the light
+ * curve, and also require Boost.Random. findPeaks() and refinePeaks()
+ * pick out the strongest peaks of a periodogram and locate them
+ * precisely.
+ *
+ * @{
+ */
+
+/** Algorithms for computing a periodogram on a regular frequency grid
+ */
+enum LsMethod {
+	/** Press & Rybicki (1989) extirpolation onto a regular grid, followed
+	 *	by a fast Fourier transform. Takes O(N + M log M) time for N
+	 *	measurements and M frequencies. */
+	LS_FAST,
+	/** Direct evaluation of the trigonometric sums. Takes O(NM) time,
+	 *	and is exact to within roundoff error. */
+	LS_EXACT,
+	/** Direct sums, stepping from one frequency to the next by phasor
+	 *	rotation as in parallelLombScargle(). Takes O(NM) time, with
+	 *	far fewer trigonometric calls than LS_EXACT. */
+	LS_DIRECT
+};
+
+/** Scratch memory for computing periodograms.
+ *
+ * Passing the same workspace to FrequencyGrid::periodogram() for many
+ * light curves lets it reuse its internal arrays instead of allocating
+ * them for each light curve. A workspace must not be used by two threads
+ * at once.
+ */
+class PeriodogramWorkspace {
+public:
+	/** Creates an empty workspace.
+	 */
+	PeriodogramWorkspace();
+
+	/** Releases the scratch memory.
+	 */
+	~PeriodogramWorkspace();
+
+private:
+	// Workspaces hold only scratch memory, so there is no reason to copy them
+	PeriodogramWorkspace(const PeriodogramWorkspace&);
+	PeriodogramWorkspace& operator=(const PeriodogramWorkspace&);
+
+	friend class FrequencyGrid;
+	struct Impl;
+	boost::scoped_ptr<Impl> impl;
+};
+
+/** A regular frequency grid, with any tables needed to compute
+ *	periodograms on it.
+ *
+ * Building a FrequencyGrid once and calling periodogram() for each light
+ * curve avoids recomputing the grid and, for LS_FAST, the FFT twiddle
+ * factors. A FrequencyGrid is never modified after construction, so it
+ * may be shared among threads.
+ */
+class FrequencyGrid {
+public:
+	/** Creates a regular frequency grid.
+	 */
+	FrequencyGrid(double fMin, double fStep, size_t nFreq, LsMethod method = LS_FAST);
+
+	/** Returns the frequencies in the grid, in ascending order.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	const std::vector<double>& frequencies() const {
+		return freq;
+	}
+
+	/** Returns the algorithm used by periodogram().
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	LsMethod method() const {
+		return algorithm;
+	}
+
+	/** Computes the Lomb-Scargle periodogram of a time series on this grid.
+	 */
+	void periodogram(const std::vector<double>& times, const std::vector<double>& data,
+		const std::vector<double>& errors, std::vector<double>& power) const;
+
+	/** Computes the Lomb-Scargle periodogram of a time series on this grid,
+	 *	using memory left over from previous calls.
+	 */
+	void periodogram(const std::vector<double>& times, const std::vector<double>& data,
+		const std::vector<double>& errors, std::vector<double>& power,
+		PeriodogramWorkspace& workspace) const;
+
+private:
+	double lowFreq;
+	double step;
+	LsMethod algorithm;
+	std::vector<double> freq;
+	/** FFT twiddle factors, used only by LS_FAST
+	 */
+	std::vector<std::complex<double> > twiddles;
+};
+
+/** Computes the Lomb-Scargle periodogram of a time series on a regular
+ *	frequency grid.
+ */
+void lombScargle(const std::vector<double>& times, const std::vector<double>& data,
+	const std::vector<double>& errors, double fMin, double fStep, size_t nFreq,
+	std::vector<double>& freq, std::vector<double>& power, LsMethod method = LS_FAST);
+
+/** Computes the Lomb-Scargle periodogram of a time series at arbitrary
+ *	frequencies.
+ */
+void lombScargle(const std::vector<double>& times, const std::vector<double>& data,
+	const std::vector<double>& errors, const std::vector<double>& freq,
+	std::vector<double>& power);
+
+/** Computes the Lomb-Scargle periodogram of a time series on a regular
+ *	frequency grid by direct summation, using several threads.
+ */
+void parallelLombScargle(const std::vector<double>& times, const std::vector<double>& data,
+	const std::vector<double>& errors, double fMin, double fStep, size_t nFreq,
+	std::vector<double>& freq, std::vector<double>& power, unsigned int nThreads = 0);
+
+/** Computes the Lomb-Scargle periodogram of a time series at arbitrary
+ *	frequencies, using several threads.
+ */
+void parallelLombScargle(const std::vector<double>& times, const std::vector<double>& data,
+	const std::vector<double>& errors, const std::vector<double>& freq,
+	std::vector<double>& power, unsigned int nThreads = 0);
+
+/** Function that loads the light curve with a given index into the
+ *	times, data, and errors vectors. Used by batchLombScargle().
+ *
+ * The function is called from worker threads, possibly for several light
+ * curves at once, and must be safe to call that way. It may throw
+ * exceptions.
+ */
+typedef boost::function<void (size_t, std::vector<double>&, std::vector<double>&,
+	std::vector<double>&)> LightCurveSource;
+
+/** Function that receives the frequencies and power of the periodogram
+ *	of the light curve with a given index. Used by batchLombScargle().
+ *
+ * The function is called from the thread that called batchLombScargle(),
+ * once for each light curve, in order. It may throw exceptions.
+ */
+typedef boost::function<void (size_t, const std::vector<double>&,
+	const std::vector<double>&)> PeriodogramSink;
+
+/** Computes the periodograms of many light curves on a common grid,
+ *	dividing the light curves among threads.
+ */
+void batchLombScargle(const FrequencyGrid& grid, size_t nCurves,
+	const LightCurveSource& source, const PeriodogramSink& sink,
+	unsigned int nThreads = 0);
+
+/** Computes the periodograms of many light curves on a common grid,
+ *	dividing the light curves among threads.
+ */
+void batchLombScargle(const FrequencyGrid& grid,
+	const std::vector<std::vector<double> >& times,
+	const std::vector<std::vector<double> >& data,
+	const std::vector<std::vector<double> >& errors,
+	std::vector<std::vector<double> >& power, unsigned int nThreads = 0);
+
+/** Ways to resample a light curve when estimating false alarm
+ *	probabilities
+ */
+enum ResampleMethod {
+	/** Shuffle the measurements among the observation times. */
+	RESAMPLE_PERMUTE,
+	/** Draw measurements with replacement. */
+	RESAMPLE_BOOTSTRAP
+};
+
+/** A false alarm probability estimated by resampling
+ */
+struct FapEstimate {
+	/** The fraction of resamples whose highest peak reached the threshold */
+	double fap;
+	/** The lower bound of the 95% confidence interval on fap */
+	double lower;
+	/** The upper bound of the 95% confidence interval on fap */
+	double upper;
+	/** The number of resamples computed */
+	size_t resamples;
+	/** The number of resamples whose highest peak reached the threshold */
+	size_t exceedances;
+};
+
+/** Estimates the false alarm probability of a periodogram peak by
+ *	resampling the light curve.
+ */
+FapEstimate bootstrapFap(const FrequencyGrid& grid, const std::vector<double>& times,
+	const std::vector<double>& data, const std::vector<double>& errors,
+	double threshold, size_t maxResamples, double tolerance = 0.0,
+	ResampleMethod method = RESAMPLE_PERMUTE, unsigned long seed = 0,
+	unsigned int nThreads = 0);
+
+/** Finds the highest periodogram peak of each of many resampled light
+ *	curves.
+ */
+void bootstrapPeaks(const FrequencyGrid& grid, const std::vector<double>& times,
+	const std::vector<double>& data, const std::vector<double>& errors,
+	size_t nResamples, std::vector<double>& peaks,
+	ResampleMethod method = RESAMPLE_PERMUTE, unsigned long seed = 0,
+	unsigned int nThreads = 0);
+
+/** A peak in a periodogram
+ */
+struct Peak {
+	/** The frequency of the peak */
+	double frequency;
+	/** The periodogram power at the peak */
+	double power;
+	/** The index of the peak in the original periodogram */
+	size_t index;
+};
+
+/** Finds the strongest peaks in a periodogram.
+ */
+void findPeaks(const std::vector<double>& freq, const std::vector<double>& power,
+	size_t nPeaks, std::vector<Peak>& peaks, double window = 0.0,
+	const std::vector<double>& aliases = std::vector<double>(),
+	unsigned int maxHarmonic = 0);
+
+/** Refines the frequencies and powers of periodogram peaks.
+ */
+void refinePeaks(const std::vector<double>& times, const std::vector<double>& data,
+	const std::vector<double>& errors, double halfWidth, size_t nPoints,
+	std::vector<Peak>& peaks);
+
+/** A PeriodogramSink that writes each periodogram to its own file with
+ *	printPeriodogram().
+ */
+class PeriodogramPrinter {
+public:
+	/** Prepares to write a batch of periodograms.
+	 *
+	 * @param[in] fileNames The file to which to write each periodogram.
+	 *	The list must not be modified or destroyed while the
+	 *	PeriodogramPrinter is in use.
+	 * @param[in] threshold, fap The significance threshold and false
+	 *	alarm probability to write in each file's header.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	PeriodogramPrinter(const std::vector<std::string>& fileNames, double threshold,
+			double fap) : fileNames(fileNames), threshold(threshold), fap(fap) {
+	}
+
+	/** Writes one periodogram.
+	 */
+	void operator()(size_t index, const std::vector<double>& freq,
+		const std::vector<double>& power) const;
+
+private:
+	const std::vector<std::string>& fileNames;
+	double threshold;
+	double fap;
+};
+
+/** @} */	// end stats
+
+}	// end kpfutils
+
+#endif		// KPFUTILSPERIODOGRAMH
@@ -0,0 +1,510 @@
+/** Lomb-Scargle periodograms of many light curves
+ * @file common/periodogram_batch.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <boost/bind/bind.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/ref.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread.hpp>
+#include "fileio.h"
+#include "lcio.h"
+#include "periodogram.h"
+#include "stats_except.h"
+
+namespace kpfutils {
+
+namespace {
+
+/** Number of finished periodograms each worker may get ahead of the
+ *	calling thread
+ */
+const size_t WINDOW_PER_THREAD = 2;
+
+/** Ways in which one light curve in a batch can fail
+ */
+enum Failure {
+	NO_FAILURE,
+	FAIL_NOT_ENOUGH_DATA,
+	FAIL_INVALID_ARGUMENT,
+	FAIL_FILE_IO,
+	FAIL_BAD_ALLOC,
+	FAIL_OTHER
+};
+
+/** The result of processing one light curve
+ */
+struct Outcome {
+	/** Creates an empty result.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	Outcome() : ready(false), failure(NO_FAILURE), message(), power() {
+	}
+
+	/** Exchanges the contents of two results.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	void swap(Outcome& other) {
+		std::swap(ready, other.ready);
+		std::swap(failure, other.failure);
+		message.swap(other.message);
+		power.swap(other.power);
+	}
+
+	/** Set once the light curve has been processed */
+	bool ready;
+	/** The reason the light curve could not be processed, if any */
+	Failure failure;
+	/** The description of the failure */
+	std::string message;
+	/** The periodogram, if there was no failure */
+	std::vector<double> power;
+};
+
+/** Records why a light curve could not be processed
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void recordFailure(Outcome& result, Failure failure, const char* what) {
+	result.failure = failure;
+	try {
+		result.message = what;
+	} catch (const std::bad_alloc&) {
+		result.failure = FAIL_BAD_ALLOC;
+	}
+}
+
+/** Loads one light curve and computes its periodogram
+ *
+ * Any exception is recorded in @p result rather than thrown, so that it
+ * can be passed back to the calling thread.
+ *
+ * @param[in,out] workspace Scratch memory to reuse from the previous light
+ *	curve, or NULL to allocate new scratch memory.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void processCurve(const FrequencyGrid& grid, const LightCurveSource& source,
+		size_t index, PeriodogramWorkspace* workspace, Outcome& result) {
+	try {
+		std::vector<double> times, data, errors;
+		source(index, times, data, errors);
+		if (workspace != NULL) {
+			grid.periodogram(times, data, errors, result.power, *workspace);
+		} else {
+			grid.periodogram(times, data, errors, result.power);
+		}
+		result.failure = NO_FAILURE;
+	} catch (const except::NotEnoughData& e) {
+		recordFailure(result, FAIL_NOT_ENOUGH_DATA, e.what());
+	} catch (const std::invalid_argument& e) {
+		recordFailure(result, FAIL_INVALID_ARGUMENT, e.what());
+	} catch (const except::FileIo& e) {
+		recordFailure(result, FAIL_FILE_IO, e.what());
+	} catch (const std::bad_alloc&) {
+		result.failure = FAIL_BAD_ALLOC;
+	} catch (const std::exception& e) {
+		recordFailure(result, FAIL_OTHER, e.what());
+	} catch (...) {
+		recordFailure(result, FAIL_OTHER, "Unknown error");
+	}
+	result.ready = true;
+}
+
+/** Throws the exception recorded for a light curve, naming the light curve
+ *
+ * @pre @p result.failure &ne; NO_FAILURE
+ *
+ * @exception kpfutils::except::NotEnoughData, std::invalid_argument,
+ *	kpfutils::except::FileIo, std::bad_alloc, std::runtime_error
+ *	Thrown according to @p result.failure.
+ */
+void rethrow(size_t index, const Outcome& result) {
+	if (result.failure == FAIL_BAD_ALLOC) {
+		throw std::bad_alloc();
+	}
+
+	const std::string message = "Light curve " + boost::lexical_cast<std::string>(index)
+		+ ": " + result.message;
+	switch (result.failure) {
+	case FAIL_NOT_ENOUGH_DATA:
+		throw except::NotEnoughData(message);
+	case FAIL_INVALID_ARGUMENT:
+		throw std::invalid_argument(message);
+	case FAIL_FILE_IO:
+		throw except::FileIo(message);
+	default:
+		throw std::runtime_error(message);
+	}
+}
+
+/** State shared by the worker threads and the calling thread
+ *
+ * Workers claim light curves in order, and leave each result in the slot
+ * numbered index % slots.size(). A worker may not claim a light curve
+ * until the result previously held by its slot has been passed to the
+ * sink, which bounds the memory used by results waiting to be written.
+ */
+struct BatchState {
+	/** Prepares to process a batch.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory
+	 *	for the slots.
+	 * @exception boost::thread_resource_error Thrown if the
+	 *	synchronization objects could not be created.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	BatchState(const FrequencyGrid& grid, size_t nCurves, const LightCurveSource& source,
+			size_t nSlots) : grid(grid), nCurves(nCurves), source(source),
+			mutex(), changed(), next(0), emitted(0), stop(false), slots(nSlots) {
+	}
+
+	const FrequencyGrid& grid;
+	const size_t nCurves;
+	const LightCurveSource& source;
+
+	/** Guards all members below */
+	boost::mutex mutex;
+	/** Signaled whenever a result is ready or a slot is freed */
+	boost::condition_variable changed;
+	/** The index of the next light curve to claim */
+	size_t next;
+	/** The number of results passed to the sink */
+	size_t emitted;
+	/** Set if the batch has been abandoned */
+	bool stop;
+	std::vector<Outcome> slots;
+};
+
+/** Processes light curves until there are none left or the batch is
+ *	abandoned
+ *
+ * Each worker keeps one PeriodogramWorkspace for all the light curves it
+ * processes.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void batchWorker(BatchState& state) {
+	boost::scoped_ptr<PeriodogramWorkspace> workspace;
+	try {
+		workspace.reset(new PeriodogramWorkspace());
+	} catch (const std::bad_alloc&) {
+		// Allocate scratch memory per light curve instead; any further 
+		//	shortage is reported for the light curve that hit it
+	}
+
+	for(;;) {
+		size_t index;
+		{
+			boost::unique_lock<boost::mutex> lock(state.mutex);
+			while (!state.stop && state.next < state.nCurves
+					&& state.next >= state.emitted + state.slots.size()) {
+				state.changed.wait(lock);
+			}
+			if (state.stop || state.next >= state.nCurves) {
+				return;
+			}
+			index = state.next++;
+		}
+
+		Outcome result;
+		processCurve(state.grid, state.source, index, workspace.get(), result);
+
+		{
+			boost::lock_guard<boost::mutex> lock(state.mutex);
+			state.slots[index % state.slots.size()].swap(result);
+		}
+		state.changed.notify_all();
+	}
+}
+
+/** Adapts in-memory light curves to a LightCurveSource
+ */
+class VectorSource {
+public:
+	/** Wraps a set of light curves, which must outlive this object.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	VectorSource(const std::vector<std::vector<double> >& times,
+			const std::vector<std::vector<double> >& data,
+			const std::vector<std::vector<double> >& errors)
+			: times(times), data(data), errors(errors) {
+	}
+
+	/** Copies the ith light curve.
+	 *
+	 * @exceptsafe The arguments are in a valid but unspecified state in
+	 *	the event of an exception.
+	 */
+	void operator()(size_t i, std::vector<double>& timeOut, std::vector<double>& dataOut,
+			std::vector<double>& errorOut) const {
+		timeOut  = times[i];
+		dataOut  = data[i];
+		errorOut = errors[i];
+	}
+
+private:
+	const std::vector<std::vector<double> >& times;
+	const std::vector<std::vector<double> >& data;
+	const std::vector<std::vector<double> >& errors;
+};
+
+/** Adapts a vector of periodograms to a PeriodogramSink
+ */
+class VectorSink {
+public:
+	/** Wraps a vector with room for every periodogram, which must
+	 *	outlive this object.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	explicit VectorSink(std::vector<std::vector<double> >& power) : power(power) {
+	}
+
+	/** Stores the ith periodogram.
+	 *
+	 * @exceptsafe The stored periodograms are in a valid but unspecified
+	 *	state in the event of an exception.
+	 */
+	void operator()(size_t i, const std::vector<double>&, const std::vector<double>& result) const {
+		power[i] = result;
+	}
+
+private:
+	std::vector<std::vector<double> >& power;
+};
+
+}	// end unnamed
+
+/** Computes the periodograms of many light curves on a common grid,
+ *	dividing the light curves among threads.
+ *
+ * Each worker thread loads a light curve with @p source, computes its
+ * periodogram with @p grid.periodogram(), and starts on the next light
+ * curve. The calling thread passes the finished periodograms to @p sink
+ * in order, so @p sink need not be thread-safe, and may write files with
+ * printPeriodogram() or a PeriodogramPrinter. Workers may run at most a
+ * few light curves ahead of @p sink, so memory use does not depend on
+ * the number of light curves.
+ *
+ * For example, to analyze the light curves named in a file list and
+ * write each periodogram to its own file:
+ * @code
+ * FileNameList inputs;
+ * readFileNames("lightcurves.txt", inputs);
+ * std::vector<std::string> outputs = ...;
+ * batchLombScargle(FrequencyGrid(0.01, 1e-4, 100000), inputs.size(),
+ * 	MyReader(inputs), PeriodogramPrinter(outputs, threshold, fap));
+ * @endcode
+ * where @c MyReader calls readWgLightCurve() on the ith file name.
+ *
+ * @param[in] grid The frequency grid and algorithm to use for every
+ *	light curve.
+ * @param[in] nCurves The number of light curves.
+ * @param[in] source A function that loads the ith light curve, for i
+ *	in [0, @p nCurves).
+ * @param[in] sink A function that receives the ith periodogram.
+ * @param[in] nThreads The number of worker threads, or 0 to use one per
+ *	processor. If 1, or if there is only one light curve, all work is
+ *	done in the calling thread.
+ *
+ * @post @p sink has been called once for each light curve, in order.
+ * @post The periodograms do not depend on @p nThreads.
+ *
+ * @perform O(P/T), where P is the time needed to load and analyze every
+ *	light curve and T is the number of threads, if @p sink is fast
+ *	compared to the other steps.
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if any light curve
+ *	has fewer than 3 measurements.
+ * @exception std::invalid_argument Thrown if any light curve is invalid
+ *	as described for FrequencyGrid::periodogram().
+ * @exception kpfutils::except::FileIo Thrown if @p source throws it.
+ * @exception std::runtime_error Thrown if @p source throws any other
+ *	exception.
+ * @exception std::bad_alloc Thrown if there is not enough memory for
+ *	the computation.
+ * @exception boost::thread_resource_error Thrown if a thread could not
+ *	be started.
+ *
+ * Exceptions from @p source and from the periodogram are rethrown with
+ * the index of the offending light curve added to the message. Any
+ * exception thrown by @p sink is passed through unchanged.
+ *
+ * @exceptsafe If an exception is thrown, @p sink has been called for
+ *	every light curve before the one that failed, and for no others.
+ *	All threads are finished.
+ *
+ * @test Five light curves of different lengths, 1 or 3 threads. Expected
+ *	behavior: identical to FrequencyGrid::periodogram() on each light
+ *	curve, delivered in order.
+ * @test Twenty light curves, the 12th of length 2, 4 threads. Expected
+ *	behavior: sink called for the first 11, then throw NotEnoughData.
+ */
+void batchLombScargle(const FrequencyGrid& grid, size_t nCurves,
+		const LightCurveSource& source, const PeriodogramSink& sink,
+		unsigned int nThreads) {
+	if (nThreads == 0) {
+		nThreads = std::max(1u, boost::thread::hardware_concurrency());
+	}
+	const size_t nWorkers = std::min<size_t>(nThreads, nCurves);
+
+	if (nWorkers <= 1) {
+		PeriodogramWorkspace workspace;
+		for(size_t i = 0; i < nCurves; i++) {
+			Outcome result;
+			processCurve(grid, source, i, &workspace, result);
+			if (result.failure != NO_FAILURE) {
+				rethrow(i, result);
+			}
+			sink(i, grid.frequencies(), result.power);
+		}
+		return;
+	}
+
+	BatchState state(grid, nCurves, source, WINDOW_PER_THREAD * nWorkers);
+	boost::thread_group workers;
+	try {
+		for(size_t i = 0; i < nWorkers; i++) {
+			workers.create_thread(boost::bind(&batchWorker, boost::ref(state)));
+		}
+
+		for(size_t i = 0; i < nCurves; i++) {
+			Outcome result;
+			{
+				boost::unique_lock<boost::mutex> lock(state.mutex);
+				Outcome& slot = state.slots[i % state.slots.size()];
+				while (!slot.ready) {
+					state.changed.wait(lock);
+				}
+				slot.swap(result);
+			}
+			if (result.failure != NO_FAILURE) {
+				rethrow(i, result);
+			}
+
+			sink(i, grid.frequencies(), result.power);
+
+			{
+				boost::lock_guard<boost::mutex> lock(state.mutex);
+				state.emitted++;
+			}
+			state.changed.notify_all();
+		}
+	} catch (...) {
+		{
+			boost::lock_guard<boost::mutex> lock(state.mutex);
+			state.stop = true;
+		}
+		state.changed.notify_all();
+		workers.join_all();
+		throw;
+	}
+	workers.join_all();
+}
+
+/** Computes the periodograms of many light curves on a common grid,
+ *	dividing the light curves among threads.
+ *
+ * This function behaves like the version taking a LightCurveSource and
+ * a PeriodogramSink, but reads the light curves from memory and stores
+ * all the periodograms.
+ *
+ * @param[in] grid The frequency grid and algorithm to use for every
+ *	light curve.
+ * @param[in] times The times of each light curve.
+ * @param[in] data The measurements of each light curve.
+ * @param[in] errors The uncertainties of each light curve.
+ * @param[out] power On output, @p power[i] is the periodogram of the ith
+ *	light curve, evaluated at @p grid.frequencies().
+ * @param[in] nThreads The number of worker threads, or 0 to use one per
+ *	processor.
+ *
+ * @pre No value in @p times or @p data is NaN
+ *
+ * @post @p power.size() = @p times.size()
+ *
+ * @perform O(NM/T) for LS_DIRECT or LS_EXACT, where N is the total number
+ *	of measurements, M = @p grid.frequencies().size(), and T is the
+ *	number of threads.
+ *
+ * @exception std::invalid_argument Thrown if @p times, @p data, and
+ *	@p errors hold different numbers of light curves, or if any light
+ *	curve is invalid as described for FrequencyGrid::periodogram().
+ *	The message names the offending light curve.
+ * @exception kpfutils::except::NotEnoughData Thrown if any light curve
+ *	has fewer than 3 measurements. The message names the offending
+ *	light curve.
+ * @exception std::bad_alloc Thrown if there is not enough memory for
+ *	the computation.
+ * @exception boost::thread_resource_error Thrown if a thread could not
+ *	be started.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an
+ *	exception.
+ *
+ * @test Five light curves of different lengths, 1 or 3 threads. Expected
+ *	behavior: identical to FrequencyGrid::periodogram() on each light
+ *	curve.
+ * @test Mismatched numbers of light curves. Expected behavior: throw
+ *	invalid_argument.
+ */
+void batchLombScargle(const FrequencyGrid& grid,
+		const std::vector<std::vector<double> >& times,
+		const std::vector<std::vector<double> >& data,
+		const std::vector<std::vector<double> >& errors,
+		std::vector<std::vector<double> >& power, unsigned int nThreads) {
+	if (data.size() != times.size() || errors.size() != times.size()) {
+		throw std::invalid_argument(
+			"Different numbers of light curves passed to batchLombScargle()");
+	}
+
+	std::vector<std::vector<double> > temp(times.size());
+	batchLombScargle(grid, times.size(), VectorSource(times, data, errors),
+		VectorSink(temp), nThreads);
+
+	// IMPORTANT: no exceptions beyond this point
+
+	power.swap(temp);
+}
+
+/** Writes one periodogram.
+ *
+ * @param[in] index The position of the periodogram in the batch.
+ * @param[in] freq The frequencies at which the periodogram was computed.
+ * @param[in] power The periodogram.
+ *
+ * @pre @p index < the number of file names
+ *
+ * @post Writes the periodogram to the file named in position @p index,
+ *	as described for printPeriodogram().
+ *
+ * @exception kpfutils::except::FileIo Thrown if any file operation fails.
+ *
+ * @exceptsafe The file may be incomplete in the event of an exception.
+ */
+void PeriodogramPrinter::operator()(size_t index, const std::vector<double>& freq,
+		const std::vector<double>& power) const {
+	printPeriodogram(fileNames[index], freq, power, threshold, fap);
+}
+
+}	// end kpfutils
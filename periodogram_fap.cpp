@@ -0,0 +1,507 @@
+/** Bootstrap false alarm probabilities for Lomb-Scargle periodograms
+ * @file common/periodogram_fap.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+#include <vector>
+#include <cmath>
+#include <boost/bind/bind.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/random/taus88.hpp>
+#include <boost/random/uniform_int_distribution.hpp>
+#include <boost/ref.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread.hpp>
+#include "periodogram.h"
+
+namespace kpfutils {
+
+namespace {
+
+/** Number of resamples between checks of the stopping criterion
+ *
+ * The rounds do not depend on the number of threads, so neither does the
+ * point at which bootstrapFap() stops.
+ */
+const size_t ROUND_SIZE = 128;
+
+/** Normal quantile for the 95% confidence interval on the false alarm
+ *	probability
+ */
+const double CONFIDENCE_Z = 1.96;
+
+/** Scrambles the bits of a 32-bit word
+ *
+ * This is the finalizer of MurmurHash3, which maps nearby inputs to
+ * unrelated outputs.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+boost::uint32_t mixBits(boost::uint32_t h) {
+	h ^= h >> 16;
+	h *= 0x85ebca6bu;
+	h ^= h >> 13;
+	h *= 0xc2b2ae35u;
+	h ^= h >> 16;
+	return h;
+}
+
+/** Generates and analyzes resampled light curves
+ *
+ * Each Resampler owns all the memory needed for one resample, so a
+ * thread can process any number of resamples without allocating.
+ */
+class Resampler {
+public:
+	/** Prepares to resample a light curve.
+	 *
+	 * @param[in] grid The frequencies at which to compute periodograms.
+	 * @param[in] times, data, errors The light curve to resample. The
+	 *	arguments must outlive this object.
+	 * @param[in] method The resampling scheme.
+	 * @param[in] seed The seed shared by all resamples.
+	 *
+	 * @exception std::bad_alloc Thrown if there is not enough memory.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	Resampler(const FrequencyGrid& grid, const std::vector<double>& times,
+			const std::vector<double>& data, const std::vector<double>& errors,
+			ResampleMethod method, unsigned long seed)
+			: grid(grid), times(times), data(data), errors(errors), method(method),
+			seed(seed), newData(data), newErrors(errors), power(),
+			workspace(), rng(), failed(false) {
+	}
+
+	/** Computes the periodogram of the original light curve.
+	 *
+	 * Calling check() on any Resampler for a light curve ensures that the
+	 * light curve is valid before run() is called. It also sets up the
+	 * workspace of the Resampler it is called on; other Resamplers set
+	 * up theirs on their first resample.
+	 *
+	 * @exception kpfutils::except::NotEnoughData Thrown if there are fewer
+	 *	than 3 measurements.
+	 * @exception std::invalid_argument Thrown if the light curve is
+	 *	invalid, as for FrequencyGrid::periodogram().
+	 * @exception std::bad_alloc Thrown if there is not enough memory.
+	 *
+	 * @exceptsafe The object is in a valid state in the event of an
+	 *	exception.
+	 */
+	void check() {
+		grid.periodogram(times, data, errors, power, workspace);
+	}
+
+	/** Finds the highest periodogram peak of a range of resamples.
+	 *
+	 * Each resample uses its own random stream, chosen by its index, so
+	 * the result does not depend on which Resampler computes it.
+	 *
+	 * @param[in] first, last The indices of the resamples to compute.
+	 * @param[in] base The index of the resample stored in @p peaks[0].
+	 * @param[out] peaks The highest power of each resample.
+	 *
+	 * @pre check() has been called without throwing, on this or another
+	 *	Resampler for the same light curve.
+	 *
+	 * @post If failed() is true, the contents of @p peaks are unspecified.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	void run(size_t first, size_t last, size_t base, std::vector<double>& peaks) {
+		try {
+			for (size_t r = first; r < last; r++) {
+				reseed(r);
+				resample();
+				grid.periodogram(times, newData, newErrors, power, workspace);
+				peaks[r - base] = *std::max_element(power.begin(), power.end());
+			}
+		} catch (...) {
+			// The light curve passed check(), so the only possible
+			//	error is running out of memory
+			failed = true;
+		}
+	}
+
+	/** Returns true if run() has failed.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	bool hasFailed() const {
+		return failed;
+	}
+
+private:
+	// Resamplers own a workspace, which cannot be copied
+	Resampler(const Resampler&);
+	Resampler& operator=(const Resampler&);
+
+	/** Starts the random stream for one resample
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	void reseed(size_t index) {
+		boost::uint32_t h = mixBits(static_cast<boost::uint32_t>(seed)
+			^ mixBits(static_cast<boost::uint32_t>((seed >> 16) >> 16)));
+		h = mixBits(h ^ static_cast<boost::uint32_t>(index));
+		h = mixBits(h ^ static_cast<boost::uint32_t>((index >> 16) >> 16));
+
+		boost::uint32_t words[3];
+		for (size_t i = 0; i < 3; i++) {
+			h = mixBits(h + 0x9e3779b9u);
+			words[i] = h;
+		}
+		boost::uint32_t* first = words;
+		rng.seed(first, words + 3);
+	}
+
+	/** Fills newData and newErrors with a resampled light curve
+	 *
+	 * Each measurement keeps its own error. The times are not resampled,
+	 * so the sampling pattern, and hence the window function, is
+	 * unchanged.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	void resample() {
+		const size_t n = data.size();
+		if (method == RESAMPLE_BOOTSTRAP) {
+			boost::random::uniform_int_distribution<size_t> pick(0, n-1);
+			for (size_t i = 0; i < n; i++) {
+				const size_t j = pick(rng);
+				newData  [i] = data  [j];
+				newErrors[i] = errors[j];
+			}
+		} else {
+			std::copy(data.begin(), data.end(), newData.begin());
+			std::copy(errors.begin(), errors.end(), newErrors.begin());
+			// Fisher-Yates shuffle
+			for (size_t i = n-1; i > 0; i--) {
+				const size_t j = boost::random::uniform_int_distribution<size_t>(0, i)(rng);
+				std::swap(newData  [i], newData  [j]);
+				std::swap(newErrors[i], newErrors[j]);
+			}
+		}
+	}
+
+	const FrequencyGrid& grid;
+	const std::vector<double>& times;
+	const std::vector<double>& data;
+	const std::vector<double>& errors;
+	ResampleMethod method;
+	unsigned long seed;
+
+	std::vector<double> newData;
+	std::vector<double> newErrors;
+	std::vector<double> power;
+	PeriodogramWorkspace workspace;
+	boost::random::taus88 rng;
+	bool failed;
+};
+
+typedef std::vector<boost::shared_ptr<Resampler> > ResamplerList;
+
+/** Creates one Resampler per thread and checks the light curve
+ *
+ * The light curve is checked only once, by the first Resampler, so that
+ * the periodogram of the original light curve is not recomputed for
+ * every thread.
+ *
+ * @param[in] grid, times, data, errors, method, seed As for the
+ *	Resampler constructor.
+ * @param[in] nResamples The largest number of resamples that will be run
+ *	at once.
+ * @param[in] nThreads The requested number of threads, or 0 to use one
+ *	per processor.
+ * @param[out] workers The new Resamplers.
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are fewer
+ *	than 3 measurements.
+ * @exception std::invalid_argument Thrown if the light curve is invalid.
+ * @exception std::bad_alloc Thrown if there is not enough memory.
+ *
+ * @exceptsafe The arguments are unchanged in the event of an exception.
+ */
+void makeResamplers(const FrequencyGrid& grid, const std::vector<double>& times,
+		const std::vector<double>& data, const std::vector<double>& errors,
+		ResampleMethod method, unsigned long seed, size_t nResamples,
+		unsigned int nThreads, ResamplerList& workers) {
+	if (nThreads == 0) {
+		nThreads = std::max(1u, boost::thread::hardware_concurrency());
+	}
+	const size_t nWorkers = std::max<size_t>(1, std::min<size_t>(nThreads, nResamples));
+
+	ResamplerList temp;
+	temp.reserve(nWorkers);
+	for (size_t i = 0; i < nWorkers; i++) {
+		temp.push_back(boost::shared_ptr<Resampler>(
+			new Resampler(grid, times, data, errors, method, seed)));
+	}
+	temp.front()->check();
+
+	// IMPORTANT: no exceptions beyond this point
+
+	workers.swap(temp);
+}
+
+/** Computes a block of resamples, dividing them among the Resamplers
+ *
+ * The first share is processed by the calling thread.
+ *
+ * @param[in] workers The Resamplers to use, one per thread.
+ * @param[in] first, last The indices of the resamples to compute.
+ * @param[out] peaks On output, @p peaks[r - @p first] is the highest power
+ *	of resample r.
+ *
+ * @pre @p peaks.size() &ge; @p last - @p first
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory for any
+ *	resample.
+ * @exception boost::thread_resource_error Thrown if a thread could not
+ *	be started.
+ *
+ * @exceptsafe The contents of @p peaks are unspecified in the event of
+ *	an exception. All threads are finished in the event of an exception.
+ */
+void runResamples(const ResamplerList& workers, size_t first, size_t last,
+		std::vector<double>& peaks) {
+	const size_t count = last - first;
+	const size_t nShares = std::min(workers.size(), count);
+
+	boost::thread_group threads;
+	try {
+		for(size_t i = 1; i < nShares; i++) {
+			threads.create_thread(boost::bind(&Resampler::run, workers[i].get(),
+				first + i * count / nShares, first + (i+1) * count / nShares,
+				first, boost::ref(peaks)));
+		}
+		workers[0]->run(first, first + count / nShares, first, peaks);
+	} catch (...) {
+		threads.join_all();
+		throw;
+	}
+	threads.join_all();
+
+	for (size_t i = 0; i < nShares; i++) {
+		if (workers[i]->hasFailed()) {
+			throw std::bad_alloc();
+		}
+	}
+}
+
+/** Computes a 95% Wilson score interval for a binomial proportion
+ *
+ * @param[in] successes, trials The observed counts.
+ * @param[out] lower, upper The bounds of the interval.
+ *
+ * @pre @p trials > 0
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void wilsonInterval(size_t successes, size_t trials, double& lower, double& upper) {
+	const double n = static_cast<double>(trials);
+	const double p = static_cast<double>(successes) / n;
+	const double z2 = CONFIDENCE_Z * CONFIDENCE_Z;
+
+	const double denom = 1.0 + z2 / n;
+	const double center = (p + 0.5 * z2 / n) / denom;
+	const double halfWidth = CONFIDENCE_Z / denom
+		* std::sqrt(p * (1.0 - p) / n + 0.25 * z2 / (n * n));
+
+	lower = std::max(0.0, center - halfWidth);
+	upper = std::min(1.0, center + halfWidth);
+}
+
+}	// end unnamed
+
+/** Estimates the false alarm probability of a periodogram peak by
+ *	resampling the light curve.
+ *
+ * Each resample scrambles the measurements (with their errors) among the
+ * observation times, destroying any periodic signal while keeping the
+ * sampling pattern and the distribution of values. The false alarm
+ * probability is the fraction of resamples whose highest periodogram
+ * peak on @p grid reaches @p threshold.
+ *
+ * The resamples are divided among threads, each with its own random
+ * number generator and scratch memory, so after the first round
+ * computing a resample does not allocate memory. Every resample draws
+ * from its own random stream, determined by @p seed and its index, so
+ * the result does not depend on the number of threads.
+ *
+ * Resamples are computed in rounds. After each round, a 95% Wilson score
+ * interval is found for the false alarm probability, and the estimation
+ * stops once the interval is no wider than &plusmn;@p tolerance.
+ *
+ * @param[in] grid The frequencies at which to compute periodograms.
+ * @param[in] times The times at which @p data were measured.
+ * @param[in] data The measurements to analyze.
+ * @param[in] errors The uncertainties of @p data.
+ * @param[in] threshold The periodogram power to test, typically the
+ *	height of the highest peak in the periodogram of @p data.
+ * @param[in] maxResamples The largest number of resamples to compute.
+ * @param[in] tolerance The half-width of the confidence interval at which
+ *	to stop early, or 0 to always compute @p maxResamples resamples.
+ * @param[in] method Whether to permute the measurements or to draw them
+ *	with replacement.
+ * @param[in] seed The seed for the random number generators. Calls with
+ *	the same seed give the same result.
+ * @param[in] nThreads The number of threads to use, or 0 to use one per
+ *	processor.
+ *
+ * @return The estimated false alarm probability, its confidence
+ *	interval, and the number of resamples used.
+ *
+ * @pre No value in @p times or @p data is NaN
+ *
+ * @post The result does not depend on @p nThreads.
+ *
+ * @perform O(RP/T), where R is the number of resamples, P is the cost of
+ *	grid.periodogram(), and T is the number of threads.
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are fewer
+ *	than 3 measurements.
+ * @exception std::invalid_argument Thrown if @p times, @p data, and
+ *	@p errors have different lengths, if any error is not positive and
+ *	finite, if @p maxResamples is zero, or if @p tolerance is negative.
+ * @exception std::bad_alloc Thrown if there is not enough memory for
+ *	the computation.
+ * @exception boost::thread_resource_error Thrown if a thread could not
+ *	be started.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an
+ *	exception.
+ *
+ * @test Sinusoid with noise, threshold at its highest peak. Expected
+ *	behavior: false alarm probability 0.
+ * @test Pure noise, threshold at its highest peak. Expected behavior:
+ *	false alarm probability roughly uniform, so averaging well above
+ *	0 over many noise realizations.
+ * @test 1, 3, or 8 threads, either resampling method. Expected
+ *	behavior: identical results.
+ * @test Tolerance 0.05. Expected behavior: stops before maxResamples,
+ *	with a confidence interval no wider than &plusmn;0.05.
+ * @test maxResamples = 0, negative tolerance, or invalid light curve.
+ *	Expected behavior: throw invalid_argument or NotEnoughData.
+ */
+FapEstimate bootstrapFap(const FrequencyGrid& grid, const std::vector<double>& times,
+		const std::vector<double>& data, const std::vector<double>& errors,
+		double threshold, size_t maxResamples, double tolerance,
+		ResampleMethod method, unsigned long seed, unsigned int nThreads) {
+	if (maxResamples == 0) {
+		throw std::invalid_argument("Need at least one resample in bootstrapFap()");
+	}
+	if (!(tolerance >= 0.0)) {
+		throw std::invalid_argument("Tolerance must be nonnegative in bootstrapFap()");
+	}
+
+	ResamplerList workers;
+	makeResamplers(grid, times, data, errors, method, seed,
+		std::min(ROUND_SIZE, maxResamples), nThreads, workers);
+
+	std::vector<double> peaks(std::min(ROUND_SIZE, maxResamples));
+	FapEstimate result;
+	result.resamples = 0;
+	result.exceedances = 0;
+	while (result.resamples < maxResamples) {
+		const size_t first = result.resamples;
+		const size_t last = std::min(maxResamples, first + ROUND_SIZE);
+		runResamples(workers, first, last, peaks);
+
+		for (size_t r = 0; r < last - first; r++) {
+			if (peaks[r] >= threshold) {
+				result.exceedances++;
+			}
+		}
+		result.resamples = last;
+
+		wilsonInterval(result.exceedances, result.resamples, result.lower, result.upper);
+		if (tolerance > 0.0 && 0.5 * (result.upper - result.lower) <= tolerance) {
+			break;
+		}
+	}
+	result.fap = static_cast<double>(result.exceedances)
+		/ static_cast<double>(result.resamples);
+
+	return result;
+}
+
+/** Finds the highest periodogram peak of each of many resampled light
+ *	curves.
+ *
+ * The resamples are the same as those used by bootstrapFap() with the
+ * same @p method and @p seed. Their peak heights may be used to choose
+ * a significance threshold, for example by taking the 99th percentile
+ * as the threshold for a 1% false alarm probability.
+ *
+ * @param[in] grid The frequencies at which to compute periodograms.
+ * @param[in] times The times at which @p data were measured.
+ * @param[in] data The measurements to analyze.
+ * @param[in] errors The uncertainties of @p data.
+ * @param[in] nResamples The number of resamples to compute.
+ * @param[out] peaks On output, @p peaks[r] is the highest power in the
+ *	periodogram of the rth resample.
+ * @param[in] method Whether to permute the measurements or to draw them
+ *	with replacement.
+ * @param[in] seed The seed for the random number generators.
+ * @param[in] nThreads The number of threads to use, or 0 to use one per
+ *	processor.
+ *
+ * @pre No value in @p times or @p data is NaN
+ *
+ * @post @p peaks.size() = @p nResamples
+ * @post The result does not depend on @p nThreads.
+ *
+ * @perform O(RP/T), where R = @p nResamples, P is the cost of
+ *	grid.periodogram(), and T is the number of threads.
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are fewer
+ *	than 3 measurements.
+ * @exception std::invalid_argument Thrown if @p times, @p data, and
+ *	@p errors have different lengths, if any error is not positive and
+ *	finite, or if @p nResamples is zero.
+ * @exception std::bad_alloc Thrown if there is not enough memory for
+ *	the computation.
+ * @exception boost::thread_resource_error Thrown if a thread could not
+ *	be started.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an
+ *	exception.
+ *
+ * @test Pure noise, 200 resamples, 1 or 4 threads. Expected behavior:
+ *	200 peaks between 0 and 1, identical for both thread counts, and
+ *	consistent with bootstrapFap().
+ */
+void bootstrapPeaks(const FrequencyGrid& grid, const std::vector<double>& times,
+		const std::vector<double>& data, const std::vector<double>& errors,
+		size_t nResamples, std::vector<double>& peaks, ResampleMethod method,
+		unsigned long seed, unsigned int nThreads) {
+	if (nResamples == 0) {
+		throw std::invalid_argument("Need at least one resample in bootstrapPeaks()");
+	}
+
+	ResamplerList workers;
+	makeResamplers(grid, times, data, errors, method, seed, nResamples, nThreads, workers);
+
+	std::vector<double> tempPeaks(nResamples);
+	runResamples(workers, 0, nResamples, tempPeaks);
+
+	// IMPORTANT: no exceptions beyond this point
+
+	peaks.swap(tempPeaks);
+}
+
+}	// end kpfutils
@@ -0,0 +1,330 @@
+/** Peak extraction from Lomb-Scargle periodograms
+ * @file common/periodogram_peaks.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+#include <cmath>
+#include "periodogram.h"
+
+namespace kpfutils {
+
+namespace {
+
+/** Number of candidate maxima kept for each requested peak on the first
+ *	pass through the periodogram
+ */
+const size_t POOL_PER_PEAK = 8;
+
+/** Orders peaks from strongest to weakest, breaking ties by frequency
+ *
+ * Used as the heap order in findPeaks(), where it puts the weakest
+ * candidate at the top of the heap.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+bool stronger(const Peak& x, const Peak& y) {
+	if (x.power != y.power) {
+		return x.power > y.power;
+	}
+	return x.index < y.index;
+}
+
+/** Tests whether a frequency falls in a window around a reference
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+bool near(double freq, double center, double window) {
+	return std::fabs(freq - center) < window;
+}
+
+/** Tests whether a candidate peak is excluded by a stronger peak
+ *
+ * @param[in] candidate The frequency of the weaker peak.
+ * @param[in] accepted The frequency of the stronger peak.
+ * @param[in] window, aliases, maxHarmonic The exclusion windows, as for
+ *	findPeaks().
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+bool excluded(double candidate, double accepted, double window,
+		const std::vector<double>& aliases, unsigned int maxHarmonic) {
+	if (near(candidate, accepted, window)) {
+		return true;
+	}
+	for (size_t i = 0; i < aliases.size(); i++) {
+		if (near(candidate, accepted + aliases[i], window)
+				|| near(candidate, std::fabs(accepted - aliases[i]), window)) {
+			return true;
+		}
+	}
+	for (unsigned int h = 2; h <= maxHarmonic; h++) {
+		if (near(candidate, accepted * h, window)
+				|| near(candidate, accepted / h, window)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/** Collects the strongest local maxima of a periodogram in one pass
+ *
+ * @param[in] freq, power The periodogram.
+ * @param[in] capacity The largest number of maxima to keep.
+ * @param[out] pool The strongest maxima, from strongest to weakest.
+ *
+ * @return The total number of local maxima in the periodogram.
+ *
+ * @perform O(M log C), where M = @p power.size() and C = @p capacity.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory.
+ *
+ * @exceptsafe The contents of @p pool are unspecified in the event of an
+ *	exception.
+ */
+size_t collectMaxima(const std::vector<double>& freq, const std::vector<double>& power,
+		size_t capacity, std::vector<Peak>& pool) {
+	pool.clear();
+	pool.reserve(capacity);
+
+	const size_t n = power.size();
+	size_t nMaxima = 0;
+	for (size_t i = 0; i < n; i++) {
+		if (i > 0 && !(power[i] > power[i-1])) {
+			continue;
+		}
+		// The first point of a plateau counts as the maximum
+		size_t last = i;
+		while (last + 1 < n && power[last+1] == power[i]) {
+			last++;
+		}
+		const bool aboveRight = (last + 1 == n || power[last+1] < power[i]);
+		if (!aboveRight || (i == 0 && last + 1 == n)) {
+			continue;
+		}
+		nMaxima++;
+
+		Peak candidate;
+		candidate.frequency = freq[i];
+		candidate.power = power[i];
+		candidate.index = i;
+		if (pool.size() < capacity) {
+			pool.push_back(candidate);
+			std::push_heap(pool.begin(), pool.end(), &stronger);
+		} else if (stronger(candidate, pool.front())) {
+			std::pop_heap(pool.begin(), pool.end(), &stronger);
+			pool.back() = candidate;
+			std::push_heap(pool.begin(), pool.end(), &stronger);
+		}
+	}
+
+	std::sort_heap(pool.begin(), pool.end(), &stronger);
+	return nMaxima;
+}
+
+}	// end unnamed
+
+/** Finds the strongest peaks in a periodogram.
+ *
+ * A peak is a local maximum of @p power, which may be at either end of
+ * the periodogram. If the maximum is a plateau, the peak is at its
+ * lowest frequency. Peaks are chosen greedily from
+ * strongest to weakest, and each chosen peak at frequency f excludes any
+ * weaker peak within @p window of f, of the aliases f + a and |f - a| for
+ * each a in @p aliases, or of the harmonics h*f and subharmonics f/h for
+ * h = 2, ..., @p maxHarmonic.
+ *
+ * The peaks are found in a single pass that keeps the strongest local
+ * maxima in a bounded heap. The pass is repeated with a larger heap only
+ * if the exclusion windows reject so many candidates that fewer than
+ * @p nPeaks are left.
+ *
+ * @param[in] freq The frequencies of the periodogram.
+ * @param[in] power The periodogram power at each frequency, as computed
+ *	by lombScargle() or a similar function.
+ * @param[in] nPeaks The largest number of peaks to return.
+ * @param[out] peaks The peaks found, from strongest to weakest.
+ * @param[in] window The half-width of the exclusion windows, in the same
+ *	units as @p freq. If zero, no peaks are excluded.
+ * @param[in] aliases The frequencies, such as the inverse of a sidereal
+ *	day, that produce aliases of a signal.
+ * @param[in] maxHarmonic The highest harmonic to exclude, or 0 or 1 to
+ *	not exclude harmonics.
+ *
+ * @pre No value in @p power is NaN
+ *
+ * @post @p peaks.size() &le; @p nPeaks, and is smaller only if the
+ *	periodogram has fewer admissible peaks.
+ * @post @p peaks is sorted by decreasing power, with ties broken by
+ *	increasing index.
+ *
+ * @perform O(M log @p nPeaks) in most cases, where M = @p power.size().
+ *
+ * @exception std::invalid_argument Thrown if @p freq and @p power have
+ *	different lengths, or if @p window is negative.
+ * @exception std::bad_alloc Thrown if there is not enough memory for
+ *	the computation.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an
+ *	exception.
+ *
+ * @test Six separated peaks, no exclusion. Expected behavior: the
+ *	strongest peaks in order, including one at the end of the grid.
+ * @test Six peaks with a sidelobe, an alias, and a harmonic of the
+ *	strongest peak. Expected behavior: the sidelobe, alias, and
+ *	harmonic are skipped.
+ * @test Random periodogram, wide exclusion windows. Expected behavior:
+ *	same as a greedy search over all local maxima.
+ * @test Mismatched lengths or negative window. Expected behavior: throw
+ *	invalid_argument.
+ */
+void findPeaks(const std::vector<double>& freq, const std::vector<double>& power,
+		size_t nPeaks, std::vector<Peak>& peaks, double window,
+		const std::vector<double>& aliases, unsigned int maxHarmonic) {
+	if (freq.size() != power.size()) {
+		throw std::invalid_argument("Frequency and power vectors must have the same length in findPeaks()");
+	}
+	if (!(window >= 0.0)) {
+		throw std::invalid_argument("Exclusion window must be nonnegative in findPeaks()");
+	}
+
+	std::vector<Peak> tempPeaks;
+	if (nPeaks > 0) {
+		std::vector<Peak> pool;
+		size_t capacity = (nPeaks > power.size() / POOL_PER_PEAK
+			? power.size() : nPeaks * POOL_PER_PEAK);
+		for(;;) {
+			const size_t nMaxima = collectMaxima(freq, power, capacity, pool);
+
+			// Greedy selection only depends on stronger candidates, all
+			//	of which are in the pool
+			tempPeaks.clear();
+			for (size_t i = 0; i < pool.size() && tempPeaks.size() < nPeaks; i++) {
+				bool keep = true;
+				for (size_t j = 0; j < tempPeaks.size() && keep; j++) {
+					keep = !excluded(pool[i].frequency, tempPeaks[j].frequency,
+						window, aliases, maxHarmonic);
+				}
+				if (keep) {
+					tempPeaks.push_back(pool[i]);
+				}
+			}
+
+			if (tempPeaks.size() == nPeaks || pool.size() == nMaxima) {
+				break;
+			}
+			capacity = std::min(nMaxima, 2 * capacity);
+		}
+	}
+
+	// IMPORTANT: no exceptions beyond this point
+
+	peaks.swap(tempPeaks);
+}
+
+/** Refines the frequencies and powers of periodogram peaks.
+ *
+ * Each peak is re-evaluated at @p nPoints frequencies spaced evenly
+ * between its frequency &plusmn; @p halfWidth, as well as at its original
+ * frequency, and moved to the frequency with the highest power. This
+ * gives a precise peak location without oversampling the whole
+ * periodogram. Frequencies that are not positive are skipped.
+ *
+ * The refined powers are computed directly, as by the lombScargle()
+ * overload for arbitrary frequencies, so they may differ slightly from
+ * those of an LS_FAST periodogram.
+ *
+ * @param[in] times The times at which @p data were measured.
+ * @param[in] data The measurements to analyze.
+ * @param[in] errors The uncertainties of @p data.
+ * @param[in] halfWidth The half-width of the region to search around
+ *	each peak, typically the spacing of the original frequency grid.
+ * @param[in] nPoints The number of frequencies at which to evaluate
+ *	each peak.
+ * @param[in,out] peaks The peaks to refine, typically as found by
+ *	findPeaks(). On output, the frequency and power of each peak are
+ *	updated, and the peaks are sorted from strongest to weakest. The
+ *	index of each peak is unchanged.
+ *
+ * @pre No value in @p times or @p data is NaN
+ * @pre Each peak has a positive frequency
+ *
+ * @perform O(NKP), where N = @p times.size(), K = @p peaks.size(), and
+ *	P = @p nPoints.
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are fewer
+ *	than 3 measurements.
+ * @exception std::invalid_argument Thrown if @p times, @p data, and
+ *	@p errors have different lengths, if any error is not positive and
+ *	finite, if @p halfWidth is not positive, or if @p nPoints is less
+ *	than 2.
+ * @exception std::bad_alloc Thrown if there is not enough memory for
+ *	the computation.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an
+ *	exception.
+ *
+ * @test Sinusoid off the coarse grid. Expected behavior: refined
+ *	frequency closer to the input frequency than the grid allows, and
+ *	refined power at least the exact power at the grid peak.
+ * @test Nonpositive width or too few points. Expected behavior: throw
+ *	invalid_argument.
+ */
+void refinePeaks(const std::vector<double>& times, const std::vector<double>& data,
+		const std::vector<double>& errors, double halfWidth, size_t nPoints,
+		std::vector<Peak>& peaks) {
+	if (!(halfWidth > 0.0)) {
+		throw std::invalid_argument("Refinement width must be positive in refinePeaks()");
+	}
+	if (nPoints < 2) {
+		throw std::invalid_argument("Need at least 2 points per peak in refinePeaks()");
+	}
+
+	// Evaluate all the fine grids at once, to share the setup cost
+	std::vector<double> fineFreq;
+	std::vector<size_t> starts;
+	fineFreq.reserve(peaks.size() * (nPoints + 1));
+	starts.reserve(peaks.size() + 1);
+	for (size_t i = 0; i < peaks.size(); i++) {
+		starts.push_back(fineFreq.size());
+		const double center = peaks[i].frequency;
+		fineFreq.push_back(center);
+		for (size_t j = 0; j < nPoints; j++) {
+			const double f = center + halfWidth
+				* (2.0 * static_cast<double>(j) / static_cast<double>(nPoints - 1) - 1.0);
+			if (f > 0.0) {
+				fineFreq.push_back(f);
+			}
+		}
+	}
+	starts.push_back(fineFreq.size());
+
+	std::vector<double> finePower;
+	lombScargle(times, data, errors, fineFreq, finePower);
+
+	std::vector<Peak> tempPeaks(peaks);
+	for (size_t i = 0; i < tempPeaks.size(); i++) {
+		const size_t best = std::max_element(finePower.begin() + starts[i],
+			finePower.begin() + starts[i+1]) - finePower.begin();
+		tempPeaks[i].frequency = fineFreq [best];
+		tempPeaks[i].power     = finePower[best];
+	}
+	std::sort(tempPeaks.begin(), tempPeaks.end(), &stronger);
+
+	// IMPORTANT: no exceptions beyond this point
+
+	peaks.swap(tempPeaks);
+}
+
+}	// end kpfutils
@@ -0,0 +1,112 @@
+/** Read-ahead support for processing long lists of files
+ * @file common/prefetch.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#include <new>
+#include <vector>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "prefetch.h"
+
+namespace kpfutils {
+
+/** Asks the operating system to start reading a file into its cache
+ *
+ * The request is asynchronous: the function returns immediately, and the
+ * file is read in the background.
+ *
+ * @param[in] fileName The file that will be needed soon.
+ *
+ * @return True if the request was made, false if the file could not be
+ *	opened.
+ *
+ * @post @c errno is unchanged
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+bool adviseWillNeed(const char* fileName) {
+	const int oldErr = errno;
+
+	int fd = open(fileName, O_RDONLY);
+	if (fd < 0) {
+		errno = oldErr;
+		return false;
+	}
+	// Closing the file does not cancel the read-ahead
+	bool success = (0 == posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED));
+	close(fd);
+
+	errno = oldErr;
+	return success;
+}
+
+/** Tests whether a file is entirely in the operating system's cache
+ *
+ * @param[in] fileName The file to test.
+ *
+ * @return True if every page of @p fileName is resident in memory, so that
+ *	reading it will not touch the disk. False if any page is not resident,
+ *	or if the file could not be examined.
+ *
+ * @post @c errno is unchanged
+ *
+ * @perform O(P), where P is the number of pages in the file.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+bool isCached(const char* fileName) {
+	const int oldErr = errno;
+	bool cached = false;
+
+	int fd = open(fileName, O_RDONLY);
+	if (fd >= 0) {
+		struct stat fileInfo;
+		if (0 == fstat(fd, &fileInfo)) {
+			const size_t fileSize = static_cast<size_t>(fileInfo.st_size);
+			if (fileSize == 0) {
+				cached = true;
+			} else {
+				// Mapping does not read anything; it only lets us query the cache
+				void* map = mmap(NULL, fileSize, PROT_READ, MAP_SHARED, fd, 0);
+				if (map != MAP_FAILED) {
+					const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+					const size_t nPages   = (fileSize + pageSize - 1) / pageSize;
+					try {
+						std::vector<unsigned char> residency(nPages);
+						if (0 == mincore(map, fileSize, &residency[0])) {
+							cached = true;
+							for(size_t i = 0; i < nPages; i++) {
+								if (!(residency[i] & 1)) {
+									cached = false;
+									break;
+								}
+							}
+						}
+					} catch (const std::bad_alloc& e) {
+						cached = false;
+					}
+					munmap(map, fileSize);
+				}
+			}
+		}
+		close(fd);
+	}
+
+	errno = oldErr;
+	return cached;
+}
+
+}	// end kpfutils
@@ -0,0 +1,192 @@
+/** Read-ahead support for processing long lists of files
+ * @file common/prefetch.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#ifndef KPFUTILSPREFETCHH
+#define KPFUTILSPREFETCHH
+
+#include <algorithm>
+#include <string>
+
+namespace kpfutils {
+
+/** @addtogroup lcio
+ *
+ * Include prefetch.h to read files ahead of time.
+ *
+ * @{
+ */
+
+/** Asks the operating system to start reading a file into its cache
+ */
+bool adviseWillNeed(const char* fileName);
+
+/** Tests whether a file is entirely in the operating system's cache
+ */
+bool isCached(const char* fileName);
+
+/** Returns a file name as a C string.
+ *
+ * @param[in] fileName The name to convert.
+ *
+ * @return A pointer to the characters of @p fileName.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+inline const char* fileCString(const std::string& fileName) {
+	return fileName.c_str();
+}
+
+/** Returns a file name as a C string.
+ *
+ * @param[in] fileName The name to convert.
+ *
+ * @return @p fileName
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+inline const char* fileCString(const char* fileName) {
+	return fileName;
+}
+
+/** Keeps upcoming files in a list warm in the operating system's cache.
+ *
+ * A program that reads a list of files in order calls advance() before
+ * opening each file. The Prefetcher then asks the operating system to
+ * start reading the next few files in the background, so that they are
+ * (ideally) already in memory by the time they are opened. This hides the
+ * seek and transfer latency of slow storage behind the processing of
+ * earlier files.
+ *
+ * @tparam FileList The type of the file list, typically
+ *	<tt>std::vector<std::string></tt> or
+ *	@ref kpfutils::FileNameList "FileNameList". Must provide @c size()
+ *	and an @c operator[] returning either a @c std::string or a
+ *	<tt>const char*</tt>.
+ *
+ * @note This class is a performance hint only. Files that cannot be
+ *	opened are silently skipped, and are reported when the program
+ *	itself tries to open them.
+ */
+template <class FileList>
+class Prefetcher {
+public:
+	/** Prepares to read a list of files.
+	 *
+	 * @param[in] files The files to be read, in order. The list must not
+	 *	be modified or destroyed while the Prefetcher is in use.
+	 * @param[in] distance The number of files to keep in flight ahead of
+	 *	the file currently being read.
+	 * @param[in] measure If set, check whether each file was already
+	 *	cached when advance() is called. Checking requires mapping
+	 *	the file, so it should be disabled once the prefetch distance
+	 *	is tuned.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	Prefetcher(const FileList& files, size_t distance, bool measure = true)
+			: files(files), distance(distance), measure(measure),
+			nextToAdvise(0), nVisited(0), nAdvised(0), nWarm(0) {
+	}
+
+	/** Announces that a file is about to be read.
+	 *
+	 * @param[in] index The position in the list of the file about to
+	 *	be read.
+	 *
+	 * @pre @p index < the size of the file list
+	 *
+	 * @post All files in positions (@p index, @p index + distance] have
+	 *	been requested from the operating system.
+	 *
+	 * @perform O(distance) system calls on the first call, and O(1)
+	 *	amortized system calls if files are read in order.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	void advance(size_t index) {
+		nVisited++;
+		if (measure && isCached(fileCString(files[index]))) {
+			nWarm++;
+		}
+
+		const size_t last = std::min(index + distance + 1,
+			static_cast<size_t>(files.size()));
+		for(nextToAdvise = std::max(nextToAdvise, index+1);
+				nextToAdvise < last; nextToAdvise++) {
+			if (adviseWillNeed(fileCString(files[nextToAdvise]))) {
+				nAdvised++;
+			}
+		}
+	}
+
+	/** Returns the number of calls to advance() so far.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	size_t visited() const {
+		return nVisited;
+	}
+
+	/** Returns the number of files successfully requested from the
+	 *	operating system so far.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	size_t advised() const {
+		return nAdvised;
+	}
+
+	/** Returns the number of files that were fully cached when they were
+	 *	passed to advance().
+	 *
+	 * @return The number of cache hits, or 0 if the Prefetcher was
+	 *	constructed with @p measure = false.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	size_t warm() const {
+		return nWarm;
+	}
+
+	/** Returns the number of files that were not fully cached when they
+	 *	were passed to advance().
+	 *
+	 * @return The number of cache misses, or 0 if the Prefetcher was
+	 *	constructed with @p measure = false.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	size_t cold() const {
+		return (measure ? nVisited - nWarm : 0);
+	}
+
+private:
+	const FileList& files;
+	const size_t distance;
+	const bool measure;
+
+	/** Position of the first file that has not yet been requested
+	 */
+	size_t nextToAdvise;
+
+	size_t nVisited;
+	size_t nAdvised;
+	size_t nWarm;
+};
+
+/** @} */	// end lcio
+
+}	// end kpfutils
+
+#endif		// KPFUTILSPREFETCHH
@@ -2,7 +2,7 @@
  * @file readnames.cpp
  * @author Krzysztof Findeisen
  * @date Created February 6, 2011
- * @date Last modified July 25, 2013
+ * @date Last modified October 18, 2026
  */
 
 /* Copyright 2014, California Institute of Technology.
@@ -15,10 +15,13 @@
 #include <algorithm>
 #include <string>
 #include <vector>
-#include <boost/algorithm/string.hpp>
-#include <boost/smart_ptr.hpp>
-#include "alloc.tmp.h"
-#include "cerror.h"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "fileio.h"
 #include "lcio.h"
 
 using namespace std;
@@ -41,8 +44,174 @@ bool isNewLine(char x) {
 	}
 }
 
+namespace {
+
+/** Closes a POSIX file descriptor when it goes out of scope
+ */
+class FdGuard {
+public:
+	explicit FdGuard(int fd) : fd(fd) {
+	}
+	~FdGuard() {
+		close(fd);
+	}
+private:
+	// Not copyable
+	FdGuard(const FdGuard&);
+	FdGuard& operator=(const FdGuard&);
+
+	int fd;
+};
+
+/** Unmaps a memory-mapped file when it goes out of scope
+ */
+class MapGuard {
+public:
+	MapGuard(void* address, size_t length) : address(address), length(length) {
+	}
+	~MapGuard() {
+		munmap(address, length);
+	}
+private:
+	// Not copyable
+	MapGuard(const MapGuard&);
+	MapGuard& operator=(const MapGuard&);
+
+	void* address;
+	size_t length;
+};
+
+/** Size of each read() when a file cannot be memory-mapped
+ */
+const size_t READ_CHUNK = 65536;
+
+/** Throws an exception describing the current value of errno
+ *
+ * @exception kpfutils::except::FileIo Always thrown.
+ */
+void throwReadError(const string& action, const string& fileName) {
+	int err = errno;
+	errno = 0;
+	throw kpfutils::except::FileIo(action + fileName + ": " + strerror(err));
+}
+
+/** Splits a buffer into names, one per line
+ *
+ * @param[in] fileStart, fileEnd The contents of the file.
+ * @param[out] fileList The list to which to append the names.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the names.
+ *
+ * @exceptsafe @p fileList is in a valid state in the event of an exception.
+ */
+void parseNames(const char* fileStart, const char* fileEnd, 
+		kpfutils::FileNameList& fileList) {
+	for(const char* line = fileStart; line < fileEnd; ) {
+		const char* lineEnd = static_cast<const char*>(
+			memchr(line, '\n', static_cast<size_t>(fileEnd - line)));
+		if (lineEnd == NULL) {
+			lineEnd = fileEnd;
+		}
+		
+		// Commented line
+		if (*line != '#') {
+			const char* nameEnd = lineEnd;
+			while (nameEnd > line && isNewLine(*(nameEnd-1))) {
+				nameEnd--;
+			}
+			fileList.push_back(line, nameEnd);
+		}
+		
+		line = lineEnd + 1;
+	}
+}
+
+/** Reads an entire file whose size is not known in advance
+ *
+ * @param[in] fd An open file descriptor.
+ * @param[in] fileName The name of the file, for error messages.
+ * @param[out] buffer The contents of the file.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the file.
+ * @exception kpfutils::except::FileIo Thrown if the file could not be read.
+ *
+ * @exceptsafe @p buffer is in a valid state in the event of an exception.
+ */
+void readAll(int fd, const string& fileName, vector<char>& buffer) {
+	buffer.clear();
+	for(;;) {
+		const size_t oldSize = buffer.size();
+		buffer.resize(oldSize + READ_CHUNK);
+		const ssize_t nRead = read(fd, &buffer[oldSize], READ_CHUNK);
+		if (nRead < 0) {
+			buffer.resize(oldSize);
+			if (errno == EINTR) {
+				errno = 0;
+				continue;
+			}
+			throwReadError("Could not read ", fileName);
+		}
+		buffer.resize(oldSize + static_cast<size_t>(nRead));
+		if (nRead == 0) {
+			return;
+		}
+	}
+}
+
+}	// end anonymous namespace
+
 namespace kpfutils {
 
+/** Preallocates memory for a list of names.
+ *
+ * @param[in] nChars The total length of all names, including one null 
+ *	character per name.
+ * @param[in] nNames The number of names.
+ *
+ * @post The list can hold @p nChars characters and @p nNames names without 
+ *	reallocating.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the list.
+ * @exception std::length_error Thrown if @p nChars or @p nNames exceeds 
+ *	the maximum list size.
+ *
+ * @exceptsafe The object is in a valid state in the event of an exception.
+ */
+void FileNameList::reserve(size_t nChars, size_t nNames) {
+	arena .reserve(nChars);
+	starts.reserve(nNames);
+}
+
+/** Adds a name to the end of the list.
+ *
+ * @param[in] first,last The characters of the name. The range must not 
+ *	include a terminating null.
+ *
+ * @post size() is increased by 1, and (*this)[size()-1] is a null-terminated 
+ *	copy of [@p first, @p last).
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to 
+ *	store the name.
+ *
+ * @exceptsafe The object is unchanged in the event of an exception.
+ */
+void FileNameList::push_back(const char* first, const char* last) {
+	const size_t oldSize = arena.size();
+	
+	starts.push_back(oldSize);
+	try {
+		arena.insert(arena.end(), first, last);
+		arena.push_back('\0');
+	} catch (...) {
+		starts.pop_back();
+		arena.resize(oldSize);
+		throw;
+	}
+}
+
 /** Reads a file containing a list of file names
  * 
  * @param[in] fileName the name of a file to be read. The file 
@@ -58,36 +227,87 @@ namespace kpfutils {
  * @exceptsafe The function arguments are unchanged in the event of an exception.
  */	
 void readFileNames(const string& fileName, vector<string> &fileList) {
-	using boost::algorithm::trim_right_copy_if;
-	
+	FileNameList names;
+	readFileNames(fileName, names);
+
 	// copy-and-swap
 	vector<string> temp;
+	temp.reserve(names.size());
+	for(size_t i = 0; i < names.size(); i++) {
+		temp.push_back(string(names[i], names.length(i)));
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	swap(fileList, temp);
+}
 
-	boost::shared_ptr<FILE> hInput = fileCheckOpen(fileName, "r");
+/** Reads a file containing a list of file names
+ * 
+ * Regular files are memory-mapped and parsed in a single pass, and the 
+ * names are copied into one contiguous buffer. Other files, such as pipes 
+ * and files in /proc, whose size is not known in advance, are read into 
+ * memory first. Lines may be of any length.
+ * 
+ * @param[in] fileName the name of a file to be read. The file 
+ *	is assumed to be formatted as a list of strings, one per 
+ *	line. Lines starting with '#' are treated as comments and ignored.
+ * @param[out] fileList a list of strings that stores the filenames in 
+ *	@p fileName. The list may be empty.
+ *
+ * @post Each line of @p fileName, other than comments, is stored in 
+ *	@p fileList with any trailing newline characters removed. Other 
+ *	whitespace is preserved, lest there be a pathological filename.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to store 
+ *	the file list.
+ * @exception kpfutils::except::FileIo Thrown if the file could not be read.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an exception.
+ */	
+void readFileNames(const string& fileName, FileNameList &fileList) {
+	// copy-and-swap
+	FileNameList temp;
 
-	// Read into dates
-	char buffer[250];
-	while(!feof(hInput.get())) {
-		if(ferror(hInput.get())) {
-			fileError(hInput.get(), "Misformatted file: ");
-		}
-		// Empty line
-		if(NULL == fgets(buffer, 250, hInput.get())) {
-			continue;
+	int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0) {
+		throwReadError("Could not open ", fileName);
+	}
+	FdGuard fdGuard(fd);
+	
+	struct stat fileInfo;
+	if (0 != fstat(fd, &fileInfo)) {
+		throwReadError("Could not read ", fileName);
+	}
+	const size_t fileSize = static_cast<size_t>(fileInfo.st_size);
+	
+	// mmap() needs a known, nonzero size
+	if (S_ISREG(fileInfo.st_mode) && fileSize > 0) {
+		void* map = mmap(NULL, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map == MAP_FAILED) {
+			throwReadError("Could not read ", fileName);
 		}
-		// Commented line
-		if(buffer[0] == '#') {
-			continue;
+		MapGuard mapGuard(map, fileSize);
+		madvise(map, fileSize, MADV_SEQUENTIAL);
+		
+		const char* const fileStart = static_cast<const char*>(map);
+		
+		// Every newline becomes a null, so the file size is nearly exact
+		// Don't count lines in advance; that would take a second pass
+		temp.reserve(fileSize + 1, 0);
+		parseNames(fileStart, fileStart + fileSize, temp);
+	} else {
+		vector<char> buffer;
+		readAll(fd, fileName, buffer);
+		if (!buffer.empty()) {
+			temp.reserve(buffer.size() + 1, 0);
+			parseNames(&buffer[0], &buffer[0] + buffer.size(), temp);
 		}
-		// use strtrim to remove any trailing newline
-		// be careful not to remove spaces, lest there be a 
-		//	pathological filename
-		temp.push_back(trim_right_copy_if(string(buffer), &isNewLine));
 	}
 	
 	// IMPORTANT: no exceptions beyond this point
 	
-	swap(fileList, temp);
+	fileList.swap(temp);
 }
 
 }	// end kpfutils
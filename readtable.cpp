@@ -2,7 +2,7 @@
  * @file common/readtable.cpp
  * @author Krzysztof Findeisen
  * @date Created July 25, 2013
- * @date Last modified October 29, 2013
+ * @date Last modified October 18, 2026
  */
 
 /* Copyright 2014, California Institute of Technology.
@@ -28,6 +28,141 @@ namespace kpfutils {
 
 using namespace std;
 
+namespace {
+
+/** Reads a file containing two columns of data into vectors of any 
+ *	floating-point type
+ *
+ * Values are parsed in double precision and then converted to the 
+ * element types of @p col1 and @p col2.
+ *
+ * @exceptsafe Program is in a consistent state in the event of an exception.
+ */
+template <typename T1, typename T2>
+void readColumns(FILE* hInput, const string& format, 
+		vector<T1>& col1, vector<T2>& col2) {
+	// copy-and-swap
+	vector<T1> temp1;
+	vector<T2> temp2;
+	
+	while (!feof(hInput)) {
+		// Save start-of-line
+		fpos_t curLine;
+		if (0 != fgetpos(hInput, &curLine)) {
+			cError("Could not save file position: ");
+		}
+		
+		char lineBuffer[256], commentTest;
+		int nRead;
+
+		// Test whether it's a comment line
+		// Grab the first NON-WHITESPACE character
+		nRead = fscanf(hInput, " %1c\n", &commentTest);
+		if (nRead == EOF) {
+			break;
+		} else if (nRead < 1 || ferror(hInput)) {
+			fileError(hInput, "While looking for first non-whitespace character on file line: ");
+		}
+		
+		if ('#' == commentTest) {
+			// Skip to the next line
+			if(NULL == fgets(lineBuffer, 256, hInput)) {
+				fileError(hInput, "While reading comment line from file: ");
+			}
+		} else {
+			// Not a comment line, so start over and read it in
+			if (0 != fsetpos(hInput, &curLine)) {
+				cError("Could not restore file position: ");
+			}
+
+			double val1, val2;
+			nRead = fscanf(hInput, (format + "\n").c_str(), 
+				&val1, &val2);
+			if(nRead < 1 || ferror(hInput) || nRead == EOF) {
+				fileError(hInput, "Misformatted file: ");
+			}
+
+			temp1.push_back(static_cast<T1>(val1));
+			temp2.push_back(static_cast<T2>(val2));
+		}
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(col1, temp1);
+	swap(col2, temp2);
+}
+
+/** Reads a file containing three columns of data into vectors of any 
+ *	floating-point type
+ *
+ * Values are parsed in double precision and then converted to the 
+ * element types of @p col1, @p col2, and @p col3.
+ *
+ * @exceptsafe Program is in a consistent state in the event of an exception.
+ */
+template <typename T1, typename T2, typename T3>
+void readColumns(FILE* hInput, const string& format, 
+		vector<T1>& col1, vector<T2>& col2, vector<T3>& col3) {
+	// copy-and-swap
+	vector<T1> temp1;
+	vector<T2> temp2;
+	vector<T3> temp3;
+	
+	while (!feof(hInput)) {
+		// Save start-of-line
+		fpos_t curLine;
+		if (0 != fgetpos(hInput, &curLine)) {
+			cError("Could not save file position: ");
+		}
+		
+		char lineBuffer[256], commentTest;
+		int nRead;
+
+		// Test whether it's a comment line
+		// Grab the first NON-WHITESPACE character
+		nRead = fscanf(hInput, " %1c\n", &commentTest);
+		if (nRead == EOF) {
+			break;
+		} else if (nRead < 1 || ferror(hInput)) {
+			fileError(hInput, "While looking for first non-whitespace character on file line: ");
+		}
+		
+		if ('#' == commentTest) {
+			// Skip to the next line
+			if(NULL == fgets(lineBuffer, 256, hInput)) {
+				fileError(hInput, "While reading comment line from file: ");
+			}
+		} else {
+			// Not a comment line, so start over and read it in
+			if (0 != fsetpos(hInput, &curLine)) {
+				cError("Could not restore file position: ");
+			}
+
+			double val1, val2, val3;
+			nRead = fscanf(hInput, (format + "\n").c_str(), 
+				&val1, &val2, &val3);
+			if(nRead < 1 || ferror(hInput) || nRead == EOF) {
+				fileError(hInput, "Misformatted file: ");
+			}
+
+			temp1.push_back(static_cast<T1>(val1));
+			temp2.push_back(static_cast<T2>(val2));
+			temp3.push_back(static_cast<T3>(val3));
+		}
+	}
+	
+	// IMPORTANT: no exceptions beyond this point
+	
+	using std::swap;
+	swap(col1, temp1);
+	swap(col2, temp2);
+	swap(col3, temp3);
+}
+
+}	// end unnamed
+
 /** Reads a file containing two columns of data
  * 
  * @param[in] fileName the name of a file to be read. The file 
@@ -86,56 +221,7 @@ void readTable(const string& fileName, const string& format,
  */
 void readTable(FILE* hInput, const string& format, 
 		vector<double>& col1, vector<double>& col2) {
-	// copy-and-swap
-	vector<double> temp1, temp2;
-	
-	while (!feof(hInput)) {
-		// Save start-of-line
-		fpos_t curLine;
-		if (0 != fgetpos(hInput, &curLine)) {
-			cError("Could not save file position: ");
-		}
-		
-		char lineBuffer[256], commentTest;
-		int nRead;
-
-		// Test whether it's a comment line
-		// Grab the first NON-WHITESPACE character
-		nRead = fscanf(hInput, " %1c\n", &commentTest);
-		if (nRead == EOF) {
-			break;
-		} else if (nRead < 1 || ferror(hInput)) {
-			fileError(hInput, "While looking for first non-whitespace character on file line: ");
-		}
-		
-		if ('#' == commentTest) {
-			// Skip to the next line
-			if(NULL == fgets(lineBuffer, 256, hInput)) {
-				fileError(hInput, "While reading comment line from file: ");
-			}
-		} else {
-			// Not a comment line, so start over and read it in
-			if (0 != fsetpos(hInput, &curLine)) {
-				cError("Could not restore file position: ");
-			}
-
-			double val1, val2;
-			nRead = fscanf(hInput, (format + "\n").c_str(), 
-				&val1, &val2);
-			if(nRead < 1 || ferror(hInput) || nRead == EOF) {
-				fileError(hInput, "Misformatted file: ");
-			}
-
-			temp1.push_back(val1);
-			temp2.push_back(val2);
-		}
-	}
-	
-	// IMPORTANT: no exceptions beyond this point
-	
-	using std::swap;
-	swap(col1, temp1);
-	swap(col2, temp2);
+	readColumns(hInput, format, col1, col2);
 }
 
 /** Reads a file containing three columns of data
@@ -196,58 +282,146 @@ void readTable(const string& fileName, const string& format,
  */
 void readTable(FILE* hInput, const string& format, 
 		vector<double>& col1, vector<double>& col2, vector<double>& col3) {
-	// copy-and-swap
-	vector<double> temp1, temp2, temp3;
-	
-	while (!feof(hInput)) {
-		// Save start-of-line
-		fpos_t curLine;
-		if (0 != fgetpos(hInput, &curLine)) {
-			cError("Could not save file position: ");
-		}
-		
-		char lineBuffer[256], commentTest;
-		int nRead;
+	readColumns(hInput, format, col1, col2, col3);
+}
 
-		// Test whether it's a comment line
-		// Grab the first NON-WHITESPACE character
-		nRead = fscanf(hInput, " %1c\n", &commentTest);
-		if (nRead == EOF) {
-			break;
-		} else if (nRead < 1 || ferror(hInput)) {
-			fileError(hInput, "While looking for first non-whitespace character on file line: ");
-		}
-		
-		if ('#' == commentTest) {
-			// Skip to the next line
-			if(NULL == fgets(lineBuffer, 256, hInput)) {
-				fileError(hInput, "While reading comment line from file: ");
-			}
-		} else {
-			// Not a comment line, so start over and read it in
-			if (0 != fsetpos(hInput, &curLine)) {
-				cError("Could not restore file position: ");
-			}
+/** Reads a file containing two columns of data, storing the second in 
+ *	single precision
+ *
+ * This function behaves exactly like the version taking two vectors of 
+ * @c double, but halves the memory needed for the second column. It is 
+ * intended for measurements whose precision does not justify a @c double, 
+ * paired with times that do.
+ * 
+ * @param[in] fileName the name of a file to be read, formatted as for 
+ *	the version taking two vectors of @c double.
+ * @param[in] format a scanf-style formatting string representing a single row 
+ *	of the table in @p hInput
+ * @param[out] col1, col2 vectors containing the columns of the table
+ *
+ * @pre <tt>scanf(format, ...)</tt> reads exactly two @c double values
+ *
+ * @post @p col1 and @p col2 contain the data contained in the 
+ *	two selected columns of @p fileName, with @p col2 rounded to 
+ *	single precision
+ * @post @p col1.size() = @p col2.size()
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to store 
+ *	the data.
+ * @exception kpfutils::except::FileIo Thrown if any file operation fails.
+ *
+ * @exceptsafe Program is in a consistent state in the event of an exception.
+ */
+void readTable(const string& fileName, const string& format, 
+		vector<double>& col1, vector<float>& col2) {
+	try {
+		boost::shared_ptr<FILE> hInput = fileCheckOpen(fileName, "r");
+		readColumns(hInput.get(), format, col1, col2);
+	} catch (const std::runtime_error& e) {
+		throw except::FileIo(e.what());
+	}
+}
 
-			double val1, val2, val3;
-			nRead = fscanf(hInput, (format + "\n").c_str(), 
-				&val1, &val2, &val3);
-			if(nRead < 1 || ferror(hInput) || nRead == EOF) {
-				fileError(hInput, "Misformatted file: ");
-			}
+/** Reads a file containing two columns of data, storing the second in 
+ *	single precision
+ *
+ * This function behaves exactly like the version taking two vectors of 
+ * @c double, but halves the memory needed for the second column.
+ * 
+ * @param[in] hInput an open file handle to be read, formatted as for 
+ *	the version taking two vectors of @c double.
+ * @param[in] format a scanf-style formatting string representing a single row 
+ *	of the table in @p hInput
+ * @param[out] col1, col2 vectors containing the columns of the table
+ *
+ * @pre <tt>scanf(format, ...)</tt> reads exactly two @c double values
+ *
+ * @post @p col1 and @p col2 contain the data contained in the 
+ *	two selected columns of @p hInput, with @p col2 rounded to 
+ *	single precision
+ * @post @p col1.size() = @p col2.size()
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to store 
+ *	the data.
+ * @exception kpfutils::except::FileIo Thrown if any file operation fails.
+ * @exception std::runtime_error Thrown if file marker becomes invalidated 
+ *	during the read
+ *
+ * @exceptsafe Program is in a consistent state in the event of an exception.
+ */
+void readTable(FILE* hInput, const string& format, 
+		vector<double>& col1, vector<float>& col2) {
+	readColumns(hInput, format, col1, col2);
+}
 
-			temp1.push_back(val1);
-			temp2.push_back(val2);
-			temp3.push_back(val3);
-		}
+/** Reads a file containing three columns of data, storing the second and 
+ *	third in single precision
+ *
+ * This function behaves exactly like the version taking three vectors of 
+ * @c double, but halves the memory needed for the second and third 
+ * columns. It is intended for measurements and errors whose precision 
+ * does not justify a @c double, paired with times that do.
+ * 
+ * @param[in] fileName the name of a file to be read, formatted as for 
+ *	the version taking three vectors of @c double.
+ * @param[in] format a scanf-style formatting string representing a single row 
+ *	of the table in @p hInput
+ * @param[out] col1, col2, col3 vectors containing the columns of the table
+ *
+ * @pre <tt>scanf(format, ...)</tt> reads exactly three @c double values
+ *
+ * @post @p col1, @p col2, and @p col3 contain the data contained in the 
+ *	three selected columns of @p fileName, with @p col2 and @p col3 
+ *	rounded to single precision
+ * @post @p col1.size() = @p col2.size() = @p col3.size()
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to store 
+ *	the data.
+ * @exception kpfutils::except::FileIo Thrown if any file operation fails.
+ *
+ * @exceptsafe Program is in a consistent state in the event of an exception.
+ */
+void readTable(const string& fileName, const string& format, 
+		vector<double>& col1, vector<float>& col2, vector<float>& col3) {
+	try {
+		boost::shared_ptr<FILE> hInput = fileCheckOpen(fileName, "r");
+		readColumns(hInput.get(), format, col1, col2, col3);
+	} catch (const std::runtime_error& e) {
+		throw except::FileIo(e.what());
 	}
-	
-	// IMPORTANT: no exceptions beyond this point
-	
-	using std::swap;
-	swap(col1, temp1);
-	swap(col2, temp2);
-	swap(col3, temp3);
+}
+
+/** Reads a file containing three columns of data, storing the second and 
+ *	third in single precision
+ *
+ * This function behaves exactly like the version taking three vectors of 
+ * @c double, but halves the memory needed for the second and third 
+ * columns.
+ * 
+ * @param[in] hInput an open file handle to be read, formatted as for 
+ *	the version taking three vectors of @c double.
+ * @param[in] format a scanf-style formatting string representing a single row 
+ *	of the table in @p hInput
+ * @param[out] col1, col2, col3 vectors containing the columns of the table
+ *
+ * @pre <tt>scanf(format, ...)</tt> reads exactly three @c double values
+ *
+ * @post @p col1, @p col2, and @p col3 contain the data contained in the 
+ *	three selected columns of @p hInput, with @p col2 and @p col3 
+ *	rounded to single precision
+ * @post @p col1.size() = @p col2.size() = @p col3.size()
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to store 
+ *	the data.
+ * @exception kpfutils::except::FileIo Thrown if any file operation fails.
+ * @exception std::runtime_error Thrown if file marker becomes invalidated 
+ *	during the read
+ *
+ * @exceptsafe Program is in a consistent state in the event of an exception.
+ */
+void readTable(FILE* hInput, const string& format, 
+		vector<double>& col1, vector<float>& col2, vector<float>& col3) {
+	readColumns(hInput, format, col1, col2, col3);
 }
 
 }	// end kpfutils
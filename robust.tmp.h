@@ -0,0 +1,396 @@
+/** Outlier-resistant statistics for data sets in containers
+ * @file common/robust.tmp.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#ifndef KPFUTILSROBUSTH
+#define KPFUTILSROBUSTH
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <cmath>
+#include <boost/concept/requires.hpp>
+#include <boost/iterator/iterator_concepts.hpp>
+#include "stats.tmp.h"
+#include "stats_except.h"
+
+namespace kpfutils {
+
+/** @addtogroup stats
+ *
+ * Include robust.tmp.h for statistics that resist outliers.
+ *
+ * @{
+ */
+
+/** Ratio of the standard deviation to the median absolute deviation of a
+ *	normal distribution. Multiply medianAbsDev() by this factor to get a
+ *	robust estimate of sigma.
+ */
+const double MAD_TO_SIGMA = 1.482602218505602;
+
+/** Summary of a sigma-clipped data set, as returned by sigmaClip()
+ */
+struct ClipResult {
+	/** Creates a summary of an empty data set.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	ClipResult() : center(0.0), mean(0.0), stdDev(0.0), nUsed(0),
+			iterations(0), converged(false) {
+	}
+
+	/** Median of the retained values
+	 */
+	double center;
+	/** Mean of the retained values
+	 */
+	double mean;
+	/** Sample standard deviation of the retained values
+	 */
+	double stdDev;
+	/** Number of retained values
+	 */
+	size_t nUsed;
+	/** Number of clipping passes that changed the set of retained values
+	 */
+	size_t iterations;
+	/** True if the last clipping pass left the retained values unchanged
+	 */
+	bool converged;
+};
+
+namespace detail {
+
+/** Fills in the statistics of a set of retained values
+ *
+ * @param[in,out] retained The values to summarize. On output, they are
+ *	reordered as by std::nth_element().
+ * @param[out] result The summary to update.
+ *
+ * @pre @p retained.size() >= 2
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+inline void clipStats(std::vector<double>& retained, ClipResult& result) {
+	const std::pair<double, double> stats
+		= kpfutils::meanVariance(retained.begin(), retained.end());
+	result.mean   = stats.first;
+	result.stdDev = std::sqrt(stats.second);
+	result.nUsed  = retained.size();
+
+	std::vector<double>::iterator mid = retained.begin()
+		+ quantileIndex(0.5, retained.size());
+	std::nth_element(retained.begin(), mid, retained.end());
+	result.center = *mid;
+}
+
+}	// end detail
+
+/** Finds the median absolute deviation of the values in a generic
+ *	container object. The container class is accessed using first and
+ *	last iterators, and the deviation is computed over the interval
+ *	[first, last).
+ *
+ * The median absolute deviation is the median of |x - median(x)|. It
+ * ignores up to half the data, however extreme, making it a robust measure
+ * of spread. Both medians follow the same convention as quantile().
+ *
+ * @tparam ConstForwardIterator The iterator type for the container over which the
+ *	deviation is to be calculated. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
+ * @param[in] first Input iterator marking the first element in the
+ *	container.
+ * @param[in] last Input iterator marking the position after the last
+ *	element in the container.
+ * @param[in,out] scratch A buffer to use for the computation. Its contents
+ *	on input are ignored, and its contents on output are unspecified.
+ *	The buffer's capacity is retained for later calls.
+ *
+ * @return The median absolute deviation of the elements between @p first,
+ *	inclusive, and @p last, exclusive.
+ *
+ * @pre [@p first, @p last) is a valid range
+ * @pre [@p first, @p last) does not overlap @p scratch
+ * @pre No value in [@p first, @p last) is NaN
+ *
+ * @post The return value is not NaN, and is nonnegative
+ *
+ * @perform O(D) on average, where D = std::distance(@p first, @p last).
+ * @perform Does not allocate memory if @p scratch.capacity() >= D.
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are not enough
+ *	elements to define a deviation.
+ * @exception std::bad_alloc Thrown if @p scratch could not be enlarged.
+ *
+ * @exceptsafe The range [@p first, @p last) is unchanged in the event of
+ *	an exception. The contents of @p scratch are unspecified.
+ *
+ * @test Vector of doubles, length 100, randomly generated. Expected
+ *	behavior: equals the median of the absolute differences from the
+ *	median, found by sorting.
+ * @test List of ints, length 100, randomly generated. Expected behavior:
+ *	equals the median of the absolute differences from the median, found
+ *	by sorting.
+ */
+template <typename ConstForwardIterator> 				// Iterator to use
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstForwardIterator>))
+	((ForwardTraversalConcept<ConstForwardIterator>)),	// Iterator semantics
+	(typename std::iterator_traits<ConstForwardIterator>::value_type)) // Return type
+medianAbsDev(ConstForwardIterator first, ConstForwardIterator last,
+		std::vector<typename std::iterator_traits<ConstForwardIterator>::value_type>& scratch) {
+	typedef typename std::iterator_traits<ConstForwardIterator>::value_type Value;
+	typedef typename std::vector<Value>::iterator Iterator;
+
+	scratch.assign(first, last);
+	if (scratch.size() < 1) {
+		throw except::NotEnoughData("Supplied empty data set to medianAbsDev()");
+	}
+
+	Iterator mid = scratch.begin() + detail::quantileIndex(0.5, scratch.size());
+	std::nth_element(scratch.begin(), mid, scratch.end());
+	const Value median = *mid;
+
+	// Written to avoid wraparound for unsigned types
+	for (Iterator it = scratch.begin(); it != scratch.end(); it++) {
+		*it = (*it < median ? median - *it : *it - median);
+	}
+	std::nth_element(scratch.begin(), mid, scratch.end());
+
+	return *mid;
+}
+
+/** Finds the median absolute deviation of the values in a generic
+ *	container object. The container class is accessed using first and
+ *	last iterators, and the deviation is computed over the interval
+ *	[first, last).
+ *
+ * @tparam ConstForwardIterator The iterator type for the container over which the
+ *	deviation is to be calculated. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
+ * @param[in] first Input iterator marking the first element in the
+ *	container.
+ * @param[in] last Input iterator marking the position after the last
+ *	element in the container.
+ *
+ * @return The median absolute deviation of the elements between @p first,
+ *	inclusive, and @p last, exclusive.
+ *
+ * @pre [@p first, @p last) is a valid range
+ * @pre No value in [@p first, @p last) is NaN
+ *
+ * @post The return value is not NaN, and is nonnegative
+ *
+ * @perform O(D) on average, where D = std::distance(@p first, @p last).
+ * @perform Allocates a copy of the data on every call. Use the overload
+ *	taking a scratch buffer to avoid this.
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are not enough
+ *	elements to define a deviation.
+ *
+ * @exceptsafe The range [@p first, @p last) is unchanged in the event of
+ *	an exception.
+ *
+ * @test List of ints, length 0. Expected behavior: throw NotEnoughData.
+ * @test List of ints, length 1. Expected behavior: return 0.
+ */
+template <typename ConstForwardIterator> 				// Iterator to use
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstForwardIterator>))
+	((ForwardTraversalConcept<ConstForwardIterator>)),	// Iterator semantics
+	(typename std::iterator_traits<ConstForwardIterator>::value_type)) // Return type
+medianAbsDev(ConstForwardIterator first, ConstForwardIterator last) {
+	typedef typename std::iterator_traits<ConstForwardIterator>::value_type Value;
+
+	std::vector<Value> scratch;
+	return kpfutils::medianAbsDev(first, last, scratch);
+}
+
+/** Iteratively rejects outliers from the values in a generic container
+ *	object. The container class is accessed using first and last
+ *	iterators, and the clipping is done over the interval [first, last).
+ *
+ * On each pass, values farther than @p nSigma standard deviations from the
+ * median of the currently retained values are rejected, and previously
+ * rejected values that now fall within the limits are restored. Passes
+ * continue until one leaves the retained set unchanged, or until
+ * @p maxIter passes have changed it.
+ *
+ * Each pass reads the data once, flipping only the entries of @p mask
+ * whose status changes, and gathers the retained values into @p scratch
+ * for the next median and variance. No pass sorts the data.
+ *
+ * @tparam ConstForwardIterator The iterator type for the container to be
+ *	clipped. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
+ * @param[in] first Input iterator marking the first element in the
+ *	container.
+ * @param[in] last Input iterator marking the position after the last
+ *	element in the container.
+ * @param[in] nSigma The clipping threshold, in units of the standard
+ *	deviation of the retained values.
+ * @param[out] mask On output, has one entry per element of
+ *	[@p first, @p last), nonzero if the element was retained and zero
+ *	if it was rejected.
+ * @param[in,out] scratch A buffer to use for the computation. Its contents
+ *	on input are ignored, and its contents on output are unspecified.
+ *	The buffer's capacity is retained for later calls.
+ * @param[in] maxIter The maximum number of passes that may change the
+ *	retained values. If zero, no values are rejected.
+ *
+ * @return The median, mean, and standard deviation of the retained values,
+ *	their number, the number of passes that changed them, and whether
+ *	the clipping converged.
+ *
+ * @pre [@p first, @p last) is a valid range
+ * @pre [@p first, @p last) does not overlap @p scratch
+ * @pre No value in [@p first, @p last) is NaN
+ *
+ * @post @p mask.size() = std::distance(@p first, @p last)
+ * @post The number of nonzero entries in @p mask equals the returned nUsed
+ *
+ * @perform O(D &times; I) on average, where D = std::distance(@p first, @p last)
+ *	and I is the number of passes.
+ * @perform Does not allocate memory if @p mask.capacity() >= D and
+ *	@p scratch.capacity() >= D.
+ *
+ * @exception std::invalid_argument Thrown if @p nSigma is not positive.
+ * @exception kpfutils::except::NotEnoughData Thrown if fewer than two
+ *	values are given, or if fewer than two values survive clipping.
+ * @exception std::bad_alloc Thrown if @p mask or @p scratch could not be
+ *	enlarged.
+ *
+ * @exceptsafe The range [@p first, @p last) is unchanged in the event of
+ *	an exception. The contents of @p mask and @p scratch are unspecified.
+ *
+ * @test Vector of doubles, length 100, randomly generated, with three
+ *	values replaced by outliers, nSigma = 3. Expected behavior: the
+ *	outliers are masked out, the clipping converges, and the mean and
+ *	median match those of the retained values.
+ * @test As above, called twice with the same buffers. Expected behavior:
+ *	identical results.
+ * @test Vector of doubles, length 100, maxIter = 0. Expected behavior:
+ *	all values retained, converged = false.
+ * @test Vector of doubles, nSigma = 0. Expected behavior: throw
+ *	invalid_argument.
+ */
+template <typename ConstForwardIterator> 				// Iterator to use
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstForwardIterator>))
+	((ForwardTraversalConcept<ConstForwardIterator>)),	// Iterator semantics
+	(ClipResult)) // Return type
+sigmaClip(ConstForwardIterator first, ConstForwardIterator last, double nSigma,
+		std::vector<unsigned char>& mask, std::vector<double>& scratch,
+		size_t maxIter = 10) {
+	if (!(nSigma > 0.0)) {
+		throw std::invalid_argument("Clipping threshold must be positive in sigmaClip()");
+	}
+
+	scratch.assign(first, last);
+	if (scratch.size() < 2) {
+		throw except::NotEnoughData("Not enough data to clip in sigmaClip()");
+	}
+	mask.assign(scratch.size(), 1);
+
+	ClipResult result;
+	detail::clipStats(scratch, result);
+
+	while (result.iterations < maxIter) {
+		const double lower = result.center - nSigma * result.stdDev;
+		const double upper = result.center + nSigma * result.stdDev;
+
+		bool changed = false;
+		scratch.clear();
+		std::vector<unsigned char>::iterator flag = mask.begin();
+		for (ConstForwardIterator it = first; it != last; it++, flag++) {
+			const double x = static_cast<double>(*it);
+			const unsigned char keep = (x >= lower && x <= upper ? 1 : 0);
+			if (keep != *flag) {
+				*flag   = keep;
+				changed = true;
+			}
+			if (keep) {
+				scratch.push_back(x);
+			}
+		}
+
+		if (!changed) {
+			result.converged = true;
+			break;
+		}
+		result.iterations++;
+
+		if (scratch.size() < 2) {
+			throw except::NotEnoughData("Too few values survived clipping in sigmaClip()");
+		}
+		detail::clipStats(scratch, result);
+	}
+
+	return result;
+}
+
+/** Iteratively rejects outliers from the values in a generic container
+ *	object. The container class is accessed using first and last
+ *	iterators, and the clipping is done over the interval [first, last).
+ *
+ * This overload is a convenience for one-off calls. When clipping many
+ * data sets, use the overload taking a mask and scratch buffer so that
+ * memory can be reused.
+ *
+ * @tparam ConstForwardIterator The iterator type for the container to be
+ *	clipped. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
+ * @param[in] first Input iterator marking the first element in the
+ *	container.
+ * @param[in] last Input iterator marking the position after the last
+ *	element in the container.
+ * @param[in] nSigma The clipping threshold, in units of the standard
+ *	deviation of the retained values.
+ * @param[in] maxIter The maximum number of passes that may change the
+ *	retained values. If zero, no values are rejected.
+ *
+ * @return The median, mean, and standard deviation of the retained values,
+ *	their number, the number of passes that changed them, and whether
+ *	the clipping converged.
+ *
+ * @pre [@p first, @p last) is a valid range
+ * @pre No value in [@p first, @p last) is NaN
+ *
+ * @perform O(D &times; I) on average, where D = std::distance(@p first, @p last)
+ *	and I is the number of passes.
+ *
+ * @exception std::invalid_argument Thrown if @p nSigma is not positive.
+ * @exception kpfutils::except::NotEnoughData Thrown if fewer than two
+ *	values are given, or if fewer than two values survive clipping.
+ * @exception std::bad_alloc Thrown if there is not enough memory for
+ *	the computation.
+ *
+ * @exceptsafe The range [@p first, @p last) is unchanged in the event of
+ *	an exception.
+ */
+template <typename ConstForwardIterator> 				// Iterator to use
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstForwardIterator>))
+	((ForwardTraversalConcept<ConstForwardIterator>)),	// Iterator semantics
+	(ClipResult)) // Return type
+sigmaClip(ConstForwardIterator first, ConstForwardIterator last, double nSigma,
+		size_t maxIter = 10) {
+	std::vector<unsigned char> mask;
+	std::vector<double> scratch;
+	return kpfutils::sigmaClip(first, last, nSigma, mask, scratch, maxIter);
+}
+
+/** @} */	// end stats
+
+}	// end kpfutils
+
+#endif		// KPFUTILSROBUSTH
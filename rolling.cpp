@@ -0,0 +1,371 @@
+/** Statistics in sliding time windows
+ * @file common/rolling.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#include <algorithm>
+#include <limits>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+#include "rolling.h"
+#include "sorted.tmp.h"
+#include "stats.tmp.h"
+
+namespace kpfutils {
+
+namespace {
+
+/** Checks that a time series can be given to a rolling statistic
+ *
+ * @exception std::invalid_argument Thrown if @p times and @p data have
+ *	different lengths, if @p halfWidth is negative or NaN, or if
+ *	@p checkOrder is set and @p times is not sorted in ascending order.
+ */
+void checkSeries(const std::vector<double>& times, const std::vector<double>& data,
+		double halfWidth, const char* caller, bool checkOrder) {
+	if (times.size() != data.size()) {
+		throw std::invalid_argument(std::string("Times and data have different lengths in ")
+			+ caller + "()");
+	}
+	if (!(halfWidth >= 0.0)) {
+		throw std::invalid_argument(std::string("Window width must be nonnegative in ")
+			+ caller + "()");
+	}
+	if (checkOrder && !isSorted(times.begin(), times.end())) {
+		throw std::invalid_argument(std::string("Times must be sorted in ")
+			+ caller + "()");
+	}
+}
+
+/** Order statistic of a multiset that supports insertion and removal
+ *
+ * The values are split between two sets so that every value in @p low
+ * is less than or equal to every value in @p high, and @p low holds
+ * exactly the values up to and including the requested quantile. The
+ * quantile is then the largest value in @p low.
+ */
+class QuantileWindow {
+public:
+	/** Creates an empty window.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	explicit QuantileWindow(double quantile) : quantile(quantile), low(), high() {
+	}
+
+	/** Adds a value to the window in O(log w) time.
+	 *
+	 * @exceptsafe The window is unchanged in the event of an exception.
+	 */
+	void insert(double x) {
+		if (!low.empty() && x <= *low.rbegin()) {
+			low.insert(x);
+		} else {
+			high.insert(x);
+		}
+	}
+
+	/** Removes one copy of a value from the window in O(log w) time.
+	 *
+	 * @pre @p x is in the window
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	void erase(double x) {
+		// If x equals the largest value in low, low must contain it
+		if (!low.empty() && x <= *low.rbegin()) {
+			low.erase(low.find(x));
+		} else {
+			high.erase(high.find(x));
+		}
+	}
+
+	/** Returns the quantile of the values in the window.
+	 *
+	 * @pre The window is not empty
+	 *
+	 * @perform Amortized O(log w) per insertion or removal since the
+	 *	last call.
+	 *
+	 * @exceptsafe The window's contents are unchanged in the event of an
+	 *	exception.
+	 */
+	double value() {
+		const size_t target = detail::quantileIndex(quantile, low.size() + high.size()) + 1;
+		while (low.size() > target) {
+			std::multiset<double>::iterator top = --low.end();
+			high.insert(high.begin(), *top);
+			low.erase(top);
+		}
+		while (low.size() < target) {
+			std::multiset<double>::iterator bottom = high.begin();
+			low.insert(low.end(), *bottom);
+			high.erase(bottom);
+		}
+		return *low.rbegin();
+	}
+
+private:
+	double quantile;
+	std::multiset<double> low;
+	std::multiset<double> high;
+};
+
+/** Computes the mean and standard deviation of a time series in a sliding
+ *	window, assuming valid input
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an
+ *	exception.
+ */
+void meanRms(const std::vector<double>& times, const std::vector<double>& data,
+		double halfWidth, std::vector<double>& means, std::vector<double>& rms) {
+	const size_t n = times.size();
+	std::vector<double> tempMeans(n), tempRms(n);
+
+	size_t first = 0, last = 0, removed = 0;
+	double count = 0.0, mean = 0.0, m2 = 0.0;
+	for (size_t i = 0; i < n; i++) {
+		for (; last < n && times[last] - times[i] <= halfWidth; last++) {
+			const double x = data[last];
+			count += 1.0;
+			const double delta = x - mean;
+			mean += delta / count;
+			m2   += delta * (x - mean);
+		}
+		for (; times[i] - times[first] > halfWidth; first++) {
+			const double x = data[first];
+			count -= 1.0;
+			const double delta = x - mean;
+			mean -= delta / count;
+			m2   -= delta * (x - mean);
+			removed++;
+		}
+
+		// Removals accumulate roundoff error; once the window has
+		//	turned over, start afresh. This costs O(1) per step on average.
+		if (removed >= last - first) {
+			detail::blockMoments(&data[first], last - first, mean, m2);
+			removed = 0;
+		}
+
+		tempMeans[i] = mean;
+		// Removal can leave a tiny negative residue
+		tempRms[i] = (count > 1.0
+			? std::sqrt(std::max(m2, 0.0) / (count - 1.0))
+			: std::numeric_limits<double>::quiet_NaN());
+	}
+
+	using std::swap;
+	swap(means, tempMeans);
+	swap(rms, tempRms);
+}
+
+/** Computes a quantile of a time series in a sliding window, assuming
+ *	valid input
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an
+ *	exception.
+ */
+void windowQuantile(const std::vector<double>& times, const std::vector<double>& data,
+		double halfWidth, double quantile, std::vector<double>& result) {
+	const size_t n = times.size();
+	std::vector<double> temp(n);
+	QuantileWindow window(quantile);
+
+	size_t first = 0, last = 0;
+	for (size_t i = 0; i < n; i++) {
+		for (; last < n && times[last] - times[i] <= halfWidth; last++) {
+			window.insert(data[last]);
+		}
+		for (; times[i] - times[first] > halfWidth; first++) {
+			window.erase(data[first]);
+		}
+		temp[i] = window.value();
+	}
+
+	using std::swap;
+	swap(result, temp);
+}
+
+}	// end unnamed
+
+/** Computes the mean and standard deviation of a time series in a sliding
+ *	window.
+ *
+ * The mean and variance are updated incrementally (Welford 1962) as
+ * measurements enter and leave the window, so the total cost does not
+ * depend on the window width.
+ *
+ * @param[in] times The times at which @p data were measured.
+ * @param[in] data The measurements to summarize.
+ * @param[in] halfWidth The maximum time difference between the center of
+ *	a window and the measurements in it, in the same units as @p times.
+ * @param[out] means On output, @p means[i] is the mean of the measurements
+ *	in the window around @p times[i].
+ * @param[out] rms On output, @p rms[i] is the sample standard deviation of
+ *	the measurements in the window around @p times[i], or NaN if the
+ *	window holds only one measurement.
+ *
+ * @pre No value in @p data is NaN
+ *
+ * @post @p means.size() = @p rms.size() = @p times.size()
+ *
+ * @perform O(N), where N = @p times.size().
+ *
+ * @exception std::invalid_argument Thrown if @p times and @p data have
+ *	different lengths, if @p halfWidth is negative, or if @p times is
+ *	not sorted in ascending order.
+ * @exception std::bad_alloc Thrown if there is not enough memory for
+ *	the output.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an
+ *	exception.
+ *
+ * @test Times spaced 0.3 apart with repeats, random data, halfWidth = 0,
+ *	1.0, or 100. Expected behavior: agrees with mean() and variance()
+ *	of each window to within 1e-8.
+ * @test Times and data of different lengths. Expected behavior: throw
+ *	invalid_argument.
+ */
+void rollingMeanRms(const std::vector<double>& times, const std::vector<double>& data,
+		double halfWidth, std::vector<double>& means, std::vector<double>& rms) {
+	checkSeries(times, data, halfWidth, "rollingMeanRms", true);
+	meanRms(times, data, halfWidth, means, rms);
+}
+
+/** Computes a quantile of a time series in a sliding window.
+ *
+ * The measurements in the window are kept in an ordered structure that is
+ * updated as measurements enter and leave, so each update costs
+ * O(log w), where w is the number of measurements in a window. The
+ * quantile follows the same convention as quantile().
+ *
+ * @param[in] times The times at which @p data were measured.
+ * @param[in] data The measurements to summarize.
+ * @param[in] halfWidth The maximum time difference between the center of
+ *	a window and the measurements in it, in the same units as @p times.
+ * @param[in] quantile The quantile to find in each window.
+ * @param[out] result On output, @p result[i] is the quantile of the
+ *	measurements in the window around @p times[i].
+ *
+ * @pre No value in @p data is NaN
+ *
+ * @post @p result.size() = @p times.size()
+ *
+ * @perform O(N log w), where N = @p times.size().
+ *
+ * @exception std::invalid_argument Thrown if @p times and @p data have
+ *	different lengths, if @p halfWidth is negative, if @p times is not
+ *	sorted in ascending order, or if @p quantile is not in the interval
+ *	[0, 1].
+ * @exception std::bad_alloc Thrown if there is not enough memory for
+ *	the computation.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an
+ *	exception.
+ *
+ * @test Times spaced 0.3 apart with repeats, random data, halfWidth = 0,
+ *	1.0, or 100, quantile = 0.0, 0.5, or 0.9. Expected behavior: agrees
+ *	with quantile() of each window.
+ * @test Unsorted times. Expected behavior: throw invalid_argument.
+ */
+void rollingQuantile(const std::vector<double>& times, const std::vector<double>& data,
+		double halfWidth, double quantile, std::vector<double>& result) {
+	checkSeries(times, data, halfWidth, "rollingQuantile", true);
+	detail::checkQuantile(quantile, "rollingQuantile");
+	windowQuantile(times, data, halfWidth, quantile, result);
+}
+
+/** Computes the mean and standard deviation of a time series in a sliding
+ *	window, without checking the order of the times.
+ *
+ * This function behaves exactly like the version taking a plain vector of
+ * times, but skips the O(N) check that the times are sorted.
+ *
+ * @param[in] times The times at which @p data were measured.
+ * @param[in] data The measurements to summarize.
+ * @param[in] halfWidth The maximum time difference between the center of
+ *	a window and the measurements in it, in the same units as @p times.
+ * @param[out] means On output, @p means[i] is the mean of the measurements
+ *	in the window around the ith time.
+ * @param[out] rms On output, @p rms[i] is the sample standard deviation of
+ *	the measurements in the window around the ith time, or NaN if the
+ *	window holds only one measurement.
+ *
+ * @pre No value in @p data is NaN
+ *
+ * @post @p means.size() = @p rms.size() = @p times.size()
+ *
+ * @perform O(N), where N = @p times.size().
+ *
+ * @exception std::invalid_argument Thrown if @p times and @p data have
+ *	different lengths or if @p halfWidth is negative.
+ * @exception std::bad_alloc Thrown if there is not enough memory for
+ *	the output.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an
+ *	exception.
+ *
+ * @test Times spaced 0.3 apart with repeats, marked as sorted, random
+ *	data, halfWidth = 1.0. Expected behavior: same results as for
+ *	an ordinary vector.
+ */
+void rollingMeanRms(const Sorted<std::vector<double> >& times, const std::vector<double>& data,
+		double halfWidth, std::vector<double>& means, std::vector<double>& rms) {
+	checkSeries(times.get(), data, halfWidth, "rollingMeanRms", false);
+	meanRms(times.get(), data, halfWidth, means, rms);
+}
+
+/** Computes a quantile of a time series in a sliding window, without
+ *	checking the order of the times.
+ *
+ * This function behaves exactly like the version taking a plain vector of
+ * times, but skips the O(N) check that the times are sorted.
+ *
+ * @param[in] times The times at which @p data were measured.
+ * @param[in] data The measurements to summarize.
+ * @param[in] halfWidth The maximum time difference between the center of
+ *	a window and the measurements in it, in the same units as @p times.
+ * @param[in] quantile The quantile to find in each window.
+ * @param[out] result On output, @p result[i] is the quantile of the
+ *	measurements in the window around the ith time.
+ *
+ * @pre No value in @p data is NaN
+ *
+ * @post @p result.size() = @p times.size()
+ *
+ * @perform O(N log w), where N = @p times.size().
+ *
+ * @exception std::invalid_argument Thrown if @p times and @p data have
+ *	different lengths, if @p halfWidth is negative, or if @p quantile
+ *	is not in the interval [0, 1].
+ * @exception std::bad_alloc Thrown if there is not enough memory for
+ *	the computation.
+ *
+ * @exceptsafe The function arguments are unchanged in the event of an
+ *	exception.
+ *
+ * @test Times spaced 0.3 apart with repeats, marked as sorted, random
+ *	data, halfWidth = 1.0, quantile = 0.5. Expected behavior: same
+ *	results as for an ordinary vector.
+ */
+void rollingQuantile(const Sorted<std::vector<double> >& times, const std::vector<double>& data,
+		double halfWidth, double quantile, std::vector<double>& result) {
+	checkSeries(times.get(), data, halfWidth, "rollingQuantile", false);
+	detail::checkQuantile(quantile, "rollingQuantile");
+	windowQuantile(times.get(), data, halfWidth, quantile, result);
+}
+
+}	// end kpfutils
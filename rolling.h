@@ -0,0 +1,87 @@
+/** Statistics in sliding time windows
+ * @file common/rolling.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#ifndef KPFUTILSROLLINGH
+#define KPFUTILSROLLINGH
+
+#include <vector>
+
+namespace kpfutils {
+
+template <class Container> class Sorted;
+
+/** @addtogroup stats
+ *
+ * Include rolling.h to compute statistics in a window that slides along
+ * a time series.
+ *
+ * In all of these functions, the window around the ith measurement holds
+ * every measurement whose time differs from @p times[i] by at most
+ * @p halfWidth. Windows are found by advancing two indices along the
+ * time column, so each measurement enters and leaves a window only once.
+ *
+ * @{
+ */
+
+/** Computes the mean and standard deviation of a time series in a sliding
+ *	window.
+ */
+void rollingMeanRms(const std::vector<double>& times, const std::vector<double>& data,
+	double halfWidth, std::vector<double>& means, std::vector<double>& rms);
+
+/** Computes the mean and standard deviation of a time series in a sliding
+ *	window, without checking the order of the times.
+ */
+void rollingMeanRms(const Sorted<std::vector<double> >& times, const std::vector<double>& data,
+	double halfWidth, std::vector<double>& means, std::vector<double>& rms);
+
+/** Computes a quantile of a time series in a sliding window.
+ */
+void rollingQuantile(const std::vector<double>& times, const std::vector<double>& data,
+	double halfWidth, double quantile, std::vector<double>& result);
+
+/** Computes a quantile of a time series in a sliding window, without
+ *	checking the order of the times.
+ */
+void rollingQuantile(const Sorted<std::vector<double> >& times, const std::vector<double>& data,
+	double halfWidth, double quantile, std::vector<double>& result);
+
+/** Computes the median of a time series in a sliding window.
+ *
+ * Equivalent to rollingQuantile(@p times, @p data, @p halfWidth, 0.5, @p result).
+ *
+ * @see rollingQuantile()
+ */
+inline void rollingMedian(const std::vector<double>& times, const std::vector<double>& data,
+		double halfWidth, std::vector<double>& result) {
+	rollingQuantile(times, data, halfWidth, 0.5, result);
+}
+
+/** Computes the median of a time series in a sliding window, without
+ *	checking the order of the times.
+ *
+ * Equivalent to rollingQuantile(@p times, @p data, @p halfWidth, 0.5, @p result).
+ *
+ * @see rollingQuantile()
+ */
+inline void rollingMedian(const Sorted<std::vector<double> >& times, const std::vector<double>& data,
+		double halfWidth, std::vector<double>& result) {
+	rollingQuantile(times, data, halfWidth, 0.5, result);
+}
+
+/** @} */	// end stats
+
+}	// end kpfutils
+
+#endif		// KPFUTILSROLLINGH
@@ -0,0 +1,422 @@
+/** Streaming quantile estimation with bounded memory
+ * @file common/sketch.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <locale>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include <cmath>
+#include "sketch.h"
+#include "stats.tmp.h"
+#include "stats_except.h"
+
+namespace {
+
+/** First line of every serialized sketch
+ */
+const char* const SKETCH_MAGIC = "#kpfutils sketch 1";
+
+/** Ratio of the capacities of adjacent levels
+ */
+const double LEVEL_RATIO = 2.0/3.0;
+
+}	// end anonymous namespace
+
+namespace kpfutils {
+
+using std::string;
+using std::vector;
+
+/** Creates an empty sketch.
+ *
+ * @param[in] k The accuracy parameter. Larger values of @p k give more
+ *	accurate quantiles at the cost of more memory; the rank error
+ *	is approximately proportional to 1/@p k.
+ * @param[in] seed The seed for the sketch's random number generator.
+ *
+ * @pre @p k >= 8
+ *
+ * @exception std::invalid_argument Thrown if @p k < 8.
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	create the sketch.
+ *
+ * @exceptsafe Object construction is atomic.
+ */
+QuantileSketch::QuantileSketch(size_t k, unsigned int seed) : k(k), n(0),
+		minValue(0.0), maxValue(0.0), levels(), size(0), maxSize(0),
+		rng(seed) {
+	if (k < 8) {
+		throw std::invalid_argument("QuantileSketch needs an accuracy parameter of at least 8.");
+	}
+	grow();
+}
+
+/** Adds a value to the sketch.
+ *
+ * @param[in] value The value to add.
+ *
+ * @pre @p value is not NaN
+ *
+ * @post count() is increased by 1.
+ *
+ * @perform Amortized O(log k).
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	store the value.
+ *
+ * @exceptsafe The sketch is in a valid state, but may not include
+ *	@p value, in the event of an exception.
+ */
+void QuantileSketch::add(double value) {
+	if (n == 0) {
+		minValue = maxValue = value;
+	} else {
+		minValue = std::min(minValue, value);
+		maxValue = std::max(maxValue, value);
+	}
+
+	levels[0].push_back(value);
+	size++;
+	n++;
+	if (size >= maxSize) {
+		compress();
+	}
+}
+
+/** Adds all the values summarized by another sketch to this one.
+ *
+ * If the two sketches have different accuracy parameters, the merged
+ * sketch keeps this sketch's parameter, but is no more accurate than
+ * the less accurate of the two.
+ *
+ * @param[in] other The sketch to merge. May be this sketch.
+ *
+ * @post count() is increased by @p other.count().
+ *
+ * @perform O(k log(N/k)), where N is the combined count.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	merge the sketches.
+ *
+ * @exceptsafe This sketch is in a valid but unspecified state in the
+ *	event of an exception.
+ */
+void QuantileSketch::merge(const QuantileSketch& other) {
+	if (&other == this) {
+		const QuantileSketch copy(other);
+		merge(copy);
+		return;
+	}
+	if (other.n == 0) {
+		return;
+	}
+
+	if (n == 0) {
+		minValue = other.minValue;
+		maxValue = other.maxValue;
+	} else {
+		minValue = std::min(minValue, other.minValue);
+		maxValue = std::max(maxValue, other.maxValue);
+	}
+
+	while (levels.size() < other.levels.size()) {
+		grow();
+	}
+	for(size_t h = 0; h < other.levels.size(); h++) {
+		levels[h].insert(levels[h].end(),
+			other.levels[h].begin(), other.levels[h].end());
+	}
+	size += other.size;
+	n    += other.n;
+
+	while (size >= maxSize) {
+		compress();
+	}
+}
+
+/** Estimates a quantile of the values added so far.
+ *
+ * The quantile follows the same convention as
+ * @ref kpfutils::quantile() "quantile()", and the result is exact
+ * if the sketch has not yet compacted any values.
+ *
+ * @param[in] quantile The percentile to recover.
+ *
+ * @return An estimate of the largest value whose quantile is less than
+ *	or equal to @p quantile. The estimate's rank is within about
+ *	1.7% (for k = 200) of the requested rank, with 99% confidence.
+ *	Quantiles of 0 and 1 return the exact minimum and maximum.
+ *
+ * @perform O(R log R), where R = retained().
+ *
+ * @exception std::invalid_argument Thrown if @p quantile is not
+ *	in the interval [0, 1].
+ * @exception kpfutils::except::NotEnoughData Thrown if no values have
+ *	been added to the sketch.
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	compute the quantile.
+ *
+ * @exceptsafe The sketch is unchanged in the event of an exception.
+ */
+double QuantileSketch::quantile(double quantile) const {
+	detail::checkQuantile(quantile, "QuantileSketch::quantile");
+	if (n == 0) {
+		throw except::NotEnoughData("Supplied empty sketch to QuantileSketch::quantile()");
+	}
+	if (quantile == 0.0) {
+		return minValue;
+	} else if (quantile == 1.0) {
+		return maxValue;
+	}
+
+	// Weight of each value, as a power of two
+	vector<std::pair<double, size_t> > weighted;
+	weighted.reserve(size);
+	for(size_t h = 0; h < levels.size(); h++) {
+		for(vector<double>::const_iterator it = levels[h].begin();
+				it != levels[h].end(); it++) {
+			weighted.push_back(std::make_pair(*it, h));
+		}
+	}
+	std::sort(weighted.begin(), weighted.end());
+
+	// Rank to find, counting from 0
+	const double target = static_cast<double>(
+		detail::quantileIndex(quantile, static_cast<size_t>(n)));
+	double cumulative = 0.0;
+	for(vector<std::pair<double, size_t> >::const_iterator it = weighted.begin();
+			it != weighted.end(); it++) {
+		cumulative += std::ldexp(1.0, static_cast<int>(it->second));
+		if (cumulative > target) {
+			return it->first;
+		}
+	}
+	return maxValue;
+}
+
+/** Returns the number of values currently stored by the sketch.
+ *
+ * @return The number of values in memory, which is O(k log(count()/k)).
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t QuantileSketch::retained() const {
+	return size;
+}
+
+/** Encodes the sketch as a string.
+ *
+ * The encoding is a short text table: a header line, a line giving the
+ * accuracy parameter, count, minimum, maximum, and number of levels, and
+ * one line per level listing its size and values. Values are written
+ * with full precision, so deserialize() recreates the sketch exactly
+ * (apart from the state of the random number generator).
+ *
+ * @return A string from which deserialize() can recreate the sketch.
+ *
+ * @perform O(R), where R = retained().
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	encode the sketch.
+ *
+ * @exceptsafe The sketch is unchanged in the event of an exception.
+ */
+string QuantileSketch::serialize() const {
+	// Must match the locale used by deserialize()
+	std::ostringstream output;
+	output.imbue(std::locale::classic());
+	output << std::setprecision(17);
+
+	output << SKETCH_MAGIC << '\n';
+	output << static_cast<unsigned long>(k) << ' ' << n << ' ' << minValue << ' ' 
+		<< maxValue << ' ' << static_cast<unsigned long>(levels.size()) << '\n';
+
+	for(size_t h = 0; h < levels.size(); h++) {
+		output << static_cast<unsigned long>(levels[h].size());
+		for(vector<double>::const_iterator it = levels[h].begin();
+				it != levels[h].end(); it++) {
+			output << ' ' << *it;
+		}
+		output << '\n';
+	}
+
+	return output.str();
+}
+
+/** Decodes a sketch from a string.
+ *
+ * @param[in] data A string created by serialize().
+ *
+ * @return A sketch identical to the one that was serialized. Its random
+ *	number generator is reset to the default seed.
+ *
+ * @perform O(R), where R is the number of values in the sketch.
+ *
+ * @exception std::invalid_argument Thrown if @p data is not a valid
+ *	encoding of a sketch.
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	decode the sketch.
+ *
+ * @exceptsafe Does not change any program state.
+ */
+QuantileSketch QuantileSketch::deserialize(const string& data) {
+	std::istringstream input(data);
+	input.imbue(std::locale::classic());
+
+	string magic;
+	std::getline(input, magic);
+	if (magic != SKETCH_MAGIC) {
+		throw std::invalid_argument("Data is not a serialized QuantileSketch.");
+	}
+
+	unsigned long k = 0, n = 0, nLevels = 0;
+	double minValue = 0.0, maxValue = 0.0;
+	input >> k >> n >> minValue >> maxValue >> nLevels;
+	if (!input || k < 8 || nLevels < 1) {
+		throw std::invalid_argument("Corrupted QuantileSketch header.");
+	}
+
+	QuantileSketch result(k);
+	while (result.levels.size() < nLevels) {
+		result.grow();
+	}
+	double totalWeight = 0.0;
+	for(size_t h = 0; h < nLevels; h++) {
+		unsigned long levelSize = 0;
+		input >> levelSize;
+		if (!input) {
+			throw std::invalid_argument("Corrupted QuantileSketch data.");
+		}
+		result.levels[h].reserve(levelSize);
+		for(unsigned long i = 0; i < levelSize; i++) {
+			double value = 0.0;
+			input >> value;
+			if (!input) {
+				throw std::invalid_argument("Corrupted QuantileSketch data.");
+			}
+			result.levels[h].push_back(value);
+		}
+		result.size += levelSize;
+		totalWeight += std::ldexp(static_cast<double>(levelSize), static_cast<int>(h));
+	}
+	if (totalWeight != static_cast<double>(n)) {
+		throw std::invalid_argument("Corrupted QuantileSketch data.");
+	}
+	result.n        = n;
+	result.minValue = minValue;
+	result.maxValue = maxValue;
+
+	return result;
+}
+
+/** Exchanges the contents of two sketches.
+ *
+ * @param[in,out] other The sketch to swap with this one.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+void QuantileSketch::swap(QuantileSketch& other) {
+	using std::swap;
+
+	swap(k,        other.k);
+	swap(n,        other.n);
+	swap(minValue, other.minValue);
+	swap(maxValue, other.maxValue);
+	levels.swap(other.levels);
+	swap(size,     other.size);
+	swap(maxSize,  other.maxSize);
+	swap(rng,      other.rng);
+}
+
+/** Returns the number of values a level may hold before compacting
+ *
+ * Capacities shrink geometrically from the top level down, so that most
+ * of the sketch's memory is spent on the heaviest values.
+ *
+ * @param[in] h The level to test.
+ *
+ * @return The capacity of level @p h, at least 2.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+size_t QuantileSketch::capacity(size_t h) const {
+	const size_t depth = levels.size() - h - 1;
+	return static_cast<size_t>(std::ceil(std::pow(LEVEL_RATIO,
+		static_cast<double>(depth)) * k)) + 1;
+}
+
+/** Adds an empty level to the top of the sketch
+ *
+ * @post The total capacity of the sketch is updated for the new level.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	add a level.
+ *
+ * @exceptsafe The sketch is unchanged in the event of an exception.
+ */
+void QuantileSketch::grow() {
+	levels.push_back(vector<double>());
+
+	// IMPORTANT: no exceptions beyond this point
+
+	maxSize = 0;
+	for(size_t h = 0; h < levels.size(); h++) {
+		maxSize += capacity(h);
+	}
+}
+
+/** Compacts full levels until the sketch is below its size limit
+ *
+ * Each full level is sorted, and either its odd- or even-ranked values
+ * (chosen at random) are promoted to the level above. If the level has
+ * an odd number of values, its smallest value stays behind.
+ *
+ * @post size < maxSize, or every level is below its capacity.
+ *
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	promote values.
+ *
+ * @exceptsafe The sketch is in a valid state in the event of an exception.
+ */
+void QuantileSketch::compress() {
+	for(size_t h = 0; h < levels.size(); h++) {
+		if (levels[h].size() >= capacity(h)) {
+			if (h+1 >= levels.size()) {
+				grow();
+			}
+			vector<double>& level = levels[h];
+			vector<double>& above = levels[h+1];
+
+			std::sort(level.begin(), level.end());
+			const size_t keep   = level.size() % 2;
+			const size_t offset = rng() & 1u;
+			above.reserve(above.size() + level.size()/2);
+			for(size_t i = keep + offset; i < level.size(); i += 2) {
+				above.push_back(level[i]);
+			}
+			size -= (level.size() - keep) / 2;
+			level.resize(keep);
+
+			if (size < maxSize) {
+				break;
+			}
+		}
+	}
+}
+
+}	// end kpfutils
@@ -0,0 +1,147 @@
+/** Streaming quantile estimation with bounded memory
+ * @file common/sketch.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#ifndef KPFUTILSSKETCHH
+#define KPFUTILSSKETCHH
+
+#include <string>
+#include <vector>
+#include <boost/random/taus88.hpp>
+
+namespace kpfutils {
+
+/** @addtogroup stats
+ *
+ * Include sketch.h to estimate quantiles of data too large to store.
+ *
+ * @{
+ */
+
+/** Estimates quantiles of a stream of values using a fixed amount of memory.
+ *
+ * QuantileSketch implements the KLL sketch of Karnin, Lang, & Liberty
+ * (2016). Values are added one at a time, and are never stored in full:
+ * the sketch keeps a hierarchy of buffers, each representing its values
+ * with twice the weight of the one below it. When a buffer fills, it is
+ * sorted and every other value is promoted to the next level, with a
+ * random choice of which half survives.
+ *
+ * Sketches built from disjoint parts of a data set (e.g., by different
+ * threads or nodes) can be combined with merge(), and the result is as
+ * accurate as a single sketch of the full data set. Sketches can be
+ * saved and restored with serialize() and deserialize().
+ *
+ * @par Accuracy
+ * The error is expressed in terms of rank: if quantile(q) returns a
+ * value x, the true fraction of the data less than or equal to x differs
+ * from @p q by at most &epsilon;. With 99% confidence, &epsilon; is about
+ * 1.7% for the default k = 200, and scales roughly as 1/k, independent of
+ * the number or distribution of values. The minimum and maximum are
+ * always exact, as are all quantiles until the sketch first compacts
+ * (after k values).
+ *
+ * @par Memory
+ * A sketch holds O(k log(N/k)) values, where N is the number of values
+ * added; for k = 200 this is about 600 values plus a few per doubling
+ * of N.
+ *
+ * @note The random choices are made with a fixed-seed generator, so a
+ *	given sequence of calls always produces the same result.
+ */
+class QuantileSketch {
+public:
+	/** Creates an empty sketch.
+	 */
+	explicit QuantileSketch(size_t k = 200, unsigned int seed = 42);
+
+	/** Adds a value to the sketch.
+	 */
+	void add(double value);
+
+	/** Adds all the values summarized by another sketch to this one.
+	 */
+	void merge(const QuantileSketch& other);
+
+	/** Estimates a quantile of the values added so far.
+	 */
+	double quantile(double quantile) const;
+
+	/** Returns the number of values added to the sketch.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	unsigned long count() const {
+		return n;
+	}
+
+	/** Returns the number of values currently stored by the sketch.
+	 */
+	size_t retained() const;
+
+	/** Returns the accuracy parameter of the sketch.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	size_t accuracy() const {
+		return k;
+	}
+
+	/** Encodes the sketch as a string.
+	 */
+	std::string serialize() const;
+
+	/** Decodes a sketch from a string.
+	 */
+	static QuantileSketch deserialize(const std::string& data);
+
+	/** Exchanges the contents of two sketches.
+	 */
+	void swap(QuantileSketch& other);
+
+private:
+	/** Returns the number of values level @p h may hold before compacting
+	 */
+	size_t capacity(size_t h) const;
+
+	/** Adds an empty level to the top of the sketch
+	 */
+	void grow();
+
+	/** Compacts full levels until the sketch is below its size limit
+	 */
+	void compress();
+
+	size_t k;
+	unsigned long n;
+	double minValue;
+	double maxValue;
+
+	/** Values at each level. A value at level h stands for 2^h inputs.
+	 */
+	std::vector<std::vector<double> > levels;
+	/** Total number of values in @p levels
+	 */
+	size_t size;
+	/** Total capacity of @p levels
+	 */
+	size_t maxSize;
+
+	boost::random::taus88 rng;
+};
+
+/** @} */	// end stats
+
+}	// end kpfutils
+
+#endif		// KPFUTILSSKETCHH
@@ -0,0 +1,203 @@
+/** Containers known to be in ascending order
+ * @file common/sorted.tmp.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#ifndef KPFUTILSSORTEDH
+#define KPFUTILSSORTEDH
+
+#include <stdexcept>
+#include "stats.tmp.h"
+
+namespace kpfutils {
+
+/** @addtogroup stats
+ *
+ * Include sorted.tmp.h to pass data whose order has already been checked.
+ *
+ * @{
+ */
+
+/** Tag asserting that data are already sorted in ascending order.
+ *
+ * Passing this tag is a promise by the caller; it is not verified.
+ */
+struct KnownSorted {
+};
+
+/** Convenience instance of KnownSorted
+ */
+const KnownSorted knownSorted = KnownSorted();
+
+/** A read-only container whose elements are in ascending order.
+ *
+ * Sorted records, in the type system, that a container's order has already
+ * been established, whether by sorting it, by checking it, or by reading
+ * it from a source that guarantees it. Functions that require sorted input
+ * can accept a Sorted and skip their own O(N) check.
+ *
+ * A Sorted can only be filled by checking the contents or by an explicit
+ * KnownSorted promise, and offers no way to modify them, so the order
+ * cannot be lost after construction.
+ *
+ * @tparam Container The type of container to wrap. Must provide
+ *	<tt>const_iterator</tt>, <tt>begin()</tt>, <tt>end()</tt>,
+ *	<tt>size()</tt>, and <tt>swap()</tt>.
+ */
+template <class Container>
+class Sorted {
+public:
+	/** The type of the wrapped container
+	 */
+	typedef Container container_type;
+	/** The type of the elements
+	 */
+	typedef typename Container::value_type value_type;
+	/** Iterator over the elements
+	 */
+	typedef typename Container::const_iterator const_iterator;
+
+	/** Creates an empty container, which is trivially sorted.
+	 *
+	 * @exception std::bad_alloc Thrown if the container could not be
+	 *	created.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	Sorted() : data() {
+	}
+
+	/** Copies a container, checking that it is sorted.
+	 *
+	 * @param[in] values The container to copy.
+	 *
+	 * @perform O(N), where N = @p values.size().
+	 *
+	 * @exception std::invalid_argument Thrown if @p values is not sorted
+	 *	in ascending order.
+	 * @exception std::bad_alloc Thrown if the copy could not be made.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	explicit Sorted(const Container& values) : data() {
+		if (!isSorted(values.begin(), values.end())) {
+			throw std::invalid_argument("Sorted created from unsorted data");
+		}
+		data = values;
+	}
+
+	/** Copies a container that the caller promises is sorted.
+	 *
+	 * @param[in] values The container to copy.
+	 *
+	 * @pre @p values is sorted in ascending order
+	 *
+	 * @perform O(N) copy, with no comparisons.
+	 *
+	 * @exception std::bad_alloc Thrown if the copy could not be made.
+	 *
+	 * @exceptsafe Object construction is atomic.
+	 */
+	Sorted(const Container& values, KnownSorted) : data(values) {
+	}
+
+	/** Replaces the contents with those of a container that the caller
+	 *	promises is sorted, without copying.
+	 *
+	 * @param[in,out] values The container to adopt. On output, holds the
+	 *	previous contents of this object.
+	 *
+	 * @pre @p values is sorted in ascending order
+	 *
+	 * @perform O(1) for standard containers.
+	 *
+	 * @exceptsafe Does not throw exceptions if Container::swap() does
+	 *	not throw.
+	 */
+	void adopt(Container& values, KnownSorted) {
+		data.swap(values);
+	}
+
+	/** Moves the contents into an ordinary container, without copying.
+	 *
+	 * @param[out] values On output, holds the contents of this object.
+	 *	Its previous contents are transferred to this object, which
+	 *	is then cleared.
+	 *
+	 * @post This object is empty.
+	 *
+	 * @exceptsafe Does not throw exceptions if Container::swap() does
+	 *	not throw.
+	 */
+	void release(Container& values) {
+		data.swap(values);
+		Container().swap(data);
+	}
+
+	/** Exchanges the contents of two sorted containers.
+	 *
+	 * @exceptsafe Does not throw exceptions if Container::swap() does
+	 *	not throw.
+	 */
+	void swap(Sorted& other) {
+		data.swap(other.data);
+	}
+
+	/** Returns the wrapped container.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	const Container& get() const {
+		return data;
+	}
+
+	/** Returns an iterator to the smallest element.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	const_iterator begin() const {
+		return data.begin();
+	}
+
+	/** Returns an iterator past the largest element.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	const_iterator end() const {
+		return data.end();
+	}
+
+	/** Returns the number of elements.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	size_t size() const {
+		return data.size();
+	}
+
+	/** Tests whether the container is empty.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	bool empty() const {
+		return data.empty();
+	}
+
+private:
+	Container data;
+};
+
+/** @} */	// end stats
+
+}	// end kpfutils
+
+#endif		// KPFUTILSSORTEDH
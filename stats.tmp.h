@@ -2,7 +2,7 @@
  * @file common/stats.tmp.h
  * @author Krzysztof Findeisen
  * @date Created July 21, 2011
- * @date Last modified July 24, 2013
+ * @date Last modified October 18, 2026
  */
 
 /* Copyright 2014, California Institute of Technology.
@@ -12,15 +12,21 @@
  * distribution and at http://opensource.org/licenses/BSD-3-Clause. 
  */
 
+#ifndef KPFUTILSSTATSH
+#define KPFUTILSSTATSH
+
 #include <algorithm>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 #include <cstdio>
 #include <boost/concept/requires.hpp>
 #include <boost/iterator/iterator_concepts.hpp>
 #include <boost/lexical_cast.hpp>
+#include <boost/type_traits/integral_constant.hpp>
 #include "stats_except.h"
+#include "stats_kernels.tmp.h"
 
 namespace kpfutils {
 
@@ -47,9 +53,145 @@ using boost_concepts::RandomAccessTraversalConcept;
  *	convert vectors to C arrays just so GSL can understand them
  */
 
+namespace detail {
+
+/** Finds the mean of an arbitrary range.
+ *
+ * @exceptsafe The range [@p first, @p last) is unchanged in the event of 
+ *	an exception.
+ */
+template <typename ConstInputIterator>
+typename std::iterator_traits<ConstInputIterator>::value_type 
+mean(ConstInputIterator first, ConstInputIterator last, false_type) {
+	typedef typename std::iterator_traits<ConstInputIterator>::value_type Value;
+
+	typename SumType<Value>::type sum = 0;
+	long count = 0;
+
+	// Since iterators are passed by value, incrementing first does not 
+	//	violate exception guarantee
+	for(; first != last; first++) {
+		sum += (*first);
+		count++;
+	}
+	if (count <= 0) {
+		throw except::NotEnoughData("Not enough data to compute mean");
+	}
+
+	// Force floating-point arithmetic to avoid inconsistencies in 
+	//	integer division rounding conventions
+	// Delayed conversion because ++ operator is inaccurate for large doubles
+	double dcount = static_cast<double>(count);
+
+	return static_cast<Value>(sum / dcount);
+}
+
+/** Finds the mean of a contiguous array of arithmetic values.
+ *
+ * @exceptsafe The range [@p first, @p last) is unchanged in the event of 
+ *	an exception.
+ */
+template <typename ConstInputIterator>
+typename std::iterator_traits<ConstInputIterator>::value_type 
+mean(ConstInputIterator first, ConstInputIterator last, true_type) {
+	typedef typename std::iterator_traits<ConstInputIterator>::value_type Value;
+	typedef ContiguousTraits<ConstInputIterator> Traits;
+
+	const size_t n = static_cast<size_t>(last - first);
+	if (n < 1) {
+		throw except::NotEnoughData("Not enough data to compute mean");
+	}
+
+	return static_cast<Value>(blockSum(Traits::address(first), n) 
+		/ static_cast<double>(n));
+}
+
+/** Finds the variance of an arbitrary range.
+ *
+ * @exceptsafe The range [@p first, @p last) is unchanged in the event of 
+ *	an exception.
+ */
+template <typename ConstInputIterator>
+typename std::iterator_traits<ConstInputIterator>::value_type 
+variance(ConstInputIterator first, ConstInputIterator last, false_type) {
+	typedef typename std::iterator_traits<ConstInputIterator>::value_type Value;
+
+	typedef typename SumType<Value>::type Sum;
+
+	Sum  sum = 0, sumsq = 0;
+	long count = 0;
+
+	// Since iterators are passed by value, incrementing first does not 
+	//	violate exception guarantee
+	for(; first != last; first++) {
+		// Square in the accumulator's precision, not the element's
+		const Sum x = *first;
+		sum   += x;
+		sumsq += x*x;
+		count++;
+	}
+	if (count <= 1) {
+		throw except::NotEnoughData("Not enough data to compute variance");
+	}
+
+	// Force floating-point arithmetic to avoid inconsistencies in 
+	//	integer division rounding conventions
+	// Delayed conversion because ++ operator is inaccurate for large doubles
+	double dcount = static_cast<double>(count);
+
+	// Minimize number of divisions and maximize dividend in case value_type is integral
+	return static_cast<Value>((sumsq - sum*sum/dcount)/(dcount-1));
+}
+
+/** Finds the variance of a contiguous array of @c float.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+inline float arrayVariance(const float* data, size_t n) {
+	double mean, m2;
+	blockMoments(data, n, mean, m2);
+	return static_cast<float>(m2 / static_cast<double>(n - 1));
+}
+
+/** Finds the variance of a contiguous array of @c double.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+inline double arrayVariance(const double* data, size_t n) {
+	double mean, m2;
+	blockMoments(data, n, mean, m2);
+	return m2 / static_cast<double>(n - 1);
+}
+
+/** Finds the variance of a contiguous array of floating-point values.
+ *
+ * @exceptsafe The range [@p first, @p last) is unchanged in the event of 
+ *	an exception.
+ */
+template <typename ConstInputIterator>
+typename std::iterator_traits<ConstInputIterator>::value_type 
+variance(ConstInputIterator first, ConstInputIterator last, true_type) {
+	typedef ContiguousTraits<ConstInputIterator> Traits;
+
+	const size_t n = static_cast<size_t>(last - first);
+	if (n <= 1) {
+		throw except::NotEnoughData("Not enough data to compute variance");
+	}
+
+	return arrayVariance(Traits::address(first), n);
+}
+
+}	// end detail
+
 /** Finds the mean of the values in a generic container object. The container 
  *	class is accessed using first and last iterators, and the mean is 
  *	computed over the interval [first, last).
+ *
+ * Contiguous ranges of arithmetic values (pointers or @c std::vector 
+ * iterators) are summed by an unrolled kernel that the compiler can 
+ * vectorize. All other ranges are summed one element at a time. The 
+ * choice is made at compile time. Either way, @c float values are summed 
+ * in @c double, so single-precision storage does not cost accuracy.
  * 
  * @tparam ConstInputIterator The iterator type for the container over which the 
  *	mean is to be calculated. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
@@ -84,6 +226,8 @@ using boost_concepts::RandomAccessTraversalConcept;
  *	agrees with gsl_stats_mean to within 1e-10 in 10 out of 10 trials.
  * @test Array of doubles, length 100, randomly generated. Expected behavior: 
  *	agrees with gsl_stats_mean to within 1e-10 in 10 out of 10 trials.
+ * @test List and vector of floats, length 100000, values 1e4 + i%10. 
+ *	Expected behavior: mean 1e4 + 4.5 to within 1e-5.
  *
  * @todo Apply concept checking to the return type
  */
@@ -93,32 +237,18 @@ BOOST_CONCEPT_REQUIRES(
 	((ForwardTraversalConcept<ConstInputIterator>)),	// Iterator semantics
 	(typename std::iterator_traits<ConstInputIterator>::value_type)) // Return type
 mean(ConstInputIterator first, ConstInputIterator last) {
-	typedef typename std::iterator_traits<ConstInputIterator>::value_type Value;
-
-	Value  sum = 0;
-	long count = 0;
-
-	// Since iterators are passed by value, incrementing first does not 
-	//	violate exception guarantee
-	for(; first != last; first++) {
-		sum += (*first);
-		count++;
-	}
-	if (count <= 0) {
-		throw except::NotEnoughData("Not enough data to compute mean");
-	}
-
-	// Force floating-point arithmetic to avoid inconsistencies in 
-	//	integer division rounding conventions
-	// Delayed conversion because ++ operator is inaccurate for large doubles
-	double dcount = static_cast<double>(count);
-
-	return static_cast<Value>(sum / dcount);
+	return detail::mean(first, last, detail::UseArrayKernel<ConstInputIterator>());
 }
 
 /** Finds the variance of the values in a generic container object. The 
  *	container class is accessed using first and last iterators, and 
  *	the variance is computed over the interval [first, last).
+ *
+ * Contiguous ranges of @c float or @c double (pointers or @c std::vector 
+ * iterators) are processed by the vectorized kernel of meanVariance(), 
+ * which is also numerically stable. All other ranges use the textbook 
+ * single-pass formula. The choice is made at compile time. Either way, 
+ * @c float values are accumulated in @c double.
  * 
  * @tparam ConstInputIterator The iterator type for the container over which the 
  *	variance is to be calculated. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
@@ -153,6 +283,8 @@ mean(ConstInputIterator first, ConstInputIterator last) {
  *	agrees with gsl_stats_variance to within 1e-10 in 10 out of 10 trials.
  * @test Array of doubles, length 100, randomly generated. Expected behavior: 
  *	agrees with gsl_stats_variance to within 1e-10 in 10 out of 10 trials.
+ * @test List and vector of floats, length 100000, values 1e4 + i%10. 
+ *	Expected behavior: variance 8.25*N/(N-1) to within 1e-5.
  *
  * @todo Apply concept checking to the return type
  */
@@ -162,172 +294,1230 @@ BOOST_CONCEPT_REQUIRES(
 	((ForwardTraversalConcept<ConstInputIterator>)),	// Iterator semantics
 	(typename std::iterator_traits<ConstInputIterator>::value_type)) // Return type
 variance(ConstInputIterator first, ConstInputIterator last) {
-	typedef typename std::iterator_traits<ConstInputIterator>::value_type Value;
+	return detail::variance(first, last, detail::UseFloatKernel<ConstInputIterator>());
+}
 
-	Value  sum = 0, sumsq = 0;
-	long count = 0;
+namespace detail {
 
-	// Since iterators are passed by value, incrementing first does not 
-	//	violate exception guarantee
-	for(; first != last; first++) {
-		sum   += (*first);
-		sumsq += (*first)*(*first);
-		count++;
-	}
-	if (count <= 1) {
-		throw except::NotEnoughData("Not enough data to compute variance");
-	}
+/** Computes the moments of a contiguous array of floating-point values.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+template <typename ConstInputIterator>
+void moments(ConstInputIterator first, ConstInputIterator last, 
+		long& count, double& mean, double& m2, true_type) {
+	typedef ContiguousTraits<ConstInputIterator> Traits;
 
-	// Force floating-point arithmetic to avoid inconsistencies in 
-	//	integer division rounding conventions
-	// Delayed conversion because ++ operator is inaccurate for large doubles
-	double dcount = static_cast<double>(count);
+	const size_t n = static_cast<size_t>(last - first);
+	count = static_cast<long>(n);
+	mean  = 0.0;
+	m2    = 0.0;
+	if (n > 0) {
+		blockMoments(Traits::address(first), n, mean, m2);
+	}
+}
 
-	// Minimize number of divisions and maximize dividend in case value_type is integral
-	return static_cast<Value>((sumsq - sum*sum/dcount)/(dcount-1));
+/** Computes the moments of an arbitrary range.
+ *
+ * @exceptsafe Does not throw exceptions unless ConstInputIterator throws.
+ */
+template <typename ConstInputIterator>
+void moments(ConstInputIterator first, ConstInputIterator last, 
+		long& count, double& mean, double& m2, false_type) {
+	welfordMoments(first, last, count, mean, m2);
 }
 
-/** Finds the (uninterpolated) quantile of the values in a generic container 
- *	object. The container class is accessed using first and last 
- *	iterators, and the quantile is computed over the interval 
- *	[first, last). Data is assumed unsorted.
+}	// end detail
+
+/** Finds the mean and variance of the values in a generic container object 
+ *	in a single pass. The container class is accessed using first and last 
+ *	iterators, and the statistics are computed over the interval 
+ *	[first, last).
+ *
+ * Contiguous ranges of @c float or @c double (pointers or @c std::vector 
+ * iterators) are processed with a blocked kernel that uses several 
+ * independent accumulators, allowing the compiler to vectorize it. All 
+ * other ranges use Welford's algorithm. The choice is made at compile time.
+ * Unlike variance(), both methods are numerically stable even when the 
+ * mean is much larger than the standard deviation.
  * 
- * @tparam ConstRandomAccessIterator The iterator type for the container over which the 
- *	variance is to be calculated. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/RandomAccessTraversal.html">random access</a>
- * @param[in] first Input iterator marking the first element in the 
- *	container.
- * @param[in] last Input iterator marking the position after the last 
- *	element in the container.
- * @param[in] quantile The percentile to recover.
+ * @tparam ConstInputIterator The iterator type for the container over which the 
+ *	statistics are to be calculated. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
+ * @param[in] first Input iterator marking the first element in the container.
+ * @param[in] last Input iterator marking the position after the last element in the container.
  *
- * @return The largest value whose quantile is less than or equal to 
- *	@p quantile.
+ * @return A pair whose first element is the arithmetic mean, and whose 
+ *	second element is the (unbiased) sample variance, of the elements 
+ *	between @p first, inclusive, and @p last, exclusive. The return type 
+ *	is that of the elements pointed to by the @p first and @p last 
+ *	iterators. All intermediate calculations are done in @c double.
  *
  * @pre [@p first, @p last) is a valid range
  * @pre There are at least two elements in the range [@p first, @p last)
- * @pre 0 <= @p quantile <= 1
  * @pre No value in [@p first, @p last) is NaN
  *
- * @post The return value is not NaN
+ * @post Neither element of the return value is NaN
  *
- * @perform O(D log D), where D = std::distance(@p first, @p last).
- * 
- * @exception std::invalid_argument Thrown if @p quantile is not 
- *	in the interval [0, 1].
+ * @perform O(D), where D = std::distance(@p first, @p last). Each element 
+ *	is read from memory exactly once.
  *
  * @exception kpfutils::except::NotEnoughData Thrown if there are not enough 
- *	elements to define a quantile.
+ *	elements to define a variance.
  * 
  * @exceptsafe The range [@p first, @p last) is unchanged in the event of an exception.
  *
- * @test List of ints, length 0. Expected behavior: throw invalid_argument.
- * @test List of ints, length 1, quantile=0.00. Expected behavior: return %list::front()
- * @test List of ints, length 1, quantile=0.42. Expected behavior: return %list::front()
- * @test List of ints, length 1, quantile=1.00. Expected behavior: return %list::front()
- * @test List of ints, length 100, randomly generated, quantile=-0.01 or 1.01. 
- *	Expected behavior: throw domain_error
- * @test List of ints, length 100, randomly generated, quantile=0.00, 0.42, or 1.00. 
- *	Expected behavior: TBD
- * @test List of doubles, length 100, randomly generated, quantile=0.00, 0.42, or 1.00. 
- *	Expected behavior: TBD
- * @test Vector of doubles, length 100, randomly generated, quantile=0.00, 0.42, or 1.00. 
- *	Expected behavior: TBD
- * @test Array of doubles, length 100, randomly generated, quantile=0.00, 0.42, or 1.00. 
- *	Expected behavior: TBD
- *
- * @todo Pick a specific convention for quantiles and use it consistently
- *
- * @todo Finish designing test cases. Can't use gsl_stats_quantile_from_sorted_data 
- *	as an oracle because it interpolates
- * @todo Apply concept checking to the return type
+ * @test List of ints, length 0. Expected behavior: throw NotEnoughData.
+ * @test List of ints, length 1. Expected behavior: throw NotEnoughData.
+ * @test List of doubles, length 100, randomly generated. Expected behavior: 
+ *	agrees with gsl_stats_mean and gsl_stats_variance to within 1e-8 
+ *	in 10 out of 10 trials.
+ * @test Vector of doubles, length 100, randomly generated. Expected behavior: 
+ *	agrees with gsl_stats_mean and gsl_stats_variance to within 1e-8 
+ *	in 10 out of 10 trials.
+ * @test Array of doubles, length 100, randomly generated. Expected behavior: 
+ *	agrees with gsl_stats_mean and gsl_stats_variance to within 1e-8 
+ *	in 10 out of 10 trials.
+ * @test Vector of doubles, length 10000, values 1e9 + i%10. Expected 
+ *	behavior: mean 1e9 + 4.5 and variance 8.25*N/(N-1) to within 1e-8.
  */
-template <typename ConstRandomAccessIterator> 				// Iterator to use
+template <typename ConstInputIterator> 				// Iterator to use
 BOOST_CONCEPT_REQUIRES(
-	((ReadableIteratorConcept<ConstRandomAccessIterator>)) 
-	((RandomAccessTraversalConcept<ConstRandomAccessIterator>)),	// Iterator semantics
-	(typename std::iterator_traits<ConstRandomAccessIterator>::value_type)) // Return type
-quantile(ConstRandomAccessIterator first, ConstRandomAccessIterator last, double quantile) {
-	typedef typename std::iterator_traits<ConstRandomAccessIterator>::value_type Value;
-	
-	if (quantile < 0.0 || quantile > 1.0) {
-		try {
-			throw std::invalid_argument("Invalid quantile of " + lexical_cast<std::string>(quantile) + " passed to quantile()");
-		} catch (const bad_lexical_cast& e) {
-			throw std::invalid_argument("Invalid quantile passed to quantile()");
-		}
+	((ReadableIteratorConcept<ConstInputIterator>)) 
+	((ForwardTraversalConcept<ConstInputIterator>)),	// Iterator semantics
+	(std::pair<typename std::iterator_traits<ConstInputIterator>::value_type, 
+		typename std::iterator_traits<ConstInputIterator>::value_type>)) // Return type
+meanVariance(ConstInputIterator first, ConstInputIterator last) {
+	typedef typename std::iterator_traits<ConstInputIterator>::value_type Value;
+
+	long count = 0;
+	double mean = 0.0, m2 = 0.0;
+	detail::moments(first, last, count, mean, m2, 
+		typename detail::UseFloatKernel<ConstInputIterator>::type());
+
+	if (count <= 1) {
+		throw except::NotEnoughData("Not enough data to compute variance");
 	}
 
-	// We don't want to alter the data, so we copy while sorting
-	// Copy to a vector because sorting requires random access
-	size_t vecSize = distance(first, last);
-	if (vecSize < 1) {
-		throw except::NotEnoughData("Supplied empty data set to quantile()");
+	double dcount = static_cast<double>(count);
+	return std::make_pair(static_cast<Value>(mean), static_cast<Value>(m2/(dcount-1)));
+}
+
+namespace detail {
+
+/** Selects the floating-point kernels for a pair of contiguous ranges.
+ *
+ * @tparam Iterator1, Iterator2 The iterator types to test.
+ */
+template <typename Iterator1, typename Iterator2>
+struct UseFloatKernel2 : public integral_constant<bool, 
+		UseFloatKernel<Iterator1>::value && UseFloatKernel<Iterator2>::value> {
+};
+
+/** Computes the weighted moments of contiguous arrays of floating-point 
+ *	values.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+template <typename ConstInputIterator1, typename ConstInputIterator2>
+void weightedMoments(ConstInputIterator1 first, ConstInputIterator1 last, 
+		ConstInputIterator2 errFirst, 
+		long& count, double& w, double& wSq, double& mean, double& s, true_type) {
+	const size_t n = static_cast<size_t>(last - first);
+	count = static_cast<long>(n);
+	w     = 0.0;
+	wSq   = 0.0;
+	mean  = 0.0;
+	s     = 0.0;
+	if (n > 0) {
+		blockWeighted(ContiguousTraits<ConstInputIterator1>::address(first), 
+			ContiguousTraits<ConstInputIterator2>::address(errFirst), 
+			n, w, wSq, mean, s);
 	}
-	std::vector<Value> sortedVec(vecSize);
-	/** @todo Reimplement using partial sorting
-	 */
-	std::partial_sort_copy(first, last, sortedVec.begin(), sortedVec.end());
+}
 
-	size_t index = 0;
-	if (quantile >= 0.0 && quantile < 1.0) {
-		index = static_cast<size_t>(quantile*vecSize);
-	} else if (quantile == 1.0) {
-		index = vecSize-1;
+/** Computes the weighted moments of arbitrary ranges.
+ *
+ * @exceptsafe Does not throw exceptions unless the iterators throw.
+ */
+template <typename ConstInputIterator1, typename ConstInputIterator2>
+void weightedMoments(ConstInputIterator1 first, ConstInputIterator1 last, 
+		ConstInputIterator2 errFirst, 
+		long& count, double& w, double& wSq, double& mean, double& s, false_type) {
+	westWeighted(first, last, errFirst, count, w, wSq, mean, s);
+}
+
+/** Computes the weighted moments of any ranges, and checks the result.
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are fewer 
+ *	than @p minCount elements.
+ * @exception std::invalid_argument Thrown if any error is zero.
+ *
+ * @exceptsafe The ranges are unchanged in the event of an exception.
+ */
+template <typename ConstInputIterator1, typename ConstInputIterator2>
+void checkedWeightedMoments(ConstInputIterator1 first, ConstInputIterator1 last, 
+		ConstInputIterator2 errFirst, long minCount, const std::string& caller, 
+		long& count, double& w, double& wSq, double& mean, double& s) {
+	weightedMoments(first, last, errFirst, count, w, wSq, mean, s, 
+		typename UseFloatKernel2<ConstInputIterator1, ConstInputIterator2>::type());
+
+	if (count < minCount) {
+		throw except::NotEnoughData("Not enough data passed to " + caller + "()");
+	}
+	// Tests for infinity without requiring C99 or nan.h
+	if (!(w - w == 0.0)) {
+		throw std::invalid_argument("Zero or invalid error passed to " + caller + "()");
 	}
-	
-	return sortedVec[index];
 }
 
-/** Tests whether a range is sorted.
+}	// end detail
+
+/** Finds the inverse-variance weighted mean of the values in a generic 
+ *	container object. The data are accessed using first and last 
+ *	iterators, and the mean is computed over the interval [first, last), 
+ *	with the error of each datum read from a parallel range.
  *
- * This function emulates <tt>std::is_sorted()</tt> for platforms without access 
- * to either a C++11-compliant compiler or Boost 1.50 or later.
+ * The weights 1/&sigma;<sub>i</sub><sup>2</sup> are computed on the fly, 
+ * in the same pass as the mean, so no temporary storage is needed. If 
+ * both ranges are contiguous arrays of @c float or @c double, a blocked, 
+ * vectorizable kernel is used.
+ * 
+ * @tparam ConstInputIterator1 The iterator type for the data. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
+ * @tparam ConstInputIterator2 The iterator type for the errors. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
+ * @param[in] first Input iterator marking the first datum.
+ * @param[in] last Input iterator marking the position after the last datum.
+ * @param[in] errFirst Input iterator marking the error of the first datum.
  *
- * @tparam ConstForwardIterator The iterator type for the container to be tested. 
- * Must be a <a href="http://www.boost.org/doc/libs/release/doc/html/ForwardIterator.html">forward iterator</a>.
- * @param[in] first,last Forward iterators to the range to test. The range 
- *	is all elements in the interval [@p first, @p last).
+ * @return The weighted mean &Sigma;w<sub>i</sub>x<sub>i</sub> / 
+ *	&Sigma;w<sub>i</sub>, where w<sub>i</sub> = 1/&sigma;<sub>i</sub><sup>2</sup>. 
+ *	The return type is that of the elements pointed to by @p first 
+ *	and @p last.
  *
- * @return True if [@p first, @p last) is sorted in ascending order. A range 
- *	containing less than two elements is always sorted.
+ * @pre [@p first, @p last) is a valid range
+ * @pre The range starting at @p errFirst has at least as many elements 
+ *	as [@p first, @p last)
+ * @pre There is at least one element in the range [@p first, @p last)
+ * @pre No value in either range is NaN
+ *
+ * @post The return value is not NaN
  *
  * @perform O(D), where D = std::distance(@p first, @p last).
  *
- * @exceptsafe The range [@p first, @p last) is unchanged in the event of 
- *	an exception if ConstForwardIterator provides at least the basic 
- *	guarantee. Does not throw exceptions unless ConstForwardIterator throws.
+ * @exception kpfutils::except::NotEnoughData Thrown if there are not enough 
+ *	elements to define a mean.
+ * @exception std::invalid_argument Thrown if any error is zero.
  * 
- * @test Empty list. Expected behavior: true.
- * @test List of size 1. Expected behavior: true.
- * @test List of size 2, sorted asc. Expected behavior: true.
- * @test List of size 2, sorted desc. Expected behavior: false.
- * @test List of size 10, list[i] = i^2. Expected behavior: true.
- * @test List of size 10, list[i] = (i-5)^2. Expected behavior: false.
- * @test List of size 10, random elements. Expected behavior: false.
+ * @exceptsafe Neither range is changed in the event of an exception.
  *
- * @todo Implement these test cases.
+ * @test Vectors of doubles, length 0. Expected behavior: throw NotEnoughData.
+ * @test Vectors of doubles, length 100, one error zero. Expected behavior: 
+ *	throw invalid_argument.
+ * @test Vectors, lists, and arrays of doubles, length 100, randomly 
+ *	generated. Expected behavior: agrees with a two-pass calculation 
+ *	to within 1e-8.
  */
-template <class ConstForwardIterator>
+template <typename ConstInputIterator1, typename ConstInputIterator2>
 BOOST_CONCEPT_REQUIRES(
-	((ReadableIteratorConcept<ConstForwardIterator>)) 
-	((ForwardTraversalConcept<ConstForwardIterator>)),	// Iterator semantics
-	(bool)) 					// Return type
-isSorted (ConstForwardIterator first, ConstForwardIterator last) {
-	// Code shamelessly copied from http://www.cplusplus.com/reference/algorithm/is_sorted/
-	if (first==last) {
-		return true;
-	}
-	
-	// Since iterators are passed by value, incrementing first does not 
-	//	violate exception guarantee
-	for(ConstForwardIterator next = first; ++next != last; ++first) {
-		if (*next<*first) {
-			return false;
-		}
-	}
-	return true;
-}
+	((ReadableIteratorConcept<ConstInputIterator1>)) 
+	((ForwardTraversalConcept<ConstInputIterator1>))
+	((ReadableIteratorConcept<ConstInputIterator2>)) 
+	((ForwardTraversalConcept<ConstInputIterator2>)),	// Iterator semantics
+	(typename std::iterator_traits<ConstInputIterator1>::value_type)) // Return type
+weightedMean(ConstInputIterator1 first, ConstInputIterator1 last, ConstInputIterator2 errFirst) {
+	typedef typename std::iterator_traits<ConstInputIterator1>::value_type Value;
+
+	long count = 0;
+	double w = 0.0, wSq = 0.0, mean = 0.0, s = 0.0;
+	detail::checkedWeightedMoments(first, last, errFirst, 1, "weightedMean", 
+		count, w, wSq, mean, s);
+
+	return static_cast<Value>(mean);
+}
+
+/** Finds the inverse-variance weighted variance of the values in a generic 
+ *	container object. The data are accessed using first and last 
+ *	iterators, and the variance is computed over the interval 
+ *	[first, last), with the error of each datum read from a parallel range.
+ *
+ * The weighted mean and the squared deviations from it are found in a 
+ * single pass, with no temporary storage. If both ranges are contiguous 
+ * arrays of @c float or @c double, a blocked, vectorizable kernel is used.
+ * 
+ * @tparam ConstInputIterator1 The iterator type for the data. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
+ * @tparam ConstInputIterator2 The iterator type for the errors. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
+ * @param[in] first Input iterator marking the first datum.
+ * @param[in] last Input iterator marking the position after the last datum.
+ * @param[in] errFirst Input iterator marking the error of the first datum.
+ *
+ * @return The weighted variance with the unbiased normalization for 
+ *	reliability weights, 
+ *	&Sigma;w<sub>i</sub>(x<sub>i</sub> - &mu;)<sup>2</sup> / 
+ *	(V<sub>1</sub> - V<sub>2</sub>/V<sub>1</sub>), where 
+ *	w<sub>i</sub> = 1/&sigma;<sub>i</sub><sup>2</sup>, 
+ *	V<sub>1</sub> = &Sigma;w<sub>i</sub>, and 
+ *	V<sub>2</sub> = &Sigma;w<sub>i</sub><sup>2</sup>. If all errors are 
+ *	equal, this reduces to the sample variance. The return type is 
+ *	that of the elements pointed to by @p first and @p last.
+ *
+ * @pre [@p first, @p last) is a valid range
+ * @pre The range starting at @p errFirst has at least as many elements 
+ *	as [@p first, @p last)
+ * @pre There are at least two elements in the range [@p first, @p last)
+ * @pre No value in either range is NaN
+ *
+ * @post The return value is not NaN
+ *
+ * @perform O(D), where D = std::distance(@p first, @p last).
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are not enough 
+ *	elements to define a variance.
+ * @exception std::invalid_argument Thrown if any error is zero.
+ * 
+ * @exceptsafe Neither range is changed in the event of an exception.
+ *
+ * @test Vectors of doubles, length 1. Expected behavior: throw NotEnoughData.
+ * @test Vectors of doubles, length 100, all errors equal. Expected 
+ *	behavior: agrees with variance() to within 1e-8.
+ * @test Vectors, lists, and arrays of doubles, length 100, randomly 
+ *	generated. Expected behavior: agrees with a two-pass calculation 
+ *	to within 1e-8.
+ */
+template <typename ConstInputIterator1, typename ConstInputIterator2>
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstInputIterator1>)) 
+	((ForwardTraversalConcept<ConstInputIterator1>))
+	((ReadableIteratorConcept<ConstInputIterator2>)) 
+	((ForwardTraversalConcept<ConstInputIterator2>)),	// Iterator semantics
+	(typename std::iterator_traits<ConstInputIterator1>::value_type)) // Return type
+weightedVariance(ConstInputIterator1 first, ConstInputIterator1 last, ConstInputIterator2 errFirst) {
+	typedef typename std::iterator_traits<ConstInputIterator1>::value_type Value;
+
+	long count = 0;
+	double w = 0.0, wSq = 0.0, mean = 0.0, s = 0.0;
+	detail::checkedWeightedMoments(first, last, errFirst, 2, "weightedVariance", 
+		count, w, wSq, mean, s);
+
+	return static_cast<Value>(s / (w - wSq/w));
+}
+
+/** Finds the reduced &chi;<sup>2</sup> of the values in a generic container 
+ *	object about their weighted mean. The data are accessed using first 
+ *	and last iterators, and the statistic is computed over the interval 
+ *	[first, last), with the error of each datum read from a parallel range.
+ *
+ * The weighted mean and the &chi;<sup>2</sup> about it are found in a 
+ * single pass, with no temporary storage. If both ranges are contiguous 
+ * arrays of @c float or @c double, a blocked, vectorizable kernel is used.
+ * 
+ * @tparam ConstInputIterator1 The iterator type for the data. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
+ * @tparam ConstInputIterator2 The iterator type for the errors. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
+ * @param[in] first Input iterator marking the first datum.
+ * @param[in] last Input iterator marking the position after the last datum.
+ * @param[in] errFirst Input iterator marking the error of the first datum.
+ *
+ * @return &Sigma;((x<sub>i</sub> - &mu;)/&sigma;<sub>i</sub>)<sup>2</sup> / (N-1), 
+ *	where &mu; is the weighted mean and N the number of data. The 
+ *	return value is always @c double.
+ *
+ * @pre [@p first, @p last) is a valid range
+ * @pre The range starting at @p errFirst has at least as many elements 
+ *	as [@p first, @p last)
+ * @pre There are at least two elements in the range [@p first, @p last)
+ * @pre No value in either range is NaN
+ *
+ * @post The return value is not NaN
+ *
+ * @perform O(D), where D = std::distance(@p first, @p last).
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are not enough 
+ *	elements to define a &chi;<sup>2</sup>.
+ * @exception std::invalid_argument Thrown if any error is zero.
+ * 
+ * @exceptsafe Neither range is changed in the event of an exception.
+ *
+ * @test Vectors of doubles, length 1. Expected behavior: throw NotEnoughData.
+ * @test Vectors, lists, and arrays of doubles, length 100, randomly 
+ *	generated. Expected behavior: agrees with a two-pass calculation 
+ *	to within 1e-8.
+ */
+template <typename ConstInputIterator1, typename ConstInputIterator2>
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstInputIterator1>)) 
+	((ForwardTraversalConcept<ConstInputIterator1>))
+	((ReadableIteratorConcept<ConstInputIterator2>)) 
+	((ForwardTraversalConcept<ConstInputIterator2>)),	// Iterator semantics
+	(double)) // Return type
+reducedChiSq(ConstInputIterator1 first, ConstInputIterator1 last, ConstInputIterator2 errFirst) {
+	long count = 0;
+	double w = 0.0, wSq = 0.0, mean = 0.0, s = 0.0;
+	detail::checkedWeightedMoments(first, last, errFirst, 2, "reducedChiSq", 
+		count, w, wSq, mean, s);
+
+	return s / (static_cast<double>(count) - 1.0);
+}
+
+namespace detail {
+
+/** Verifies that a quantile is in the interval [0, 1].
+ *
+ * @param[in] quantile The quantile to test.
+ * @param[in] caller The name of the function to report in exception 
+ *	messages.
+ *
+ * @exception std::invalid_argument Thrown if @p quantile is not 
+ *	in the interval [0, 1].
+ *
+ * @exceptsafe Does not change any program state.
+ */
+inline void checkQuantile(double quantile, const std::string& caller) {
+	if (quantile < 0.0 || quantile > 1.0) {
+		try {
+			throw std::invalid_argument("Invalid quantile of " + lexical_cast<std::string>(quantile) + " passed to " + caller + "()");
+		} catch (const bad_lexical_cast& e) {
+			throw std::invalid_argument("Invalid quantile passed to " + caller + "()");
+		}
+	}
+}
+
+/** Returns the position, in a sorted array, of the uninterpolated quantile
+ *
+ * @param[in] quantile The quantile to find.
+ * @param[in] n The number of elements in the array.
+ *
+ * @return The index of the largest element whose quantile is less than 
+ *	or equal to @p quantile.
+ *
+ * @pre 0 <= @p quantile <= 1
+ * @pre @p n > 0
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+inline size_t quantileIndex(double quantile, size_t n) {
+	size_t index = 0;
+	if (quantile >= 0.0 && quantile < 1.0) {
+		index = static_cast<size_t>(quantile*n);
+	} else if (quantile == 1.0) {
+		index = n-1;
+	}
+	return index;
+}
+
+/** Selects the element of an arbitrary range with a given rank.
+ *
+ * @exceptsafe The range [@p first, @p last) is unchanged in the event of 
+ *	an exception. The contents of @p scratch are unspecified.
+ */
+template <typename ConstRandomAccessIterator>
+typename std::iterator_traits<ConstRandomAccessIterator>::value_type 
+selectRank(ConstRandomAccessIterator first, ConstRandomAccessIterator last, size_t index, 
+		std::vector<typename std::iterator_traits<ConstRandomAccessIterator>::value_type>& scratch, 
+		false_type) {
+	// We don't want to alter the data, so we select from a copy
+	scratch.assign(first, last);
+	std::nth_element(scratch.begin(), scratch.begin()+index, scratch.end());
+	
+	return scratch[index];
+}
+
+/** Selects the element of a contiguous array with a given rank.
+ *
+ * The smallest and largest elements are found with a single scan, 
+ * without copying the array.
+ *
+ * @exceptsafe The range [@p first, @p last) is unchanged in the event of 
+ *	an exception. The contents of @p scratch are unspecified.
+ */
+template <typename ConstRandomAccessIterator>
+typename std::iterator_traits<ConstRandomAccessIterator>::value_type 
+selectRank(ConstRandomAccessIterator first, ConstRandomAccessIterator last, size_t index, 
+		std::vector<typename std::iterator_traits<ConstRandomAccessIterator>::value_type>& scratch, 
+		true_type) {
+	typedef typename std::iterator_traits<ConstRandomAccessIterator>::value_type Value;
+	typedef ContiguousTraits<ConstRandomAccessIterator> Traits;
+
+	const Value* const data = Traits::address(first);
+	const size_t n = static_cast<size_t>(last - first);
+	if (index == 0) {
+		return *std::min_element(data, data + n);
+	} else if (index + 1 == n) {
+		return *std::max_element(data, data + n);
+	}
+
+	scratch.assign(data, data + n);
+	Value* const copy = &scratch[0];
+	std::nth_element(copy, copy + index, copy + n);
+
+	return copy[index];
+}
+
+}	// end detail
+
+/** Finds the (uninterpolated) quantile of the values in a generic container 
+ *	object, using caller-provided working memory. The container class is 
+ *	accessed using first and last iterators, and the quantile is computed 
+ *	over the interval [first, last). Data is assumed unsorted.
+ *
+ * This function behaves exactly like 
+ * @ref quantile(ConstRandomAccessIterator, ConstRandomAccessIterator, double) 
+ * "quantile(first, last, quantile)", but copies the data into @p scratch 
+ * rather than a temporary. Reusing one buffer across many calls avoids 
+ * repeated allocation.
+ *
+ * For contiguous ranges of arithmetic values (pointers or @c std::vector 
+ * iterators), the smallest and largest values are found by a single scan 
+ * that does not touch @p scratch.
+ * 
+ * @tparam ConstRandomAccessIterator The iterator type for the container over which the 
+ *	quantile is to be calculated. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/RandomAccessTraversal.html">random access</a>
+ * @param[in] first Input iterator marking the first element in the 
+ *	container.
+ * @param[in] last Input iterator marking the position after the last 
+ *	element in the container.
+ * @param[in] quantile The percentile to recover.
+ * @param[in,out] scratch A buffer to use for the computation. Its contents 
+ *	on input are ignored, and its contents on output are unspecified. 
+ *	The buffer's capacity is retained for later calls.
+ *
+ * @return The largest value whose quantile is less than or equal to 
+ *	@p quantile.
+ *
+ * @pre [@p first, @p last) is a valid range
+ * @pre [@p first, @p last) does not overlap @p scratch
+ * @pre 0 <= @p quantile <= 1
+ * @pre No value in [@p first, @p last) is NaN
+ *
+ * @post The return value is not NaN
+ *
+ * @perform O(D) on average, where D = std::distance(@p first, @p last).
+ * @perform Does not allocate memory if @p scratch.capacity() >= D.
+ * 
+ * @exception std::invalid_argument Thrown if @p quantile is not 
+ *	in the interval [0, 1].
+ * @exception kpfutils::except::NotEnoughData Thrown if there are not enough 
+ *	elements to define a quantile.
+ * @exception std::bad_alloc Thrown if @p scratch could not be enlarged.
+ * 
+ * @exceptsafe The range [@p first, @p last) is unchanged in the event of 
+ *	an exception. The contents of @p scratch are unspecified.
+ *
+ * @test Vector of doubles, length 100, randomly generated, quantile=0.00, 
+ *	0.42, or 1.00, same buffer for all calls. Expected behavior: same 
+ *	results as quantile(first, last, quantile).
+ */
+template <typename ConstRandomAccessIterator> 				// Iterator to use
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstRandomAccessIterator>)) 
+	((RandomAccessTraversalConcept<ConstRandomAccessIterator>)),	// Iterator semantics
+	(typename std::iterator_traits<ConstRandomAccessIterator>::value_type)) // Return type
+quantile(ConstRandomAccessIterator first, ConstRandomAccessIterator last, double quantile, 
+		std::vector<typename std::iterator_traits<ConstRandomAccessIterator>::value_type>& scratch) {
+	detail::checkQuantile(quantile, "quantile");
+
+	// We don't want to alter the data, so we select from a copy
+	size_t vecSize = std::distance(first, last);
+	if (vecSize < 1) {
+		throw except::NotEnoughData("Supplied empty data set to quantile()");
+	}
+
+	size_t index = detail::quantileIndex(quantile, vecSize);
+	return detail::selectRank(first, last, index, scratch, 
+		detail::UseArrayKernel<ConstRandomAccessIterator>());
+}
+
+/** Finds the (uninterpolated) quantile of the values in a generic container 
+ *	object. The container class is accessed using first and last 
+ *	iterators, and the quantile is computed over the interval 
+ *	[first, last). Data is assumed unsorted.
+ * 
+ * @tparam ConstRandomAccessIterator The iterator type for the container over which the 
+ *	variance is to be calculated. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/RandomAccessTraversal.html">random access</a>
+ * @param[in] first Input iterator marking the first element in the 
+ *	container.
+ * @param[in] last Input iterator marking the position after the last 
+ *	element in the container.
+ * @param[in] quantile The percentile to recover.
+ *
+ * @return The largest value whose quantile is less than or equal to 
+ *	@p quantile.
+ *
+ * @pre [@p first, @p last) is a valid range
+ * @pre There are at least two elements in the range [@p first, @p last)
+ * @pre 0 <= @p quantile <= 1
+ * @pre No value in [@p first, @p last) is NaN
+ *
+ * @post The return value is not NaN
+ *
+ * @perform O(D) on average, where D = std::distance(@p first, @p last).
+ * @perform Allocates a copy of the data on every call. Use the overload 
+ *	taking a scratch buffer to avoid this.
+ * 
+ * @exception std::invalid_argument Thrown if @p quantile is not 
+ *	in the interval [0, 1].
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are not enough 
+ *	elements to define a quantile.
+ * 
+ * @exceptsafe The range [@p first, @p last) is unchanged in the event of an exception.
+ *
+ * @test List of ints, length 0. Expected behavior: throw invalid_argument.
+ * @test List of ints, length 1, quantile=0.00. Expected behavior: return %list::front()
+ * @test List of ints, length 1, quantile=0.42. Expected behavior: return %list::front()
+ * @test List of ints, length 1, quantile=1.00. Expected behavior: return %list::front()
+ * @test List of ints, length 100, randomly generated, quantile=-0.01 or 1.01. 
+ *	Expected behavior: throw domain_error
+ * @test Vector of doubles, length 100, randomly generated, quantile=0.00, 
+ *	0.42, or 1.00. Expected behavior: equals element floor(quantile*100) 
+ *	(or 99 for quantile=1) of a sorted copy.
+ * @test Array of doubles, length 100, randomly generated, quantile=0.00, 
+ *	0.42, or 1.00. Expected behavior: equals element floor(quantile*100) 
+ *	(or 99 for quantile=1) of a sorted copy.
+ *
+ * @todo Pick a specific convention for quantiles and use it consistently
+ * @todo Apply concept checking to the return type
+ */
+template <typename ConstRandomAccessIterator> 				// Iterator to use
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstRandomAccessIterator>)) 
+	((RandomAccessTraversalConcept<ConstRandomAccessIterator>)),	// Iterator semantics
+	(typename std::iterator_traits<ConstRandomAccessIterator>::value_type)) // Return type
+quantile(ConstRandomAccessIterator first, ConstRandomAccessIterator last, double quantile) {
+	typedef typename std::iterator_traits<ConstRandomAccessIterator>::value_type Value;
+	
+	std::vector<Value> scratch;
+	return kpfutils::quantile(first, last, quantile, scratch);
+}
+
+/** Finds the (uninterpolated) quantile of the values in a generic container 
+ *	object, reordering the container. The container class is accessed 
+ *	using first and last iterators, and the quantile is computed over the 
+ *	interval [first, last). Data is assumed unsorted.
+ *
+ * This function is the fastest way to find a quantile of data that is no 
+ * longer needed in its original order, as it neither copies nor allocates.
+ * 
+ * @tparam RandomAccessIterator The iterator type for the container over which the 
+ *	quantile is to be calculated. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a>, <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/WritableIterator.html">writable</a>, and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/RandomAccessTraversal.html">random access</a>
+ * @param[in,out] first Input iterator marking the first element in the 
+ *	container.
+ * @param[in,out] last Input iterator marking the position after the last 
+ *	element in the container.
+ * @param[in] quantile The percentile to recover.
+ *
+ * @return The largest value whose quantile is less than or equal to 
+ *	@p quantile.
+ *
+ * @pre [@p first, @p last) is a valid range
+ * @pre 0 <= @p quantile <= 1
+ * @pre No value in [@p first, @p last) is NaN
+ *
+ * @post The return value is not NaN
+ * @post [@p first, @p last) is a permutation of its original contents, 
+ *	partitioned around the return value as by std::nth_element().
+ *
+ * @perform O(D) on average, where D = std::distance(@p first, @p last).
+ * 
+ * @exception std::invalid_argument Thrown if @p quantile is not 
+ *	in the interval [0, 1].
+ * @exception kpfutils::except::NotEnoughData Thrown if there are not enough 
+ *	elements to define a quantile.
+ * 
+ * @exceptsafe The range [@p first, @p last) is unchanged in the event of 
+ *	an exception.
+ *
+ * @test Vector of doubles, length 100, randomly generated, quantile=0.00, 
+ *	0.42, or 1.00. Expected behavior: same results as 
+ *	quantile(first, last, quantile).
+ */
+template <typename RandomAccessIterator> 				// Iterator to use
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<RandomAccessIterator>)) 
+	((RandomAccessTraversalConcept<RandomAccessIterator>)),	// Iterator semantics
+	(typename std::iterator_traits<RandomAccessIterator>::value_type)) // Return type
+quantileInPlace(RandomAccessIterator first, RandomAccessIterator last, double quantile) {
+	detail::checkQuantile(quantile, "quantileInPlace");
+
+	size_t vecSize = std::distance(first, last);
+	if (vecSize < 1) {
+		throw except::NotEnoughData("Supplied empty data set to quantileInPlace()");
+	}
+
+	size_t index = detail::quantileIndex(quantile, vecSize);
+	std::nth_element(first, first+index, last);
+	
+	return *(first+index);
+}
+
+/** Finds the (uninterpolated) quantile of the values in a sorted container 
+ *	object. The container class is accessed using first and last 
+ *	iterators, and the quantile is computed over the interval 
+ *	[first, last).
+ *
+ * The caller is responsible for ensuring the data are sorted; the order is 
+ * not checked. Use isSorted() to check it if in doubt.
+ * 
+ * @tparam ConstRandomAccessIterator The iterator type for the container over which the 
+ *	quantile is to be calculated. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/RandomAccessTraversal.html">random access</a>
+ * @param[in] first Input iterator marking the first element in the 
+ *	container.
+ * @param[in] last Input iterator marking the position after the last 
+ *	element in the container.
+ * @param[in] quantile The percentile to recover.
+ *
+ * @return The largest value whose quantile is less than or equal to 
+ *	@p quantile.
+ *
+ * @pre [@p first, @p last) is a valid range
+ * @pre [@p first, @p last) is sorted in ascending order
+ * @pre 0 <= @p quantile <= 1
+ * @pre No value in [@p first, @p last) is NaN
+ *
+ * @post The return value is not NaN
+ *
+ * @perform O(1)
+ * 
+ * @exception std::invalid_argument Thrown if @p quantile is not 
+ *	in the interval [0, 1].
+ * @exception kpfutils::except::NotEnoughData Thrown if there are not enough 
+ *	elements to define a quantile.
+ * 
+ * @exceptsafe The range [@p first, @p last) is unchanged in the event of an exception.
+ *
+ * @test Sorted vector of doubles, length 100, quantile=0.00, 0.42, or 1.00. 
+ *	Expected behavior: same results as quantile(first, last, quantile).
+ */
+template <typename ConstRandomAccessIterator> 				// Iterator to use
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstRandomAccessIterator>)) 
+	((RandomAccessTraversalConcept<ConstRandomAccessIterator>)),	// Iterator semantics
+	(typename std::iterator_traits<ConstRandomAccessIterator>::value_type)) // Return type
+quantileSorted(ConstRandomAccessIterator first, ConstRandomAccessIterator last, double quantile) {
+	detail::checkQuantile(quantile, "quantileSorted");
+
+	size_t vecSize = std::distance(first, last);
+	if (vecSize < 1) {
+		throw except::NotEnoughData("Supplied empty data set to quantileSorted()");
+	}
+
+	return *(first + detail::quantileIndex(quantile, vecSize));
+}
+
+namespace detail {
+
+/** Places several order statistics of an array in their sorted positions.
+ *
+ * The range of requested ranks is split at its middle rank, which is 
+ * placed with std::nth_element(). The two halves of the data are then 
+ * processed recursively, each with the ranks that fall inside it. This 
+ * takes O(D log K) time, compared to O(D K) for K separate selections.
+ *
+ * @param[in,out] first, last The data to partially order.
+ * @param[in] rankFirst, rankLast The ranks to find, relative to @p first, 
+ *	sorted in ascending order without duplicates.
+ * @param[in] offset The rank of the element at @p first.
+ *
+ * @post For every rank r in [@p rankFirst, @p rankLast), the element at 
+ *	@p first + (r - @p offset) is the one that would be there if 
+ *	[@p first, @p last) were sorted.
+ *
+ * @exceptsafe The range [@p first, @p last) is left in a valid but 
+ *	unspecified order in the event of an exception.
+ */
+template <typename RandomAccessIterator>
+void multiSelect(RandomAccessIterator first, RandomAccessIterator last, 
+		std::vector<size_t>::const_iterator rankFirst, 
+		std::vector<size_t>::const_iterator rankLast, size_t offset) {
+	if (rankFirst == rankLast || first == last) {
+		return;
+	}
+
+	std::vector<size_t>::const_iterator rankMid = rankFirst + (rankLast - rankFirst)/2;
+	RandomAccessIterator pivot = first + (*rankMid - offset);
+	std::nth_element(first, pivot, last);
+
+	multiSelect(first, pivot, rankFirst, rankMid, offset);
+	multiSelect(pivot+1, last, rankMid+1, rankLast, *rankMid+1);
+}
+
+}	// end detail
+
+/** Finds several (uninterpolated) quantiles of the values in a generic 
+ *	container object at once. The container class is accessed using first 
+ *	and last iterators, and the quantiles are computed over the interval 
+ *	[first, last). Data is assumed unsorted.
+ *
+ * Each quantile follows the same convention as 
+ * @ref quantile(ConstRandomAccessIterator, ConstRandomAccessIterator, double) 
+ * "quantile()". The data are copied only once, and all quantiles are 
+ * found in a single recursive selection, so this function is much faster 
+ * than calling quantile() repeatedly.
+ * 
+ * @tparam ConstRandomAccessIterator The iterator type for the container over which the 
+ *	quantiles are to be calculated. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/RandomAccessTraversal.html">random access</a>
+ * @param[in] first Input iterator marking the first element in the 
+ *	container.
+ * @param[in] last Input iterator marking the position after the last 
+ *	element in the container.
+ * @param[in] probs The percentiles to recover, in any order. Duplicates 
+ *	are allowed.
+ *
+ * @return A vector of the same length as @p probs, whose ith element is 
+ *	the largest value whose quantile is less than or equal to 
+ *	@p probs[i].
+ *
+ * @pre [@p first, @p last) is a valid range
+ * @pre 0 <= @p probs[i] <= 1 for all i
+ * @pre No value in [@p first, @p last) is NaN
+ *
+ * @post No element of the return value is NaN
+ *
+ * @perform O(D log K) on average, where D = std::distance(@p first, @p last) 
+ *	and K = @p probs.size().
+ * 
+ * @exception std::invalid_argument Thrown if any element of @p probs is 
+ *	not in the interval [0, 1].
+ * @exception kpfutils::except::NotEnoughData Thrown if there are not enough 
+ *	elements to define a quantile.
+ * @exception std::bad_alloc Thrown if there is not enough memory to copy 
+ *	the data.
+ * 
+ * @exceptsafe The range [@p first, @p last) is unchanged in the event of an exception.
+ *
+ * @test Vector of doubles, length 100, randomly generated, 
+ *	probs={0.95, 0.05, 0.5, 0.16, 0.84, 0.5, 0.0, 1.0}. Expected behavior: 
+ *	each element agrees with quantile(first, last, probs[i]).
+ * @test Vector of doubles, length 100, probs={0.5, 1.01}. Expected 
+ *	behavior: throw invalid_argument.
+ * @test Empty vector, probs={0.5}. Expected behavior: throw NotEnoughData.
+ * @test Vector of doubles, length 100, empty probs. Expected behavior: 
+ *	return empty vector.
+ */
+template <typename ConstRandomAccessIterator> 				// Iterator to use
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstRandomAccessIterator>)) 
+	((RandomAccessTraversalConcept<ConstRandomAccessIterator>)),	// Iterator semantics
+	(std::vector<typename std::iterator_traits<ConstRandomAccessIterator>::value_type>)) // Return type
+quantiles(ConstRandomAccessIterator first, ConstRandomAccessIterator last, 
+		const std::vector<double>& probs) {
+	typedef typename std::iterator_traits<ConstRandomAccessIterator>::value_type Value;
+
+	for(std::vector<double>::const_iterator it = probs.begin(); 
+			it != probs.end(); it++) {
+		detail::checkQuantile(*it, "quantiles");
+	}
+
+	size_t vecSize = std::distance(first, last);
+	if (vecSize < 1) {
+		throw except::NotEnoughData("Supplied empty data set to quantiles()");
+	}
+
+	std::vector<size_t> ranks;
+	ranks.reserve(probs.size());
+	for(std::vector<double>::const_iterator it = probs.begin(); 
+			it != probs.end(); it++) {
+		ranks.push_back(detail::quantileIndex(*it, vecSize));
+	}
+	std::vector<size_t> uniqueRanks(ranks);
+	std::sort(uniqueRanks.begin(), uniqueRanks.end());
+	uniqueRanks.erase(std::unique(uniqueRanks.begin(), uniqueRanks.end()), 
+		uniqueRanks.end());
+
+	// We don't want to alter the data, so we select from a copy
+	std::vector<Value> scratch(first, last);
+	detail::multiSelect(scratch.begin(), scratch.end(), 
+		uniqueRanks.begin(), uniqueRanks.end(), 0);
+
+	std::vector<Value> result;
+	result.reserve(ranks.size());
+	for(std::vector<size_t>::const_iterator it = ranks.begin(); 
+			it != ranks.end(); it++) {
+		result.push_back(scratch[*it]);
+	}
+	return result;
+}
+
+namespace detail {
+
+/** Computes the moments of the usable values in a contiguous array of 
+ *	floating-point values.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+template <typename ConstInputIterator>
+void maskedMoments(ConstInputIterator first, ConstInputIterator last, bool skipInf, 
+		long& count, double& mean, double& m2, true_type) {
+	const size_t n = static_cast<size_t>(last - first);
+	count = 0;
+	mean  = 0.0;
+	m2    = 0.0;
+	if (n > 0) {
+		maskedBlockMoments(ContiguousTraits<ConstInputIterator>::address(first), 
+			n, skipInf, count, mean, m2);
+	}
+}
+
+/** Computes the moments of the usable values in an arbitrary range.
+ *
+ * @exceptsafe Does not throw exceptions unless ConstInputIterator throws.
+ */
+template <typename ConstInputIterator>
+void maskedMoments(ConstInputIterator first, ConstInputIterator last, bool skipInf, 
+		long& count, double& mean, double& m2, false_type) {
+	maskedWelfordMoments(first, last, skipInf, count, mean, m2);
+}
+
+}	// end detail
+
+/** Finds the mean of the values in a generic container object, ignoring 
+ *	NaNs. The container class is accessed using first and last iterators, 
+ *	and the mean is computed over the interval [first, last).
+ *
+ * Invalid values are skipped as part of the same pass that computes the 
+ * mean, so no filtered copy of the data is needed. For contiguous ranges 
+ * of @c float or @c double, the filtering is done with masks rather than 
+ * branches, and the loop is vectorizable.
+ * 
+ * @tparam ConstInputIterator The iterator type for the container over which the 
+ *	mean is to be calculated. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
+ * @param[in] first Input iterator marking the first element in the container.
+ * @param[in] last Input iterator marking the position after the last 
+ *	element in the container.
+ * @param[out] nUsed The number of values included in the mean.
+ * @param[in] skipInf If set, infinite values are ignored as well as NaNs.
+ *
+ * @return The arithmetic mean of the elements between @p first, inclusive, 
+ *	and @p last, exclusive, that are not NaN (or, if @p skipInf is set, 
+ *	infinite). If @p skipInf is not set and the elements include 
+ *	infinities, the mean is that infinity if they all have the same 
+ *	sign, and NaN otherwise. The return type is that of the elements 
+ *	pointed to by the @p first and @p last iterators.
+ *
+ * @pre [@p first, @p last) is a valid range
+ * @pre There is at least one usable element in the range [@p first, @p last)
+ * @pre The program is not compiled with options, such as 
+ *	<tt>-ffast-math</tt>, that assume NaNs do not occur.
+ *
+ * @perform O(D), where D = std::distance(@p first, @p last).
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are not enough 
+ *	usable elements to define a mean.
+ * 
+ * @exceptsafe The range [@p first, @p last) and @p nUsed are unchanged 
+ *	in the event of an exception.
+ *
+ * @test Vector of doubles, all NaN. Expected behavior: throw NotEnoughData.
+ * @test Vector and list of doubles, length 100, every seventh value NaN 
+ *	and every eleventh value infinite, skipInf = true. Expected behavior: 
+ *	agrees with mean() of the finite values to within 1e-8, 
+ *	and reports their number.
+ * @test Vector and list of doubles, length 100, every seventh value NaN 
+ *	and one infinite value, skipInf = false. Expected behavior: returns 
+ *	infinity, and reports the number of non-NaN values.
+ * @test Vector and list of doubles, length 2000, one negative infinity 
+ *	after the first block, skipInf = false. Expected behavior: returns 
+ *	negative infinity.
+ * @test Vector and list of doubles, length 2000, infinities of both 
+ *	signs, skipInf = false. Expected behavior: returns NaN.
+ */
+template <typename ConstInputIterator> 				// Iterator to use
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstInputIterator>)) 
+	((ForwardTraversalConcept<ConstInputIterator>)),	// Iterator semantics
+	(typename std::iterator_traits<ConstInputIterator>::value_type)) // Return type
+nanMean(ConstInputIterator first, ConstInputIterator last, size_t& nUsed, 
+		bool skipInf = false) {
+	typedef typename std::iterator_traits<ConstInputIterator>::value_type Value;
+
+	long count = 0;
+	double mean = 0.0, m2 = 0.0;
+	detail::maskedMoments(first, last, skipInf, count, mean, m2, 
+		typename detail::UseFloatKernel<ConstInputIterator>::type());
+	if (count <= 0) {
+		throw except::NotEnoughData("Not enough data to compute mean");
+	}
+
+	nUsed = static_cast<size_t>(count);
+	return static_cast<Value>(mean);
+}
+
+/** Finds the variance of the values in a generic container object, ignoring 
+ *	NaNs. The container class is accessed using first and last iterators, 
+ *	and the variance is computed over the interval [first, last).
+ *
+ * Invalid values are skipped as part of the same pass that computes the 
+ * variance, so no filtered copy of the data is needed. For contiguous 
+ * ranges of @c float or @c double, the filtering is done with masks 
+ * rather than branches, and the loop is vectorizable.
+ * 
+ * @tparam ConstInputIterator The iterator type for the container over which the 
+ *	variance is to be calculated. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
+ * @param[in] first Input iterator marking the first element in the container.
+ * @param[in] last Input iterator marking the position after the last 
+ *	element in the container.
+ * @param[out] nUsed The number of values included in the variance.
+ * @param[in] skipInf If set, infinite values are ignored as well as NaNs.
+ *
+ * @return The (unbiased) sample variance of the elements between @p first, 
+ *	inclusive, and @p last, exclusive, that are not NaN (or, if 
+ *	@p skipInf is set, infinite). If @p skipInf is not set and the 
+ *	elements include infinities, the variance is NaN. The return type 
+ *	is that of the elements pointed to by the @p first and @p last 
+ *	iterators.
+ *
+ * @pre [@p first, @p last) is a valid range
+ * @pre There are at least two usable elements in the range [@p first, @p last)
+ * @pre The program is not compiled with options, such as 
+ *	<tt>-ffast-math</tt>, that assume NaNs do not occur.
+ *
+ * @perform O(D), where D = std::distance(@p first, @p last).
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are not enough 
+ *	usable elements to define a variance.
+ * 
+ * @exceptsafe The range [@p first, @p last) and @p nUsed are unchanged 
+ *	in the event of an exception.
+ *
+ * @test Vector of doubles, one non-NaN value. Expected behavior: throw 
+ *	NotEnoughData.
+ * @test Vector and list of doubles, length 100, every seventh value NaN 
+ *	and every eleventh value infinite, skipInf = true. Expected behavior: 
+ *	agrees with variance() of the finite values to within 1e-8, 
+ *	and reports their number.
+ */
+template <typename ConstInputIterator> 				// Iterator to use
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstInputIterator>)) 
+	((ForwardTraversalConcept<ConstInputIterator>)),	// Iterator semantics
+	(typename std::iterator_traits<ConstInputIterator>::value_type)) // Return type
+nanVariance(ConstInputIterator first, ConstInputIterator last, size_t& nUsed, 
+		bool skipInf = false) {
+	typedef typename std::iterator_traits<ConstInputIterator>::value_type Value;
+
+	long count = 0;
+	double mean = 0.0, m2 = 0.0;
+	detail::maskedMoments(first, last, skipInf, count, mean, m2, 
+		typename detail::UseFloatKernel<ConstInputIterator>::type());
+	if (count <= 1) {
+		throw except::NotEnoughData("Not enough data to compute variance");
+	}
+
+	nUsed = static_cast<size_t>(count);
+	return static_cast<Value>(m2 / (static_cast<double>(count) - 1.0));
+}
+
+/** Finds the (uninterpolated) quantile of the values in a generic container 
+ *	object, ignoring NaNs. The container class is accessed using first 
+ *	and last iterators, and the quantile is computed over the interval 
+ *	[first, last). Data is assumed unsorted.
+ *
+ * The usable values are copied into @p scratch in a single pass, and the 
+ * quantile is then found by selection, following the same convention as 
+ * @ref quantile(ConstRandomAccessIterator, ConstRandomAccessIterator, double) 
+ * "quantile()".
+ * 
+ * @tparam ConstInputIterator The iterator type for the container over which the 
+ *	quantile is to be calculated. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
+ * @param[in] first Input iterator marking the first element in the container.
+ * @param[in] last Input iterator marking the position after the last 
+ *	element in the container.
+ * @param[in] quantile The percentile to recover.
+ * @param[out] nUsed The number of values the quantile is drawn from.
+ * @param[in,out] scratch A buffer to use for the computation. Its contents 
+ *	on input are ignored, and its contents on output are unspecified.
+ * @param[in] skipInf If set, infinite values are ignored as well as NaNs.
+ *
+ * @return The largest usable value whose quantile, among the usable 
+ *	values, is less than or equal to @p quantile.
+ *
+ * @pre [@p first, @p last) is a valid range
+ * @pre [@p first, @p last) does not overlap @p scratch
+ * @pre 0 <= @p quantile <= 1
+ * @pre The program is not compiled with options, such as 
+ *	<tt>-ffast-math</tt>, that assume NaNs do not occur.
+ *
+ * @post The return value is not NaN
+ *
+ * @perform O(D) on average, where D = std::distance(@p first, @p last).
+ * @perform Does not allocate memory if @p scratch.capacity() >= D.
+ * 
+ * @exception std::invalid_argument Thrown if @p quantile is not 
+ *	in the interval [0, 1].
+ * @exception kpfutils::except::NotEnoughData Thrown if there are no 
+ *	usable elements.
+ * @exception std::bad_alloc Thrown if @p scratch could not be enlarged.
+ * 
+ * @exceptsafe The range [@p first, @p last) and @p nUsed are unchanged 
+ *	in the event of an exception. The contents of @p scratch are 
+ *	unspecified.
+ *
+ * @test Vector of doubles, all NaN. Expected behavior: throw NotEnoughData.
+ * @test Vector of doubles, length 100, every seventh value NaN and every 
+ *	eleventh value infinite, skipInf = true, quantile=0.00, 0.42, or 1.00. 
+ *	Expected behavior: agrees with quantile() of the finite values, 
+ *	and reports their number.
+ */
+template <typename ConstInputIterator> 				// Iterator to use
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstInputIterator>)) 
+	((ForwardTraversalConcept<ConstInputIterator>)),	// Iterator semantics
+	(typename std::iterator_traits<ConstInputIterator>::value_type)) // Return type
+nanQuantile(ConstInputIterator first, ConstInputIterator last, double quantile, 
+		size_t& nUsed, 
+		std::vector<typename std::iterator_traits<ConstInputIterator>::value_type>& scratch, 
+		bool skipInf = false) {
+	detail::checkQuantile(quantile, "nanQuantile");
+
+	scratch.clear();
+	for(; first != last; first++) {
+		if (detail::isUsable(static_cast<double>(*first), skipInf)) {
+			scratch.push_back(*first);
+		}
+	}
+	if (scratch.empty()) {
+		throw except::NotEnoughData("Supplied no valid data to nanQuantile()");
+	}
+
+	size_t index = detail::quantileIndex(quantile, scratch.size());
+	std::nth_element(scratch.begin(), scratch.begin()+index, scratch.end());
+	
+	nUsed = scratch.size();
+	return scratch[index];
+}
+
+/** Finds the (uninterpolated) quantile of the values in a generic container 
+ *	object, ignoring NaNs. The container class is accessed using first 
+ *	and last iterators, and the quantile is computed over the interval 
+ *	[first, last). Data is assumed unsorted.
+ *
+ * This function behaves exactly like the version of nanQuantile() taking 
+ * a scratch buffer, but allocates its own.
+ * 
+ * @tparam ConstInputIterator The iterator type for the container over which the 
+ *	quantile is to be calculated. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ForwardTraversal.html">forward traversal</a>.
+ * @param[in] first Input iterator marking the first element in the container.
+ * @param[in] last Input iterator marking the position after the last 
+ *	element in the container.
+ * @param[in] quantile The percentile to recover.
+ * @param[out] nUsed The number of values the quantile is drawn from.
+ * @param[in] skipInf If set, infinite values are ignored as well as NaNs.
+ *
+ * @return The largest usable value whose quantile, among the usable 
+ *	values, is less than or equal to @p quantile.
+ *
+ * @pre [@p first, @p last) is a valid range
+ * @pre 0 <= @p quantile <= 1
+ * @pre The program is not compiled with options, such as 
+ *	<tt>-ffast-math</tt>, that assume NaNs do not occur.
+ *
+ * @post The return value is not NaN
+ *
+ * @perform O(D) on average, where D = std::distance(@p first, @p last).
+ * 
+ * @exception std::invalid_argument Thrown if @p quantile is not 
+ *	in the interval [0, 1].
+ * @exception kpfutils::except::NotEnoughData Thrown if there are no 
+ *	usable elements.
+ * @exception std::bad_alloc Thrown if there is not enough memory to copy 
+ *	the data.
+ * 
+ * @exceptsafe The range [@p first, @p last) and @p nUsed are unchanged 
+ *	in the event of an exception.
+ *
+ * @test Vector of doubles, length 100, every seventh value NaN, 
+ *	quantile=0.42. Expected behavior: agrees with the version taking 
+ *	a scratch buffer.
+ */
+template <typename ConstInputIterator> 				// Iterator to use
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstInputIterator>)) 
+	((ForwardTraversalConcept<ConstInputIterator>)),	// Iterator semantics
+	(typename std::iterator_traits<ConstInputIterator>::value_type)) // Return type
+nanQuantile(ConstInputIterator first, ConstInputIterator last, double quantile, 
+		size_t& nUsed, bool skipInf = false) {
+	typedef typename std::iterator_traits<ConstInputIterator>::value_type Value;
+	
+	std::vector<Value> scratch;
+	return kpfutils::nanQuantile(first, last, quantile, nUsed, scratch, skipInf);
+}
+
+namespace detail {
+
+/** Tests whether an arbitrary range is sorted.
+ *
+ * @exceptsafe Does not throw exceptions unless ConstForwardIterator throws.
+ */
+template <class ConstForwardIterator>
+bool isSorted(ConstForwardIterator first, ConstForwardIterator last, false_type) {
+	// Code shamelessly copied from http://www.cplusplus.com/reference/algorithm/is_sorted/
+	if (first==last) {
+		return true;
+	}
+	
+	// Since iterators are passed by value, incrementing first does not 
+	//	violate exception guarantee
+	for(ConstForwardIterator next = first; ++next != last; ++first) {
+		if (*next<*first) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/** Tests whether a contiguous array of arithmetic values is sorted.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+template <class ConstForwardIterator>
+bool isSorted(ConstForwardIterator first, ConstForwardIterator last, true_type) {
+	typedef ContiguousTraits<ConstForwardIterator> Traits;
+
+	return sortedKernel(Traits::address(first), static_cast<size_t>(last - first));
+}
+
+}	// end detail
+
+/** Tests whether a range is sorted.
+ *
+ * This function emulates <tt>std::is_sorted()</tt> for platforms without access 
+ * to either a C++11-compliant compiler or Boost 1.50 or later.
+ *
+ * Contiguous ranges of arithmetic values (pointers or @c std::vector 
+ * iterators) are tested by a kernel that works on the underlying array.
+ *
+ * @tparam ConstForwardIterator The iterator type for the container to be tested. 
+ * Must be a <a href="http://www.boost.org/doc/libs/release/doc/html/ForwardIterator.html">forward iterator</a>.
+ * @param[in] first,last Forward iterators to the range to test. The range 
+ *	is all elements in the interval [@p first, @p last).
+ *
+ * @return True if [@p first, @p last) is sorted in ascending order. A range 
+ *	containing less than two elements is always sorted.
+ *
+ * @perform O(D), where D = std::distance(@p first, @p last).
+ *
+ * @exceptsafe The range [@p first, @p last) is unchanged in the event of 
+ *	an exception if ConstForwardIterator provides at least the basic 
+ *	guarantee. Does not throw exceptions unless ConstForwardIterator throws.
+ * 
+ * @test Empty list. Expected behavior: true.
+ * @test List of size 1. Expected behavior: true.
+ * @test List of size 2, sorted asc. Expected behavior: true.
+ * @test List of size 2, sorted desc. Expected behavior: false.
+ * @test List of size 10, list[i] = i^2. Expected behavior: true.
+ * @test List of size 10, list[i] = (i-5)^2. Expected behavior: false.
+ * @test List of size 10, random elements. Expected behavior: false.
+ *
+ * @todo Implement these test cases.
+ */
+template <class ConstForwardIterator>
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstForwardIterator>)) 
+	((ForwardTraversalConcept<ConstForwardIterator>)),	// Iterator semantics
+	(bool)) 					// Return type
+isSorted (ConstForwardIterator first, ConstForwardIterator last) {
+	return detail::isSorted(first, last, detail::UseArrayKernel<ConstForwardIterator>());
+}
 
 /** @} */	// end stats
 
 }	// end kpfutils
+
+#endif	// KPFUTILSSTATSH
@@ -0,0 +1,789 @@
+/** Specialized kernels for statistics on contiguous arrays
+ * @file common/stats_kernels.tmp.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#ifndef KPFUTILSSTATSKERNELSH
+#define KPFUTILSSTATSKERNELSH
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <boost/type_traits.hpp>
+#include "nan.h"
+
+namespace kpfutils { namespace detail {
+
+/*----------------------------------------------------------
+ * Compile-time identification of contiguous storage
+ * Each kernel in this file operates on a plain array. The generic
+ *	templates in stats.tmp.h use ContiguousTraits to decide, at compile
+ *	time, whether an iterator can be converted to such an array.
+ */
+
+/** Identifies iterators over contiguous arrays of arithmetic values.
+ *
+ * The primary template handles all iterators not known to be contiguous.
+ *
+ * @tparam Iterator The iterator type to test.
+ */
+template <typename Iterator>
+struct ContiguousTraits {
+	/** True if and only if @p Iterator points into a contiguous array of
+	 *	an arithmetic type
+	 */
+	static const bool value = false;
+};
+
+/** Identifies pointers to arithmetic values as contiguous.
+ *
+ * @tparam T The (possibly const) type pointed to.
+ */
+template <typename T>
+struct ContiguousTraits<T*> {
+	static const bool value = boost::is_arithmetic<T>::value;
+	/** The type of the array elements
+	 */
+	typedef typename boost::remove_cv<T>::type value_type;
+
+	/** Returns the address of the element an iterator points to
+	 */
+	static const value_type* address(T* it) {
+		return it;
+	}
+};
+
+#ifdef __GLIBCXX__
+/** Identifies libstdc++'s @c std::vector and @c std::string iterators as
+ *	contiguous.
+ *
+ * @tparam T The (possibly const) element type.
+ * @tparam Container The container type.
+ */
+template <typename T, typename Container>
+struct ContiguousTraits<__gnu_cxx::__normal_iterator<T*, Container> > {
+	static const bool value = boost::is_arithmetic<T>::value;
+	/** The type of the array elements
+	 */
+	typedef typename boost::remove_cv<T>::type value_type;
+
+	/** Returns the address of the element an iterator points to
+	 */
+	static const value_type* address(const __gnu_cxx::__normal_iterator<T*, Container>& it) {
+		return it.base();
+	}
+};
+#endif
+
+/** Selects the floating-point kernels for contiguous ranges of @c float
+ *	or @c double.
+ *
+ * @tparam Iterator The iterator type to test.
+ */
+template <typename Iterator>
+struct UseFloatKernel : public boost::integral_constant<bool,
+		ContiguousTraits<Iterator>::value
+		&& (boost::is_same<typename std::iterator_traits<Iterator>::value_type, float >::value
+		 || boost::is_same<typename std::iterator_traits<Iterator>::value_type, double>::value)> {
+};
+
+/** Selects the array kernels for contiguous ranges of any arithmetic type.
+ *
+ * @tparam Iterator The iterator type to test.
+ */
+template <typename Iterator>
+struct UseArrayKernel : public boost::integral_constant<bool,
+		ContiguousTraits<Iterator>::value> {
+};
+
+/*----------------------------------------------------------
+ * Sums
+ */
+
+/** Selects the type in which sums of an array are accumulated.
+ *
+ * Floating-point values are summed in @c double. Integers are summed in
+ * their own type, as in the generic templates, so that the kernels give
+ * exactly the same results for integer data.
+ *
+ * @tparam T The element type.
+ */
+template <typename T>
+struct SumType {
+	typedef T type;
+};
+
+/** Sums @c float values in @c double.
+ */
+template <>
+struct SumType<float> {
+	typedef double type;
+};
+
+/** Sums @c double values in @c double.
+ */
+template <>
+struct SumType<double> {
+	typedef double type;
+};
+
+/** Computes the sum of an array
+ *
+ * The loop keeps four independent accumulators, which breaks the
+ * dependency between successive additions and lets the compiler
+ * vectorize it.
+ *
+ * @tparam T The element type.
+ *
+ * @param[in] data, n The array to sum.
+ *
+ * @return The sum of the first @p n elements of @p data.
+ *
+ * @perform O(@p n)
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+template <typename T>
+typename SumType<T>::type blockSum(const T* data, size_t n) {
+	typedef typename SumType<T>::type Sum;
+
+	Sum s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+	size_t i = 0;
+	for(; i + 4 <= n; i += 4) {
+		s0 += data[i  ];
+		s1 += data[i+1];
+		s2 += data[i+2];
+		s3 += data[i+3];
+	}
+	for(; i < n; i++) {
+		s0 += data[i];
+	}
+	return (s0 + s1) + (s2 + s3);
+}
+
+/*----------------------------------------------------------
+ * Moments
+ */
+
+/** Number of elements per block in the blocked moment kernels. A block
+ *	of doubles fits comfortably in L1 cache, so the second pass over
+ *	each block does not touch main memory.
+ */
+const size_t MOMENT_BLOCK = 512;
+
+/** Merges the count, mean, and sum of squared deviations of two data sets
+ *
+ * This is the pairwise update of Chan, Golub, & LeVeque (1979).
+ *
+ * @param[in,out] n, mean, m2 The statistics of the first data set. On
+ *	return, the statistics of the union of both data sets.
+ * @param[in] nB, meanB, m2B The statistics of the second data set.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+inline void mergeMoments(double& n, double& mean, double& m2,
+		double nB, double meanB, double m2B) {
+	if (nB <= 0.0) {
+		return;
+	} else if (n <= 0.0) {
+		n = nB;
+		mean = meanB;
+		m2 = m2B;
+	} else {
+		const double nTotal = n + nB;
+		const double delta  = meanB - mean;
+		mean += delta * (nB / nTotal);
+		m2   += m2B + delta * delta * (n * nB / nTotal);
+		n     = nTotal;
+	}
+}
+
+/** Computes the mean and sum of squared deviations of a floating-point
+ *	array in a single pass
+ *
+ * The array is processed in cache-sized blocks. Each block's mean and
+ * squared deviations are found exactly with two passes over the (cached)
+ * block, using four independent accumulators so that the compiler can
+ * vectorize each pass. The blocks are then merged with mergeMoments().
+ * The result is as accurate as a two-pass algorithm, but reads the data
+ * from memory only once.
+ *
+ * @tparam T The element type, either @c float or @c double. All
+ *	arithmetic is done in @c double.
+ *
+ * @param[in] data, n The array to analyze.
+ * @param[out] mean The mean of the array.
+ * @param[out] m2 The sum of squared deviations from @p mean.
+ *
+ * @pre @p n > 0
+ *
+ * @perform O(@p n)
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+template <typename T>
+void blockMoments(const T* data, size_t n, double& mean, double& m2) {
+	double count = 0.0;
+	mean = 0.0;
+	m2   = 0.0;
+
+	for(size_t start = 0; start < n; start += MOMENT_BLOCK) {
+		const T* const block = data + start;
+		const size_t len = std::min(MOMENT_BLOCK, n - start);
+
+		double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+		size_t i = 0;
+		for(; i + 4 <= len; i += 4) {
+			s0 += block[i  ];
+			s1 += block[i+1];
+			s2 += block[i+2];
+			s3 += block[i+3];
+		}
+		for(; i < len; i++) {
+			s0 += block[i];
+		}
+		const double blockMean = ((s0 + s1) + (s2 + s3)) / static_cast<double>(len);
+
+		double q0 = 0.0, q1 = 0.0, q2 = 0.0, q3 = 0.0;
+		i = 0;
+		for(; i + 4 <= len; i += 4) {
+			const double d0 = block[i  ] - blockMean;
+			const double d1 = block[i+1] - blockMean;
+			const double d2 = block[i+2] - blockMean;
+			const double d3 = block[i+3] - blockMean;
+			q0 += d0*d0;
+			q1 += d1*d1;
+			q2 += d2*d2;
+			q3 += d3*d3;
+		}
+		for(; i < len; i++) {
+			const double d = block[i] - blockMean;
+			q0 += d*d;
+		}
+
+		mergeMoments(count, mean, m2, static_cast<double>(len), blockMean,
+			(q0 + q1) + (q2 + q3));
+	}
+}
+
+/** Computes the mean and sum of squared deviations of an arbitrary range
+ *	in a single pass
+ *
+ * This is Welford's (1962) algorithm, used for ranges that cannot be
+ * converted to arrays. The data are shifted by their first element, which
+ * preserves precision when the mean is much larger than the spread.
+ *
+ * @tparam ConstInputIterator A readable, forward-traversable iterator.
+ *
+ * @param[in] first, last The range to analyze.
+ * @param[out] count The number of elements in [@p first, @p last).
+ * @param[out] mean The mean of the range, or 0 if the range is empty.
+ * @param[out] m2 The sum of squared deviations from @p mean.
+ *
+ * @perform O(D), where D = std::distance(@p first, @p last).
+ *
+ * @exceptsafe Does not throw exceptions unless ConstInputIterator throws.
+ */
+template <typename ConstInputIterator>
+void welfordMoments(ConstInputIterator first, ConstInputIterator last,
+		long& count, double& mean, double& m2) {
+	count = 0;
+	mean  = 0.0;
+	m2    = 0.0;
+	if (first == last) {
+		return;
+	}
+
+	const double shift = static_cast<double>(*first);
+	for(; first != last; first++) {
+		const double x = static_cast<double>(*first) - shift;
+		count++;
+		const double delta = x - mean;
+		mean += delta / static_cast<double>(count);
+		m2   += delta * (x - mean);
+	}
+	mean += shift;
+}
+
+/*----------------------------------------------------------
+ * Inverse-variance weighted moments
+ */
+
+/** Merges the statistics of two weighted data sets
+ *
+ * @param[in,out] w, wSq, mean, s The total weight, sum of squared weights,
+ *	weighted mean, and weighted sum of squared deviations of the first
+ *	data set. On return, the statistics of the union of both data sets.
+ * @param[in] wB, wSqB, meanB, sB The statistics of the second data set.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+inline void mergeWeighted(double& w, double& wSq, double& mean, double& s,
+		double wB, double wSqB, double meanB, double sB) {
+	if (wB <= 0.0) {
+		return;
+	} else if (w <= 0.0) {
+		w = wB;
+		wSq = wSqB;
+		mean = meanB;
+		s = sB;
+	} else {
+		const double wTotal = w + wB;
+		const double delta  = meanB - mean;
+		mean += delta * (wB / wTotal);
+		s    += sB + delta * delta * (w * wB / wTotal);
+		w     = wTotal;
+		wSq  += wSqB;
+	}
+}
+
+/** Computes inverse-variance weighted statistics of floating-point arrays
+ *	in a single pass
+ *
+ * The arrays are processed in cache-sized blocks. The weights of each
+ * block are computed once into a small stack buffer, then the block's
+ * weighted mean and squared deviations are found with two passes over
+ * the (cached) block, using four independent accumulators so that the
+ * compiler can vectorize each pass. The blocks are then merged with
+ * mergeWeighted().
+ *
+ * @tparam T, U The element types of the data and errors, either @c float
+ *	or @c double. All arithmetic is done in @c double.
+ *
+ * @param[in] data, errors, n The arrays to analyze.
+ * @param[out] w The sum of the weights 1/@p errors[i]^2.
+ * @param[out] wSq The sum of the squared weights.
+ * @param[out] mean The weighted mean of @p data.
+ * @param[out] s The weighted sum of squared deviations from @p mean, which
+ *	is also the &chi;<sup>2</sup> of @p data about @p mean.
+ *
+ * @pre @p n > 0
+ *
+ * @perform O(@p n)
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+template <typename T, typename U>
+void blockWeighted(const T* data, const U* errors, size_t n,
+		double& w, double& wSq, double& mean, double& s) {
+	double weights[MOMENT_BLOCK];
+
+	w    = 0.0;
+	wSq  = 0.0;
+	mean = 0.0;
+	s    = 0.0;
+
+	for(size_t start = 0; start < n; start += MOMENT_BLOCK) {
+		const T* const block    = data   + start;
+		const U* const errBlock = errors + start;
+		const size_t len = std::min(MOMENT_BLOCK, n - start);
+
+		double a0 = 0.0, a1 = 0.0, a2 = 0.0, a3 = 0.0;
+		double b0 = 0.0, b1 = 0.0, b2 = 0.0, b3 = 0.0;
+		double c0 = 0.0, c1 = 0.0, c2 = 0.0, c3 = 0.0;
+		size_t i = 0;
+		for(; i + 4 <= len; i += 4) {
+			const double e0 = errBlock[i  ], e1 = errBlock[i+1];
+			const double e2 = errBlock[i+2], e3 = errBlock[i+3];
+			const double w0 = 1.0/(e0*e0), w1 = 1.0/(e1*e1);
+			const double w2 = 1.0/(e2*e2), w3 = 1.0/(e3*e3);
+			weights[i  ] = w0;
+			weights[i+1] = w1;
+			weights[i+2] = w2;
+			weights[i+3] = w3;
+			a0 += w0;
+			a1 += w1;
+			a2 += w2;
+			a3 += w3;
+			b0 += w0*block[i  ];
+			b1 += w1*block[i+1];
+			b2 += w2*block[i+2];
+			b3 += w3*block[i+3];
+			c0 += w0*w0;
+			c1 += w1*w1;
+			c2 += w2*w2;
+			c3 += w3*w3;
+		}
+		for(; i < len; i++) {
+			const double e = errBlock[i];
+			const double wi = 1.0/(e*e);
+			weights[i] = wi;
+			a0 += wi;
+			b0 += wi*block[i];
+			c0 += wi*wi;
+		}
+		const double blockW    = (a0 + a1) + (a2 + a3);
+		const double blockMean = ((b0 + b1) + (b2 + b3)) / blockW;
+
+		double q0 = 0.0, q1 = 0.0, q2 = 0.0, q3 = 0.0;
+		i = 0;
+		for(; i + 4 <= len; i += 4) {
+			const double d0 = block[i  ] - blockMean;
+			const double d1 = block[i+1] - blockMean;
+			const double d2 = block[i+2] - blockMean;
+			const double d3 = block[i+3] - blockMean;
+			q0 += weights[i  ]*d0*d0;
+			q1 += weights[i+1]*d1*d1;
+			q2 += weights[i+2]*d2*d2;
+			q3 += weights[i+3]*d3*d3;
+		}
+		for(; i < len; i++) {
+			const double d = block[i] - blockMean;
+			q0 += weights[i]*d*d;
+		}
+
+		mergeWeighted(w, wSq, mean, s, blockW, (c0 + c1) + (c2 + c3),
+			blockMean, (q0 + q1) + (q2 + q3));
+	}
+}
+
+/** Computes inverse-variance weighted statistics of arbitrary ranges in a
+ *	single pass
+ *
+ * This is West's (1979) weighted update, used for ranges that cannot be
+ * converted to arrays. The data are shifted by their first element, which
+ * preserves precision when the mean is much larger than the spread.
+ *
+ * @tparam ConstInputIterator1, ConstInputIterator2 Readable,
+ *	forward-traversable iterators.
+ *
+ * @param[in] first, last The data to analyze.
+ * @param[in] errFirst The start of the errors, one per datum.
+ * @param[out] count The number of elements in [@p first, @p last).
+ * @param[out] w, wSq, mean, s As for blockWeighted().
+ *
+ * @perform O(D), where D = std::distance(@p first, @p last).
+ *
+ * @exceptsafe Does not throw exceptions unless the iterators throw.
+ */
+template <typename ConstInputIterator1, typename ConstInputIterator2>
+void westWeighted(ConstInputIterator1 first, ConstInputIterator1 last,
+		ConstInputIterator2 errFirst,
+		long& count, double& w, double& wSq, double& mean, double& s) {
+	count = 0;
+	w     = 0.0;
+	wSq   = 0.0;
+	mean  = 0.0;
+	s     = 0.0;
+	if (first == last) {
+		return;
+	}
+
+	const double shift = static_cast<double>(*first);
+	for(; first != last; first++, errFirst++) {
+		const double x  = static_cast<double>(*first) - shift;
+		const double e  = static_cast<double>(*errFirst);
+		const double wi = 1.0/(e*e);
+		count++;
+
+		const double wNew  = w + wi;
+		const double delta = x - mean;
+		const double r     = delta * wi / wNew;
+		mean += r;
+		s    += w * delta * r;
+		w     = wNew;
+		wSq  += wi*wi;
+	}
+	mean += shift;
+}
+
+/*----------------------------------------------------------
+ * Moments of data containing invalid values
+ */
+
+/** Tests whether a value should be included in a NaN-skipping statistic
+ *
+ * The tests are those of isNan() and isNanOrInf(), which rely only on
+ * IEEE comparison semantics and so compile to branch-free compare
+ * instructions. They give incorrect results if the
+ * program is compiled with options such as <tt>-ffast-math</tt> that
+ * assume no NaNs exist.
+ *
+ * @param[in] x The value to test.
+ * @param[in] skipInf If set, reject infinite values as well as NaN.
+ *
+ * @return True if @p x is not NaN and, if @p skipInf is set, not infinite.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+inline bool isUsable(double x, bool skipInf) {
+	return skipInf ? !isNanOrInf(x) : !isNan(x);
+}
+
+/** Folds infinite values into the moments of the finite values
+ *
+ * Infinities are counted separately from the finite values because
+ * including them in the running mean gives inf - inf = NaN as soon as a
+ * second value arrives.
+ *
+ * @param[in] posInf, negInf The number of positive and negative
+ *	infinities.
+ * @param[in,out] count, mean, m2 On input, the statistics of the finite
+ *	values. On output, the statistics of all values: the mean is the
+ *	infinity if all infinities have the same sign and NaN otherwise,
+ *	and @p m2 is NaN.
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+inline void addInfinities(long posInf, long negInf, long& count, double& mean, double& m2) {
+	if (posInf <= 0 && negInf <= 0) {
+		return;
+	}
+	count += posInf + negInf;
+	if (negInf <= 0) {
+		mean = std::numeric_limits<double>::infinity();
+	} else if (posInf <= 0) {
+		mean = -std::numeric_limits<double>::infinity();
+	} else {
+		mean = std::numeric_limits<double>::quiet_NaN();
+	}
+	m2 = std::numeric_limits<double>::quiet_NaN();
+}
+
+/** Implements maskedBlockMoments() for a fixed choice of values to reject
+ *
+ * Making the choice a template parameter removes the only branch from the
+ * inner loops. Only finite values enter the sums; if infinities are kept,
+ * they are counted in a separate pass over each cached block and folded
+ * in with addInfinities().
+ *
+ * @tparam SkipInf If set, reject infinite values as well as NaN.
+ */
+template <bool SkipInf, typename T>
+void maskedBlockMomentsImpl(const T* data, size_t n,
+		long& count, double& mean, double& m2) {
+	const double inf = std::numeric_limits<double>::infinity();
+	double total = 0.0, posInf = 0.0, negInf = 0.0;
+	mean = 0.0;
+	m2   = 0.0;
+
+	for(size_t start = 0; start < n; start += MOMENT_BLOCK) {
+		const T* const block = data + start;
+		const size_t len = std::min(MOMENT_BLOCK, n - start);
+
+		if (!SkipInf) {
+			for(size_t i = 0; i < len; i++) {
+				const double x = block[i];
+				posInf += (x ==  inf ? 1.0 : 0.0);
+				negInf += (x == -inf ? 1.0 : 0.0);
+			}
+		}
+
+		double s0 = 0.0, s1 = 0.0, s2 = 0.0, s3 = 0.0;
+		double n0 = 0.0, n1 = 0.0, n2 = 0.0, n3 = 0.0;
+		size_t i = 0;
+		for(; i + 4 <= len; i += 4) {
+			const double x0 = block[i  ], x1 = block[i+1];
+			const double x2 = block[i+2], x3 = block[i+3];
+			const bool ok0 = isUsable(x0, true), ok1 = isUsable(x1, true);
+			const bool ok2 = isUsable(x2, true), ok3 = isUsable(x3, true);
+			s0 += (ok0 ? x0 : 0.0);
+			s1 += (ok1 ? x1 : 0.0);
+			s2 += (ok2 ? x2 : 0.0);
+			s3 += (ok3 ? x3 : 0.0);
+			n0 += (ok0 ? 1.0 : 0.0);
+			n1 += (ok1 ? 1.0 : 0.0);
+			n2 += (ok2 ? 1.0 : 0.0);
+			n3 += (ok3 ? 1.0 : 0.0);
+		}
+		for(; i < len; i++) {
+			const double x = block[i];
+			const bool ok = isUsable(x, true);
+			s0 += (ok ? x : 0.0);
+			n0 += (ok ? 1.0 : 0.0);
+		}
+		const double blockCount = (n0 + n1) + (n2 + n3);
+		if (blockCount <= 0.0) {
+			continue;
+		}
+		const double blockMean = ((s0 + s1) + (s2 + s3)) / blockCount;
+
+		double q0 = 0.0, q1 = 0.0, q2 = 0.0, q3 = 0.0;
+		i = 0;
+		for(; i + 4 <= len; i += 4) {
+			const double x0 = block[i  ], x1 = block[i+1];
+			const double x2 = block[i+2], x3 = block[i+3];
+			const double d0 = (isUsable(x0, true) ? x0 : blockMean) - blockMean;
+			const double d1 = (isUsable(x1, true) ? x1 : blockMean) - blockMean;
+			const double d2 = (isUsable(x2, true) ? x2 : blockMean) - blockMean;
+			const double d3 = (isUsable(x3, true) ? x3 : blockMean) - blockMean;
+			q0 += d0*d0;
+			q1 += d1*d1;
+			q2 += d2*d2;
+			q3 += d3*d3;
+		}
+		for(; i < len; i++) {
+			const double x = block[i];
+			const double d = (isUsable(x, true) ? x : blockMean) - blockMean;
+			q0 += d*d;
+		}
+
+		mergeMoments(total, mean, m2, blockCount, blockMean,
+			(q0 + q1) + (q2 + q3));
+	}
+
+	count = static_cast<long>(total);
+	addInfinities(static_cast<long>(posInf), static_cast<long>(negInf), count, mean, m2);
+}
+
+/** Computes the mean and sum of squared deviations of the usable values
+ *	in a floating-point array in a single pass
+ *
+ * This is the masked equivalent of blockMoments(). Rejected values are
+ * replaced by zero weight rather than skipped with a branch, so the loops
+ * remain vectorizable.
+ *
+ * @tparam T The element type, either @c float or @c double. All
+ *	arithmetic is done in @c double.
+ *
+ * @param[in] data, n The array to analyze.
+ * @param[in] skipInf If set, reject infinite values as well as NaN.
+ * @param[out] count The number of usable values.
+ * @param[out] mean The mean of the usable values, or 0 if there are none.
+ *	If infinities are usable and present, this is the infinity if
+ *	they all have the same sign, and NaN otherwise.
+ * @param[out] m2 The sum of squared deviations of the usable values
+ *	from @p mean, or NaN if infinities are usable and present.
+ *
+ * @perform O(@p n)
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+template <typename T>
+void maskedBlockMoments(const T* data, size_t n, bool skipInf,
+		long& count, double& mean, double& m2) {
+	if (skipInf) {
+		maskedBlockMomentsImpl<true >(data, n, count, mean, m2);
+	} else {
+		maskedBlockMomentsImpl<false>(data, n, count, mean, m2);
+	}
+}
+
+/** Computes the mean and sum of squared deviations of the usable values
+ *	in an arbitrary range in a single pass
+ *
+ * This is the masked equivalent of welfordMoments().
+ *
+ * @tparam ConstInputIterator A readable, forward-traversable iterator.
+ *
+ * @param[in] first, last The range to analyze.
+ * @param[in] skipInf If set, reject infinite values as well as NaN.
+ * @param[out] count, mean, m2 As for maskedBlockMoments().
+ *
+ * @perform O(D), where D = std::distance(@p first, @p last).
+ *
+ * @exceptsafe Does not throw exceptions unless ConstInputIterator throws.
+ */
+template <typename ConstInputIterator>
+void maskedWelfordMoments(ConstInputIterator first, ConstInputIterator last,
+		bool skipInf, long& count, double& mean, double& m2) {
+	count = 0;
+	mean  = 0.0;
+	m2    = 0.0;
+
+	const double inf = std::numeric_limits<double>::infinity();
+	long posInf = 0, negInf = 0;
+	double shift = 0.0;
+	for(; first != last; first++) {
+		const double raw = static_cast<double>(*first);
+		if (!isUsable(raw, true)) {
+			if (!skipInf) {
+				posInf += (raw ==  inf ? 1 : 0);
+				negInf += (raw == -inf ? 1 : 0);
+			}
+			continue;
+		}
+		if (count == 0) {
+			shift = raw;
+		}
+		const double x = raw - shift;
+		count++;
+		const double delta = x - mean;
+		mean += delta / static_cast<double>(count);
+		m2   += delta * (x - mean);
+	}
+	mean += shift;
+	addInfinities(posInf, negInf, count, mean, m2);
+}
+
+/*----------------------------------------------------------
+ * Ordering
+ */
+
+/** Number of elements compared between early-exit tests in sortedKernel()
+ */
+const size_t SORTED_BLOCK = 64;
+
+/** Selects the type in which sortedKernel() counts out-of-order elements.
+ *
+ * Counting in a type as wide as the elements lets each comparison result 
+ * stay in its own vector lane.
+ *
+ * @tparam T The element type.
+ */
+template <typename T>
+struct FlagType {
+	typedef int type;
+};
+
+/** Counts out-of-order @c float values in @c float lanes.
+ */
+template <>
+struct FlagType<float> {
+	typedef float type;
+};
+
+/** Counts out-of-order @c double values in @c double lanes.
+ */
+template <>
+struct FlagType<double> {
+	typedef double type;
+};
+
+/** Tests whether an array is sorted in ascending order
+ *
+ * The array is compared in blocks of SORTED_BLOCK adjacent pairs. Within 
+ * a block, the out-of-order pairs are counted without branching, so that 
+ * the compiler can compare several pairs per instruction; the count is 
+ * tested only at the end of each block. The function therefore reads at 
+ * most one block past the first out-of-order pair.
+ *
+ * @tparam T The element type.
+ *
+ * @param[in] data, n The array to test.
+ *
+ * @return True if no element of @p data is less than the one before it.
+ *
+ * @perform O(@p n)
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+template <typename T>
+bool sortedKernel(const T* data, size_t n) {
+	typedef typename FlagType<T>::type Flag;
+
+	for(size_t start = 1; start < n; start += SORTED_BLOCK) {
+		const size_t end = std::min(n, start + SORTED_BLOCK);
+		Flag descents = 0;
+		for(size_t i = start; i < end; i++) {
+			descents += (data[i] < data[i-1] ? 1 : 0);
+		}
+		if (descents != 0) {
+			return false;
+		}
+	}
+	return true;
+}
+
+}}	// end kpfutils::detail
+
+#endif	// KPFUTILSSTATSKERNELSH
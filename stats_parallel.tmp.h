@@ -0,0 +1,362 @@
+/** Multithreaded statistics for large data sets
+ * @file common/stats_parallel.tmp.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#ifndef KPFUTILSSTATSPARALLELH
+#define KPFUTILSSTATSPARALLELH
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+#include <boost/bind/bind.hpp>
+#include <boost/concept/requires.hpp>
+#include <boost/iterator/iterator_concepts.hpp>
+#include <boost/ref.hpp>
+#include <boost/thread.hpp>
+#include "moments.h"
+#include "stats.tmp.h"
+#include "stats_except.h"
+
+namespace kpfutils {
+
+/** @addtogroup stats
+ *
+ * Include stats_parallel.tmp.h to split statistics of large data sets
+ * across several threads. These functions require Boost.Thread.
+ *
+ * @{
+ */
+
+namespace detail {
+
+/** Smallest number of elements worth giving to a separate thread
+ */
+const size_t MIN_THREAD_CHUNK = 16384;
+
+/** Count, mean, and sum of squared deviations of part of a data set
+ */
+struct PartialMoments {
+	PartialMoments() : count(0), mean(0.0), m2(0.0) {
+	}
+
+	long count;
+	double mean;
+	double m2;
+};
+
+/** Computes the moments of one thread's share of a data set
+ *
+ * @param[in] first, last The range to analyze.
+ * @param[out] result The statistics of [@p first, @p last).
+ *
+ * @exceptsafe Does not throw exceptions unless the iterators throw.
+ */
+template <typename ConstRandomAccessIterator>
+void chunkMoments(ConstRandomAccessIterator first, ConstRandomAccessIterator last,
+		PartialMoments& result) {
+	moments(first, last, result.count, result.mean, result.m2,
+		typename UseFloatKernel<ConstRandomAccessIterator>::type());
+}
+
+/** Computes all four moments of one thread's share of a data set
+ *
+ * @param[in] first, last The range to analyze.
+ * @param[out] result The moments of [@p first, @p last).
+ *
+ * @exceptsafe Does not throw exceptions unless the iterators throw.
+ */
+template <typename ConstRandomAccessIterator>
+void chunkAllMoments(ConstRandomAccessIterator first, ConstRandomAccessIterator last,
+		Moments& result) {
+	for(; first != last; first++) {
+		result.add(static_cast<double>(*first));
+	}
+}
+
+/** Runs a task on one share of a range, storing its output only when done
+ *
+ * The outputs of all shares sit next to each other in memory, so a task
+ * that updated its output in place would keep invalidating the cache
+ * lines of its neighbors. Working on a local copy avoids this false
+ * sharing.
+ *
+ * @param[in] task A function taking a subrange and an output object.
+ * @param[in] first, last The subrange to process.
+ * @param[out] result The output of @p task.
+ *
+ * @exceptsafe Does not throw exceptions unless @p task or the copy
+ *	assignment of @p Result throws.
+ */
+template <typename ConstRandomAccessIterator, typename Result>
+void runShare(void (*task)(ConstRandomAccessIterator, ConstRandomAccessIterator, Result&),
+		ConstRandomAccessIterator first, ConstRandomAccessIterator last, 
+		Result& result) {
+	Result local;
+	task(first, last, local);
+	result = local;
+}
+
+/** Runs a task over equal, contiguous shares of a range, one per thread
+ *
+ * Share @p i is [@p first + i*D/T, @p first + (i+1)*D/T), where D is
+ * the length of the range and T the number of shares. The first share
+ * is processed by the calling thread. Each thread works on a private
+ * output object and copies it into @p results once at the end.
+ *
+ * @param[in] first, last The range to divide.
+ * @param[in] nThreads The requested number of threads, or 0 to use one
+ *	per processor.
+ * @param[in] task A function taking a subrange and an output object.
+ * @param[out] results The output of each share, in order.
+ *
+ * @post The number of shares depends only on @p nThreads and the length
+ *	of the range, so the results are reproducible.
+ *
+ * @exception boost::thread_resource_error Thrown if a thread could not
+ *	be started.
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	start the threads.
+ *
+ * @exceptsafe All threads are finished in the event of an exception.
+ *	The contents of @p results are unspecified.
+ */
+template <typename ConstRandomAccessIterator, typename Result>
+void splitRange(ConstRandomAccessIterator first, ConstRandomAccessIterator last,
+		unsigned int nThreads,
+		void (*task)(ConstRandomAccessIterator, ConstRandomAccessIterator, Result&),
+		std::vector<Result>& results) {
+	const size_t n = static_cast<size_t>(std::distance(first, last));
+	if (nThreads == 0) {
+		nThreads = std::max(1u, boost::thread::hardware_concurrency());
+	}
+	const size_t nShares = std::max<size_t>(1,
+		std::min<size_t>(nThreads, n / MIN_THREAD_CHUNK));
+
+	results.assign(nShares, Result());
+	boost::thread_group workers;
+	try {
+		for(size_t i = 1; i < nShares; i++) {
+			workers.create_thread(boost::bind(
+				&runShare<ConstRandomAccessIterator, Result>, task,
+				first + i*n/nShares, first + (i+1)*n/nShares,
+				boost::ref(results[i])));
+		}
+		runShare(task, first, first + n/nShares, results[0]);
+	} catch (...) {
+		workers.join_all();
+		throw;
+	}
+	workers.join_all();
+}
+
+}	// end detail
+
+/** Finds the mean of the values in a random-access container, using
+ *	several threads. The mean is computed over the interval [first, last).
+ *
+ * The range is split into equal, contiguous shares, whose statistics are
+ * merged in order once all threads finish. The result is therefore the
+ * same from run to run for a given number of threads, but may differ in
+ * the last few bits from mean() or from a run with a different number of
+ * threads. Ranges too short to benefit from threading are processed on
+ * the calling thread alone.
+ *
+ * @tparam ConstRandomAccessIterator The iterator type for the container over which the
+ *	mean is to be calculated. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/RandomAccessTraversal.html">random access</a>.
+ * @param[in] first Input iterator marking the first element in the container.
+ * @param[in] last Input iterator marking the position after the last element in the container.
+ * @param[in] nThreads The maximum number of threads to use, including
+ *	the calling thread. If 0, uses one thread per processor.
+ *
+ * @return The arithmetic mean of the elements between @p first, inclusive,
+ *	and @p last, exclusive. The return type is that of the elements
+ *	pointed to by the @p first and @p last iterators.
+ *
+ * @pre [@p first, @p last) is a valid range
+ * @pre There is at least one element in the range [@p first, @p last)
+ * @pre No value in [@p first, @p last) is NaN
+ * @pre [@p first, @p last) is not modified by another thread during the call
+ *
+ * @post The return value is not NaN
+ *
+ * @perform O(D/T), where D = std::distance(@p first, @p last) and
+ *	T = @p nThreads.
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are not enough
+ *	elements to define a mean.
+ * @exception boost::thread_resource_error Thrown if a thread could not
+ *	be started.
+ *
+ * @exceptsafe The range [@p first, @p last) is unchanged in the event of an exception.
+ *
+ * @test Vector of doubles, length 10^6, 1, 2, 3, or 8 threads. Expected
+ *	behavior: agrees with mean() to within 1e-8.
+ * @test Vector of doubles, length 10^6, 4 threads, run twice. Expected
+ *	behavior: identical results.
+ */
+template <typename ConstRandomAccessIterator> 				// Iterator to use
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstRandomAccessIterator>))
+	((RandomAccessTraversalConcept<ConstRandomAccessIterator>)),	// Iterator semantics
+	(typename std::iterator_traits<ConstRandomAccessIterator>::value_type)) // Return type
+parallelMean(ConstRandomAccessIterator first, ConstRandomAccessIterator last,
+		unsigned int nThreads = 0) {
+	typedef typename std::iterator_traits<ConstRandomAccessIterator>::value_type Value;
+
+	std::vector<detail::PartialMoments> shares;
+	detail::splitRange(first, last, nThreads,
+		&detail::chunkMoments<ConstRandomAccessIterator>, shares);
+
+	double count = 0.0, mean = 0.0, m2 = 0.0;
+	for(std::vector<detail::PartialMoments>::const_iterator it = shares.begin();
+			it != shares.end(); it++) {
+		detail::mergeMoments(count, mean, m2,
+			static_cast<double>(it->count), it->mean, it->m2);
+	}
+	if (count < 1.0) {
+		throw except::NotEnoughData("Not enough data to compute mean");
+	}
+
+	return static_cast<Value>(mean);
+}
+
+/** Finds the variance of the values in a random-access container, using
+ *	several threads. The variance is computed over the interval
+ *	[first, last).
+ *
+ * The range is split into equal, contiguous shares, whose statistics are
+ * merged in order once all threads finish. The result is therefore the
+ * same from run to run for a given number of threads, but may differ in
+ * the last few bits from meanVariance() or from a run with a different
+ * number of threads. Ranges too short to benefit from threading are
+ * processed on the calling thread alone.
+ *
+ * @tparam ConstRandomAccessIterator The iterator type for the container over which the
+ *	variance is to be calculated. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/RandomAccessTraversal.html">random access</a>.
+ * @param[in] first Input iterator marking the first element in the container.
+ * @param[in] last Input iterator marking the position after the last element in the container.
+ * @param[in] nThreads The maximum number of threads to use, including
+ *	the calling thread. If 0, uses one thread per processor.
+ *
+ * @return The (unbiased) sample variance of the elements between @p first,
+ *	inclusive, and @p last, exclusive. The return type is that of the
+ *	elements pointed to by the @p first and @p last iterators.
+ *
+ * @pre [@p first, @p last) is a valid range
+ * @pre There are at least two elements in the range [@p first, @p last)
+ * @pre No value in [@p first, @p last) is NaN
+ * @pre [@p first, @p last) is not modified by another thread during the call
+ *
+ * @post The return value is not NaN
+ *
+ * @perform O(D/T), where D = std::distance(@p first, @p last) and
+ *	T = @p nThreads.
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are not enough
+ *	elements to define a variance.
+ * @exception boost::thread_resource_error Thrown if a thread could not
+ *	be started.
+ *
+ * @exceptsafe The range [@p first, @p last) is unchanged in the event of an exception.
+ *
+ * @test List of ints, length 1. Expected behavior: throw NotEnoughData.
+ * @test Vector of doubles, length 10^6, 1, 2, 3, or 8 threads. Expected
+ *	behavior: agrees with meanVariance() to within 1e-8.
+ * @test Vector of doubles, length 10^6, 4 threads, run twice. Expected
+ *	behavior: identical results.
+ */
+template <typename ConstRandomAccessIterator> 				// Iterator to use
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstRandomAccessIterator>))
+	((RandomAccessTraversalConcept<ConstRandomAccessIterator>)),	// Iterator semantics
+	(typename std::iterator_traits<ConstRandomAccessIterator>::value_type)) // Return type
+parallelVariance(ConstRandomAccessIterator first, ConstRandomAccessIterator last,
+		unsigned int nThreads = 0) {
+	typedef typename std::iterator_traits<ConstRandomAccessIterator>::value_type Value;
+
+	std::vector<detail::PartialMoments> shares;
+	detail::splitRange(first, last, nThreads,
+		&detail::chunkMoments<ConstRandomAccessIterator>, shares);
+
+	double count = 0.0, mean = 0.0, m2 = 0.0;
+	for(std::vector<detail::PartialMoments>::const_iterator it = shares.begin();
+			it != shares.end(); it++) {
+		detail::mergeMoments(count, mean, m2,
+			static_cast<double>(it->count), it->mean, it->m2);
+	}
+	if (count < 2.0) {
+		throw except::NotEnoughData("Not enough data to compute variance");
+	}
+
+	return static_cast<Value>(m2 / (count - 1.0));
+}
+
+/** Finds the first four moments of the values in a random-access
+ *	container, using several threads. The moments are computed over
+ *	the interval [first, last).
+ *
+ * Each thread accumulates a Moments object for its share of the range,
+ * and the objects are merged in order once all threads finish. The
+ * result is therefore the same from run to run for a given number of
+ * threads.
+ *
+ * @tparam ConstRandomAccessIterator The iterator type for the container over which the
+ *	moments are to be calculated. Must be <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/ReadableIterator.html">readable</a> and support <a href="http://www.boost.org/doc/libs/release/libs/iterator/doc/RandomAccessTraversal.html">random access</a>.
+ * @param[in] first Input iterator marking the first element in the container.
+ * @param[in] last Input iterator marking the position after the last element in the container.
+ * @param[in] nThreads The maximum number of threads to use, including
+ *	the calling thread. If 0, uses one thread per processor.
+ *
+ * @return An accumulator containing all elements between @p first,
+ *	inclusive, and @p last, exclusive. The accumulator may be empty.
+ *
+ * @pre [@p first, @p last) is a valid range
+ * @pre No value in [@p first, @p last) is NaN
+ * @pre [@p first, @p last) is not modified by another thread during the call
+ *
+ * @perform O(D/T), where D = std::distance(@p first, @p last) and
+ *	T = @p nThreads.
+ *
+ * @exception boost::thread_resource_error Thrown if a thread could not
+ *	be started.
+ *
+ * @exceptsafe The range [@p first, @p last) is unchanged in the event of an exception.
+ *
+ * @test Vector of doubles, length 10^6, 1 or 3 threads. Expected
+ *	behavior: mean, variance, skewness, and kurtosis agree with a
+ *	single Moments object to within 1e-8.
+ */
+template <typename ConstRandomAccessIterator> 				// Iterator to use
+BOOST_CONCEPT_REQUIRES(
+	((ReadableIteratorConcept<ConstRandomAccessIterator>))
+	((RandomAccessTraversalConcept<ConstRandomAccessIterator>)),	// Iterator semantics
+	(Moments)) // Return type
+parallelMoments(ConstRandomAccessIterator first, ConstRandomAccessIterator last,
+		unsigned int nThreads = 0) {
+	std::vector<Moments> shares;
+	detail::splitRange(first, last, nThreads,
+		&detail::chunkAllMoments<ConstRandomAccessIterator>, shares);
+
+	Moments result;
+	for(std::vector<Moments>::const_iterator it = shares.begin();
+			it != shares.end(); it++) {
+		result.merge(*it);
+	}
+	return result;
+}
+
+/** @} */	// end stats
+
+}	// end kpfutils
+
+#endif		// KPFUTILSSTATSPARALLELH
@@ -0,0 +1,167 @@
+/** Timing benchmarks for statistics template functions in stats.tmp.h
+ * @file common/tests/bench_stats.cpp
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is part of the kpfutils Test Suite.
+ *
+ * The kpfutils Test Suite is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as published
+ * by the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version, subject to the following
+ * exception added under Section 7 of the License:
+ *	* Neither the name of the copyright holder nor the names of its contributors
+ *	  may be used to endorse or promote products derived from this software
+ *	  without specific prior written permission.
+ *
+ * The kpfutils Test Suite is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with the kpfutils Test Suite. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <boost/iterator/iterator_adaptor.hpp>
+#include "../stats.tmp.h"
+
+namespace kpfutils { namespace test {
+
+/** Wraps an iterator so that stats.tmp.h cannot recognize it as contiguous.
+ *
+ * Timing a range through both the raw and the wrapped iterator measures
+ * the gain from the array kernels on identical data.
+ */
+template <typename Iterator>
+class Opaque : public boost::iterator_adaptor<Opaque<Iterator>, Iterator> {
+public:
+	/** Wraps an iterator.
+	 */
+	explicit Opaque(Iterator it) : Opaque::iterator_adaptor_(it) {
+	}
+};
+
+/** Wraps an iterator so that stats.tmp.h cannot recognize it as contiguous.
+ */
+template <typename Iterator>
+Opaque<Iterator> opaque(Iterator it) {
+	return Opaque<Iterator>(it);
+}
+
+/** Number of elements in each benchmark array
+ */
+const size_t BENCH_LEN = 1 << 20;
+/** Number of times each function is called per measurement
+ */
+const int BENCH_REPS = 50;
+
+/** Keeps the compiler from discarding the benchmarked calls
+ */
+volatile double sink = 0.0;
+
+/** Identifies a statistic to benchmark
+ */
+enum Statistic {MEAN, VARIANCE, MEDIAN, MAXIMUM, SORTED};
+
+/** Computes one statistic of a range
+ */
+template <typename Iterator, typename Value>
+double compute(Statistic stat, Iterator first, Iterator last, std::vector<Value>& scratch) {
+	switch (stat) {
+	case MEAN:
+		return static_cast<double>(kpfutils::mean(first, last));
+	case VARIANCE:
+		return static_cast<double>(kpfutils::variance(first, last));
+	case MEDIAN:
+		return static_cast<double>(kpfutils::quantile(first, last, 0.5, scratch));
+	case MAXIMUM:
+		return static_cast<double>(kpfutils::quantile(first, last, 1.0, scratch));
+	case SORTED:
+		return kpfutils::isSorted(first, last) ? 1.0 : 0.0;
+	default:
+		return 0.0;
+	}
+}
+
+/** Returns the average time, in nanoseconds per element, needed to
+ *	compute a statistic
+ */
+template <typename Iterator, typename Value>
+double timeStat(Statistic stat, Iterator first, Iterator last, std::vector<Value>& scratch) {
+	const std::clock_t start = std::clock();
+	for (int i = 0; i < BENCH_REPS; i++) {
+		sink = sink + compute(stat, first, last, scratch);
+	}
+	const std::clock_t end = std::clock();
+
+	return 1e9 * static_cast<double>(end - start) / CLOCKS_PER_SEC
+		/ (static_cast<double>(BENCH_REPS) * static_cast<double>(last - first));
+}
+
+/** Prints the time taken by each statistic with and without the array
+ *	kernels
+ */
+template <typename Value>
+void benchmark(const char* typeName, const std::vector<Value>& data) {
+	static const char* const NAMES[] = {"mean", "variance", "quantile(0.5)",
+		"quantile(1.0)", "isSorted"};
+	static const Statistic STATS[] = {MEAN, VARIANCE, MEDIAN, MAXIMUM, SORTED};
+
+	std::vector<Value> sorted(data);
+	std::sort(sorted.begin(), sorted.end());
+	std::vector<Value> scratch;
+
+	for (size_t i = 0; i < sizeof(STATS)/sizeof(STATS[0]); i++) {
+		// isSorted exits early on random data, so time it on sorted data
+		const std::vector<Value>& input = (STATS[i] == SORTED ? sorted : data);
+
+		const double generic = timeStat(STATS[i],
+			opaque(input.begin()), opaque(input.end()), scratch);
+		const double array   = timeStat(STATS[i],
+			input.begin(), input.end(), scratch);
+		std::printf("%-15s %-14s %10.3f %10.3f %8.2fx\n", typeName, NAMES[i],
+			generic, array, generic / array);
+	}
+}
+
+}}		// end kpfutils::test
+
+/** Times the statistics functions on large arrays of doubles, floats,
+ *	and ints, comparing the generic iterator code to the contiguous-array
+ *	kernels.
+ */
+int main() {
+	using namespace kpfutils::test;
+
+	std::srand(42);
+	std::vector<double> dblData(BENCH_LEN);
+	std::vector<float>  fltData(BENCH_LEN);
+	std::vector<int>    intData(BENCH_LEN);
+	for (size_t i = 0; i < BENCH_LEN; i++) {
+		const double x = static_cast<double>(std::rand()) / RAND_MAX;
+		dblData[i] = x;
+		fltData[i] = static_cast<float>(x);
+		// Small enough that the sums of squares cannot overflow
+		intData[i] = static_cast<int>(40.0 * x);
+	}
+
+	std::printf("%d elements, %d calls each; times in ns per element\n",
+		static_cast<int>(BENCH_LEN), BENCH_REPS);
+	std::printf("%-15s %-14s %10s %10s %9s\n", "type", "statistic",
+		"generic", "array", "speedup");
+	benchmark("vector<double>", dblData);
+	benchmark("vector<float>",  fltData);
+	benchmark("vector<int>",    intData);
+
+	return 0;
+}
@@ -2,7 +2,7 @@
  * @file common/tests/unit_lcio.cpp
  * @author Krzysztof Findeisen
  * @date Created July 25, 2011
- * @date Last modified July 25, 2013
+ * @date Last modified October 18, 2026
  */
 
 /* Copyright 2014, California Institute of Technology.
@@ -49,9 +49,23 @@
 #pragma GCC diagnostic pop
 #endif
 
+#include <string>
 #include <vector>
 #include <cmath>
+#include <cstdio>
+#include <sys/stat.h>
+#include <zlib.h>
+#include <boost/bind/bind.hpp>
+#include <boost/thread.hpp>
+#include "../alloc.tmp.h"
+#include "../archive.h"
+#include "../csv.h"
+#include "../fileio.h"
+#include "../prefetch.h"
+#include "../lcio.h"
+#include "../sorted.tmp.h"
 
+using std::string;
 using std::vector;
 
 // Private functions to test
@@ -114,6 +128,415 @@ BOOST_AUTO_TEST_CASE(time_sort3)
 	BOOST_CHECK_NO_THROW(sortByTime(mockTimes, mockData, mockErrs));
 }
 
+/** Tests whether the light curve readers can mark their times as sorted
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(sorted_read)
+{
+	{
+		FILE* hFile = fopen("test_lc.txt", "wb");
+		BOOST_REQUIRE(hFile != NULL);
+		fprintf(hFile, "# time mag\n3.0 13.0\n1.0 11.0\n2.0 12.0\n");
+		fclose(hFile);
+	}
+	
+	/** @test Unsorted two-column file. Expected behavior: Sorted and plain 
+	 *	readers give the same times in ascending order, with each 
+	 *	measurement still matched to its time.
+	 */
+	vector<double> times, data, sortedData;
+	Sorted<vector<double> > sortedTimes;
+	readMcLightCurve("test_lc.txt", times, data);
+	readMcLightCurve("test_lc.txt", sortedTimes, sortedData);
+	remove("test_lc.txt");
+	
+	BOOST_REQUIRE_EQUAL(sortedTimes.size(), 3U);
+	BOOST_CHECK(sortedTimes.get() == times);
+	BOOST_CHECK(sortedData == data);
+	for(size_t i = 0; i < 3; i++) {
+		BOOST_CHECK_EQUAL(sortedTimes.get()[i], 1.0 + i);
+		BOOST_CHECK_EQUAL(sortedData[i], 11.0 + i);
+	}
+	
+	/** @test Already sorted data. Expected behavior: sortByTime() leaves 
+	 *	the data unchanged.
+	 */
+	const vector<double> oldData(data);
+	sortByTime(times, data);
+	BOOST_CHECK(data == oldData);
+	
+	/** @test Sorted and unsorted data with a repeated time. Expected 
+	 *	behavior: sortByTime() orders the tied measurements by value in 
+	 *	both cases.
+	 */
+	const double sortedTieTimes[] = {1.0, 2.0, 2.0, 3.0};
+	const double sortedTieData [] = {1.0, 5.0, 4.0, 3.0};
+	const double shuffledTieTimes[] = {2.0, 3.0, 1.0, 2.0};
+	const double shuffledTieData [] = {5.0, 3.0, 1.0, 4.0};
+	const double expectedData[] = {1.0, 4.0, 5.0, 3.0};
+	vector<double> tieTimes(sortedTieTimes, sortedTieTimes+4);
+	vector<double> tieData (sortedTieData , sortedTieData +4);
+	sortByTime(tieTimes, tieData);
+	BOOST_CHECK_EQUAL_COLLECTIONS(tieData.begin(), tieData.end(), 
+		expectedData, expectedData+4);
+	
+	tieTimes.assign(shuffledTieTimes, shuffledTieTimes+4);
+	tieData .assign(shuffledTieData , shuffledTieData +4);
+	sortByTime(tieTimes, tieData);
+	BOOST_CHECK_EQUAL_COLLECTIONS(tieTimes.begin(), tieTimes.end(), 
+		sortedTieTimes, sortedTieTimes+4);
+	BOOST_CHECK_EQUAL_COLLECTIONS(tieData.begin(), tieData.end(), 
+		expectedData, expectedData+4);
+}
+
+/** Tests whether the light curve readers can store measurements in 
+ *	single precision
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(float_read)
+{
+	{
+		FILE* hFile = fopen("test_lc.txt", "wb");
+		BOOST_REQUIRE(hFile != NULL);
+		fprintf(hFile, "# time mag err\n"
+			"2456000.0003 13.1 0.01\n"
+			"2456000.0001 13.3 0.50\n"
+			"2456000.0002 13.2 0.02\n");
+		fclose(hFile);
+	}
+	
+	/** @test Unsorted three-column file with one noisy point, times that 
+	 *	differ only in the tenth significant figure. Expected behavior: 
+	 *	float and double readers give identical times, and the float 
+	 *	measurements and errors equal the double ones rounded to float.
+	 */
+	vector<double> times, data, errs, fltTimes;
+	FloatVec fltData, fltErrs;
+	readWgLightCurve("test_lc.txt", 0.1, times, data, errs);
+	readWgLightCurve("test_lc.txt", 0.1, fltTimes, fltData, fltErrs);
+	remove("test_lc.txt");
+	
+	BOOST_REQUIRE_EQUAL(fltTimes.size(), 2U);
+	BOOST_REQUIRE_EQUAL(fltData .size(), 2U);
+	BOOST_REQUIRE_EQUAL(fltErrs .size(), 2U);
+	BOOST_CHECK(fltTimes == times);
+	BOOST_CHECK(fltTimes[0] < fltTimes[1]);
+	for(size_t i = 0; i < 2; i++) {
+		BOOST_CHECK_EQUAL(fltData[i], static_cast<float>(data[i]));
+		BOOST_CHECK_EQUAL(fltErrs[i], static_cast<float>(errs[i]));
+	}
+	BOOST_CHECK_EQUAL(fltData[0], 13.2f);
+	
+	/** @test Three-column file with errors 0.1, 0.05, and 0.1, 
+	 *	errMax = 0.1. Expected behavior: float and double readers both 
+	 *	keep all three points.
+	 */
+	{
+		FILE* hFile = fopen("test_lc.txt", "wb");
+		BOOST_REQUIRE(hFile != NULL);
+		fprintf(hFile, "1.0 13.1 0.1\n2.0 13.3 0.05\n3.0 13.2 0.1\n");
+		fclose(hFile);
+	}
+	readWgLightCurve("test_lc.txt", 0.1, times, data, errs);
+	readWgLightCurve("test_lc.txt", 0.1, fltTimes, fltData, fltErrs);
+	remove("test_lc.txt");
+	BOOST_CHECK_EQUAL(times   .size(), 3U);
+	BOOST_CHECK_EQUAL(fltTimes.size(), 3U);
+	BOOST_CHECK_EQUAL(fltErrs .size(), 3U);
+	
+	/** @test Two-column file. Expected behavior: float measurements equal 
+	 *	the double ones rounded to float.
+	 */
+	{
+		FILE* hFile = fopen("test_lc.txt", "wb");
+		BOOST_REQUIRE(hFile != NULL);
+		fprintf(hFile, "2456000.0003 13.1\n2456000.0001 13.3\n2456000.0002 13.2\n");
+		fclose(hFile);
+	}
+	vector<double> mcData;
+	FloatVec fltMcData;
+	readMcLightCurve("test_lc.txt", times, mcData);
+	readMcLightCurve("test_lc.txt", fltTimes, fltMcData);
+	remove("test_lc.txt");
+	
+	BOOST_REQUIRE_EQUAL(fltMcData.size(), 3U);
+	BOOST_CHECK(fltTimes == times);
+	for(size_t i = 0; i < 3; i++) {
+		BOOST_CHECK_EQUAL(fltMcData[i], static_cast<float>(mcData[i]));
+	}
+}
+
+/** Writes text to a named pipe, for readers to consume
+ */
+void writeFifo(const string& fileName, const string& text) {
+	FILE* hFifo = fopen(fileName.c_str(), "wb");
+	if (hFifo != NULL) {
+		fputs(text.c_str(), hFifo);
+		fclose(hFifo);
+	}
+}
+
+/** Tests whether readFileNames() handles comments, line endings, and 
+ *	long lines
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(file_names)
+{
+	const string longName(300, 'x');
+	{
+		FILE* hList = fopen("test_list.txt", "wb");
+		BOOST_REQUIRE(hList != NULL);
+		fprintf(hList, "# comment\na.dat\nb dat\r\n\n%s", longName.c_str());
+		fclose(hList);
+	}
+	
+	/** @test List with a comment, Unix and Windows newlines, a blank line, 
+	 *	and a 300-character name with no trailing newline. Expected 
+	 *	behavior: four names, none truncated.
+	 */
+	FileNameList names;
+	BOOST_REQUIRE_NO_THROW(readFileNames("test_list.txt", names));
+	BOOST_REQUIRE_EQUAL(names.size(), 4);
+	BOOST_CHECK_EQUAL(string(names[0]), "a.dat");
+	BOOST_CHECK_EQUAL(string(names[1]), "b dat");
+	BOOST_CHECK_EQUAL(names.length(2), 0);
+	BOOST_CHECK_EQUAL(names.length(3), longName.size());
+	BOOST_CHECK_EQUAL(string(names[3]), longName);
+	
+	vector<string> nameVec;
+	BOOST_REQUIRE_NO_THROW(readFileNames("test_list.txt", nameVec));
+	BOOST_REQUIRE_EQUAL(nameVec.size(), 4);
+	BOOST_CHECK_EQUAL(nameVec[3], longName);
+	
+	/** @test Nonexistent file. Expected behavior: throw FileIo and leave 
+	 *	the list unchanged.
+	 */
+	BOOST_CHECK_THROW(readFileNames("test_nonexistent.txt", names), except::FileIo);
+	BOOST_CHECK_EQUAL(names.size(), 4);
+	
+	remove("test_list.txt");
+	
+	/** @test Named pipe containing two names. Expected behavior: two 
+	 *	names, the same as for a regular file.
+	 */
+	BOOST_REQUIRE_EQUAL(mkfifo("test_list.fifo", 0600), 0);
+	{
+		boost::thread writer(boost::bind(&writeFifo, string("test_list.fifo"), 
+			string("a.dat\n# comment\nb.dat\n")));
+		BOOST_CHECK_NO_THROW(readFileNames("test_list.fifo", nameVec));
+		writer.join();
+	}
+	remove("test_list.fifo");
+	BOOST_REQUIRE_EQUAL(nameVec.size(), 2);
+	BOOST_CHECK_EQUAL(nameVec[0], "a.dat");
+	BOOST_CHECK_EQUAL(nameVec[1], "b.dat");
+}
+
+/** Tests whether Prefetcher keeps consistent statistics
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(prefetch)
+{
+	vector<string> files;
+	for(size_t i = 0; i < 5; i++) {
+		files.push_back("test_prefetch" + string(1, static_cast<char>('0'+i)) + ".txt");
+		// Leave one file missing
+		if (i != 3) {
+			printTable(files.back(), "Time\tMag", mockTimes, mockData);
+		}
+	}
+	
+	/** @test List of 5 files, one missing, read in order with distance 2. 
+	 *	Expected behavior: the 3 existing files after the first are 
+	 *	advised, and every read counts as warm or cold.
+	 */
+	Prefetcher<vector<string> > prefetcher(files, 2);
+	for(size_t i = 0; i < files.size(); i++) {
+		prefetcher.advance(i);
+	}
+	BOOST_CHECK_EQUAL(prefetcher.visited(), files.size());
+	BOOST_CHECK_EQUAL(prefetcher.advised(), 3);
+	BOOST_CHECK_EQUAL(prefetcher.warm() + prefetcher.cold(), files.size());
+	BOOST_CHECK(!isCached("test_prefetch3.txt"));
+	
+	for(size_t i = 0; i < files.size(); i++) {
+		remove(files[i].c_str());
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+/** Reads an entire file, decompressing it if necessary
+ *
+ * @param[in] fileName The file to read.
+ *
+ * @return The uncompressed contents of @p fileName.
+ */
+string slurp(const string& fileName) {
+	string contents;
+	gzFile hInput = gzopen(fileName.c_str(), "rb");
+	if (hInput != NULL) {
+		char buffer[4096];
+		int nRead;
+		while ((nRead = gzread(hInput, buffer, sizeof(buffer))) > 0) {
+			contents.append(buffer, nRead);
+		}
+		gzclose(hInput);
+	}
+	return contents;
+}
+
+/** Reads an entire file without decompressing it
+ *
+ * @param[in] fileName The file to read.
+ *
+ * @return The raw contents of @p fileName.
+ */
+string slurpRaw(const string& fileName) {
+	string contents;
+	FILE* hInput = fopen(fileName.c_str(), "rb");
+	if (hInput != NULL) {
+		char buffer[4096];
+		size_t nRead;
+		while ((nRead = fread(buffer, 1, sizeof(buffer), hInput)) > 0) {
+			contents.append(buffer, nRead);
+		}
+		fclose(hInput);
+	}
+	return contents;
+}
+
+/** Test cases for light curve output
+ * @class BoostTest::test_lcwrite
+ */
+BOOST_FIXTURE_TEST_SUITE(test_lcwrite, LcIoData)
+
+/** Tests whether printPeriodogram() compresses output on request
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(compressed_output)
+{
+	/** @test Uncompressed and gzipped periodograms. Expected behavior: 
+	 *	identical contents after decompression.
+	 */
+	BOOST_REQUIRE_NO_THROW(printPeriodogram("test_plain.txt", 
+		mockTimes, mockData, 10.0, 0.01));
+	BOOST_REQUIRE_NO_THROW(printPeriodogram("test_auto.txt.gz", 
+		mockTimes, mockData, 10.0, 0.01));
+	BOOST_REQUIRE_NO_THROW(printPeriodogram("test_explicit.txt", 
+		mockTimes, mockData, 10.0, 0.01, CODEC_GZIP));
+	
+	const string plain = slurp("test_plain.txt");
+	BOOST_CHECK(!plain.empty());
+	BOOST_CHECK(slurp("test_auto.txt.gz") == plain);
+	BOOST_CHECK(slurp("test_explicit.txt") == plain);
+	
+	/** @test Gzipped periodograms read without decompression. Expected 
+	 *	behavior: gzip header present, contents differ from plain text.
+	 */
+	const char* compressed[] = {"test_auto.txt.gz", "test_explicit.txt"};
+	for (size_t i = 0; i < 2; i++) {
+		const string raw = slurpRaw(compressed[i]);
+		BOOST_REQUIRE(raw.size() >= 2);
+		BOOST_CHECK_EQUAL(static_cast<unsigned char>(raw[0]), 0x1f);
+		BOOST_CHECK_EQUAL(static_cast<unsigned char>(raw[1]), 0x8b);
+		BOOST_CHECK(raw != plain);
+	}
+	
+	/** @test Compressed file opened for reading. Expected behavior: 
+	 *	throw invalid_argument.
+	 */
+	BOOST_CHECK_THROW(fileCheckOpen("test_auto.txt.gz", "r", CODEC_GZIP), 
+		std::invalid_argument);
+	
+	/** @test Gzipped and plain periodograms written to a full device. 
+	 *	Expected behavior: throw FileIo.
+	 */
+	BOOST_CHECK_THROW(printPeriodogram("/dev/full", mockTimes, mockData, 10.0, 0.01, 
+		CODEC_GZIP), except::FileIo);
+	BOOST_CHECK_THROW(printPeriodogram("/dev/full", mockTimes, mockData, 10.0, 0.01, 
+		CODEC_NONE), except::FileIo);
+	
+	/** @test Plain table written to a full device, closed explicitly. 
+	 *	Expected behavior: throw FileIo naming the file.
+	 */
+	{
+		boost::shared_ptr<FILE> hFull = fileCheckOpen("/dev/full", "w");
+		fputs("Time\tMag\n", hFull.get());
+		try {
+			fileCheckClose(hFull);
+			BOOST_ERROR("fileCheckClose() did not throw on /dev/full");
+		} catch (const except::FileIo& e) {
+			BOOST_CHECK(string(e.what()).find("/dev/full") != string::npos);
+		}
+		BOOST_CHECK(!hFull);
+	}
+	
+	remove("test_plain.txt");
+	remove("test_auto.txt.gz");
+	remove("test_explicit.txt");
+}
+
+/** Tests whether light curve products can be stored in and retrieved from 
+ *	an archive
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(archive_output)
+{
+	BOOST_REQUIRE_NO_THROW(printAcf("test_plain.txt", mockTimes, mockData));
+	
+	{
+		ArchiveWriter archive("test_archive.dat");
+		BOOST_REQUIRE_NO_THROW(printPeriodogram(archive, "star1/pgram", 
+			mockTimes, mockData, 10.0, 0.01));
+		BOOST_REQUIRE_NO_THROW(printAcf (archive, "star1/acf" , mockTimes, mockData));
+		
+		/** @test Entry with mismatched columns. Expected behavior: throw 
+		 *	invalid_argument, archive remains usable.
+		 */
+		vector<double> shortData(mockData.begin(), mockData.end()-1);
+		BOOST_CHECK_THROW(printDmDt(archive, "star1/dmdt", mockTimes, shortData), 
+			std::invalid_argument);
+		BOOST_REQUIRE_NO_THROW(printRmsT(archive, "star2/rmst", mockTimes, mockErrs));
+		
+		/** @test Duplicate entry. Expected behavior: throw invalid_argument.
+		 */
+		BOOST_CHECK_THROW(printAcf(archive, "star1/acf", mockTimes, mockData), 
+			std::invalid_argument);
+		BOOST_REQUIRE_NO_THROW(archive.close());
+	}
+	
+	/** @test Archive with three entries. Expected behavior: each entry 
+	 *	identical to the equivalent stand-alone file.
+	 */
+	ArchiveReader reader("test_archive.dat");
+	BOOST_CHECK_EQUAL(reader.entryNames().size(), 3);
+	BOOST_CHECK( reader.contains("star1/pgram"));
+	BOOST_CHECK(!reader.contains("star1/dmdt"));
+	BOOST_CHECK(reader.read("star1/acf") == slurp("test_plain.txt"));
+	BOOST_CHECK_THROW(reader.read("star3/acf"), std::invalid_argument);
+	
+	{
+		boost::shared_ptr<FILE> hEntry = reader.open("star2/rmst");
+		char buffer[256];
+		size_t nLines = 0;
+		while (NULL != fgets(buffer, 256, hEntry.get())) {
+			nLines++;
+		}
+		// Header plus one line per point
+		BOOST_CHECK_EQUAL(nLines, mockTimes.size()+1);
+	}
+	
+	remove("test_plain.txt");
+	remove("test_archive.dat");
+}
+
 BOOST_AUTO_TEST_SUITE_END()
 
 }}	// end kpfutils::test
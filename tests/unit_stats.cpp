@@ -2,7 +2,7 @@
  * @file common/tests/unit_stats.cpp
  * @author Krzysztof Findeisen
  * @date Created July 20, 2011
- * @date Last modified July 24, 2013
+ * @date Last modified October 18, 2026
  */
 
 /* Copyright 2014, California Institute of Technology.
@@ -49,16 +49,30 @@
 #pragma GCC diagnostic pop
 #endif
 
+#include <algorithm>
+#include <limits>
 #include <list>
+#include <locale>
 #include <stdexcept>
 #include <vector>
+#include <cmath>
 #include <boost/smart_ptr.hpp>
 #include <gsl/gsl_randist.h>
 #include <gsl/gsl_rng.h>
 #include <gsl/gsl_statistics_double.h>
 #include <gsl/gsl_statistics_int.h>
+#include "../binning.tmp.h"
+#include "../histogram.tmp.h"
+#include "../moments.h"
 #include "../nan.h"
+#include "../periodogram.h"
+#include "../robust.tmp.h"
+#include "../rolling.h"
+#include "../sketch.h"
+#include "../sorted.tmp.h"
 #include "../stats.tmp.h"
+#include "../stats_parallel.tmp.h"
+#include "../variability.tmp.h"
 #include "../alloc.tmp.h"
 
 namespace kpfutils { namespace test {
@@ -67,6 +81,15 @@ using boost::shared_array;
 using boost::shared_ptr;
 using namespace std;
 
+/** Number formatting that uses a decimal comma, as in many European locales
+ */
+class CommaDecimal : public std::numpunct<char> {
+protected:
+	char do_decimal_point() const {
+		return ',';
+	}
+};
+
 /** Data common to the test cases.
  *
  * Contains arrays, lists, and vectors with mock data.
@@ -277,47 +300,2172 @@ BOOST_AUTO_TEST_CASE(variance)
 	}
 }
 
-BOOST_AUTO_TEST_SUITE_END()
+/** Tests whether meanVariance() works as advertised
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(mean_variance)
+{
+	/** @test List of ints, length 0. Expected behavior: throw NotEnoughData.
+	 */
+	BOOST_CHECK_THROW(kpfutils::meanVariance(emptyList.begin(), emptyList.end()), 
+		except::NotEnoughData);
+	
+	/** @test List of ints, length 1. Expected behavior: throw NotEnoughData.
+	 */
+	BOOST_CHECK_THROW(kpfutils::meanVariance(oneList.begin(), oneList.end()), 
+		except::NotEnoughData);
+	
+	for (size_t nTest = 0; nTest < TEST_COUNT; nTest++) {
+		double trueMean = gsl_stats_mean    (dblArray[nTest].get(), 1, TEST_LEN);
+		double trueVar  = gsl_stats_variance(dblArray[nTest].get(), 1, TEST_LEN);
+		
+		/** @test List of doubles, length 100, randomly generated. Expected behavior: 
+		 *	agrees with gsl_stats_mean and gsl_stats_variance to within 
+		 *	1e-8 in 10 out of 10 trials.
+		 */
+		{
+			std::pair<double, double> stats = kpfutils::meanVariance(
+				dblList[nTest].begin(), dblList[nTest].end());
+			BOOST_CHECK_CLOSE(stats.first,  trueMean, TEST_TOLERANCE);
+			BOOST_CHECK_CLOSE(stats.second, trueVar,  TEST_TOLERANCE);
+		}
+		
+		/** @test Vector of doubles, length 100, randomly generated. Expected behavior: 
+		 *	agrees with gsl_stats_mean and gsl_stats_variance to within 
+		 *	1e-8 in 10 out of 10 trials.
+		 */
+		{
+			std::pair<double, double> stats = kpfutils::meanVariance(
+				dblVec[nTest].begin(), dblVec[nTest].end());
+			BOOST_CHECK_CLOSE(stats.first,  trueMean, TEST_TOLERANCE);
+			BOOST_CHECK_CLOSE(stats.second, trueVar,  TEST_TOLERANCE);
+		}
+		
+		/** @test Array of doubles, length 100, randomly generated. Expected behavior: 
+		 *	agrees with gsl_stats_mean and gsl_stats_variance to within 
+		 *	1e-8 in 10 out of 10 trials.
+		 */
+		{
+			std::pair<double, double> stats = kpfutils::meanVariance(
+				dblArray[nTest].get(), dblArray[nTest].get()+TEST_LEN);
+			BOOST_CHECK_CLOSE(stats.first,  trueMean, TEST_TOLERANCE);
+			BOOST_CHECK_CLOSE(stats.second, trueVar,  TEST_TOLERANCE);
+		}
+	}
+	
+	/** @test Vector of doubles, length 10000, values 1e9 + i%10. Expected 
+	 *	behavior: mean 1e9 + 4.5 and variance 8.25*N/(N-1) to within 1e-8.
+	 */
+	{
+		const size_t BIG_LEN = 10000;
+		vector<double> offset;
+		list<double> offsetList;
+		for (size_t i = 0; i < BIG_LEN; i++) {
+			offset.push_back(1e9 + static_cast<double>(i % 10));
+			offsetList.push_back(offset.back());
+		}
+		const double trueVar = 8.25 * BIG_LEN / (BIG_LEN - 1.0);
+		
+		std::pair<double, double> stats = kpfutils::meanVariance(
+			offset.begin(), offset.end());
+		BOOST_CHECK_CLOSE(stats.first,  1e9 + 4.5, TEST_TOLERANCE);
+		BOOST_CHECK_CLOSE(stats.second, trueVar,   TEST_TOLERANCE);
+		
+		stats = kpfutils::meanVariance(offsetList.begin(), offsetList.end());
+		BOOST_CHECK_CLOSE(stats.first,  1e9 + 4.5, TEST_TOLERANCE);
+		BOOST_CHECK_CLOSE(stats.second, trueVar,   TEST_TOLERANCE);
+	}
+}
 
-// Boost.Test uses non-virtual destructors
-#ifdef GNUC_FINEWARN
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Weffc++"
-#endif
+/** Tests whether the quantile() family works as advertised
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(quantile)
+{
+	/** @test List of ints, length 0. Expected behavior: throw invalid_argument.
+	 */
+	{
+		vector<int> empty;
+		BOOST_CHECK_THROW(kpfutils::quantile(empty.begin(), empty.end(), 0.5), 
+			std::invalid_argument);
+		BOOST_CHECK_THROW(kpfutils::quantileInPlace(empty.begin(), empty.end(), 0.5), 
+			std::invalid_argument);
+		BOOST_CHECK_THROW(kpfutils::quantileSorted(empty.begin(), empty.end(), 0.5), 
+			std::invalid_argument);
+	}
+	
+	/** @test List of ints, length 1, quantile=0.00, 0.42, or 1.00. 
+	 *	Expected behavior: return %list::front()
+	 */
+	{
+		vector<int> one(oneList.begin(), oneList.end());
+		BOOST_CHECK_EQUAL(kpfutils::quantile(one.begin(), one.end(), 0.00), 
+			oneList.front());
+		BOOST_CHECK_EQUAL(kpfutils::quantile(one.begin(), one.end(), 0.42), 
+			oneList.front());
+		BOOST_CHECK_EQUAL(kpfutils::quantile(one.begin(), one.end(), 1.00), 
+			oneList.front());
+	}
+	
+	/** @test Vector of doubles, length 100, randomly generated, 
+	 *	quantile=-0.01 or 1.01. Expected behavior: throw invalid_argument
+	 */
+	BOOST_CHECK_THROW(kpfutils::quantile(dblVec[0].begin(), dblVec[0].end(), -0.01), 
+		std::invalid_argument);
+	BOOST_CHECK_THROW(kpfutils::quantile(dblVec[0].begin(), dblVec[0].end(),  1.01), 
+		std::invalid_argument);
+	
+	const double QUANTILES[] = {0.00, 0.42, 1.00};
+	const size_t INDICES[]   = {   0,   42,   99};
+	vector<double> scratch;
+	for (size_t nTest = 0; nTest < TEST_COUNT; nTest++) {
+		vector<double> sorted(dblVec[nTest]);
+		std::sort(sorted.begin(), sorted.end());
+		
+		for (size_t i = 0; i < 3; i++) {
+			const double q = QUANTILES[i];
+			const double trueValue = sorted[INDICES[i]];
+			
+			/** @test Vector of doubles, length 100, randomly generated, 
+			 *	quantile=0.00, 0.42, or 1.00. Expected behavior: equals 
+			 *	element floor(quantile*100) (or 99 for quantile=1) 
+			 *	of a sorted copy.
+			 */
+			BOOST_CHECK_EQUAL(kpfutils::quantile(dblVec[nTest].begin(), 
+				dblVec[nTest].end(), q), trueValue);
+			
+			/** @test Array of doubles, length 100, randomly generated, 
+			 *	quantile=0.00, 0.42, or 1.00. Expected behavior: equals 
+			 *	element floor(quantile*100) (or 99 for quantile=1) 
+			 *	of a sorted copy.
+			 */
+			BOOST_CHECK_EQUAL(kpfutils::quantile(dblArray[nTest].get(), 
+				dblArray[nTest].get()+TEST_LEN, q), trueValue);
+			
+			/** @test Vector of doubles, length 100, randomly generated, 
+			 *	quantile=0.00, 0.42, or 1.00, same buffer for all calls. 
+			 *	Expected behavior: same results as 
+			 *	quantile(first, last, quantile).
+			 */
+			BOOST_CHECK_EQUAL(kpfutils::quantile(dblVec[nTest].begin(), 
+				dblVec[nTest].end(), q, scratch), trueValue);
+			
+			/** @test Vector of doubles, length 100, randomly generated, 
+			 *	quantile=0.00, 0.42, or 1.00. Expected behavior: same 
+			 *	results as quantile(first, last, quantile).
+			 */
+			{
+				vector<double> copy(dblVec[nTest]);
+				BOOST_CHECK_EQUAL(kpfutils::quantileInPlace(copy.begin(), 
+					copy.end(), q), trueValue);
+			}
+			
+			/** @test Sorted vector of doubles, length 100, 
+			 *	quantile=0.00, 0.42, or 1.00. Expected behavior: same 
+			 *	results as quantile(first, last, quantile).
+			 */
+			BOOST_CHECK_EQUAL(kpfutils::quantileSorted(sorted.begin(), 
+				sorted.end(), q), trueValue);
+		}
+		
+		// The input must not be modified
+		BOOST_CHECK(!kpfutils::isSorted(dblVec[nTest].begin(), dblVec[nTest].end()));
+	}
+}
 
-/** Test cases for testing functions related to handling Nan values
- * @class BoostTest::test_nan
+/** Tests whether quantiles() works as advertised
+ *
+ * @exceptsafe Does not throw exceptions.
  */
-BOOST_AUTO_TEST_SUITE(test_nan)
+BOOST_AUTO_TEST_CASE(multi_quantile)
+{
+	const double PROBS[] = {0.95, 0.05, 0.5, 0.16, 0.84, 0.5, 0.0, 1.0};
+	const vector<double> probs(PROBS, PROBS + sizeof(PROBS)/sizeof(double));
+	
+	for (size_t nTest = 0; nTest < TEST_COUNT; nTest++) {
+		/** @test Vector of doubles, length 100, randomly generated, 
+		 *	probs={0.95, 0.05, 0.5, 0.16, 0.84, 0.5, 0.0, 1.0}. Expected 
+		 *	behavior: each element agrees with 
+		 *	quantile(first, last, probs[i]).
+		 */
+		vector<double> results = kpfutils::quantiles(dblVec[nTest].begin(), 
+			dblVec[nTest].end(), probs);
+		BOOST_REQUIRE_EQUAL(results.size(), probs.size());
+		for (size_t i = 0; i < probs.size(); i++) {
+			BOOST_CHECK_EQUAL(results[i], kpfutils::quantile(
+				dblVec[nTest].begin(), dblVec[nTest].end(), probs[i]));
+		}
+	}
+	
+	/** @test Vector of doubles, length 100, probs={0.5, 1.01}. Expected 
+	 *	behavior: throw invalid_argument.
+	 */
+	{
+		vector<double> badProbs(1, 0.5);
+		badProbs.push_back(1.01);
+		BOOST_CHECK_THROW(kpfutils::quantiles(dblVec[0].begin(), 
+			dblVec[0].end(), badProbs), std::invalid_argument);
+	}
+	
+	/** @test Empty vector, probs={0.5}. Expected behavior: throw NotEnoughData.
+	 */
+	{
+		vector<double> empty;
+		BOOST_CHECK_THROW(kpfutils::quantiles(empty.begin(), empty.end(), 
+			vector<double>(1, 0.5)), except::NotEnoughData);
+	}
+	
+	/** @test Vector of doubles, length 100, empty probs. Expected behavior: 
+	 *	return empty vector.
+	 */
+	BOOST_CHECK(kpfutils::quantiles(dblVec[0].begin(), dblVec[0].end(), 
+		vector<double>()).empty());
+}
 
-/** Tests whether NaN diagnostics work as advertised
+/** Tests whether QuantileSketch works as advertised
  *
  * @exceptsafe Does not throw exceptions.
  */
-BOOST_AUTO_TEST_CASE(nan_check) {
-	// Easy access to special double values
-	typedef std::numeric_limits<double> d;
+BOOST_AUTO_TEST_CASE(sketch)
+{
+	/** @test Empty sketch. Expected behavior: quantile() throws 
+	 *	NotEnoughData.
+	 */
+	BOOST_CHECK_THROW(QuantileSketch().quantile(0.5), except::NotEnoughData);
 	
-	BOOST_WARN(d::     has_infinity);
-	BOOST_WARN(d::    has_quiet_NaN);
-	BOOST_WARN(d::has_signaling_NaN);
+	/** @test Sketch of 100 values, quantile=-0.01 or 1.01. Expected 
+	 *	behavior: throw invalid_argument.
+	 */
+	/** @test Sketch of 100 values, quantile=0.00, 0.42, or 1.00. Expected 
+	 *	behavior: same results as quantile(first, last, quantile), since 
+	 *	the sketch has not compacted.
+	 */
+	for (size_t nTest = 0; nTest < TEST_COUNT; nTest++) {
+		QuantileSketch small;
+		for (size_t i = 0; i < TEST_LEN; i++) {
+			small.add(dblVec[nTest][i]);
+		}
+		BOOST_CHECK_EQUAL(small.count(), static_cast<unsigned long>(TEST_LEN));
+		BOOST_CHECK_THROW(small.quantile(-0.01), std::invalid_argument);
+		BOOST_CHECK_THROW(small.quantile( 1.01), std::invalid_argument);
+		
+		const double QUANTILES[] = {0.00, 0.42, 1.00};
+		for (size_t i = 0; i < 3; i++) {
+			BOOST_CHECK_EQUAL(small.quantile(QUANTILES[i]), kpfutils::quantile(
+				dblVec[nTest].begin(), dblVec[nTest].end(), QUANTILES[i]));
+		}
+	}
+	
+	// Large data set split among four sketches
+	const size_t BIG_LEN = 100000;
+	vector<double> big;
+	big.reserve(BIG_LEN);
+	for (size_t nTest = 0; big.size() < BIG_LEN; nTest = (nTest+1) % TEST_COUNT) {
+		for (size_t i = 0; i < TEST_LEN; i++) {
+			big.push_back(dblVec[nTest][i] + 0.01 * static_cast<double>(big.size() % 997));
+		}
+	}
+	QuantileSketch whole, parts[4];
+	for (size_t i = 0; i < BIG_LEN; i++) {
+		whole.add(big[i]);
+		parts[i % 4].add(big[i]);
+	}
+	for (size_t i = 1; i < 4; i++) {
+		parts[0].merge(parts[i]);
+	}
+	QuantileSketch restored = QuantileSketch::deserialize(whole.serialize());
+	
+	vector<double> sorted(big);
+	std::sort(sorted.begin(), sorted.end());
+	
+	/** @test Sketch of 10^5 values. Expected behavior: retains far fewer 
+	 *	than 10^5 values.
+	 */
+	BOOST_CHECK_EQUAL(whole.count(), BIG_LEN);
+	BOOST_CHECK_LT(whole.retained(), BIG_LEN / 50);
+	BOOST_CHECK_EQUAL(parts[0].count(), BIG_LEN);
+	
+	const double PROBS[] = {0.00, 0.01, 0.05, 0.16, 0.5, 0.84, 0.95, 0.99, 1.00};
+	for (size_t i = 0; i < sizeof(PROBS)/sizeof(double); i++) {
+		const double q = PROBS[i];
+		
+		/** @test Sketch of 10^5 values, quantile=0.00, 0.01, 0.05, 0.16, 0.50, 
+		 *	0.84, 0.95, 0.99, or 1.00. Expected behavior: rank of result 
+		 *	is within 1.7% of the requested quantile.
+		 */
+		/** @test Merge of four sketches of 2.5x10^4 values. Expected 
+		 *	behavior: rank of result is within 1.7% of the requested quantile.
+		 */
+		const double estimates[] = {whole.quantile(q), parts[0].quantile(q)};
+		for (size_t j = 0; j < 2; j++) {
+			const double rank = static_cast<double>(
+				std::upper_bound(sorted.begin(), sorted.end(), estimates[j]) 
+				- sorted.begin()) / BIG_LEN;
+			BOOST_CHECK_SMALL(rank - std::max(q, 1.0/BIG_LEN), 0.017);
+		}
+		
+		/** @test Serialized and deserialized sketch. Expected behavior: 
+		 *	identical quantiles to the original.
+		 */
+		BOOST_CHECK_EQUAL(restored.quantile(q), whole.quantile(q));
+	}
+	BOOST_CHECK_EQUAL(whole.quantile(0.0), sorted.front());
+	BOOST_CHECK_EQUAL(whole.quantile(1.0), sorted.back());
+	
+	/** @test Sketch serialized while the global locale uses a decimal 
+	 *	comma. Expected behavior: no commas in the encoding, and 
+	 *	identical quantiles after deserialization.
+	 */
+	{
+		const std::locale oldLocale = std::locale::global(
+			std::locale(std::locale::classic(), new CommaDecimal()));
+		const string encoding = whole.serialize();
+		std::locale::global(oldLocale);
+		BOOST_CHECK_EQUAL(encoding.find(','), string::npos);
+		BOOST_CHECK_EQUAL(QuantileSketch::deserialize(encoding).quantile(0.5), 
+			whole.quantile(0.5));
+	}
+	
+	/** @test Corrupted serialization. Expected behavior: throw 
+	 *	invalid_argument.
+	 */
+	BOOST_CHECK_THROW(QuantileSketch::deserialize("#kpfutils sketch 1\n200 5 0 1 1\n2 0 1\n"), 
+		std::invalid_argument);
+	BOOST_CHECK_THROW(QuantileSketch::deserialize("not a sketch"), 
+		std::invalid_argument);
+}
 
-	// Skip tests if the system doesn't support special floating-point values
-	BOOST_CHECK(!d::     has_infinity || !isNan( d::     infinity()));
-	BOOST_CHECK(                         !isNan( 3.0               ));
-	BOOST_CHECK(                         !isNan( 0.0               ));
-	BOOST_CHECK(                         !isNan(-3.0               ));
-	BOOST_CHECK(!d::     has_infinity || !isNan(-d::     infinity()));
-	BOOST_CHECK(!d::    has_quiet_NaN ||  isNan(-d::    quiet_NaN()));
-	BOOST_CHECK(!d::has_signaling_NaN ||  isNan(-d::signaling_NaN()));
+/** Tests whether Moments works as advertised
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(moments)
+{
+	/** @test Empty accumulator. Expected behavior: mean() and variance() 
+	 *	throw NotEnoughData.
+	 */
+	BOOST_CHECK_THROW(Moments().mean(),     except::NotEnoughData);
+	BOOST_CHECK_THROW(Moments().variance(), except::NotEnoughData);
 	
-	BOOST_CHECK(!d::     has_infinity ||  isNanOrInf( d::     infinity()));
-	BOOST_CHECK(                         !isNanOrInf( 3.0               ));
-	BOOST_CHECK(                         !isNanOrInf( 0.0               ));
-	BOOST_CHECK(                         !isNanOrInf(-3.0               ));
-	BOOST_CHECK(!d::     has_infinity ||  isNanOrInf(-d::     infinity()));
-	BOOST_CHECK(!d::    has_quiet_NaN ||  isNanOrInf(-d::    quiet_NaN()));
-	BOOST_CHECK(!d::has_signaling_NaN ||  isNanOrInf(-d::signaling_NaN()));
+	for (size_t nTest = 0; nTest < TEST_COUNT; nTest++) {
+		const vector<double>& data = dblVec[nTest];
+		
+		// Two-pass reference values
+		double trueMean = 0.0;
+		for (size_t i = 0; i < TEST_LEN; i++) {
+			trueMean += data[i];
+		}
+		trueMean /= TEST_LEN;
+		double c2 = 0.0, c3 = 0.0, c4 = 0.0;
+		for (size_t i = 0; i < TEST_LEN; i++) {
+			const double d = data[i] - trueMean;
+			c2 += d*d;
+			c3 += d*d*d;
+			c4 += d*d*d*d;
+		}
+		const double trueVar  = c2 / (TEST_LEN - 1.0);
+		const double trueSkew = sqrt(static_cast<double>(TEST_LEN)) * c3 / pow(c2, 1.5);
+		const double trueKurt = TEST_LEN * c4 / (c2*c2) - 3.0;
+		
+		/** @test Vector of doubles, length 100, randomly generated. Expected 
+		 *	behavior: mean, variance, skewness, and kurtosis agree with 
+		 *	two-pass formulas to within 1e-8.
+		 */
+		Moments whole;
+		for (size_t i = 0; i < TEST_LEN; i++) {
+			whole.add(data[i]);
+		}
+		BOOST_CHECK_EQUAL(whole.count(), TEST_LEN * 1.0);
+		BOOST_CHECK_CLOSE(whole.mean(),     trueMean, TEST_TOLERANCE);
+		BOOST_CHECK_CLOSE(whole.variance(), trueVar,  TEST_TOLERANCE);
+		BOOST_CHECK_CLOSE(whole.skewness(), trueSkew, TEST_TOLERANCE);
+		BOOST_CHECK_CLOSE(whole.kurtosis(), trueKurt, TEST_TOLERANCE);
+		
+		/** @test Vector of doubles, length 100, randomly generated, split 
+		 *	into parts of length 0, 13, and 87 and merged. Expected 
+		 *	behavior: agrees with two-pass formulas to within 1e-8.
+		 */
+		Moments empty, head, tail;
+		for (size_t i = 0; i < 13; i++) {
+			head.add(data[i]);
+		}
+		for (size_t i = 13; i < TEST_LEN; i++) {
+			tail.add(data[i]);
+		}
+		empty.merge(head);
+		empty.merge(Moments());
+		empty.merge(tail);
+		BOOST_CHECK_EQUAL(empty.count(), TEST_LEN * 1.0);
+		BOOST_CHECK_CLOSE(empty.mean(),     trueMean, TEST_TOLERANCE);
+		BOOST_CHECK_CLOSE(empty.variance(), trueVar,  TEST_TOLERANCE);
+		BOOST_CHECK_CLOSE(empty.skewness(), trueSkew, TEST_TOLERANCE);
+		BOOST_CHECK_CLOSE(empty.kurtosis(), trueKurt, TEST_TOLERANCE);
+	}
+}
+
+/** Tests whether the parallel statistics work as advertised
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(parallel)
+{
+	/** @test List of ints, length 1. Expected behavior: throw NotEnoughData.
+	 */
+	{
+		vector<int> one(oneList.begin(), oneList.end());
+		BOOST_CHECK_THROW(parallelVariance(one.begin(), one.end(), 4), 
+			except::NotEnoughData);
+		BOOST_CHECK_THROW(parallelMean(one.begin(), one.begin(), 4), 
+			except::NotEnoughData);
+	}
+	
+	const size_t BIG_LEN = 1000000;
+	vector<double> big;
+	big.reserve(BIG_LEN);
+	for (size_t i = 0; i < BIG_LEN; i++) {
+		big.push_back(100.0 + dblVec[i % TEST_COUNT][(i / TEST_COUNT) % TEST_LEN] 
+			+ 1e-3 * static_cast<double>(i % 1009));
+	}
+	const std::pair<double, double> trueStats = meanVariance(big.begin(), big.end());
+	Moments trueMoments;
+	for (size_t i = 0; i < BIG_LEN; i++) {
+		trueMoments.add(big[i]);
+	}
+	
+	const unsigned int THREADS[] = {1, 2, 3, 8};
+	for (size_t i = 0; i < 4; i++) {
+		/** @test Vector of doubles, length 10^6, 1, 2, 3, or 8 threads. 
+		 *	Expected behavior: agrees with mean() and meanVariance() 
+		 *	to within 1e-8.
+		 */
+		BOOST_CHECK_CLOSE(parallelMean    (big.begin(), big.end(), THREADS[i]), 
+			trueStats.first,  TEST_TOLERANCE);
+		BOOST_CHECK_CLOSE(parallelVariance(big.begin(), big.end(), THREADS[i]), 
+			trueStats.second, TEST_TOLERANCE);
+	}
+	
+	/** @test Vector of doubles, length 10^6, 4 threads, run twice. Expected 
+	 *	behavior: identical results.
+	 */
+	BOOST_CHECK_EQUAL(parallelVariance(big.begin(), big.end(), 4), 
+		parallelVariance(big.begin(), big.end(), 4));
+	
+	/** @test Vector of doubles, length 10^6, 1 or 3 threads. Expected 
+	 *	behavior: mean, variance, skewness, and kurtosis agree with a 
+	 *	single Moments object to within 1e-8.
+	 */
+	for (unsigned int nThreads = 1; nThreads <= 3; nThreads += 2) {
+		Moments result = parallelMoments(big.begin(), big.end(), nThreads);
+		BOOST_CHECK_EQUAL(result.count(), trueMoments.count());
+		BOOST_CHECK_CLOSE(result.mean(),     trueMoments.mean(),     TEST_TOLERANCE);
+		BOOST_CHECK_CLOSE(result.variance(), trueMoments.variance(), TEST_TOLERANCE);
+		BOOST_CHECK_CLOSE(result.skewness(), trueMoments.skewness(), TEST_TOLERANCE);
+		BOOST_CHECK_CLOSE(result.kurtosis(), trueMoments.kurtosis(), TEST_TOLERANCE);
+	}
+}
+
+/** Tests whether the weighted statistics work as advertised
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(weighted)
+{
+	/** @test Vectors of doubles, length 0. Expected behavior: throw NotEnoughData.
+	 */
+	/** @test Vectors of doubles, length 1. Expected behavior: throw NotEnoughData.
+	 */
+	{
+		const vector<double> one(1, 3.0);
+		BOOST_CHECK_THROW(weightedMean(one.begin(), one.begin(), one.begin()), 
+			except::NotEnoughData);
+		BOOST_CHECK_EQUAL(weightedMean(one.begin(), one.end(), one.begin()), 3.0);
+		BOOST_CHECK_THROW(weightedVariance(one.begin(), one.end(), one.begin()), 
+			except::NotEnoughData);
+		BOOST_CHECK_THROW(reducedChiSq(one.begin(), one.end(), one.begin()), 
+			except::NotEnoughData);
+	}
+	
+	for (size_t nTest = 0; nTest < TEST_COUNT; nTest++) {
+		const vector<double>& data = dblVec[nTest];
+		// Errors must be positive and uncorrelated with the data
+		vector<double> errors;
+		for (size_t i = 0; i < TEST_LEN; i++) {
+			errors.push_back(0.1 + fabs(dblVec[(nTest+1) % TEST_COUNT][i]));
+		}
+		list<double> dataList(data.begin(), data.end());
+		list<double> errList(errors.begin(), errors.end());
+		
+		// Two-pass reference values
+		double sumW = 0.0, sumWx = 0.0, sumW2 = 0.0;
+		for (size_t i = 0; i < TEST_LEN; i++) {
+			const double w = 1.0/(errors[i]*errors[i]);
+			sumW  += w;
+			sumWx += w * data[i];
+			sumW2 += w * w;
+		}
+		const double trueMean = sumWx / sumW;
+		double chiSq = 0.0;
+		for (size_t i = 0; i < TEST_LEN; i++) {
+			const double d = (data[i] - trueMean) / errors[i];
+			chiSq += d*d;
+		}
+		const double trueVar = chiSq / (sumW - sumW2/sumW);
+		const double trueRed = chiSq / (TEST_LEN - 1.0);
+		
+		/** @test Vectors, lists, and arrays of doubles, length 100, randomly 
+		 *	generated. Expected behavior: agrees with a two-pass 
+		 *	calculation to within 1e-8.
+		 */
+		BOOST_CHECK_CLOSE(weightedMean(data.begin(), data.end(), errors.begin()), 
+			trueMean, TEST_TOLERANCE);
+		BOOST_CHECK_CLOSE(weightedMean(dataList.begin(), dataList.end(), errList.begin()), 
+			trueMean, TEST_TOLERANCE);
+		BOOST_CHECK_CLOSE(weightedMean(dblArray[nTest].get(), 
+			dblArray[nTest].get()+TEST_LEN, &errors[0]), 
+			trueMean, TEST_TOLERANCE);
+		
+		BOOST_CHECK_CLOSE(weightedVariance(data.begin(), data.end(), errors.begin()), 
+			trueVar, TEST_TOLERANCE);
+		BOOST_CHECK_CLOSE(weightedVariance(dataList.begin(), dataList.end(), errList.begin()), 
+			trueVar, TEST_TOLERANCE);
+		
+		BOOST_CHECK_CLOSE(reducedChiSq(data.begin(), data.end(), errors.begin()), 
+			trueRed, TEST_TOLERANCE);
+		BOOST_CHECK_CLOSE(reducedChiSq(dataList.begin(), dataList.end(), errList.begin()), 
+			trueRed, TEST_TOLERANCE);
+		
+		/** @test Vectors of doubles, length 100, all errors equal. Expected 
+		 *	behavior: agrees with variance() to within 1e-8.
+		 */
+		const vector<double> sameErrors(TEST_LEN, 0.5);
+		BOOST_CHECK_CLOSE(weightedVariance(data.begin(), data.end(), sameErrors.begin()), 
+			kpfutils::variance(data.begin(), data.end()), TEST_TOLERANCE);
+		
+		/** @test Vectors of doubles, length 100, one error zero. Expected 
+		 *	behavior: throw invalid_argument.
+		 */
+		errors[TEST_LEN/2] = 0.0;
+		BOOST_CHECK_THROW(weightedMean(data.begin(), data.end(), errors.begin()), 
+			std::invalid_argument);
+	}
+}
+
+/** Tests whether the NaN-skipping statistics work as advertised
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(nan_stats)
+{
+	const double NaN = std::numeric_limits<double>::quiet_NaN();
+	const double Inf = std::numeric_limits<double>::infinity();
+	size_t nUsed = 0;
+	
+	/** @test Vector of doubles, all NaN. Expected behavior: throw NotEnoughData.
+	 */
+	/** @test Vector of doubles, one non-NaN value. Expected behavior: throw 
+	 *	NotEnoughData.
+	 */
+	{
+		vector<double> allNan(10, NaN);
+		BOOST_CHECK_THROW(nanMean(allNan.begin(), allNan.end(), nUsed), 
+			except::NotEnoughData);
+		BOOST_CHECK_THROW(nanQuantile(allNan.begin(), allNan.end(), 0.5, nUsed), 
+			except::NotEnoughData);
+		allNan[3] = 1.0;
+		BOOST_CHECK_THROW(nanVariance(allNan.begin(), allNan.end(), nUsed), 
+			except::NotEnoughData);
+		BOOST_CHECK_EQUAL(nanMean(allNan.begin(), allNan.end(), nUsed), 1.0);
+		BOOST_CHECK_EQUAL(nUsed, 1U);
+	}
+	
+	/** @test Vector and list of doubles, length 2000, one negative 
+	 *	infinity after the first block, skipInf = false. Expected 
+	 *	behavior: returns negative infinity.
+	 */
+	/** @test Vector and list of doubles, length 2000, infinities of both 
+	 *	signs, skipInf = false. Expected behavior: returns NaN.
+	 */
+	{
+		vector<double> big;
+		for (size_t i = 0; i < 20; i++) {
+			big.insert(big.end(), dblVec[i % TEST_COUNT].begin(), 
+				dblVec[i % TEST_COUNT].end());
+		}
+		big[3] = NaN;
+		big[1500] = -Inf;
+		BOOST_CHECK_EQUAL(nanMean(big.begin(), big.end(), nUsed), -Inf);
+		BOOST_CHECK_EQUAL(nUsed, 1999U);
+		BOOST_CHECK(isNan(nanVariance(big.begin(), big.end(), nUsed)));
+		list<double> bigList(big.begin(), big.end());
+		BOOST_CHECK_EQUAL(nanMean(bigList.begin(), bigList.end(), nUsed), -Inf);
+		BOOST_CHECK_EQUAL(nUsed, 1999U);
+		
+		big[700] = Inf;
+		BOOST_CHECK(isNan(nanMean(big.begin(), big.end(), nUsed)));
+		BOOST_CHECK_EQUAL(nUsed, 1999U);
+		bigList.assign(big.begin(), big.end());
+		BOOST_CHECK(isNan(nanMean(bigList.begin(), bigList.end(), nUsed)));
+	}
+	
+	for (size_t nTest = 0; nTest < TEST_COUNT; nTest++) {
+		vector<double> dirty(dblVec[nTest]), clean;
+		for (size_t i = 0; i < TEST_LEN; i++) {
+			if (i % 7 == 0) {
+				dirty[i] = NaN;
+			} else if (i % 11 == 0) {
+				dirty[i] = (i % 2 ? Inf : -Inf);
+			} else {
+				clean.push_back(dirty[i]);
+			}
+		}
+		list<double> dirtyList(dirty.begin(), dirty.end());
+		
+		/** @test Vector and list of doubles, length 100, every seventh value 
+		 *	NaN and every eleventh value infinite, skipInf = true. Expected 
+		 *	behavior: agrees with mean() and variance() of the finite 
+		 *	values to within 1e-8, and reports their number.
+		 */
+		const double trueMean = kpfutils::mean    (clean.begin(), clean.end());
+		const double trueVar  = kpfutils::variance(clean.begin(), clean.end());
+		
+		nUsed = 0;
+		BOOST_CHECK_CLOSE(nanMean(dirty.begin(), dirty.end(), nUsed, true), 
+			trueMean, TEST_TOLERANCE);
+		BOOST_CHECK_EQUAL(nUsed, clean.size());
+		nUsed = 0;
+		BOOST_CHECK_CLOSE(nanMean(dirtyList.begin(), dirtyList.end(), nUsed, true), 
+			trueMean, TEST_TOLERANCE);
+		BOOST_CHECK_EQUAL(nUsed, clean.size());
+		
+		nUsed = 0;
+		BOOST_CHECK_CLOSE(nanVariance(dirty.begin(), dirty.end(), nUsed, true), 
+			trueVar, TEST_TOLERANCE);
+		BOOST_CHECK_EQUAL(nUsed, clean.size());
+		nUsed = 0;
+		BOOST_CHECK_CLOSE(nanVariance(dirtyList.begin(), dirtyList.end(), nUsed, true), 
+			trueVar, TEST_TOLERANCE);
+		BOOST_CHECK_EQUAL(nUsed, clean.size());
+		
+		/** @test Vector of doubles, length 100, every seventh value NaN and 
+		 *	every eleventh value infinite, skipInf = true, quantile=0.00, 
+		 *	0.42, or 1.00. Expected behavior: agrees with quantile() of the 
+		 *	finite values, and reports their number.
+		 */
+		const double QUANTILES[] = {0.00, 0.42, 1.00};
+		vector<double> scratch;
+		for (size_t i = 0; i < 3; i++) {
+			nUsed = 0;
+			BOOST_CHECK_EQUAL(nanQuantile(dirty.begin(), dirty.end(), 
+				QUANTILES[i], nUsed, scratch, true), 
+				kpfutils::quantile(clean.begin(), clean.end(), QUANTILES[i]));
+			BOOST_CHECK_EQUAL(nUsed, clean.size());
+		}
+		
+		/** @test Vector and list of doubles, length 100, every seventh 
+		 *	value NaN and one infinite value, skipInf = false. Expected 
+		 *	behavior: returns infinity, and reports the number of non-NaN 
+		 *	values.
+		 */
+		{
+			vector<double> oneInf(dirty);
+			for (size_t i = 0; i < TEST_LEN; i++) {
+				if (i % 7 != 0 && i % 11 == 0) {
+					oneInf[i] = 0.0;
+				}
+			}
+			oneInf[1] = Inf;
+			BOOST_CHECK_EQUAL(nanMean(oneInf.begin(), oneInf.end(), nUsed), Inf);
+			BOOST_CHECK_EQUAL(nUsed, TEST_LEN - (TEST_LEN + 6) / 7);
+			
+			const list<double> oneInfList(oneInf.begin(), oneInf.end());
+			nUsed = 0;
+			BOOST_CHECK_EQUAL(nanMean(oneInfList.begin(), oneInfList.end(), nUsed), Inf);
+			BOOST_CHECK_EQUAL(nUsed, TEST_LEN - (TEST_LEN + 6) / 7);
+			BOOST_CHECK(isNan(nanVariance(oneInfList.begin(), oneInfList.end(), nUsed)));
+		}
+		
+		/** @test Vector of doubles, length 100, every seventh value NaN, 
+		 *	quantile=0.42. Expected behavior: agrees with the version 
+		 *	taking a scratch buffer.
+		 */
+		BOOST_CHECK_EQUAL(nanQuantile(dirty.begin(), dirty.end(), 0.42, nUsed), 
+			nanQuantile(dirty.begin(), dirty.end(), 0.42, nUsed, scratch));
+	}
+}
+
+/** Tests whether the robust statistics work as advertised
+ *
+ * @see medianAbsDev()
+ * @see sigmaClip()
+ */
+BOOST_AUTO_TEST_CASE(robust)
+{
+	/** @test List of ints, length 0. Expected behavior: throw NotEnoughData.
+	 */
+	BOOST_CHECK_THROW(medianAbsDev(emptyList.begin(), emptyList.end()), 
+		except::NotEnoughData);
+	/** @test List of ints, length 1. Expected behavior: return 0.
+	 */
+	BOOST_CHECK_EQUAL(medianAbsDev(oneList.begin(), oneList.end()), 0);
+	
+	vector<double> scratch;
+	vector<unsigned char> mask;
+	for (size_t nTest = 0; nTest < TEST_COUNT; nTest++) {
+		/** @test Vector of doubles, length 100, randomly generated. 
+		 *	Expected behavior: equals the median of the absolute 
+		 *	differences from the median, found by sorting.
+		 */
+		{
+			vector<double> sorted(dblVec[nTest]);
+			std::sort(sorted.begin(), sorted.end());
+			const double median = sorted[TEST_LEN/2];
+			for (size_t i = 0; i < TEST_LEN; i++) {
+				sorted[i] = std::fabs(sorted[i] - median);
+			}
+			std::sort(sorted.begin(), sorted.end());
+			BOOST_CHECK_EQUAL(medianAbsDev(dblVec[nTest].begin(), 
+				dblVec[nTest].end(), scratch), sorted[TEST_LEN/2]);
+		}
+		
+		/** @test List of ints, length 100, randomly generated. Expected 
+		 *	behavior: equals the median of the absolute differences from 
+		 *	the median, found by sorting.
+		 */
+		{
+			vector<int> sorted(intList[nTest].begin(), intList[nTest].end());
+			std::sort(sorted.begin(), sorted.end());
+			const int median = sorted[TEST_LEN/2];
+			for (size_t i = 0; i < TEST_LEN; i++) {
+				sorted[i] = std::abs(sorted[i] - median);
+			}
+			std::sort(sorted.begin(), sorted.end());
+			BOOST_CHECK_EQUAL(medianAbsDev(intList[nTest].begin(), 
+				intList[nTest].end()), sorted[TEST_LEN/2]);
+		}
+		
+		/** @test Vector of doubles, length 100, randomly generated, with 
+		 *	three values replaced by outliers, nSigma = 3. Expected 
+		 *	behavior: the outliers are masked out, the clipping converges, 
+		 *	and the mean and median match those of the retained values.
+		 */
+		vector<double> data(dblVec[nTest]);
+		data[ 5] =  1e6;
+		data[50] = -40.0;
+		data[95] =  25.0;
+		
+		const ClipResult result = sigmaClip(data.begin(), data.end(), 3.0, 
+			mask, scratch);
+		BOOST_CHECK(result.converged);
+		BOOST_CHECK(result.iterations >= 1);
+		BOOST_REQUIRE_EQUAL(mask.size(), static_cast<unsigned long>(TEST_LEN));
+		BOOST_CHECK_EQUAL(mask[ 5], 0);
+		BOOST_CHECK_EQUAL(mask[50], 0);
+		BOOST_CHECK_EQUAL(mask[95], 0);
+		
+		vector<double> kept;
+		for (size_t i = 0; i < TEST_LEN; i++) {
+			if (mask[i]) {
+				kept.push_back(data[i]);
+			}
+		}
+		BOOST_CHECK_EQUAL(result.nUsed, kept.size());
+		BOOST_CHECK_CLOSE(result.mean, kpfutils::mean(kept.begin(), kept.end()), 
+			TEST_TOLERANCE);
+		BOOST_CHECK_CLOSE(result.stdDev, 
+			std::sqrt(kpfutils::variance(kept.begin(), kept.end())), 
+			TEST_TOLERANCE);
+		BOOST_CHECK_EQUAL(result.center, 
+			kpfutils::quantile(kept.begin(), kept.end(), 0.5));
+		
+		/** @test As above, called twice with the same buffers. Expected 
+		 *	behavior: identical results.
+		 */
+		const vector<unsigned char> oldMask(mask);
+		const ClipResult again = sigmaClip(data.begin(), data.end(), 3.0, 
+			mask, scratch);
+		BOOST_CHECK(mask == oldMask);
+		BOOST_CHECK_EQUAL(again.mean,       result.mean);
+		BOOST_CHECK_EQUAL(again.iterations, result.iterations);
+		
+		/** @test Vector of doubles, length 100, maxIter = 0. Expected 
+		 *	behavior: all values retained, converged = false.
+		 */
+		const ClipResult none = sigmaClip(data.begin(), data.end(), 3.0, 0);
+		BOOST_CHECK(!none.converged);
+		BOOST_CHECK_EQUAL(none.iterations, 0U);
+		BOOST_CHECK_EQUAL(none.nUsed, static_cast<unsigned long>(TEST_LEN));
+	}
+	
+	/** @test Vector of doubles, nSigma = 0. Expected behavior: throw 
+	 *	invalid_argument.
+	 */
+	BOOST_CHECK_THROW(sigmaClip(dblVec[0].begin(), dblVec[0].end(), 0.0), 
+		std::invalid_argument);
+}
+
+/** Tests whether the sliding-window statistics work as advertised
+ *
+ * @see rollingMeanRms()
+ * @see rollingQuantile()
+ */
+BOOST_AUTO_TEST_CASE(rolling)
+{
+	// Evenly spaced, with every fifth time repeated
+	vector<double> times;
+	for (size_t i = 0; i < TEST_LEN; i++) {
+		times.push_back(0.3 * (i - i/5));
+	}
+	
+	/** @test Times and data of different lengths. Expected behavior: throw 
+	 *	invalid_argument.
+	 */
+	/** @test Unsorted times. Expected behavior: throw invalid_argument.
+	 */
+	{
+		vector<double> means, rms, result;
+		vector<double> shortData(TEST_LEN - 1, 0.0);
+		BOOST_CHECK_THROW(rollingMeanRms(times, shortData, 1.0, means, rms), 
+			std::invalid_argument);
+		vector<double> backwards(times.rbegin(), times.rend());
+		BOOST_CHECK_THROW(rollingQuantile(backwards, dblVec[0], 1.0, 0.5, result), 
+			std::invalid_argument);
+		BOOST_CHECK_THROW(rollingQuantile(times, dblVec[0], -1.0, 0.5, result), 
+			std::invalid_argument);
+	}
+	
+	const double WIDTHS[]    = {0.0, 1.0, 100.0};
+	const double QUANTILES[] = {0.0, 0.5, 0.9};
+	for (size_t nTest = 0; nTest < TEST_COUNT; nTest++) {
+		const vector<double>& data = dblVec[nTest];
+		for (size_t w = 0; w < 3; w++) {
+			/** @test Times spaced 0.3 apart with repeats, random data, 
+			 *	halfWidth = 0, 1.0, or 100. Expected behavior: agrees 
+			 *	with mean() and variance() of each window to within 1e-8.
+			 */
+			/** @test Times spaced 0.3 apart with repeats, random data, 
+			 *	halfWidth = 0, 1.0, or 100, quantile = 0.0, 0.5, or 0.9. 
+			 *	Expected behavior: agrees with quantile() of each window.
+			 */
+			vector<double> means, rms;
+			rollingMeanRms(times, data, WIDTHS[w], means, rms);
+			BOOST_REQUIRE_EQUAL(means.size(), static_cast<unsigned long>(TEST_LEN));
+			BOOST_REQUIRE_EQUAL(rms  .size(), static_cast<unsigned long>(TEST_LEN));
+			
+			vector<vector<double> > quants(3);
+			for (size_t q = 0; q < 3; q++) {
+				rollingQuantile(times, data, WIDTHS[w], QUANTILES[q], quants[q]);
+			}
+			vector<double> median;
+			rollingMedian(times, data, WIDTHS[w], median);
+			BOOST_CHECK(median == quants[1]);
+			
+			for (size_t i = 0; i < TEST_LEN; i++) {
+				vector<double> window;
+				for (size_t j = 0; j < TEST_LEN; j++) {
+					if (std::fabs(times[j] - times[i]) <= WIDTHS[w]) {
+						window.push_back(data[j]);
+					}
+				}
+				
+				BOOST_CHECK_CLOSE(means[i], 
+					kpfutils::mean(window.begin(), window.end()), 
+					TEST_TOLERANCE);
+				if (window.size() > 1) {
+					BOOST_CHECK_CLOSE(rms[i], std::sqrt(
+						kpfutils::variance(window.begin(), window.end())), 
+						TEST_TOLERANCE);
+				} else {
+					BOOST_CHECK(isNan(rms[i]));
+				}
+				for (size_t q = 0; q < 3; q++) {
+					BOOST_CHECK_EQUAL(quants[q][i], kpfutils::quantile(
+						window.begin(), window.end(), QUANTILES[q]));
+				}
+			}
+		}
+	}
+}
+
+/** Tests whether the contiguous-array kernels agree with the generic code
+ *
+ * @see mean()
+ * @see variance()
+ * @see quantile()
+ * @see isSorted()
+ */
+BOOST_AUTO_TEST_CASE(contiguous)
+{
+	const double QUANTILES[] = {0.00, 0.42, 1.00};
+	for (size_t nTest = 0; nTest < TEST_COUNT; nTest++) {
+		/** @test Vector and list of ints, length 100, randomly generated. 
+		 *	Expected behavior: mean(), variance(), quantile(), and 
+		 *	isSorted() give identical results for both.
+		 */
+		const vector<int> intVec(intList[nTest].begin(), intList[nTest].end());
+		BOOST_CHECK_EQUAL(kpfutils::mean(intVec.begin(), intVec.end()), 
+			kpfutils::mean(intList[nTest].begin(), intList[nTest].end()));
+		BOOST_CHECK_EQUAL(kpfutils::variance(intVec.begin(), intVec.end()), 
+			kpfutils::variance(intList[nTest].begin(), intList[nTest].end()));
+		for (size_t i = 0; i < 3; i++) {
+			BOOST_CHECK_EQUAL(kpfutils::quantile(intVec.begin(), intVec.end(), QUANTILES[i]), 
+				kpfutils::quantile(&intArray[nTest][0], &intArray[nTest][0]+TEST_LEN, 
+				QUANTILES[i]));
+		}
+		
+		vector<int> sortedInts(intVec);
+		std::sort(sortedInts.begin(), sortedInts.end());
+		BOOST_CHECK_EQUAL(isSorted(intVec.begin(), intVec.end()), 
+			isSorted(intList[nTest].begin(), intList[nTest].end()));
+		BOOST_CHECK(isSorted(sortedInts.begin(), sortedInts.end()));
+		
+		/** @test Vector and list of floats, length 100, randomly generated. 
+		 *	Expected behavior: mean() and variance() agree to within 
+		 *	1e-4, and quantile() and isSorted() are identical.
+		 */
+		const vector<float> fltVec(dblVec[nTest].begin(), dblVec[nTest].end());
+		const list<float>  fltList(fltVec.begin(), fltVec.end());
+		BOOST_CHECK_CLOSE(kpfutils::mean(fltVec.begin(), fltVec.end()), 
+			kpfutils::mean(fltList.begin(), fltList.end()), 1e-4);
+		BOOST_CHECK_CLOSE(kpfutils::variance(fltVec.begin(), fltVec.end()), 
+			kpfutils::variance(fltList.begin(), fltList.end()), 1e-4);
+		vector<float> fltScratch;
+		for (size_t i = 0; i < 3; i++) {
+			vector<float> sortedFlts(fltVec);
+			std::sort(sortedFlts.begin(), sortedFlts.end());
+			const size_t index = std::min(static_cast<size_t>(QUANTILES[i] * TEST_LEN), 
+				TEST_LEN - 1);
+			BOOST_CHECK_EQUAL(kpfutils::quantile(fltVec.begin(), fltVec.end(), 
+				QUANTILES[i], fltScratch), sortedFlts[index]);
+		}
+		BOOST_CHECK_EQUAL(isSorted(fltVec.begin(), fltVec.end()), 
+			isSorted(fltList.begin(), fltList.end()));
+	}
+	
+	/** @test List and vector of floats, length 100000, values 1e4 + i%10. 
+	 *	Expected behavior: mean 1e4 + 4.5 and variance 8.25*N/(N-1) to 
+	 *	within 1e-5, which requires the sums to be kept in double.
+	 */
+	{
+		const size_t N = 100000;
+		list<float> bigList;
+		for (size_t i = 0; i < N; i++) {
+			bigList.push_back(static_cast<float>(1e4 + i%10));
+		}
+		const vector<float> bigVec(bigList.begin(), bigList.end());
+		const double expectVar = 8.25 * N / (N-1);
+		BOOST_CHECK_CLOSE(kpfutils::mean(bigList.begin(), bigList.end()), 1e4 + 4.5, 1e-5);
+		BOOST_CHECK_CLOSE(kpfutils::mean(bigVec .begin(), bigVec .end()), 1e4 + 4.5, 1e-5);
+		BOOST_CHECK_CLOSE(kpfutils::variance(bigList.begin(), bigList.end()), expectVar, 1e-5);
+		BOOST_CHECK_CLOSE(kpfutils::variance(bigVec .begin(), bigVec .end()), expectVar, 1e-5);
+	}
+	
+	/** @test Empty vector of doubles. Expected behavior: mean() and 
+	 *	variance() throw NotEnoughData, isSorted() returns true.
+	 */
+	const vector<double> empty;
+	BOOST_CHECK_THROW(kpfutils::mean    (empty.begin(), empty.end()), except::NotEnoughData);
+	BOOST_CHECK_THROW(kpfutils::variance(empty.begin(), empty.end()), except::NotEnoughData);
+	BOOST_CHECK(isSorted(empty.begin(), empty.end()));
+}
+
+/** Tests whether sorted data are recognized and carried correctly
+ *
+ * @see isSorted()
+ * @see Sorted
+ */
+BOOST_AUTO_TEST_CASE(sorted)
+{
+	/** @test Vector of doubles, length 1000, sorted, with one pair swapped 
+	 *	at the start, end, or a block boundary. Expected behavior: 
+	 *	isSorted() returns true before the swap and false after, and 
+	 *	agrees with the list version.
+	 */
+	vector<double> ramp;
+	for (size_t i = 0; i < 1000; i++) {
+		ramp.push_back(0.5 * i);
+	}
+	BOOST_CHECK(isSorted(ramp.begin(), ramp.end()));
+	const size_t SWAPS[] = {0, 63, 64, 500, 998};
+	for (size_t i = 0; i < sizeof(SWAPS)/sizeof(SWAPS[0]); i++) {
+		vector<double> broken(ramp);
+		std::swap(broken[SWAPS[i]], broken[SWAPS[i]+1]);
+		const list<double> brokenList(broken.begin(), broken.end());
+		BOOST_CHECK(!isSorted(broken.begin(), broken.end()));
+		BOOST_CHECK(!isSorted(brokenList.begin(), brokenList.end()));
+	}
+	
+	/** @test Vector of doubles with repeated values. Expected behavior: 
+	 *	isSorted() returns true.
+	 */
+	{
+		vector<double> flat(200, 1.0);
+		flat.push_back(2.0);
+		BOOST_CHECK(isSorted(flat.begin(), flat.end()));
+	}
+	
+	/** @test Random vector of doubles. Expected behavior: creating a 
+	 *	Sorted from it throws invalid_argument; creating one from 
+	 *	a sorted copy does not.
+	 */
+	BOOST_CHECK_THROW(Sorted<vector<double> > bad(dblVec[0]), std::invalid_argument);
+	{
+		vector<double> copy(dblVec[0]);
+		std::sort(copy.begin(), copy.end());
+		Sorted<vector<double> > good(copy);
+		BOOST_CHECK(good.get() == copy);
+		
+		/** @test Sorted adopted from a vector, then released. Expected 
+		 *	behavior: contents transferred without change, and the 
+		 *	Sorted left empty.
+		 */
+		Sorted<vector<double> > adopted;
+		vector<double> moved(copy);
+		adopted.adopt(moved, knownSorted);
+		BOOST_CHECK(moved.empty());
+		BOOST_CHECK(adopted.get() == copy);
+		adopted.release(moved);
+		BOOST_CHECK(moved == copy);
+		BOOST_CHECK(adopted.empty());
+	}
+	
+	/** @test Times spaced 0.3 apart with repeats, marked as sorted, random 
+	 *	data, halfWidth = 1.0. Expected behavior: rollingMeanRms() and 
+	 *	rollingQuantile() give the same results as for an ordinary vector.
+	 */
+	vector<double> times;
+	for (size_t i = 0; i < TEST_LEN; i++) {
+		times.push_back(0.3 * (i - i/5));
+	}
+	const Sorted<vector<double> > sortedTimes(times, knownSorted);
+	vector<double> means, rms, sortedMeans, sortedRms, median, sortedMedian;
+	rollingMeanRms(times,       dblVec[0], 1.0, means,       rms);
+	rollingMeanRms(sortedTimes, dblVec[0], 1.0, sortedMeans, sortedRms);
+	BOOST_CHECK(means == sortedMeans);
+	BOOST_CHECK(rms   == sortedRms);
+	rollingMedian(times,       dblVec[0], 1.0, median);
+	rollingMedian(sortedTimes, dblVec[0], 1.0, sortedMedian);
+	BOOST_CHECK(median == sortedMedian);
+}
+
+/** Tests whether the fused variability indices agree with separate 
+ *	calculations
+ *
+ * @see variabilityIndices()
+ */
+BOOST_AUTO_TEST_CASE(variability)
+{
+	vector<double> times, errs;
+	for (size_t i = 0; i < TEST_LEN; i++) {
+		times.push_back(0.5 * i);
+		errs .push_back(0.1 + 0.01 * (i%7));
+	}
+	
+	for (size_t nTest = 0; nTest < TEST_COUNT; nTest++) {
+		/** @test Vectors of doubles, length 100, randomly generated. 
+		 *	Expected behavior: agrees with separate calculations of 
+		 *	each index to within 1e-8.
+		 */
+		const vector<double>& data = dblVec[nTest];
+		const VariabilityIndices result = variabilityIndices(times, data, errs);
+		
+		Moments moments;
+		double diffSq = 0.0;
+		for (size_t i = 0; i < TEST_LEN; i++) {
+			moments.add(data[i]);
+			if (i > 0) {
+				diffSq += (data[i] - data[i-1]) * (data[i] - data[i-1]);
+			}
+		}
+		const double n     = static_cast<double>(TEST_LEN);
+		const double var   = kpfutils::variance(data.begin(), data.end());
+		const double wMean = weightedMean(data.begin(), data.end(), errs.begin());
+		double absSum = 0.0, sqSum = 0.0, jSum = 0.0;
+		for (size_t i = 0; i < TEST_LEN; i++) {
+			const double resid = sqrt(n/(n-1)) * (data[i] - wMean) / errs[i];
+			absSum += fabs(resid);
+			sqSum  += resid * resid;
+			if (i > 0) {
+				const double p = resid * sqrt(n/(n-1)) * (data[i-1] - wMean) / errs[i-1];
+				jSum += (p >= 0.0 ? 1.0 : -1.0) * sqrt(fabs(p));
+			}
+		}
+		
+		BOOST_CHECK_EQUAL(result.count, static_cast<unsigned long>(TEST_LEN));
+		BOOST_CHECK_CLOSE(result.mean,     kpfutils::mean(data.begin(), data.end()), 1e-8);
+		BOOST_CHECK_CLOSE(result.stdDev,   sqrt(var), 1e-8);
+		BOOST_CHECK_CLOSE(result.skewness, moments.skewness(), 1e-8);
+		BOOST_CHECK_CLOSE(result.kurtosis, moments.kurtosis(), 1e-8);
+		BOOST_CHECK_CLOSE(result.eta,      diffSq / (n-1) / var, 1e-8);
+		BOOST_CHECK_CLOSE(result.weightedMean, wMean, 1e-8);
+		BOOST_CHECK_CLOSE(result.weightedStdDev, 
+			sqrt(weightedVariance(data.begin(), data.end(), errs.begin())), 1e-8);
+		BOOST_CHECK_CLOSE(result.stetsonJ, jSum / (n-1), 1e-8);
+		BOOST_CHECK_CLOSE(result.stetsonK, (absSum/n) / sqrt(sqSum/n), 1e-8);
+		
+		/** @test Vectors of floats, length 100, randomly generated. 
+		 *	Expected behavior: agrees with the double version to 
+		 *	within 1e-4, or 1e-5 absolute for J, which is near zero.
+		 */
+		const vector<float> fltData(data.begin(), data.end());
+		const vector<float> fltErrs(errs.begin(), errs.end());
+		const VariabilityIndices fltResult = variabilityIndices(times, fltData, fltErrs);
+		BOOST_CHECK_CLOSE(fltResult.stdDev,   result.stdDev,   1e-4);
+		BOOST_CHECK_CLOSE(fltResult.eta,      result.eta,      1e-4);
+		BOOST_CHECK_SMALL(fltResult.stetsonJ - result.stetsonJ, 1e-5);
+		BOOST_CHECK_CLOSE(fltResult.stetsonK, result.stetsonK, 1e-4);
+	}
+	
+	/** @test Measurements alternating between +1 and -1, equal errors. 
+	 *	Expected behavior: K = 1 and J = -2 sqrt(N/(N-1)).
+	 */
+	{
+		vector<double> alternating, equalErrs(TEST_LEN, 0.5);
+		for (size_t i = 0; i < TEST_LEN; i++) {
+			alternating.push_back(i % 2 == 0 ? 1.0 : -1.0);
+		}
+		const double n = static_cast<double>(TEST_LEN);
+		const VariabilityIndices result = variabilityIndices(
+			Sorted<vector<double> >(times), alternating, equalErrs);
+		BOOST_CHECK_CLOSE(result.stetsonK, 1.0, 1e-8);
+		BOOST_CHECK_CLOSE(result.stetsonJ, -2.0 * sqrt(n/(n-1)), 1e-8);
+	}
+	
+	/** @test Vectors of doubles, length 3. Expected behavior: throw 
+	 *	NotEnoughData.
+	 */
+	{
+		const vector<double> shortTimes(times.begin(), times.begin()+3);
+		const vector<double> shortData(dblVec[0].begin(), dblVec[0].begin()+3);
+		const vector<double> shortErrs(errs.begin(), errs.begin()+3);
+		BOOST_CHECK_THROW(variabilityIndices(shortTimes, shortData, shortErrs), 
+			except::NotEnoughData);
+	}
+	
+	/** @test Vectors of doubles, mismatched lengths or one error zero. 
+	 *	Expected behavior: throw invalid_argument.
+	 */
+	{
+		const vector<double> shortErrs(errs.begin(), errs.end()-1);
+		BOOST_CHECK_THROW(variabilityIndices(times, dblVec[0], shortErrs), 
+			std::invalid_argument);
+		vector<double> zeroErrs(errs);
+		zeroErrs[42] = 0.0;
+		BOOST_CHECK_THROW(variabilityIndices(times, dblVec[0], zeroErrs), 
+			std::invalid_argument);
+	}
+	
+	/** @test Vectors of doubles, unsorted times. Expected behavior: throw 
+	 *	NotSorted.
+	 */
+	{
+		vector<double> unsorted(times);
+		std::swap(unsorted[10], unsorted[11]);
+		BOOST_CHECK_THROW(variabilityIndices(unsorted, dblVec[0], errs), 
+			except::NotSorted);
+	}
+	
+	/** @test Three light curves of doubles. Expected behavior: results 
+	 *	identical to the single-curve version.
+	 */
+	vector<vector<double> > batchTimes(3, times), batchData, batchErrs(3, errs);
+	for (size_t i = 0; i < 3; i++) {
+		batchData.push_back(dblVec[i]);
+	}
+	vector<VariabilityIndices> batch;
+	variabilityIndices(batchTimes, batchData, batchErrs, batch);
+	BOOST_REQUIRE_EQUAL(batch.size(), 3U);
+	for (size_t i = 0; i < 3; i++) {
+		const VariabilityIndices single = variabilityIndices(times, dblVec[i], errs);
+		BOOST_CHECK_EQUAL(batch[i].eta,      single.eta);
+		BOOST_CHECK_EQUAL(batch[i].stetsonJ, single.stetsonJ);
+		BOOST_CHECK_EQUAL(batch[i].kurtosis, single.kurtosis);
+	}
+	
+	/** @test Three light curves of floats. Expected behavior: results 
+	 *	identical to the single-curve version.
+	 */
+	{
+		vector<vector<float> > fltData, fltErrs;
+		for (size_t i = 0; i < 3; i++) {
+			fltData.push_back(vector<float>(dblVec[i].begin(), dblVec[i].end()));
+			fltErrs.push_back(vector<float>(errs.begin(), errs.end()));
+		}
+		vector<VariabilityIndices> fltBatch;
+		variabilityIndices(batchTimes, fltData, fltErrs, fltBatch);
+		BOOST_REQUIRE_EQUAL(fltBatch.size(), 3U);
+		for (size_t i = 0; i < 3; i++) {
+			const VariabilityIndices single = variabilityIndices(times, 
+				fltData[i], fltErrs[i]);
+			BOOST_CHECK_EQUAL(fltBatch[i].eta,      single.eta);
+			BOOST_CHECK_EQUAL(fltBatch[i].stetsonJ, single.stetsonJ);
+			BOOST_CHECK_EQUAL(fltBatch[i].kurtosis, single.kurtosis);
+		}
+	}
+	
+	/** @test Three light curves, the second of length 3. Expected 
+	 *	behavior: throw NotEnoughData, leaving the results unchanged.
+	 */
+	batchTimes[1].resize(3);
+	batchData [1].resize(3);
+	batchErrs [1].resize(3);
+	BOOST_CHECK_THROW(variabilityIndices(batchTimes, batchData, batchErrs, batch), 
+		except::NotEnoughData);
+	BOOST_CHECK_EQUAL(batch.size(), 3U);
+}
+
+/** Tests whether binned statistics agree with statistics of each bin's 
+ *	slice of the data
+ *
+ * @see BinEdges
+ * @see binnedStats()
+ */
+BOOST_AUTO_TEST_CASE(binned)
+{
+	/** @test Uniform bins, keys 0 to 99, data random. Expected behavior: 
+	 *	each bin's count, mean, variance, and median agree with 
+	 *	mean(), variance(), and quantile() applied to its slice.
+	 */
+	vector<double> keys;
+	for (size_t i = 0; i < TEST_LEN; i++) {
+		keys.push_back(static_cast<double>(i));
+	}
+	const BinEdges uniform(0.0, 100.0, 8);
+	BOOST_REQUIRE_EQUAL(uniform.size(), 8U);
+	BOOST_CHECK(uniform.isUniform());
+	
+	BinnedStats result;
+	binnedStats(uniform, keys.begin(), keys.end(), dblVec[0].begin(), BIN_ALL, result);
+	BOOST_CHECK(result.binEdges == uniform.edges());
+	BOOST_REQUIRE_EQUAL(result.count .size(), 8U);
+	BOOST_REQUIRE_EQUAL(result.median.size(), 8U);
+	for (size_t bin = 0; bin < 8; bin++) {
+		// Keys are integers, so bin [12.5*b, 12.5*(b+1)) starts at ceil(12.5*b)
+		const size_t first = static_cast<size_t>(ceil(12.5 * bin));
+		const size_t last  = static_cast<size_t>(ceil(12.5 * (bin+1)));
+		BOOST_CHECK_EQUAL(result.count[bin], static_cast<double>(last - first));
+		BOOST_CHECK_CLOSE(result.mean[bin], kpfutils::mean(
+			dblVec[0].begin()+first, dblVec[0].begin()+last), 1e-8);
+		BOOST_CHECK_CLOSE(result.variance[bin], kpfutils::variance(
+			dblVec[0].begin()+first, dblVec[0].begin()+last), 1e-8);
+		BOOST_CHECK_EQUAL(result.median[bin], kpfutils::quantile(
+			dblVec[0].begin()+first, dblVec[0].begin()+last, 0.5));
+	}
+	
+	/** @test Arbitrary bins, keys uniformly distributed over the bins, 
+	 *	random data. Expected behavior: same counts as equivalent uniform 
+	 *	bins, and as counting each bin's keys directly.
+	 */
+	const BinEdges arbitrary(uniform.edges());
+	BOOST_CHECK(!arbitrary.isUniform());
+	vector<double> randomKeys;
+	{
+		shared_ptr<gsl_rng> keyRng(checkAlloc(gsl_rng_alloc(gsl_rng_mt19937)), 
+			&gsl_rng_free);
+		gsl_rng_set(keyRng.get(), 7);
+		for (size_t i = 0; i < TEST_LEN; i++) {
+			randomKeys.push_back(100.0 * gsl_rng_uniform(keyRng.get()));
+		}
+	}
+	vector<double> expectedCounts(8, 0.0);
+	for (size_t i = 0; i < TEST_LEN; i++) {
+		expectedCounts[static_cast<size_t>(randomKeys[i] / 12.5)] += 1.0;
+	}
+	
+	BinnedStats uniformResult, arbitraryResult;
+	binnedStats(uniform,   randomKeys.begin(), randomKeys.end(), dblVec[2].begin(), 
+		BIN_COUNT | BIN_MEAN, uniformResult);
+	binnedStats(arbitrary, randomKeys.begin(), randomKeys.end(), dblVec[2].begin(), 
+		BIN_COUNT | BIN_MEAN, arbitraryResult);
+	BOOST_CHECK_EQUAL_COLLECTIONS(uniformResult.count.begin(), uniformResult.count.end(), 
+		expectedCounts.begin(), expectedCounts.end());
+	BOOST_CHECK_EQUAL_COLLECTIONS(arbitraryResult.count.begin(), 
+		arbitraryResult.count.end(), expectedCounts.begin(), expectedCounts.end());
+	BOOST_CHECK(uniformResult.mean == arbitraryResult.mean);
+	BOOST_CHECK(uniformResult.variance.empty());
+	BOOST_CHECK(uniformResult.median  .empty());
+	
+	/** @test Keys on every bin edge, below the first edge, above the last 
+	 *	edge, and NaN. Expected behavior: edge keys go in the bin they 
+	 *	start, except the last edge, which goes in the last bin; the 
+	 *	others are ignored.
+	 */
+	{
+		const BinEdges tenths(0.0, 1.0, 10);
+		vector<double> edgeKeys(tenths.edges());
+		edgeKeys.push_back(-0.01);
+		edgeKeys.push_back(1.01);
+		if (std::numeric_limits<double>::has_quiet_NaN) {
+			edgeKeys.push_back(std::numeric_limits<double>::quiet_NaN());
+		}
+		for (size_t i = 0; i < 11; i++) {
+			size_t bin = 42;
+			BOOST_CHECK(tenths.find(edgeKeys[i], bin));
+			BOOST_CHECK_EQUAL(bin, std::min<size_t>(i, 9));
+		}
+		size_t bin = 42;
+		for (size_t i = 11; i < edgeKeys.size(); i++) {
+			BOOST_CHECK(!tenths.find(edgeKeys[i], bin));
+		}
+		BOOST_CHECK_EQUAL(bin, 42U);
+		
+		const vector<double> ones(edgeKeys.size(), 1.0);
+		BinnedStats counts;
+		binnedStats(tenths, edgeKeys.begin(), edgeKeys.end(), ones.begin(), 
+			BIN_COUNT, counts);
+		BOOST_CHECK_EQUAL(counts.count[0], 1.0);
+		BOOST_CHECK_EQUAL(counts.count[9], 2.0);
+	}
+	
+	/** @test Bins with no data. Expected behavior: count 0, and mean, 
+	 *	variance, and median NaN.
+	 */
+	{
+		const BinEdges wide(-100.0, 200.0, 3);
+		binnedStats(wide, keys.begin(), keys.end(), dblVec[0].begin(), BIN_ALL, result);
+		BOOST_CHECK_EQUAL(result.count[0], 0.0);
+		BOOST_CHECK(result.mean    [0] != result.mean    [0]);
+		BOOST_CHECK(result.variance[0] != result.variance[0]);
+		BOOST_CHECK(result.median  [0] != result.median  [0]);
+		BOOST_CHECK_EQUAL(result.count[1], static_cast<double>(TEST_LEN));
+	}
+	
+	/** @test Zero bins, reversed range, or unsorted edges. Expected 
+	 *	behavior: throw invalid_argument.
+	 */
+	BOOST_CHECK_THROW(BinEdges(0.0, 1.0, 0), std::invalid_argument);
+	BOOST_CHECK_THROW(BinEdges(1.0, 0.0, 5), std::invalid_argument);
+	{
+		vector<double> badEdges(uniform.edges());
+		std::swap(badEdges[2], badEdges[3]);
+		BOOST_CHECK_THROW(BinEdges temp(badEdges), std::invalid_argument);
+	}
+}
+
+/** Tests whether the histogram functions agree with each other and with 
+ *	BinEdges::find()
+ *
+ * @see histogram()
+ * @see parallelHistogram()
+ */
+BOOST_AUTO_TEST_CASE(histograms)
+{
+	const BinEdges uniform(0.0, 1.0, 7);
+	const BinEdges arbitrary(uniform.edges());
+	
+	/** @test Vector of doubles, length 100, randomly generated, uniform or 
+	 *	equivalent arbitrary bins. Expected behavior: each bin's count 
+	 *	equals the number of values between its edges.
+	 */
+	for (size_t nTest = 0; nTest < TEST_COUNT; nTest++) {
+		const vector<double>& data = dblVec[nTest];
+		vector<double> edges, counts, arbitraryCounts;
+		histogram(uniform,   data.begin(), data.end(), edges, counts);
+		histogram(arbitrary, data.begin(), data.end(), edges, arbitraryCounts);
+		BOOST_CHECK(edges == uniform.edges());
+		BOOST_REQUIRE_EQUAL(counts.size(), 7U);
+		BOOST_CHECK(counts == arbitraryCounts);
+		for (size_t bin = 0; bin < 7; bin++) {
+			double expected = 0.0;
+			for (size_t i = 0; i < TEST_LEN; i++) {
+				if (data[i] >= edges[bin] && (data[i] < edges[bin+1] 
+						|| (bin == 6 && data[i] == edges[bin+1]))) {
+					expected += 1.0;
+				}
+			}
+			BOOST_CHECK_EQUAL(counts[bin], expected);
+		}
+		
+		/** @test Vector of doubles, length 100, randomly generated, all 
+		 *	weights 2. Expected behavior: twice the unweighted histogram.
+		 */
+		const vector<double> twos(TEST_LEN, 2.0);
+		vector<double> weighted;
+		histogram(uniform, data.begin(), data.end(), twos.begin(), edges, weighted);
+		for (size_t bin = 0; bin < 7; bin++) {
+			BOOST_CHECK_EQUAL(weighted[bin], 2.0 * counts[bin]);
+		}
+		
+		/** @test Sorted vector of doubles, length 100, arbitrary bins. 
+		 *	Expected behavior: same result as the unsorted version.
+		 */
+		vector<double> sortedData(data);
+		std::sort(sortedData.begin(), sortedData.end());
+		vector<double> sortedCounts;
+		histogram(arbitrary, Sorted<vector<double> >(sortedData, knownSorted), 
+			edges, sortedCounts);
+		BOOST_CHECK(sortedCounts == counts);
+		
+		/** @test Sorted vector of doubles, length 100, random weights. 
+		 *	Expected behavior: agrees with the unsorted version to 
+		 *	within 1e-10.
+		 */
+		vector<double> sortedWeighted, unsortedWeighted;
+		histogram(uniform, sortedData.begin(), sortedData.end(), dblVec[0].begin(), 
+			edges, unsortedWeighted);
+		histogram(uniform, Sorted<vector<double> >(sortedData, knownSorted), 
+			dblVec[0].begin(), edges, sortedWeighted);
+		for (size_t bin = 0; bin < 7; bin++) {
+			BOOST_CHECK_CLOSE(sortedWeighted[bin], unsortedWeighted[bin], 1e-10);
+		}
+	}
+	
+	/** @test Values on every bin edge and outside the bins, sorted or not. 
+	 *	Expected behavior: same assignment as BinEdges::find().
+	 */
+	{
+		vector<double> edgeData(uniform.edges());
+		edgeData.insert(edgeData.begin(), -0.5);
+		edgeData.push_back(1.0);
+		edgeData.push_back(1.5);
+		vector<double> expected(7, 0.0);
+		for (size_t i = 0; i < edgeData.size(); i++) {
+			size_t bin = 0;
+			if (uniform.find(edgeData[i], bin)) {
+				expected[bin] += 1.0;
+			}
+		}
+		BOOST_CHECK_EQUAL(expected[6], 3.0);
+		
+		vector<double> edges, counts, sortedCounts;
+		histogram(uniform, edgeData.begin(), edgeData.end(), edges, counts);
+		histogram(uniform, Sorted<vector<double> >(edgeData), edges, sortedCounts);
+		BOOST_CHECK(counts       == expected);
+		BOOST_CHECK(sortedCounts == expected);
+	}
+	
+	/** @test Vector of doubles, length 10^6, 1, 3, or 8 threads. Expected 
+	 *	behavior: identical to histogram().
+	 */
+	vector<double> big, bigWeights;
+	for (size_t i = 0; i < 1000000; i++) {
+		big       .push_back(fmod(0.6180339887 * i, 1.0));
+		bigWeights.push_back(1.0 + 0.1 * (i % 3));
+	}
+	vector<double> edges, serial, weightedSerial;
+	histogram(uniform, big.begin(), big.end(), edges, serial);
+	histogram(uniform, big.begin(), big.end(), bigWeights.begin(), edges, weightedSerial);
+	const unsigned int THREADS[] = {1, 3, 8};
+	for (size_t i = 0; i < 3; i++) {
+		vector<double> parallel;
+		parallelHistogram(uniform, big.begin(), big.end(), edges, parallel, THREADS[i]);
+		BOOST_CHECK(parallel == serial);
+	}
+	
+	/** @test Vector of doubles, length 10^6, random weights, 4 threads. 
+	 *	Expected behavior: agrees with histogram() to within 1e-8.
+	 */
+	vector<double> weightedParallel;
+	parallelHistogram(uniform, big.begin(), big.end(), bigWeights.begin(), 
+		edges, weightedParallel, 4);
+	for (size_t bin = 0; bin < 7; bin++) {
+		BOOST_CHECK_CLOSE(weightedParallel[bin], weightedSerial[bin], 1e-8);
+	}
+}
+
+/** Tests whether the fast and exact periodograms agree and find a 
+ *	known signal
+ *
+ * @see lombScargle()
+ * @see parallelLombScargle()
+ */
+BOOST_AUTO_TEST_CASE(periodogram)
+{
+	const double SIGNAL = 0.8;
+	const double TWO_PI = 6.283185307179586;
+	vector<double> times, errs;
+	for (size_t i = 0; i < 2*TEST_LEN; i++) {
+		times.push_back(0.37 * i + 0.2 * sin(1.0 * i) * sin(1.0 * i));
+		errs .push_back(0.1 + 0.01 * (i%7));
+	}
+	
+	for (size_t nTest = 0; nTest < TEST_COUNT; nTest++) {
+		vector<double> data;
+		for (size_t i = 0; i < times.size(); i++) {
+			data.push_back(sin(TWO_PI*SIGNAL*times[i]) 
+				+ 0.3 * (dblVec[nTest][i % TEST_LEN] - 0.5));
+		}
+		
+		/** @test Unevenly sampled sinusoid with noise and unequal 
+		 *	errors, LS_FAST and LS_EXACT. Expected behavior: the two 
+		 *	agree to within 1e-3, and both peak at the input frequency.
+		 */
+		vector<double> freq, fast, exactFreq, exact;
+		lombScargle(times, data, errs, 0.01, 0.002, 1000, freq,      fast);
+		lombScargle(times, data, errs, 0.01, 0.002, 1000, exactFreq, exact, LS_EXACT);
+		BOOST_REQUIRE_EQUAL(freq.size(), 1000U);
+		BOOST_REQUIRE_EQUAL(fast.size(), 1000U);
+		BOOST_CHECK(freq == exactFreq);
+		for (size_t k = 0; k < freq.size(); k++) {
+			BOOST_CHECK_SMALL(fast[k] - exact[k], 1e-3);
+			BOOST_CHECK(exact[k] >= 0.0 && exact[k] <= 1.0);
+		}
+		const size_t fastPeak  = std::max_element(fast .begin(), fast .end()) - fast .begin();
+		const size_t exactPeak = std::max_element(exact.begin(), exact.end()) - exact.begin();
+		BOOST_CHECK_EQUAL(fastPeak, exactPeak);
+		BOOST_CHECK_SMALL(freq[exactPeak] - SIGNAL, 0.002);
+		
+		/** @test Unevenly sampled sinusoid, frequencies from the regular 
+		 *	grid. Expected behavior: agrees with the LS_EXACT grid to 
+		 *	within 1e-10.
+		 */
+		vector<double> listPower;
+		lombScargle(times, data, errs, freq, listPower);
+		BOOST_REQUIRE_EQUAL(listPower.size(), freq.size());
+		for (size_t k = 0; k < freq.size(); k++) {
+			BOOST_CHECK_SMALL(listPower[k] - exact[k], 1e-10);
+		}
+		
+		/** @test Unevenly sampled sinusoid with noise, 1000 frequencies, 
+		 *	1, 3, or 8 threads. Expected behavior: agrees with LS_EXACT 
+		 *	to within 1e-10, and identical for all thread counts.
+		 */
+		vector<double> serialFreq, serial;
+		parallelLombScargle(times, data, errs, 0.01, 0.002, 1000, serialFreq, serial, 1);
+		BOOST_CHECK(serialFreq == freq);
+		BOOST_REQUIRE_EQUAL(serial.size(), freq.size());
+		for (size_t k = 0; k < freq.size(); k++) {
+			BOOST_CHECK_SMALL(serial[k] - exact[k], 1e-10);
+		}
+		const unsigned int THREADS[] = {3, 8};
+		for (size_t i = 0; i < 2; i++) {
+			vector<double> threadFreq, threaded;
+			parallelLombScargle(times, data, errs, 0.01, 0.002, 1000, 
+				threadFreq, threaded, THREADS[i]);
+			BOOST_CHECK(threaded == serial);
+		}
+		
+		/** @test Unevenly sampled sinusoid, frequencies from the regular 
+		 *	grid, 4 threads. Expected behavior: agrees with lombScargle() 
+		 *	to within 1e-10.
+		 */
+		vector<double> threadedList;
+		parallelLombScargle(times, data, errs, freq, threadedList, 4);
+		BOOST_REQUIRE_EQUAL(threadedList.size(), freq.size());
+		for (size_t k = 0; k < freq.size(); k++) {
+			BOOST_CHECK_SMALL(threadedList[k] - listPower[k], 1e-10);
+		}
+	}
+	
+	/** @test Sinusoid sampled over 30000 days, frequencies up to 2 per 
+	 *	day. Expected behavior: agrees with LS_EXACT to within the bound 
+	 *	on the phase error.
+	 */
+	{
+		const double BASELINE = 30000.0;
+		vector<double> longTimes, data;
+		for (size_t i = 0; i < 2*TEST_LEN; i++) {
+			longTimes.push_back(BASELINE * (i + 0.3 * sin(1.0 * i) * sin(1.0 * i)) 
+				/ (2*TEST_LEN));
+			data.push_back(sin(TWO_PI*SIGNAL*longTimes[i]) 
+				+ 0.3 * (dblVec[0][i % TEST_LEN] - 0.5));
+		}
+		vector<double> freq, exact, rotated;
+		lombScargle(longTimes, data, errs, 0.01, 0.002, 1000, freq, exact, LS_EXACT);
+		parallelLombScargle(longTimes, data, errs, 0.01, 0.002, 1000, freq, rotated, 1);
+		const double phaseBound = 2.5e-14 + 2.0 * TWO_PI 
+			* numeric_limits<double>::epsilon() * (freq.back() + 16 * 0.002) * BASELINE;
+		BOOST_REQUIRE_EQUAL(rotated.size(), exact.size());
+		for (size_t k = 0; k < freq.size(); k++) {
+			BOOST_CHECK_SMALL(rotated[k] - exact[k], phaseBound);
+		}
+	}
+	
+	/** @test Constant data. Expected behavior: power is zero everywhere.
+	 */
+	{
+		const vector<double> flat(times.size(), 3.0);
+		vector<double> freq, power;
+		lombScargle(times, flat, errs, 0.01, 0.01, 100, freq, power);
+		BOOST_CHECK(power == vector<double>(100, 0.0));
+	}
+	
+	/** @test Mismatched lengths, zero errors, nonpositive frequencies, or 
+	 *	fewer than 3 points. Expected behavior: throw invalid_argument or 
+	 *	NotEnoughData.
+	 */
+	{
+		vector<double> freq, power;
+		const vector<double> shortTimes(times.begin(), times.end() - 1);
+		BOOST_CHECK_THROW(lombScargle(shortTimes, dblVec[0], errs, 0.01, 0.01, 10, freq, power), 
+			std::invalid_argument);
+		vector<double> badErrs(errs);
+		badErrs[3] = 0.0;
+		BOOST_CHECK_THROW(lombScargle(times, times, badErrs, 0.01, 0.01, 10, freq, power), 
+			std::invalid_argument);
+		BOOST_CHECK_THROW(lombScargle(times, times, errs, 0.0, 0.01, 10, freq, power), 
+			std::invalid_argument);
+		BOOST_CHECK_THROW(lombScargle(times, times, errs, 0.01, -0.01, 10, freq, power), 
+			std::invalid_argument);
+		BOOST_CHECK_THROW(lombScargle(times, times, errs, 0.01, 0.01, 0, freq, power), 
+			std::invalid_argument);
+		BOOST_CHECK_THROW(lombScargle(times, times, errs, vector<double>(1, -1.0), power), 
+			std::invalid_argument);
+		BOOST_CHECK_THROW(parallelLombScargle(times, times, badErrs, 0.01, 0.01, 10, freq, power), 
+			std::invalid_argument);
+		BOOST_CHECK_THROW(parallelLombScargle(times, times, errs, 0.01, 0.0, 10, freq, power), 
+			std::invalid_argument);
+		BOOST_CHECK_THROW(parallelLombScargle(times, times, errs, vector<double>(1, 0.0), power), 
+			std::invalid_argument);
+		const vector<double> two(2, 1.0);
+		BOOST_CHECK_THROW(lombScargle(two, two, two, 0.01, 0.01, 10, freq, power), 
+			except::NotEnoughData);
+	}
+}
+
+/** Light curve source that copies from vectors in memory
+ */
+class CopySource {
+public:
+	CopySource(const vector<vector<double> >& times, const vector<vector<double> >& data, 
+			const vector<vector<double> >& errs) : times(times), data(data), errs(errs) {
+	}
+	
+	void operator()(size_t i, vector<double>& t, vector<double>& d, vector<double>& e) const {
+		t = times[i];
+		d = data[i];
+		e = errs[i];
+	}
+	
+private:
+	const vector<vector<double> >& times;
+	const vector<vector<double> >& data;
+	const vector<vector<double> >& errs;
+};
+
+/** Periodogram sink that records the order in which it was called
+ */
+class OrderSink {
+public:
+	explicit OrderSink(vector<size_t>& order) : order(order) {
+	}
+	
+	void operator()(size_t i, const vector<double>&, const vector<double>&) const {
+		order.push_back(i);
+	}
+	
+private:
+	vector<size_t>& order;
+};
+
+/** Tests whether batch periodograms agree with single periodograms
+ *
+ * @see FrequencyGrid
+ * @see batchLombScargle()
+ */
+BOOST_AUTO_TEST_CASE(periodogram_batch)
+{
+	vector<vector<double> > times, data, errs;
+	for (size_t c = 0; c < 20; c++) {
+		times.push_back(vector<double>());
+		data .push_back(vector<double>());
+		errs .push_back(vector<double>());
+		const size_t len = (c == 11 ? 2 : 30 + 10*(c % 5));
+		for (size_t i = 0; i < len; i++) {
+			times.back().push_back(0.37 * i + 0.1 * c);
+			data .back().push_back(dblVec[c % TEST_COUNT][i]);
+			errs .back().push_back(0.1 + 0.01 * (i%7));
+		}
+	}
+	const vector<vector<double> > goodTimes(times.begin(), times.begin() + 5);
+	const vector<vector<double> > goodData (data .begin(), data .begin() + 5);
+	const vector<vector<double> > goodErrs (errs .begin(), errs .begin() + 5);
+	
+	/** @test Unevenly sampled data, each method. Expected behavior: 
+	 *	FrequencyGrid::periodogram() identical to lombScargle().
+	 */
+	const LsMethod METHODS[] = {LS_FAST, LS_EXACT, LS_DIRECT};
+	for (size_t m = 0; m < 3; m++) {
+		const FrequencyGrid grid(0.01, 0.01, 200, METHODS[m]);
+		BOOST_CHECK_EQUAL(grid.method(), METHODS[m]);
+		vector<double> freq, power, gridPower;
+		lombScargle(times[0], data[0], errs[0], 0.01, 0.01, 200, freq, power, METHODS[m]);
+		grid.periodogram(times[0], data[0], errs[0], gridPower);
+		BOOST_CHECK(freq == grid.frequencies());
+		BOOST_CHECK(gridPower == power);
+		
+		/** @test Light curves of length 60, 30, and 60, one workspace, 
+		 *	each method. Expected behavior: identical to the version 
+		 *	without a workspace.
+		 */
+		PeriodogramWorkspace workspace;
+		const size_t CURVES[] = {3, 0, 8};
+		for (size_t c = 0; c < 3; c++) {
+			vector<double> single, reused;
+			grid.periodogram(times[CURVES[c]], data[CURVES[c]], errs[CURVES[c]], single);
+			grid.periodogram(times[CURVES[c]], data[CURVES[c]], errs[CURVES[c]], reused, 
+				workspace);
+			BOOST_CHECK(reused == single);
+		}
+	}
+	
+	/** @test Five light curves of different lengths, 1 or 3 threads. 
+	 *	Expected behavior: identical to FrequencyGrid::periodogram() on 
+	 *	each light curve, delivered in order.
+	 */
+	const FrequencyGrid grid(0.01, 0.01, 200, LS_DIRECT);
+	const unsigned int THREADS[] = {1, 3};
+	for (size_t t = 0; t < 2; t++) {
+		vector<vector<double> > powers;
+		batchLombScargle(grid, goodTimes, goodData, goodErrs, powers, THREADS[t]);
+		BOOST_REQUIRE_EQUAL(powers.size(), 5U);
+		for (size_t c = 0; c < 5; c++) {
+			vector<double> single;
+			grid.periodogram(times[c], data[c], errs[c], single);
+			BOOST_CHECK(powers[c] == single);
+		}
+		
+		vector<size_t> order;
+		batchLombScargle(grid, 5, CopySource(goodTimes, goodData, goodErrs), 
+			OrderSink(order), THREADS[t]);
+		BOOST_REQUIRE_EQUAL(order.size(), 5U);
+		for (size_t c = 0; c < 5; c++) {
+			BOOST_CHECK_EQUAL(order[c], c);
+		}
+	}
+	
+	/** @test Twenty light curves, the 12th of length 2, 4 threads. 
+	 *	Expected behavior: sink called for the first 11, then throw 
+	 *	NotEnoughData.
+	 */
+	{
+		vector<size_t> order;
+		BOOST_CHECK_THROW(batchLombScargle(grid, 20, CopySource(times, data, errs), 
+			OrderSink(order), 4), except::NotEnoughData);
+		BOOST_REQUIRE_EQUAL(order.size(), 11U);
+		for (size_t c = 0; c < 11; c++) {
+			BOOST_CHECK_EQUAL(order[c], c);
+		}
+	}
+	
+	/** @test Mismatched numbers of light curves. Expected behavior: throw 
+	 *	invalid_argument.
+	 */
+	{
+		vector<vector<double> > powers;
+		BOOST_CHECK_THROW(batchLombScargle(grid, goodTimes, goodData, errs, powers), 
+			std::invalid_argument);
+	}
+}
+
+/** Tests whether resampling gives sensible false alarm probabilities
+ *
+ * @see bootstrapFap()
+ * @see bootstrapPeaks()
+ */
+BOOST_AUTO_TEST_CASE(periodogram_fap)
+{
+	const double TWO_PI = 6.283185307179586;
+	vector<double> times, errs, signal;
+	for (size_t i = 0; i < TEST_LEN; i++) {
+		times .push_back(0.37 * i + 0.2 * sin(1.0 * i) * sin(1.0 * i));
+		errs  .push_back(0.1 + 0.01 * (i%7));
+		signal.push_back(sin(TWO_PI*0.8*times[i]) + 0.3 * (dblVec[0][i] - 0.5));
+	}
+	const vector<double>& noise = dblVec[1];
+	const FrequencyGrid grid(0.01, 0.01, 130);
+	
+	vector<double> signalPower, noisePower;
+	grid.periodogram(times, signal, errs, signalPower);
+	grid.periodogram(times, noise,  errs, noisePower);
+	const double signalPeak = *std::max_element(signalPower.begin(), signalPower.end());
+	const double noisePeak  = *std::max_element(noisePower .begin(), noisePower .end());
+	
+	/** @test Sinusoid with noise, threshold at its highest peak. Expected 
+	 *	behavior: false alarm probability 0.
+	 */
+	{
+		const FapEstimate fap = bootstrapFap(grid, times, signal, errs, signalPeak, 200);
+		BOOST_CHECK_EQUAL(fap.resamples, 200U);
+		BOOST_CHECK_EQUAL(fap.exceedances, 0U);
+		BOOST_CHECK_EQUAL(fap.fap, 0.0);
+		BOOST_CHECK_EQUAL(fap.lower, 0.0);
+		BOOST_CHECK(fap.upper > 0.0 && fap.upper < 0.05);
+	}
+	
+	/** @test Pure noise, threshold at its highest peak. Expected behavior: 
+	 *	false alarm probability roughly uniform, so averaging well 
+	 *	above 0 over many noise realizations.
+	 */
+	double meanFap = 0.0;
+	for (size_t nTest = 0; nTest < TEST_COUNT; nTest++) {
+		vector<double> power;
+		grid.periodogram(times, dblVec[nTest], errs, power);
+		const FapEstimate fap = bootstrapFap(grid, times, dblVec[nTest], errs, 
+			*std::max_element(power.begin(), power.end()), 100);
+		BOOST_CHECK_EQUAL(fap.resamples, 100U);
+		BOOST_CHECK(fap.lower <= fap.fap && fap.fap <= fap.upper);
+		meanFap += fap.fap / TEST_COUNT;
+	}
+	BOOST_CHECK(meanFap > 0.2);
+	const FapEstimate noiseFap = bootstrapFap(grid, times, noise, errs, noisePeak, 200);
+	
+	/** @test 1, 3, or 8 threads, either resampling method. Expected 
+	 *	behavior: identical results.
+	 */
+	const ResampleMethod METHODS[] = {RESAMPLE_PERMUTE, RESAMPLE_BOOTSTRAP};
+	for (size_t m = 0; m < 2; m++) {
+		const FapEstimate serial = bootstrapFap(grid, times, noise, errs, noisePeak, 
+			300, 0.0, METHODS[m], 17, 1);
+		const unsigned int THREADS[] = {3, 8};
+		for (size_t t = 0; t < 2; t++) {
+			const FapEstimate threaded = bootstrapFap(grid, times, noise, errs, noisePeak, 
+				300, 0.0, METHODS[m], 17, THREADS[t]);
+			BOOST_CHECK_EQUAL(threaded.resamples,   serial.resamples);
+			BOOST_CHECK_EQUAL(threaded.exceedances, serial.exceedances);
+			BOOST_CHECK_EQUAL(threaded.fap,         serial.fap);
+		}
+	}
+	
+	/** @test Tolerance 0.05. Expected behavior: stops before 
+	 *	maxResamples, with a confidence interval no wider than 
+	 *	&plusmn;0.05.
+	 */
+	{
+		const FapEstimate fap = bootstrapFap(grid, times, noise, errs, noisePeak, 
+			5000, 0.05);
+		BOOST_CHECK(fap.resamples < 5000U);
+		BOOST_CHECK(fap.upper - fap.lower <= 0.1);
+	}
+	
+	/** @test Pure noise, 200 resamples, 1 or 4 threads. Expected behavior: 
+	 *	200 peaks between 0 and 1, identical for both thread counts, and 
+	 *	consistent with bootstrapFap().
+	 */
+	{
+		vector<double> serial, threaded;
+		bootstrapPeaks(grid, times, noise, errs, 200, serial, RESAMPLE_PERMUTE, 0, 1);
+		bootstrapPeaks(grid, times, noise, errs, 200, threaded, RESAMPLE_PERMUTE, 0, 4);
+		BOOST_REQUIRE_EQUAL(serial.size(), 200U);
+		BOOST_CHECK(threaded == serial);
+		size_t exceedances = 0;
+		for (size_t r = 0; r < serial.size(); r++) {
+			BOOST_CHECK(serial[r] >= 0.0 && serial[r] <= 1.0);
+			if (serial[r] >= noisePeak) {
+				exceedances++;
+			}
+		}
+		BOOST_CHECK_EQUAL(exceedances, noiseFap.exceedances);
+	}
+	
+	/** @test maxResamples = 0, negative tolerance, or invalid light curve. 
+	 *	Expected behavior: throw invalid_argument or NotEnoughData.
+	 */
+	{
+		vector<double> peaks;
+		BOOST_CHECK_THROW(bootstrapFap(grid, times, noise, errs, 0.5, 0), 
+			std::invalid_argument);
+		BOOST_CHECK_THROW(bootstrapFap(grid, times, noise, errs, 0.5, 100, -0.1), 
+			std::invalid_argument);
+		BOOST_CHECK_THROW(bootstrapPeaks(grid, times, noise, errs, 0, peaks), 
+			std::invalid_argument);
+		const vector<double> shortTimes(times.begin(), times.end() - 1);
+		BOOST_CHECK_THROW(bootstrapFap(grid, shortTimes, noise, errs, 0.5, 100), 
+			std::invalid_argument);
+		const vector<double> two(2, 1.0);
+		BOOST_CHECK_THROW(bootstrapPeaks(grid, two, two, two, 100, peaks), 
+			except::NotEnoughData);
+		BOOST_CHECK(peaks.empty());
+	}
+}
+
+/** Adds a narrow triangular peak to a periodogram
+ */
+void addBump(vector<double>& power, size_t center, double height) {
+	power[center] = std::max(power[center], height);
+	if (center > 0) {
+		power[center-1] = std::max(power[center-1], 0.5*height);
+	}
+	if (center + 1 < power.size()) {
+		power[center+1] = std::max(power[center+1], 0.5*height);
+	}
+}
+
+/** Tests whether peak extraction finds and refines the right peaks
+ *
+ * @see findPeaks()
+ * @see refinePeaks()
+ */
+BOOST_AUTO_TEST_CASE(periodogram_peaks)
+{
+	vector<double> freq, power(200, 0.0);
+	for (size_t i = 0; i < 200; i++) {
+		freq.push_back(0.01 * (i+1));
+	}
+	const size_t BUMPS[]   = {49,  99,  29,  129, 52,  199, 169};
+	const double HEIGHTS[] = {1.0, 0.9, 0.8, 0.7, 0.6, 0.5, 0.4};
+	for (size_t b = 0; b < 7; b++) {
+		addBump(power, BUMPS[b], HEIGHTS[b]);
+	}
+	
+	/** @test Six separated peaks, no exclusion. Expected behavior: the 
+	 *	strongest peaks in order, including one at the end of the grid.
+	 */
+	{
+		vector<Peak> peaks;
+		findPeaks(freq, power, 6, peaks);
+		BOOST_REQUIRE_EQUAL(peaks.size(), 6U);
+		for (size_t i = 0; i < 6; i++) {
+			BOOST_CHECK_EQUAL(peaks[i].index, BUMPS[i]);
+			BOOST_CHECK_EQUAL(peaks[i].power, HEIGHTS[i]);
+			BOOST_CHECK_EQUAL(peaks[i].frequency, freq[BUMPS[i]]);
+		}
+		findPeaks(freq, power, 20, peaks);
+		BOOST_CHECK_EQUAL(peaks.size(), 7U);
+		findPeaks(freq, power, 0, peaks);
+		BOOST_CHECK(peaks.empty());
+	}
+	
+	/** @test Six peaks with a sidelobe, an alias, and a harmonic of the 
+	 *	strongest peak. Expected behavior: the sidelobe, alias, and 
+	 *	harmonic are skipped.
+	 */
+	{
+		vector<Peak> peaks;
+		findPeaks(freq, power, 3, peaks, 0.035, vector<double>(1, 0.8), 2);
+		BOOST_REQUIRE_EQUAL(peaks.size(), 3U);
+		BOOST_CHECK_EQUAL(peaks[0].index, 49U);
+		BOOST_CHECK_EQUAL(peaks[1].index, 199U);
+		BOOST_CHECK_EQUAL(peaks[2].index, 169U);
+	}
+	
+	/** @test Random periodogram, wide exclusion windows. Expected 
+	 *	behavior: same as a greedy search over all local maxima.
+	 */
+	{
+		vector<double> noiseFreq, noise;
+		for (size_t nTest = 0; nTest < TEST_COUNT; nTest++) {
+			for (size_t i = 0; i < TEST_LEN; i++) {
+				noiseFreq.push_back(0.01 * (noise.size() + 1));
+				noise.push_back(dblVec[nTest][i]);
+			}
+		}
+		const vector<double> aliases(1, 1.0);
+		
+		vector<Peak> maxima;
+		for (size_t i = 0; i < noise.size(); i++) {
+			if ((i == 0 || noise[i] > noise[i-1]) 
+					&& (i + 1 == noise.size() || noise[i] > noise[i+1])) {
+				Peak peak;
+				peak.frequency = noiseFreq[i];
+				peak.power = noise[i];
+				peak.index = i;
+				maxima.push_back(peak);
+			}
+		}
+		for (size_t i = 0; i < maxima.size(); i++) {
+			for (size_t j = i+1; j < maxima.size(); j++) {
+				if (maxima[j].power > maxima[i].power) {
+					std::swap(maxima[i], maxima[j]);
+				}
+			}
+		}
+		
+		const double WINDOWS[] = {0.0, 0.05, 0.3};
+		for (size_t w = 0; w < 3; w++) {
+			vector<Peak> expected;
+			for (size_t i = 0; i < maxima.size() && expected.size() < 10; i++) {
+				bool keep = true;
+				for (size_t j = 0; j < expected.size(); j++) {
+					const double f = maxima[i].frequency, g = expected[j].frequency;
+					if (fabs(f - g) < WINDOWS[w] || fabs(f - g - 1.0) < WINDOWS[w] 
+							|| fabs(f - fabs(g - 1.0)) < WINDOWS[w] 
+							|| fabs(f - 2.0*g) < WINDOWS[w] || fabs(f - 3.0*g) < WINDOWS[w] 
+							|| fabs(f - g/2.0) < WINDOWS[w] || fabs(f - g/3.0) < WINDOWS[w]) {
+						keep = false;
+					}
+				}
+				if (keep) {
+					expected.push_back(maxima[i]);
+				}
+			}
+			
+			vector<Peak> peaks;
+			findPeaks(noiseFreq, noise, 10, peaks, WINDOWS[w], aliases, 3);
+			BOOST_REQUIRE_EQUAL(peaks.size(), expected.size());
+			for (size_t i = 0; i < peaks.size(); i++) {
+				BOOST_CHECK_EQUAL(peaks[i].index, expected[i].index);
+			}
+		}
+	}
+	
+	/** @test Sinusoid off the coarse grid. Expected behavior: refined 
+	 *	frequency closer to the input frequency than the grid allows, and 
+	 *	refined power at least the exact power at the grid peak.
+	 */
+	{
+		const double SIGNAL = 0.8123;
+		const double TWO_PI = 6.283185307179586;
+		vector<double> times, data, errs;
+		for (size_t i = 0; i < 2*TEST_LEN; i++) {
+			times.push_back(0.37 * i + 0.2 * sin(1.0 * i) * sin(1.0 * i));
+			data .push_back(sin(TWO_PI*SIGNAL*times[i]) + 0.1 * dblVec[2][i % TEST_LEN]);
+			errs .push_back(0.1 + 0.01 * (i%7));
+		}
+		vector<double> coarseFreq, coarse;
+		lombScargle(times, data, errs, 0.01, 0.01, 130, coarseFreq, coarse);
+		
+		vector<Peak> peaks;
+		findPeaks(coarseFreq, coarse, 2, peaks, 0.05);
+		BOOST_REQUIRE_EQUAL(peaks.size(), 2U);
+		const Peak gridPeak = peaks[0];
+		BOOST_CHECK_SMALL(gridPeak.frequency - SIGNAL, 0.01);
+		vector<double> exactAtGrid;
+		lombScargle(times, data, errs, vector<double>(1, gridPeak.frequency), exactAtGrid);
+		
+		refinePeaks(times, data, errs, 0.01, 201, peaks);
+		BOOST_REQUIRE_EQUAL(peaks.size(), 2U);
+		BOOST_CHECK_EQUAL(peaks[0].index, gridPeak.index);
+		BOOST_CHECK_SMALL(peaks[0].frequency - SIGNAL, 0.001);
+		BOOST_CHECK(peaks[0].power >= exactAtGrid[0]);
+		BOOST_CHECK(peaks[0].power >= peaks[1].power);
+		
+		/** @test Nonpositive width or too few points. Expected behavior: 
+		 *	throw invalid_argument.
+		 */
+		BOOST_CHECK_THROW(refinePeaks(times, data, errs, 0.0, 11, peaks), 
+			std::invalid_argument);
+		BOOST_CHECK_THROW(refinePeaks(times, data, errs, 0.01, 1, peaks), 
+			std::invalid_argument);
+	}
+	
+	/** @test Mismatched lengths or negative window. Expected behavior: throw 
+	 *	invalid_argument.
+	 */
+	{
+		vector<Peak> peaks;
+		const vector<double> shortFreq(freq.begin(), freq.end() - 1);
+		BOOST_CHECK_THROW(findPeaks(shortFreq, power, 3, peaks), std::invalid_argument);
+		BOOST_CHECK_THROW(findPeaks(freq, power, 3, peaks, -0.1), std::invalid_argument);
+	}
+}
+
+BOOST_AUTO_TEST_SUITE_END()
+
+// Boost.Test uses non-virtual destructors
+#ifdef GNUC_FINEWARN
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Weffc++"
+#endif
+
+/** Test cases for testing functions related to handling Nan values
+ * @class BoostTest::test_nan
+ */
+BOOST_AUTO_TEST_SUITE(test_nan)
+
+/** Tests whether NaN diagnostics work as advertised
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(nan_check) {
+	// Easy access to special double values
+	typedef std::numeric_limits<double> d;
+	
+	BOOST_WARN(d::     has_infinity);
+	BOOST_WARN(d::    has_quiet_NaN);
+	BOOST_WARN(d::has_signaling_NaN);
+
+	// Skip tests if the system doesn't support special floating-point values
+	BOOST_CHECK(!d::     has_infinity || !isNan( d::     infinity()));
+	BOOST_CHECK(                         !isNan( 3.0               ));
+	BOOST_CHECK(                         !isNan( 0.0               ));
+	BOOST_CHECK(                         !isNan(-3.0               ));
+	BOOST_CHECK(!d::     has_infinity || !isNan(-d::     infinity()));
+	BOOST_CHECK(!d::    has_quiet_NaN ||  isNan(-d::    quiet_NaN()));
+	BOOST_CHECK(!d::has_signaling_NaN ||  isNan(-d::signaling_NaN()));
+	
+	BOOST_CHECK(!d::     has_infinity ||  isNanOrInf( d::     infinity()));
+	BOOST_CHECK(                         !isNanOrInf( 3.0               ));
+	BOOST_CHECK(                         !isNanOrInf( 0.0               ));
+	BOOST_CHECK(                         !isNanOrInf(-3.0               ));
+	BOOST_CHECK(!d::     has_infinity ||  isNanOrInf(-d::     infinity()));
+	BOOST_CHECK(!d::    has_quiet_NaN ||  isNanOrInf(-d::    quiet_NaN()));
+	BOOST_CHECK(!d::has_signaling_NaN ||  isNanOrInf(-d::signaling_NaN()));
+}
+
+/** Tests whether the bulk NaN tests work as advertised
+ *
+ * @exceptsafe Does not throw exceptions.
+ */
+BOOST_AUTO_TEST_CASE(nan_bulk) {
+	typedef std::numeric_limits<double> d;
+	
+	/** @test NotNan called through a const reference. Expected behavior: 
+	 *	agrees with isNan().
+	 */
+	{
+		const NotNan pred = NotNan();
+		BOOST_CHECK( pred(3.0));
+		BOOST_CHECK(!d::has_quiet_NaN || !pred(d::quiet_NaN()));
+	}
+	
+	/** @test Arrays of length 0, 3, and 1000, with no non-finite values. 
+	 *	Expected behavior: count is 0, first non-finite is at the end, 
+	 *	mask is all ones, and compaction keeps every row.
+	 */
+	const size_t LENGTHS[] = {0, 3, 1000};
+	for (size_t j = 0; j < 3; j++) {
+		const size_t n = LENGTHS[j];
+		vector<double> x(n, 1.5), y(n, -2.0), z(n, 0.0);
+		vector<unsigned char> mask(5, 0);
+		
+		BOOST_CHECK_EQUAL(countNonFinite(n ? &x[0] : NULL, n), 0U);
+		BOOST_CHECK_EQUAL(findFirstNonFinite(n ? &x[0] : NULL, n), n);
+		BOOST_CHECK_EQUAL(buildFiniteMask(n ? &x[0] : NULL, n, mask), n);
+		BOOST_CHECK_EQUAL(mask.size(), n);
+		BOOST_CHECK(std::count(mask.begin(), mask.end(), 1) == static_cast<long>(n));
+		BOOST_CHECK_EQUAL(compactFinite(x, y, z), n);
+		BOOST_CHECK_EQUAL(x.size(), n);
+	}
+	
+	/** @test Three columns of length 1000, with NaNs at rows 3, 500, and 
+	 *	999 of different columns and infinities at rows 257 and 700. 
+	 *	Expected behavior: count, first position, and mask are correct for 
+	 *	each column, and compaction keeps the other 995 rows in order.
+	 */
+	if (d::has_quiet_NaN && d::has_infinity) {
+		const size_t n = 1000;
+		vector<double> times, data, errors;
+		for (size_t i = 0; i < n; i++) {
+			times .push_back(static_cast<double>(i));
+			data  .push_back(static_cast<double>(i) * 2.0);
+			errors.push_back(1.0);
+		}
+		data  [  3] =  d::quiet_NaN();
+		times [257] =  d::infinity();
+		errors[500] =  d::quiet_NaN();
+		data  [700] = -d::infinity();
+		data  [999] =  d::quiet_NaN();
+		
+		BOOST_CHECK_EQUAL(countNonFinite(&data[0], n), 3U);
+		BOOST_CHECK_EQUAL(countNonFinite(&times[0], n), 1U);
+		BOOST_CHECK_EQUAL(findFirstNonFinite(&data[0], n), 3U);
+		BOOST_CHECK_EQUAL(findFirstNonFinite(&times[0], n), 257U);
+		BOOST_CHECK_EQUAL(findFirstNonFinite(&errors[0], n), 500U);
+		
+		vector<unsigned char> mask;
+		BOOST_CHECK_EQUAL(buildFiniteMask(&data[0], n, mask), n - 3);
+		BOOST_CHECK_EQUAL(mask[3], 0);
+		BOOST_CHECK_EQUAL(mask[4], 1);
+		BOOST_CHECK_EQUAL(mask[700], 0);
+		
+		BOOST_CHECK_EQUAL(compactFinite(times, data, errors), n - 5);
+		BOOST_REQUIRE_EQUAL(times.size(), n - 5);
+		BOOST_REQUIRE_EQUAL(data.size(), n - 5);
+		BOOST_REQUIRE_EQUAL(errors.size(), n - 5);
+		BOOST_CHECK(isSorted(times.begin(), times.end()));
+		for (size_t i = 0; i < times.size(); i++) {
+			BOOST_CHECK_EQUAL(data[i], times[i] * 2.0);
+		}
+		BOOST_CHECK_EQUAL(countNonFinite(&errors[0], errors.size()), 0U);
+		
+		/** @test Columns of different lengths. Expected behavior: throw 
+		 *	invalid_argument.
+		 */
+		times.push_back(0.0);
+		BOOST_CHECK_THROW(compactFinite(times, data), std::invalid_argument);
+	}
 }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,353 @@
+/** Variability indices of light curves
+ * @file common/variability.tmp.h
+ * @author Krzysztof Findeisen
+ * @date Created October 18, 2026
+ * @date Last modified October 18, 2026
+ */
+
+/* Copyright 2014, California Institute of Technology.
+ *
+ * This file is licensed under the BSD 3-Clause License. It is subject to the
+ * license terms in the LICENSE file found in the top-level directory of this
+ * distribution and at http://opensource.org/licenses/BSD-3-Clause.
+ */
+
+#ifndef KPFUTILSVARIABILITYH
+#define KPFUTILSVARIABILITYH
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cmath>
+#include <boost/lexical_cast.hpp>
+#include "moments.h"
+#include "sorted.tmp.h"
+#include "stats_except.h"
+
+namespace kpfutils {
+
+/** @addtogroup stats
+ *
+ * Include variability.tmp.h to compute the standard variability indices
+ * of a light curve together.
+ *
+ * @{
+ */
+
+/** Variability indices of a light curve, as returned by
+ *	variabilityIndices()
+ */
+struct VariabilityIndices {
+	/** Creates a summary of an empty light curve.
+	 *
+	 * @exceptsafe Does not throw exceptions.
+	 */
+	VariabilityIndices() : count(0), mean(0.0), stdDev(0.0), skewness(0.0),
+			kurtosis(0.0), eta(0.0), weightedMean(0.0), weightedStdDev(0.0),
+			stetsonJ(0.0), stetsonK(0.0) {
+	}
+
+	/** Number of measurements
+	 */
+	size_t count;
+	/** Unweighted mean of the measurements
+	 */
+	double mean;
+	/** Unweighted sample standard deviation of the measurements
+	 */
+	double stdDev;
+	/** Sample skewness, as returned by Moments::skewness()
+	 */
+	double skewness;
+	/** Sample excess kurtosis, as returned by Moments::kurtosis()
+	 */
+	double kurtosis;
+	/** von Neumann ratio: the mean square successive difference divided
+	 *	by the variance
+	 */
+	double eta;
+	/** Inverse-variance weighted mean, as returned by weightedMean()
+	 */
+	double weightedMean;
+	/** Square root of the weighted variance, as returned by
+	 *	weightedVariance()
+	 */
+	double weightedStdDev;
+	/** Stetson (1996) J index of successive pairs of measurements
+	 */
+	double stetsonJ;
+	/** Stetson (1996) K index
+	 */
+	double stetsonK;
+};
+
+namespace detail {
+
+/** Verifies that the columns of a light curve are consistent
+ *
+ * @param[in] nTimes The number of times.
+ * @param[in] data, errs The measurements and their errors.
+ *
+ * @exception std::invalid_argument Thrown if the columns have different
+ *	lengths.
+ *
+ * @exceptsafe Does not change any program state.
+ */
+template <typename Value>
+void checkColumns(size_t nTimes, const std::vector<Value>& data,
+		const std::vector<Value>& errs) {
+	if (data.size() != nTimes || errs.size() != nTimes) {
+		throw std::invalid_argument(
+			"Times, data, and errors have different lengths in variabilityIndices()");
+	}
+}
+
+/** Computes the variability indices of measurements in time order
+ *
+ * The first pass accumulates the central moments, the successive
+ * differences, and the weighted moments together; the second finds the
+ * normalized residuals needed by the Stetson indices.
+ *
+ * @param[in] data, errs The measurements and their errors, in time order.
+ * @param[out] result The indices of @p data.
+ *
+ * @exception kpfutils::except::NotEnoughData Thrown if there are fewer
+ *	than four measurements.
+ * @exception std::invalid_argument Thrown if any error is zero.
+ *
+ * @exceptsafe @p result is unchanged in the event of an exception.
+ */
+template <typename Value>
+void fusedIndices(const std::vector<Value>& data, const std::vector<Value>& errs,
+		VariabilityIndices& result) {
+	const size_t n = data.size();
+	if (n < 4) {
+		throw except::NotEnoughData("Not enough data to compute variability indices");
+	}
+
+	Moments moments;
+	double diffSq = 0.0;
+	double w = 0.0, wSq = 0.0, wMean = 0.0, s = 0.0;
+	for(size_t i = 0; i < n; i++) {
+		const double x   = static_cast<double>(data[i]);
+		const double err = static_cast<double>(errs[i]);
+
+		moments.add(x);
+		if (i > 0) {
+			const double diff = x - static_cast<double>(data[i-1]);
+			diffSq += diff * diff;
+		}
+
+		// West (1979) update of the weighted mean and squared deviations
+		const double wi = 1.0 / (err * err);
+		w   += wi;
+		wSq += wi * wi;
+		const double delta = x - wMean;
+		wMean += delta * wi / w;
+		s     += wi * delta * (x - wMean);
+	}
+	// Tests for infinity without requiring C99 or nan.h
+	if (!(w - w == 0.0)) {
+		throw std::invalid_argument("Zero or invalid error passed to variabilityIndices()");
+	}
+
+	const double dn   = static_cast<double>(n);
+	const double bias = std::sqrt(dn / (dn - 1.0));
+	double absSum = 0.0, sqSum = 0.0, jSum = 0.0, prev = 0.0;
+	for(size_t i = 0; i < n; i++) {
+		const double resid = bias * (static_cast<double>(data[i]) - wMean)
+			/ static_cast<double>(errs[i]);
+		absSum += std::fabs(resid);
+		sqSum  += resid * resid;
+		if (i > 0) {
+			const double p = prev * resid;
+			jSum += (p >= 0.0 ? std::sqrt(p) : -std::sqrt(-p));
+		}
+		prev = resid;
+	}
+
+	VariabilityIndices temp;
+	temp.count    = n;
+	temp.mean     = moments.mean();
+	const double var = moments.variance();
+	temp.stdDev   = std::sqrt(var);
+	temp.skewness = moments.skewness();
+	temp.kurtosis = moments.kurtosis();
+	temp.eta      = diffSq / (dn - 1.0) / var;
+	temp.weightedMean   = wMean;
+	temp.weightedStdDev = std::sqrt(s / (w - wSq/w));
+	temp.stetsonJ = jSum / (dn - 1.0);
+	temp.stetsonK = (absSum / dn) / std::sqrt(sqSum / dn);
+
+	// IMPORTANT: no exceptions beyond this point
+
+	result = temp;
+}
+
+}	// end detail
+
+/** Computes the standard variability indices of a light curve together.
+ *
+ * All indices are found from two passes over the measurements, instead
+ * of one or more passes per index. The first pass finds the central
+ * moments, the successive differences, and the weighted moments; the
+ * second finds the normalized residuals
+ * &delta;<sub>i</sub> = &radic;(N/(N-1)) (x<sub>i</sub> - &mu;<sub>w</sub>)/&sigma;<sub>i</sub>
+ * about the weighted mean &mu;<sub>w</sub>, from which
+ * J = &Sigma;<sub>i</sub> sgn(P<sub>i</sub>)&radic;|P<sub>i</sub>| / (N-1)
+ * with P<sub>i</sub> = &delta;<sub>i</sub>&delta;<sub>i+1</sub>, and
+ * K = (&Sigma;|&delta;<sub>i</sub>|/N) / &radic;(&Sigma;&delta;<sub>i</sub><sup>2</sup>/N).
+ * All sums are kept in @c double, whatever the type of the measurements.
+ *
+ * @tparam Value The type in which the measurements and errors are stored.
+ *	Must be convertible to @c double.
+ *
+ * @param[in] times The times at which @p data were measured.
+ * @param[in] data The measurements to summarize.
+ * @param[in] errs The error on each measurement.
+ *
+ * @return The variability indices of the light curve. If all measurements
+ *	are equal, the skewness, kurtosis, and &eta; are NaN.
+ *
+ * @pre No value in @p data or @p errs is NaN
+ *
+ * @perform O(N), where N = @p data.size().
+ *
+ * @exception std::invalid_argument Thrown if @p times, @p data, and
+ *	@p errs have different lengths, or if any error is zero.
+ * @exception kpfutils::except::NotSorted Thrown if @p times is not
+ *	sorted in ascending order.
+ * @exception kpfutils::except::NotEnoughData Thrown if there are fewer
+ *	than four measurements.
+ *
+ * @exceptsafe The arguments are unchanged in the event of an exception.
+ *
+ * @test Vectors of doubles, length 3. Expected behavior: throw
+ *	NotEnoughData.
+ * @test Vectors of doubles, mismatched lengths or one error zero.
+ *	Expected behavior: throw invalid_argument.
+ * @test Vectors of doubles, unsorted times. Expected behavior: throw
+ *	NotSorted.
+ * @test Vectors of doubles, length 100, randomly generated. Expected
+ *	behavior: agrees with separate calculations of each index to
+ *	within 1e-8.
+ * @test Measurements alternating between +1 and -1, equal errors.
+ *	Expected behavior: K = 1 and J = -2&radic;(N/(N-1)).
+ * @test Vectors of floats, length 100, randomly generated. Expected
+ *	behavior: agrees with the double version to within 1e-4, or
+ *	1e-5 absolute for J, which is near zero.
+ */
+template <typename Value>
+VariabilityIndices variabilityIndices(const std::vector<double>& times,
+		const std::vector<Value>& data, const std::vector<Value>& errs) {
+	detail::checkColumns(times.size(), data, errs);
+	if (!isSorted(times.begin(), times.end())) {
+		throw except::NotSorted("Times must be sorted in variabilityIndices()");
+	}
+
+	VariabilityIndices result;
+	detail::fusedIndices(data, errs, result);
+	return result;
+}
+
+/** Computes the standard variability indices of a light curve together,
+ *	without checking the order of the times.
+ *
+ * This function behaves exactly like the version taking a plain vector
+ * of times, but skips the check that the times are sorted.
+ *
+ * @exception std::invalid_argument Thrown if @p times, @p data, and
+ *	@p errs have different lengths, or if any error is zero.
+ * @exception kpfutils::except::NotEnoughData Thrown if there are fewer
+ *	than four measurements.
+ *
+ * @exceptsafe The arguments are unchanged in the event of an exception.
+ *
+ * @see variabilityIndices(const std::vector<double>&, const std::vector<Value>&, const std::vector<Value>&)
+ */
+template <typename Value>
+VariabilityIndices variabilityIndices(const Sorted<std::vector<double> >& times,
+		const std::vector<Value>& data, const std::vector<Value>& errs) {
+	detail::checkColumns(times.size(), data, errs);
+
+	VariabilityIndices result;
+	detail::fusedIndices(data, errs, result);
+	return result;
+}
+
+/** Computes the standard variability indices of many light curves.
+ *
+ * Each light curve is processed as by the single-curve version of
+ * variabilityIndices(). The curves are independent, so callers with
+ * very large batches may divide them among threads.
+ *
+ * @tparam Value The type in which the measurements and errors are stored.
+ *	Must be convertible to @c double.
+ *
+ * @param[in] times The times of each light curve.
+ * @param[in] data The measurements of each light curve.
+ * @param[in] errs The errors of each light curve.
+ * @param[out] results On output, @p results[i] holds the indices of the
+ *	ith light curve.
+ *
+ * @pre No value in @p data or @p errs is NaN
+ *
+ * @perform O(N), where N is the total number of measurements.
+ *
+ * @exception std::invalid_argument Thrown if @p times, @p data, and
+ *	@p errs hold different numbers of light curves, or if any light
+ *	curve is invalid as described for the single-curve version. The
+ *	message names the offending light curve.
+ * @exception kpfutils::except::NotEnoughData Thrown if any light curve
+ *	has fewer than four measurements. The message names the offending
+ *	light curve.
+ * @exception kpfutils::except::NotSorted Thrown if the times of any
+ *	light curve are not sorted. The message names the offending
+ *	light curve.
+ * @exception std::bad_alloc Thrown if there is not enough memory to
+ *	store the results.
+ *
+ * @exceptsafe The arguments are unchanged in the event of an exception.
+ *
+ * @test Three light curves of doubles, or of floats. Expected behavior:
+ *	results identical to the single-curve version.
+ * @test Three light curves, the second of length 3. Expected behavior:
+ *	throw NotEnoughData.
+ */
+template <typename Value>
+void variabilityIndices(const std::vector<std::vector<double> >& times,
+		const std::vector<std::vector<Value> >& data,
+		const std::vector<std::vector<Value> >& errs,
+		std::vector<VariabilityIndices>& results) {
+	if (data.size() != times.size() || errs.size() != times.size()) {
+		throw std::invalid_argument(
+			"Different numbers of light curves passed to variabilityIndices()");
+	}
+
+	// copy-and-swap
+	std::vector<VariabilityIndices> temp(times.size());
+	for(size_t i = 0; i < times.size(); i++) {
+		try {
+			temp[i] = variabilityIndices(times[i], data[i], errs[i]);
+		} catch (const except::NotEnoughData& e) {
+			throw except::NotEnoughData("Light curve "
+				+ boost::lexical_cast<std::string>(i) + ": " + e.what());
+		} catch (const except::NotSorted& e) {
+			throw except::NotSorted("Light curve "
+				+ boost::lexical_cast<std::string>(i) + ": " + e.what());
+		} catch (const std::invalid_argument& e) {
+			throw std::invalid_argument("Light curve "
+				+ boost::lexical_cast<std::string>(i) + ": " + e.what());
+		}
+	}
+
+	// IMPORTANT: no exceptions beyond this point
+
+	results.swap(temp);
+}
+
+/** @} */	// end stats
+
+}	// end kpfutils
+
+#endif		// KPFUTILSVARIABILITYH
@@ -2,7 +2,7 @@
  * @file common/writetable.cpp
  * @author Krzysztof Findeisen
  * @date Created July 24, 2011
- * @date Last modified October 29, 2013
+ * @date Last modified October 18, 2026
  */
 
 /* Copyright 2014, California Institute of Technology.
@@ -32,6 +32,8 @@ using boost::lexical_cast;
  * @param[in] fileName an the name of a file to be written to
  * @param[in] header a string to be printed at the start of the file
  * @param[in] col1, col2 vectors of values to print
+ * @param[in] codec the compression format for @p fileName. By default, 
+ *	chosen from the extension of @p fileName.
  *
  * @pre @p col1.size() = @p col2.size()
  * 
@@ -44,10 +46,11 @@ using boost::lexical_cast;
  * @exceptsafe Program is in a consistent state in the event of an exception.
  */
 void printTable(const string& fileName, const string& header, 
-		const vector<double>& col1, const vector<double>& col2) {
+		const vector<double>& col1, const vector<double>& col2, Codec codec) {
 	try {
-		boost::shared_ptr<FILE> hOutput = fileCheckOpen(fileName, "w");
+		boost::shared_ptr<FILE> hOutput = fileCheckOpen(fileName, "w", codec);
 		printTable(hOutput.get(), header, col1, col2);
+		fileCheckClose(hOutput);
 	} catch (const std::runtime_error& e) {
 		throw except::FileIo(e.what());
 	}
@@ -98,6 +101,8 @@ void printTable(FILE* hOutput, const string& header,
  * @param[in] fileName the name of a file to be written to
  * @param[in] binEdges a vector of starting and ending bin edges
  * @param[in] values a vector of bin heights
+ * @param[in] codec the compression format for @p fileName. By default, 
+ *	chosen from the extension of @p fileName.
  * 
  * @pre @p binEdges.size() = @p values.size()+1
  * @pre for all i, @p values[i] is the number of items between binEdges[i] and binEdges[i+1]
@@ -111,10 +116,11 @@ void printTable(FILE* hOutput, const string& header,
  * @exceptsafe Program is in a consistent state in the event of an exception.
  */
 void printHist(const string& fileName, 
-		const vector<double>& binEdges, const vector<double>& values) {
+		const vector<double>& binEdges, const vector<double>& values, Codec codec) {
 	try {
-		boost::shared_ptr<FILE> hOutput = fileCheckOpen(fileName, "w");
+		boost::shared_ptr<FILE> hOutput = fileCheckOpen(fileName, "w", codec);
 		printHist(hOutput.get(), binEdges, values);
+		fileCheckClose(hOutput);
 	} catch (const std::runtime_error& e) {
 		throw except::FileIo(e.what());
 	}